@@ -6,25 +6,34 @@
 // SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
 // SPDX-License-Identifier: BSD-3-Clause
 
+#include "vast/format/arrow.hpp"
 #include "vast/format/json.hpp"
 #include "vast/system/make_pipelines.hpp"
 
+#include <vast/chunk.hpp>
 #include <vast/command.hpp>
 #include <vast/concept/convertible/to.hpp>
 #include <vast/concept/parseable/numeric.hpp>
 #include <vast/concept/parseable/to.hpp>
 #include <vast/concept/parseable/vast/expression.hpp>
+#include <vast/defaults.hpp>
+#include <vast/detail/narrow.hpp>
+#include <vast/detail/string.hpp>
 #include <vast/plugin.hpp>
 #include <vast/query_context.hpp>
 #include <vast/system/actors.hpp>
 #include <vast/system/node_control.hpp>
 #include <vast/system/parse_query.hpp>
+#include <vast/system/partition_request_window.hpp>
 #include <vast/system/query_cursor.hpp>
 #include <vast/table_slice.hpp>
 
+#include <caf/actor_system_config.hpp>
 #include <caf/stateful_actor.hpp>
 #include <caf/typed_event_based_actor.hpp>
 
+#include <sstream>
+
 namespace vast::plugins::rest_api::export_ {
 
 static auto const* SPEC_V0 = R"_(
@@ -84,10 +93,42 @@ static auto const* SPEC_V0 = R"_(
         required: false
         description: Render durations as numeric values.
         example: false
+      - in: query
+        name: compression
+        schema:
+          type: string
+          enum: [none, lz4, zstd]
+          default: none
+        required: false
+        description: The buffer compression of Arrow IPC responses.
+        example: zstd
     responses:
       200:
         description: The result data.
         content:
+          application/vnd.apache.arrow.stream:
+            schema:
+              type: string
+              format: binary
+              description: >
+                The events as Arrow IPC streams, selected by the Accept header.
+                Every schema change starts a new stream, so the response may
+                consist of several concatenated streams. The response uses
+                chunked transfer encoding and streams the events as they
+                arrive.
+          application/x-ndjson:
+            schema:
+              type: string
+              description: >
+                The events as newline-delimited JSON, selected by the Accept
+                header. The response uses chunked transfer encoding and streams
+                the events as they arrive.
+          text/event-stream:
+            schema:
+              type: string
+              description: >
+                The events as server-sent events with one event per `data`
+                field, selected by the Accept header.
           application/json:
             schema:
                 type: object
@@ -157,10 +198,39 @@ static auto const* SPEC_V0 = R"_(
                 default: true
                 description: Flatten nested elements in the response data.
                 example: false
+              compression:
+                type: string
+                enum: [none, lz4, zstd]
+                default: none
+                description: The buffer compression of Arrow IPC responses.
+                example: zstd
     responses:
       200:
         description: The result data.
         content:
+          application/vnd.apache.arrow.stream:
+            schema:
+              type: string
+              format: binary
+              description: >
+                The events as Arrow IPC streams, selected by the Accept header.
+                Every schema change starts a new stream, so the response may
+                consist of several concatenated streams. The response uses
+                chunked transfer encoding and streams the events as they
+                arrive.
+          application/x-ndjson:
+            schema:
+              type: string
+              description: >
+                The events as newline-delimited JSON, selected by the Accept
+                header. The response uses chunked transfer encoding and streams
+                the events as they arrive.
+          text/event-stream:
+            schema:
+              type: string
+              description: >
+                The events as server-sent events with one event per `data`
+                field, selected by the Accept header.
           application/json:
             schema:
                 type: object
@@ -232,10 +302,39 @@ static auto const* SPEC_V0 = R"_(
                 default: true
                 description: Flatten nested elements in the response data.
                 example: false
+              compression:
+                type: string
+                enum: [none, lz4, zstd]
+                default: none
+                description: The buffer compression of Arrow IPC responses.
+                example: zstd
     responses:
       200:
         description: The result data.
         content:
+          application/vnd.apache.arrow.stream:
+            schema:
+              type: string
+              format: binary
+              description: >
+                The events as Arrow IPC streams, selected by the Accept header.
+                Every schema change starts a new stream, so the response may
+                consist of several concatenated streams. The response uses
+                chunked transfer encoding and streams the events as they
+                arrive.
+          application/x-ndjson:
+            schema:
+              type: string
+              description: >
+                The events as newline-delimited JSON, selected by the Accept
+                header. The response uses chunked transfer encoding and streams
+                the events as they arrive.
+          text/event-stream:
+            schema:
+              type: string
+              description: >
+                The events as server-sent events with one event per `data`
+                field, selected by the Accept header.
           application/json:
             schema:
                 type: object
@@ -289,7 +388,10 @@ static auto const* SPEC_V0 = R"_(
 /// The EXPORT_HELPER handles a single query request.
 using export_helper_actor = system::typed_actor_fwd<
   // Receives an `atom::done` from the index after each batch of table slices.
-  auto(atom::done)->caf::result<void>>
+  auto(atom::done)->caf::result<void>,
+  // Receives the number of bytes of a streaming response that were written to
+  // the client.
+  auto(atom::resume, uint64_t)->caf::result<void>>
   // Receives table slices from the index.
   ::extend_with<system::receiver_actor<table_slice>>::unwrap;
 
@@ -304,6 +406,7 @@ struct export_format_options {
   bool flatten = defaults::rest::export_::flatten;
   bool numeric_durations = defaults::rest::export_::numeric_durations;
   bool omit_nulls = defaults::rest::export_::omit_nulls;
+  ::arrow::Compression::type compression = ::arrow::Compression::UNCOMPRESSED;
 };
 
 struct export_parameters {
@@ -323,6 +426,31 @@ struct export_helper_state {
   std::optional<system::query_cursor> cursor_ = std::nullopt;
   std::vector<table_slice> results_ = {};
   http_request request_;
+
+  /// Sizes the number of partitions that we ask the index for at once.
+  system::partition_request_window partition_window_ = {};
+
+  /// The number of events of the partitions that were requested last.
+  uint64_t round_events_ = 0;
+
+  // -- streaming responses ----------------------------------------------------
+
+  /// Whether results go to the client as soon as they arrive. This is the case
+  /// for streaming content types, unless the pipeline contains an aggregation
+  /// that needs to see all results first.
+  bool stream_results_ = false;
+  std::optional<format::arrow::ipc_chunk_writer> ipc_writer_ = {};
+  std::optional<format::json::writer> json_writer_ = {};
+
+  /// The number of bytes that were flushed, but not yet written to the client.
+  size_t inflight_bytes_ = 0;
+
+  /// The number of bytes in flight above which the export stops evaluating
+  /// further partitions.
+  size_t max_inflight_bytes_ = defaults::rest::export_::max_inflight_bytes;
+
+  /// Set when the next batch of partitions waits for the client to catch up.
+  bool awaiting_credit_ = false;
 };
 
 /// Format a set of table slices like this:
@@ -434,13 +562,18 @@ std::string format_result_typed(const std::vector<table_slice>& slices,
                      num_events, events_stringified);
 }
 
-std::string format_results(const std::vector<table_slice>& slices,
-                           const export_format_options& opts) {
+caf::settings make_json_writer_settings(const export_format_options& opts) {
   auto json_writer_settings = caf::settings{};
   put(json_writer_settings, "vast.export.json.flatten", opts.flatten);
   put(json_writer_settings, "vast.export.json.numeric-durations",
       opts.numeric_durations);
   put(json_writer_settings, "vast.export.json.omit-nulls", opts.omit_nulls);
+  return json_writer_settings;
+}
+
+std::string format_results(const std::vector<table_slice>& slices,
+                           const export_format_options& opts) {
+  auto json_writer_settings = make_json_writer_settings(opts);
   if (opts.typed_results)
     return format_result_typed(slices, json_writer_settings);
   else
@@ -456,6 +589,143 @@ struct export_multiplexer_state {
   system::index_actor index_ = {};
 };
 
+/// Renders a table slice for a streaming response. Newline-delimited JSON
+/// contains one event per line, and server-sent events contain one event per
+/// `data` field.
+caf::expected<std::vector<chunk_ptr>>
+render_streaming(export_helper_state& state, const table_slice& slice) {
+  if (state.ipc_writer_) {
+    if (auto err = state.ipc_writer_->write(slice))
+      return err;
+    return state.ipc_writer_->take();
+  }
+  VAST_ASSERT(state.json_writer_);
+  if (auto err = state.json_writer_->write(slice))
+    return err;
+  auto& out = static_cast<std::stringstream&>(state.json_writer_->out());
+  auto lines = out.str();
+  out.str({});
+  if (state.request_.content_type == http_content_type::event_stream) {
+    auto events = std::string{};
+    events.reserve(lines.size() + slice.rows() * 8);
+    for (auto line : detail::split(lines, "\n")) {
+      if (line.empty())
+        continue;
+      events += "data: ";
+      events += line;
+      events += "\n\n";
+    }
+    lines = std::move(events);
+  }
+  auto result = std::vector<chunk_ptr>{};
+  if (!lines.empty())
+    result.push_back(chunk::make(std::move(lines)));
+  return result;
+}
+
+/// Asks the index to evaluate the next partitions for the query.
+void request_next_partition(
+  export_helper_actor::stateful_pointer<export_helper_state> self) {
+  auto& cursor = *self->state.cursor_;
+  auto& window = self->state.partition_window_;
+  auto n = detail::narrow<uint32_t>(
+    window.next(cursor.candidate_partitions - cursor.scheduled_partitions,
+                self->state.params_.limit - self->state.events_));
+  cursor.scheduled_partitions += n;
+  window.start(n, system::stopwatch::now());
+  self->send(self->state.index_, atom::query_v, cursor.id, n);
+}
+
+/// Stops the evaluation of further partitions once the export reached its
+/// limit or failed. The index does not signal completion for a cancelled
+/// query, so we finish the response ourselves.
+void cancel_remaining_partitions(
+  export_helper_actor::stateful_pointer<export_helper_state> self) {
+  const auto& cursor = *self->state.cursor_;
+  VAST_DEBUG("{} skips {} of {} partitions", *self,
+             cursor.candidate_partitions - cursor.scheduled_partitions,
+             cursor.candidate_partitions);
+  self->send(self->state.index_, atom::stop_v, cursor.id);
+  self->send(self, atom::done_v);
+}
+
+/// Ends the response with an error, and terminates the helper along with the
+/// evaluation of the query.
+void abort_export(
+  export_helper_actor::stateful_pointer<export_helper_state> self,
+  std::string message, caf::error err) {
+  self->state.request_.response->abort(500, std::move(message));
+  // Releasing the response ends it with the error message.
+  self->state.request_.response.reset();
+  if (self->state.cursor_)
+    cancel_remaining_partitions(self);
+  self->quit(std::move(err));
+}
+
+/// Sends table slices to the client of a streaming response. The client
+/// returns credit for the written bytes asynchronously.
+void stream_results(
+  export_helper_actor::stateful_pointer<export_helper_state> self,
+  std::vector<table_slice> slices) {
+  auto& response = self->state.request_.response;
+  auto bytes = uint64_t{0};
+  for (const auto& slice : slices) {
+    auto chunks = render_streaming(self->state, slice);
+    if (!chunks)
+      return abort_export(
+        self, fmt::format("failed to render results: {}\n", chunks.error()),
+        std::move(chunks.error()));
+    for (auto& chunk : *chunks) {
+      bytes += chunk->size();
+      response->append_chunk(std::move(chunk));
+    }
+  }
+  if (bytes == 0)
+    return;
+  self->state.inflight_bytes_ += bytes;
+  auto handle = caf::actor_cast<export_helper_actor>(self);
+  response->flush([handle, bytes](caf::error err) {
+    if (err)
+      caf::anon_send_exit(handle, std::move(err));
+    else
+      caf::anon_send(handle, atom::resume_v, bytes);
+  });
+}
+
+/// Ends a streaming response after all results were sent.
+void finish_streaming(
+  export_helper_actor::stateful_pointer<export_helper_state> self) {
+  auto& response = self->state.request_.response;
+  if (!self->state.stream_results_) {
+    // The pipeline aggregates all results, which we can only send now.
+    auto slices = std::vector<table_slice>{};
+    for (auto&& slice : std::exchange(self->state.results_, {}))
+      if (auto error = self->state.pipeline_->add(std::move(slice)))
+        return abort_export(
+          self, fmt::format("failed to apply pipeline: {}\n", error),
+          std::move(error));
+    auto transformed = self->state.pipeline_->finish();
+    if (!transformed)
+      return abort_export(
+        self,
+        fmt::format("failed to apply pipeline: {}\n", transformed.error()),
+        std::move(transformed.error()));
+    stream_results(self, std::move(*transformed));
+    if (!response)
+      return;
+  }
+  if (self->state.ipc_writer_) {
+    if (auto err = self->state.ipc_writer_->close())
+      return abort_export(
+        self, fmt::format("failed to write Arrow IPC stream: {}\n", err),
+        std::move(err));
+    for (auto& chunk : self->state.ipc_writer_->take())
+      response->append_chunk(std::move(chunk));
+  }
+  // Releasing the response sends the remaining data and ends it.
+  response.reset();
+}
+
 export_helper_actor::behavior_type
 export_helper(export_helper_actor::stateful_pointer<export_helper_state> self,
               system::index_actor index, export_parameters&& params,
@@ -465,12 +735,46 @@ export_helper(export_helper_actor::stateful_pointer<export_helper_state> self,
   self->state.request_ = std::move(request);
   self->state.params_ = std::move(params);
   self->state.pipeline_ = std::move(executor);
+  if (is_streaming(self->state.request_.content_type)) {
+    self->state.stream_results_
+      = !self->state.pipeline_
+        || !self->state.pipeline_->validate(
+          pipeline_executor::allow_aggregate_pipelines::no);
+    if (self->state.request_.content_type == http_content_type::arrow_stream) {
+      auto writer = format::arrow::ipc_chunk_writer::make(
+        self->state.params_.format_opts.compression);
+      if (!writer) {
+        self->state.request_.response->abort(
+          500, fmt::format("failed to create Arrow IPC writer: {}\n",
+                           writer.error()));
+        self->quit(writer.error());
+        return export_helper_actor::behavior_type::make_empty_behavior();
+      }
+      self->state.ipc_writer_ = std::move(*writer);
+    } else {
+      self->state.json_writer_.emplace(
+        std::make_unique<std::stringstream>(),
+        make_json_writer_settings(self->state.params_.format_opts));
+    }
+  }
+  self->state.partition_window_ = system::partition_request_window{
+    system::partition_request_window::make_options(
+      content(self->system().config()))};
+  self->state.max_inflight_bytes_ = static_cast<size_t>(std::max(
+    int64_t{0},
+    caf::get_or(content(self->system().config()),
+                "vast.max-inflight-export-bytes",
+                static_cast<int64_t>(
+                  defaults::rest::export_::max_inflight_bytes))));
   auto query
     = vast::query_context::make_extract("api", self, self->state.params_.expr);
   self->request(self->state.index_, caf::infinite, atom::evaluate_v, query)
     .await(
       [self](system::query_cursor cursor) {
         self->state.cursor_ = cursor;
+        if (cursor.scheduled_partitions > 0)
+          self->state.partition_window_.start(cursor.scheduled_partitions,
+                                              system::stopwatch::now());
       },
       [self](const caf::error& e) {
         auto response = fmt::format("received error response from index {}", e);
@@ -480,24 +784,69 @@ export_helper(export_helper_actor::stateful_pointer<export_helper_state> self,
   return {
     // Index-facing API
     [self](vast::table_slice& slice) {
+      self->state.round_events_ += slice.rows();
       if (self->state.params_.limit <= self->state.events_)
         return;
       auto remaining = self->state.params_.limit - self->state.events_;
       self->state.events_ += std::min<size_t>(slice.rows(), remaining);
-      if (slice.rows() < remaining)
+      if (slice.rows() >= remaining) {
+        slice = head(std::move(slice), remaining);
+        cancel_remaining_partitions(self);
+      }
+      if (!self->state.stream_results_) {
         self->state.results_.emplace_back(std::move(slice));
-      else
-        self->state.results_.emplace_back(head(std::move(slice), remaining));
+        return;
+      }
+      auto slices = std::vector<table_slice>{};
+      if (self->state.pipeline_) {
+        if (auto error = self->state.pipeline_->add(std::move(slice)))
+          return abort_export(
+            self, fmt::format("failed to apply pipeline: {}\n", error),
+            std::move(error));
+        auto transformed = self->state.pipeline_->finish();
+        if (!transformed)
+          return abort_export(
+            self,
+            fmt::format("failed to apply pipeline: {}\n", transformed.error()),
+            std::move(transformed.error()));
+        slices = std::move(*transformed);
+      } else {
+        slices.push_back(std::move(slice));
+      }
+      stream_results(self, std::move(slices));
+    },
+    [self](atom::resume, uint64_t bytes) {
+      VAST_ASSERT(bytes <= self->state.inflight_bytes_);
+      self->state.inflight_bytes_ -= bytes;
+      if (self->state.awaiting_credit_
+          && self->state.inflight_bytes_ <= self->state.max_inflight_bytes_) {
+        self->state.awaiting_credit_ = false;
+        request_next_partition(self);
+      }
     },
     [self](atom::done) {
+      if (!self->state.request_.response)
+        return;
+      // A client that falls behind the streamed results slows down the
+      // evaluation of further partitions.
+      if (self->state.partition_window_.in_flight())
+        self->state.partition_window_.finish(
+          std::exchange(self->state.round_events_, 0),
+          self->state.inflight_bytes_ > self->state.max_inflight_bytes_ / 2,
+          system::stopwatch::now());
       bool remaining_partitions = self->state.cursor_->candidate_partitions
                                   > self->state.cursor_->scheduled_partitions;
       auto remaining_events = self->state.params_.limit > self->state.events_;
       if (remaining_partitions && remaining_events) {
-        auto next_batch_size = uint32_t{1};
-        self->state.cursor_->scheduled_partitions += next_batch_size;
-        self->send(self->state.index_, atom::query_v, self->state.cursor_->id,
-                   next_batch_size);
+        // Streaming responses evaluate the next partition only once the
+        // client caught up with the results that are on their way.
+        if (self->state.inflight_bytes_ > self->state.max_inflight_bytes_) {
+          self->state.awaiting_credit_ = true;
+          return;
+        }
+        request_next_partition(self);
+      } else if (is_streaming(self->state.request_.content_type)) {
+        finish_streaming(self);
       } else {
         std::vector<table_slice> slices;
         if (self->state.pipeline_) {
@@ -586,6 +935,16 @@ export_multiplexer_actor::behavior_type export_multiplexer(
         VAST_ASSERT(caf::holds_alternative<bool>(param));
         params.format_opts.numeric_durations = caf::get<bool>(param);
       }
+      if (rq.params.contains("compression")) {
+        auto& param = rq.params.at("compression");
+        VAST_ASSERT(caf::holds_alternative<std::string>(param));
+        auto compression
+          = format::arrow::to_ipc_compression(caf::get<std::string>(param));
+        if (!compression)
+          return rq.response->abort(
+            422, fmt::format("invalid compression: {}\n", compression.error()));
+        params.format_opts.compression = *compression;
+      }
       auto pipeline_executor = std::optional<vast::pipeline_executor>{};
       if (rq.params.contains("pipeline")) {
         auto data = from_json(caf::get<std::string>(rq.params.at("pipeline")));
@@ -658,6 +1017,7 @@ class plugin final : public virtual rest_endpoint_plugin {
       {"flatten", vast::bool_type{}},
       {"omit-nulls", vast::bool_type{}},
       {"numeric-durations", vast::bool_type{}},
+      {"compression", vast::string_type{}},
     };
     static auto endpoints = std::vector<vast::rest_endpoint>{
       {
@@ -667,6 +1027,9 @@ class plugin final : public virtual rest_endpoint_plugin {
         .params = common_parameters,
         .version = api_version::v0,
         .content_type = http_content_type::json,
+        .alternative_content_types = {http_content_type::arrow_stream,
+                                      http_content_type::ndjson,
+                                      http_content_type::event_stream},
       },
       {
         .endpoint_id = ENDPOINT_EXPORT,
@@ -675,6 +1038,9 @@ class plugin final : public virtual rest_endpoint_plugin {
         .params = common_parameters,
         .version = api_version::v0,
         .content_type = http_content_type::json,
+        .alternative_content_types = {http_content_type::arrow_stream,
+                                      http_content_type::ndjson,
+                                      http_content_type::event_stream},
       },
       {
         .endpoint_id = ENDPOINT_EXPORT_TYPED,
@@ -683,6 +1049,9 @@ class plugin final : public virtual rest_endpoint_plugin {
         .params = common_parameters,
         .version = api_version::v0,
         .content_type = http_content_type::json,
+        .alternative_content_types = {http_content_type::arrow_stream,
+                                      http_content_type::ndjson,
+                                      http_content_type::event_stream},
       },
     };
     return endpoints;
@@ -6,6 +6,7 @@
 // SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
 // SPDX-License-Identifier: BSD-3-Clause
 
+#include "vast/format/arrow.hpp"
 #include "vast/format/json.hpp"
 #include "vast/pipeline.hpp"
 
@@ -14,14 +15,17 @@
 #include <vast/concept/parseable/numeric.hpp>
 #include <vast/concept/parseable/to.hpp>
 #include <vast/concept/parseable/vast/expression.hpp>
+#include <vast/detail/narrow.hpp>
 #include <vast/plugin.hpp>
 #include <vast/query_context.hpp>
 #include <vast/system/actors.hpp>
 #include <vast/system/node_control.hpp>
 #include <vast/system/parse_query.hpp>
+#include <vast/system/partition_request_window.hpp>
 #include <vast/system/query_cursor.hpp>
 #include <vast/table_slice.hpp>
 
+#include <caf/actor_system_config.hpp>
 #include <caf/stateful_actor.hpp>
 #include <caf/typed_event_based_actor.hpp>
 
@@ -76,10 +80,28 @@ static auto const* SPEC_V0 = R"_(
         required: false
         example: 10
         description: Maximum number of returned events
+      - in: query
+        name: compression
+        schema:
+          type: string
+          enum: [none, lz4, zstd]
+          default: none
+        required: false
+        example: zstd
+        description: The buffer compression of Arrow IPC responses.
     responses:
       200:
         description: Success.
         content:
+          application/vnd.apache.arrow.stream:
+            schema:
+              type: string
+              format: binary
+              description: >
+                The returned events as Arrow IPC streams, selected by the
+                Accept header. Every schema change starts a new stream, so the
+                response may consist of several concatenated streams. The
+                response is empty if there are no more events.
           application/json:
             schema:
               type: object
@@ -125,36 +147,46 @@ using request_multiplexer_actor = system::typed_actor_fwd<>
 
 namespace {
 
-// Remove up to `n` events from the `slices` vector and return them
-// as a JSONLD string + number of events drained.
-std::pair<size_t, std::string>
-drain_buffer(std::deque<table_slice>& slices, size_t n) {
-  auto written = size_t{0};
-  bool error_encountered = false;
-  auto ostream = std::make_unique<std::stringstream>();
-  auto writer = vast::format::json::writer{std::move(ostream), caf::settings{}};
-  for (auto it = slices.begin(); it != slices.end(); ++it) {
-    auto& slice = *it;
-    if (slice.rows() < n) {
-      written += slice.rows();
-      if (auto error = writer.write(slice))
-        error_encountered = true;
+// Remove up to `n` events from the front of `slices`.
+std::vector<table_slice> take(std::deque<table_slice>& slices, size_t n) {
+  auto result = std::vector<table_slice>{};
+  while (n > 0 && !slices.empty()) {
+    auto& slice = slices.front();
+    if (slice.rows() <= n) {
+      n -= slice.rows();
+      result.push_back(std::move(slice));
+      slices.pop_front();
     } else {
       auto [first, second] = split(slice, n);
-      written += first.rows();
-      if (auto error = writer.write(first))
-        error_encountered = true;
-      slice = second;
-      slices.erase(slices.begin(), it);
-      break;
+      result.push_back(std::move(first));
+      slice = std::move(second);
+      n = 0;
     }
   }
-  if (error_encountered)
-    VAST_WARN("query endpoint encountered error writing json data");
-  return {written, static_cast<std::stringstream&>(writer.out()).str()};
+  return result;
 }
 
-constexpr auto BATCH_SIZE = uint32_t{1};
+// Render events as the JSON response body of the `next` endpoint.
+std::string
+format_events(const std::vector<table_slice>& slices, size_t position) {
+  auto ostream = std::make_unique<std::stringstream>();
+  auto writer = vast::format::json::writer{std::move(ostream), caf::settings{}};
+  for (const auto& slice : slices)
+    if (auto error = writer.write(slice))
+      VAST_WARN("query endpoint encountered error writing json data: {}",
+                error);
+  auto result = fmt::format("{{\"position\": {}, \"events\": [\n", position);
+  std::istringstream iss{static_cast<std::stringstream&>(writer.out()).str()};
+  size_t count = 0ull;
+  std::string line;
+  while (std::getline(iss, line)) {
+    if (count++ != 0)
+      result += ",\n";
+    result += line;
+  }
+  result += "]}\n";
+  return result;
+}
 
 } // namespace
 
@@ -170,10 +202,12 @@ struct query_manager_state {
   size_t position = 0;
   size_t events = 0;
   size_t limit = std::string::npos;
-  std::string response_body; // The current response to the GET endpoint
-  std::string body_buffer;   // JSONLD buildup of current response
+  ::arrow::Compression::type compression = ::arrow::Compression::UNCOMPRESSED;
+  std::vector<table_slice> results; // The events of the current response
   std::deque<table_slice> slice_buffer;
   std::optional<system::query_cursor> cursor = std::nullopt;
+  system::partition_request_window partition_window = {};
+  uint64_t round_events = 0; // The events of the requested partitions
 };
 
 struct request_multiplexer_state {
@@ -189,6 +223,10 @@ query_manager_actor::behavior_type
 query_manager(query_manager_actor::stateful_pointer<query_manager_state> self,
               system::index_actor index) {
   self->state.index = std::move(index);
+  self->state.partition_window
+    = system::partition_request_window{system::partition_request_window::
+                                         make_options(content(
+                                           self->system().config()))};
   self->set_exit_handler([self](const caf::exit_msg& msg) {
     if (self->state.promise.pending())
       self->state.promise.deliver(msg.reason);
@@ -203,27 +241,43 @@ query_manager(query_manager_actor::stateful_pointer<query_manager_state> self,
               rq.response->abort(500, "query manager not ready");
             if (self->state.query_in_progress)
               rq.response->abort(503, "previous request still in progress");
+            auto compression = ::arrow::Compression::UNCOMPRESSED;
+            if (rq.params.contains("compression")) {
+              auto parsed = format::arrow::to_ipc_compression(
+                caf::get<std::string>(rq.params.at("compression")));
+              if (!parsed) {
+                rq.response->abort(422, fmt::format("invalid compression: "
+                                                    "{}\n",
+                                                    parsed.error()));
+                return atom::done_v;
+              }
+              compression = *parsed;
+            }
             self->state.request = std::move(rq);
             self->state.limit = n;
+            self->state.compression = compression;
             self->state.position += self->state.events;
-            self->state.body_buffer = "";
             self->state.promise = self->make_response_promise<atom::done>();
-            std::tie(self->state.events, self->state.body_buffer)
-              = drain_buffer(self->state.slice_buffer, n);
+            self->state.results = take(self->state.slice_buffer, n);
+            self->state.events = 0;
+            for (const auto& slice : self->state.results)
+              self->state.events += slice.rows();
             // Forward to the `done` handler to avoid repeating the same logic
             // here.
             self->send(self, atom::done_v);
             return self->state.promise;
           },
           // Index-facing API
-          [self](const vast::table_slice& slice) {
-            self->state.slice_buffer.push_back(slice);
+          [self](vast::table_slice& slice) {
+            self->state.round_events += slice.rows();
+            self->state.slice_buffer.push_back(std::move(slice));
             if (self->state.limit <= self->state.events)
               return;
             auto remaining = self->state.limit - self->state.events;
-            auto [n, json] = drain_buffer(self->state.slice_buffer, remaining);
-            self->state.body_buffer += json;
-            self->state.events += n;
+            for (auto& x : take(self->state.slice_buffer, remaining)) {
+              self->state.events += x.rows();
+              self->state.results.push_back(std::move(x));
+            }
           },
           [self](atom::done) {
             // There's technically a race condition with atom::provision here,
@@ -233,28 +287,43 @@ query_manager(query_manager_actor::stateful_pointer<query_manager_state> self,
               return;
             if (!self->state.promise.pending())
               return;
+            auto& window = self->state.partition_window;
+            if (window.in_flight())
+              window.finish(std::exchange(self->state.round_events, 0), false,
+                            system::stopwatch::now());
             bool remaining_partitions
               = self->state.cursor->candidate_partitions
                 > self->state.cursor->scheduled_partitions;
             auto remaining_events = self->state.limit > self->state.events;
             if (remaining_partitions && remaining_events) {
-              self->state.cursor->scheduled_partitions += BATCH_SIZE;
+              // The client pulls results, so there is no need to account for
+              // a slow consumer beyond limiting the requested partitions to
+              // the remaining demand.
+              auto n = detail::narrow<uint32_t>(
+                window.next(self->state.cursor->candidate_partitions
+                              - self->state.cursor->scheduled_partitions,
+                            self->state.limit - self->state.events));
+              self->state.cursor->scheduled_partitions += n;
+              window.start(n, system::stopwatch::now());
               self->send(self->state.index, atom::query_v,
-                         self->state.cursor->id, BATCH_SIZE);
+                         self->state.cursor->id, n);
             } else {
-              self->state.response_body = fmt::format(
-                "{{\"position\": {}, \"events\": [\n", self->state.position);
-              std::istringstream iss{self->state.body_buffer};
-              size_t count = 0ull;
-              std::string line;
-              while (std::getline(iss, line)) {
-                if (count++ != 0)
-                  self->state.response_body += ",\n";
-                self->state.response_body += line;
-              }
-              self->state.response_body += "]}\n";
               auto request = std::exchange(self->state.request, {});
-              request.response->append(self->state.response_body);
+              auto results = std::exchange(self->state.results, {});
+              if (request.content_type == http_content_type::arrow_stream) {
+                auto chunks = format::arrow::to_ipc_streams(
+                  results, self->state.compression);
+                if (!chunks)
+                  request.response->abort(
+                    500, fmt::format("failed to write Arrow IPC stream: {}\n",
+                                     chunks.error()));
+                else
+                  for (auto& chunk : *chunks)
+                    request.response->append_chunk(std::move(chunk));
+              } else {
+                request.response->append(
+                  format_events(results, self->state.position));
+              }
               self->state.promise.deliver(atom::done_v);
             }
           }};
@@ -382,9 +451,11 @@ class plugin final : public virtual rest_endpoint_plugin {
         .params = vast::record_type{
           {"id", vast::string_type{}},
           {"n", vast::uint64_type{}},
+          {"compression", vast::string_type{}},
         },
         .version = api_version::v0,
         .content_type = http_content_type::json,
+        .alternative_content_types = {http_content_type::arrow_stream},
       },
     };
     return endpoints;
@@ -48,6 +48,15 @@ private:
     return data{all_};
   }
 
+  [[nodiscard]] caf::expected<data> save() const override {
+    return data{all_};
+  }
+
+  [[nodiscard]] caf::error merge(const data& state) override {
+    add(make_view(state));
+    return {};
+  }
+
   std::optional<bool> all_ = {};
 };
 
@@ -60,6 +69,10 @@ class plugin : public virtual aggregation_function_plugin {
     return "all";
   };
 
+  [[nodiscard]] bool supports_partial_aggregation() const override {
+    return true;
+  }
+
   [[nodiscard]] caf::expected<std::unique_ptr<aggregation_function>>
   make_aggregation_function(const type& input_type) const override {
     if (caf::holds_alternative<bool_type>(input_type))
@@ -0,0 +1,214 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <vast/aggregation_function.hpp>
+#include <vast/arrow_table_slice.hpp>
+#include <vast/detail/assert.hpp>
+#include <vast/detail/narrow.hpp>
+#include <vast/hash/hash.hpp>
+#include <vast/hash_column.hpp>
+#include <vast/plugin.hpp>
+#include <vast/sketch/hyperloglog.hpp>
+
+#include <arrow/array.h>
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+namespace vast::plugins::approx_distinct {
+
+namespace {
+
+/// The number of registers that a single value of the saved state holds.
+constexpr auto registers_per_word = size_t{8};
+
+/// The number of values of the saved state of a sketch.
+constexpr auto sketch_words
+  = (size_t{1} << sketch::hyperloglog::default_precision) / registers_per_word;
+
+/// The number of distinct digests up to which the function keeps the digests
+/// instead of a sketch. This is exact and saves memory for the many small
+/// groups that are typical for a summarize operator. It must be less than
+/// `sketch_words` to tell the saved states apart.
+constexpr auto max_exact_digests = size_t{256};
+
+static_assert(max_exact_digests < sketch_words);
+
+class approx_distinct_function final : public aggregation_function {
+public:
+  explicit approx_distinct_function(type input_type) noexcept
+    : aggregation_function(std::move(input_type)) {
+    // nop
+  }
+
+private:
+  [[nodiscard]] type output_type() const override {
+    return type{uint64_type{}};
+  }
+
+  /// The state holds either the distinct digests, or the registers of the
+  /// sketch packed into unsigned integers, as VAST has no type for bytes.
+  [[nodiscard]] type state_type() const override {
+    return type{list_type{uint64_type{}}};
+  }
+
+  void add(const data_view& view) override {
+    if (caf::holds_alternative<caf::none_t>(view))
+      return;
+    // Like distinct, we count the values inside lists rather than the lists
+    // themselves.
+    if (caf::holds_alternative<list_type>(input_type())) {
+      for (const auto& value : caf::get<vast::view<list>>(view))
+        if (!caf::holds_alternative<caf::none_t>(value))
+          add_digest(seeded_hash<default_hash>{seed}(value));
+      return;
+    }
+    add_digest(seeded_hash<default_hash>{seed}(view));
+  }
+
+  void add(const arrow::Array& array) override {
+    if (caf::holds_alternative<list_type>(input_type())) {
+      aggregation_function::add(array);
+      return;
+    }
+    // Hashing the whole array at once yields the same digests as hashing the
+    // values one by one.
+    digests_.resize(detail::narrow_cast<size_t>(array.length()));
+    hash_column<default_hash>(input_type(), array, digests_, seed);
+    for (int64_t row = 0; row < array.length(); ++row)
+      if (!array.IsNull(row))
+        add_digest(digests_[row]);
+  }
+
+  [[nodiscard]] caf::expected<data> finish() && override {
+    if (!sketch_)
+      return data{detail::narrow_cast<uint64_t>(exact_digests_.size())};
+    return data{static_cast<uint64_t>(std::llround(sketch_->estimate()))};
+  }
+
+  [[nodiscard]] caf::expected<data> save() const override {
+    auto result = list{};
+    if (!sketch_) {
+      result.reserve(exact_digests_.size());
+      for (const auto digest : exact_digests_)
+        result.emplace_back(digest);
+      return data{std::move(result)};
+    }
+    const auto registers = sketch_->registers();
+    result.reserve(registers.size() / registers_per_word);
+    for (size_t i = 0; i < registers.size(); i += registers_per_word) {
+      auto word = uint64_t{0};
+      for (size_t j = 0; j < registers_per_word; ++j)
+        word |= uint64_t{registers[i + j]} << (8 * j);
+      result.emplace_back(word);
+    }
+    return data{std::move(result)};
+  }
+
+  [[nodiscard]] caf::error merge(const data& state) override {
+    if (caf::holds_alternative<caf::none_t>(state))
+      return {};
+    const auto* words = caf::get_if<list>(&state);
+    if (!words)
+      return caf::make_error(ec::type_clash,
+                             fmt::format("approx_distinct aggregation "
+                                         "function cannot merge state {}",
+                                         state));
+    const auto is_sketch = words->size() == sketch_words;
+    auto registers = std::vector<uint8_t>{};
+    if (is_sketch)
+      registers.reserve(sketch_words * registers_per_word);
+    for (const auto& word_data : *words) {
+      const auto* word = caf::get_if<uint64_t>(&word_data);
+      if (!word)
+        return caf::make_error(ec::type_clash,
+                               fmt::format("approx_distinct aggregation "
+                                           "function cannot merge state "
+                                           "value {}",
+                                           word_data));
+      if (!is_sketch) {
+        add_digest(*word);
+        continue;
+      }
+      for (size_t j = 0; j < registers_per_word; ++j)
+        registers.push_back(static_cast<uint8_t>(*word >> (8 * j)));
+    }
+    if (!is_sketch)
+      return {};
+    auto other = sketch::hyperloglog::make(std::move(registers));
+    if (!other)
+      return std::move(other.error());
+    if (!sketch_)
+      make_sketch();
+    return sketch_->merge(*other);
+  }
+
+  /// Adds a digest of a value to the exact digests or to the sketch.
+  void add_digest(uint64_t digest) {
+    if (sketch_) {
+      sketch_->add(digest);
+      return;
+    }
+    const auto it = std::lower_bound(exact_digests_.begin(),
+                                     exact_digests_.end(), digest);
+    if (it != exact_digests_.end() && *it == digest)
+      return;
+    exact_digests_.insert(it, digest);
+    if (exact_digests_.size() > max_exact_digests)
+      make_sketch();
+  }
+
+  /// Moves the exact digests into a sketch.
+  void make_sketch() {
+    VAST_ASSERT(!sketch_);
+    sketch_.emplace();
+    for (const auto digest : exact_digests_)
+      sketch_->add(digest);
+    exact_digests_ = {};
+  }
+
+  /// The seed for hashing the values; it must not change to keep saved
+  /// states mergeable.
+  static constexpr auto seed = default_hash::seed_type{};
+
+  /// The sorted distinct digests, until the function switches to a sketch.
+  std::vector<uint64_t> exact_digests_ = {};
+
+  /// The sketch, once there are too many distinct digests.
+  std::optional<sketch::hyperloglog> sketch_ = {};
+
+  /// A buffer for the digests of an array.
+  std::vector<uint64_t> digests_ = {};
+};
+
+class plugin : public virtual aggregation_function_plugin {
+  caf::error initialize([[maybe_unused]] data config) override {
+    return {};
+  }
+
+  [[nodiscard]] std::string name() const override {
+    return "approx_distinct";
+  };
+
+  [[nodiscard]] bool supports_partial_aggregation() const override {
+    return true;
+  }
+
+  [[nodiscard]] caf::expected<std::unique_ptr<aggregation_function>>
+  make_aggregation_function(const type& input_type) const override {
+    return std::make_unique<approx_distinct_function>(input_type);
+  }
+};
+
+} // namespace
+
+} // namespace vast::plugins::approx_distinct
+
+VAST_REGISTER_PLUGIN(vast::plugins::approx_distinct::plugin)
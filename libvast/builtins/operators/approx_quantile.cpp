@@ -0,0 +1,259 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <vast/aggregation_function.hpp>
+#include <vast/arrow_table_slice.hpp>
+#include <vast/detail/type_traits.hpp>
+#include <vast/plugin.hpp>
+#include <vast/sketch/t_digest.hpp>
+
+#include <arrow/array.h>
+
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace vast::plugins::approx_quantile {
+
+namespace {
+
+/// The types that the quantile aggregation functions support.
+template <class Type>
+concept numeric_type = detail::is_any_v<Type, int64_type, uint64_type,
+                                        double_type, duration_type, time_type>;
+
+/// Converts a value into the domain of the t-digest.
+template <numeric_type Type>
+double to_double(view<type_to_data_t<Type>> value) {
+  if constexpr (std::is_same_v<Type, duration_type>)
+    return static_cast<double>(value.count());
+  else if constexpr (std::is_same_v<Type, time_type>)
+    return static_cast<double>(value.time_since_epoch().count());
+  else
+    return static_cast<double>(value);
+}
+
+/// Converts a value from the domain of the t-digest back into the input type.
+/// Integers become doubles, as quantiles of integers need not be integral.
+template <numeric_type Type>
+data from_double(double value) {
+  if constexpr (std::is_same_v<Type, duration_type>)
+    return duration{static_cast<duration::rep>(std::llround(value))};
+  else if constexpr (std::is_same_v<Type, time_type>)
+    return time{duration{static_cast<duration::rep>(std::llround(value))}};
+  else
+    return value;
+}
+
+/// Rounds a value to the nearest integer of the given type, saturating at the
+/// limits of the type.
+template <class Integer>
+  requires detail::is_any_v<Integer, int64_t, uint64_t>
+Integer round_to(double value) {
+  // Doubles cannot represent the maximum of 64-bit integers exactly, so we
+  // compare against its successor, which is a power of two.
+  constexpr auto lowest = std::is_signed_v<Integer> ? -0x1p63 : 0.0;
+  constexpr auto end = std::is_signed_v<Integer> ? 0x1p63 : 0x1p64;
+  const auto rounded = std::round(value);
+  if (std::isnan(rounded) || rounded < lowest)
+    return std::numeric_limits<Integer>::min();
+  if (rounded >= end)
+    return std::numeric_limits<Integer>::max();
+  return static_cast<Integer>(rounded);
+}
+
+/// Converts the bounds of the t-digest into the state type exactly.
+template <numeric_type Type>
+data bound_from_double(double value) {
+  if constexpr (std::is_same_v<Type, int64_type>)
+    return round_to<int64_t>(value);
+  else if constexpr (std::is_same_v<Type, uint64_type>)
+    return round_to<uint64_t>(value);
+  else
+    return from_double<Type>(value);
+}
+
+template <numeric_type Type>
+class quantile_function final : public aggregation_function {
+public:
+  quantile_function(type input_type, double quantile)
+    : aggregation_function(std::move(input_type)), quantile_{quantile} {
+    // nop
+  }
+
+private:
+  [[nodiscard]] type output_type() const override {
+    if constexpr (detail::is_any_v<Type, duration_type, time_type>)
+      return type{Type{}};
+    else
+      return type{double_type{}};
+  }
+
+  /// The state holds the bounds in the input type, and the centroids of the
+  /// t-digest as separate lists of means and weights.
+  [[nodiscard]] type state_type() const override {
+    return type{record_type{
+      {"min", Type{}},
+      {"max", Type{}},
+      {"means", list_type{double_type{}}},
+      {"weights", list_type{double_type{}}},
+    }};
+  }
+
+  void add(const data_view& view) override {
+    if (caf::holds_alternative<caf::none_t>(view))
+      return;
+    digest_.add(
+      to_double<Type>(caf::get<vast::view<type_to_data_t<Type>>>(view)));
+  }
+
+  void add(const arrow::Array& array) override {
+    for (auto&& value :
+         values(Type{}, caf::get<type_to_arrow_array_t<Type>>(array)))
+      if (value)
+        digest_.add(to_double<Type>(*value));
+  }
+
+  [[nodiscard]] caf::expected<data> finish() && override {
+    const auto result = digest_.quantile(quantile_);
+    if (!result)
+      return data{};
+    return from_double<Type>(*result);
+  }
+
+  [[nodiscard]] caf::expected<data> save() const override {
+    if (digest_.weight() == 0.0)
+      return data{};
+    auto means = list{};
+    auto weights = list{};
+    const auto centroids = digest_.centroids();
+    means.reserve(centroids.size());
+    weights.reserve(centroids.size());
+    for (const auto& centroid : centroids) {
+      means.emplace_back(centroid.mean);
+      weights.emplace_back(centroid.weight);
+    }
+    return data{record{
+      {"min", bound_from_double<Type>(digest_.min())},
+      {"max", bound_from_double<Type>(digest_.max())},
+      {"means", std::move(means)},
+      {"weights", std::move(weights)},
+    }};
+  }
+
+  [[nodiscard]] caf::error merge(const data& state) override {
+    if (caf::holds_alternative<caf::none_t>(state))
+      return {};
+    const auto make_error = [&] {
+      return caf::make_error(ec::type_clash,
+                             fmt::format("quantile aggregation function "
+                                         "cannot merge state {}",
+                                         state));
+    };
+    const auto* fields = caf::get_if<record>(&state);
+    if (!fields)
+      return make_error();
+    const auto field = [&](std::string_view name) -> const data* {
+      const auto it = fields->find(name);
+      return it != fields->end() ? &it->second : nullptr;
+    };
+    using data_type = type_to_data_t<Type>;
+    const auto* min = field("min") ? caf::get_if<data_type>(field("min"))
+                                   : nullptr;
+    const auto* max = field("max") ? caf::get_if<data_type>(field("max"))
+                                   : nullptr;
+    const auto* means = field("means") ? caf::get_if<list>(field("means"))
+                                       : nullptr;
+    const auto* weights
+      = field("weights") ? caf::get_if<list>(field("weights")) : nullptr;
+    if (!min || !max || !means || !weights || means->size() != weights->size())
+      return make_error();
+    auto centroids = std::vector<sketch::t_digest::centroid>{};
+    centroids.reserve(means->size());
+    for (size_t i = 0; i < means->size(); ++i) {
+      const auto* mean = caf::get_if<double>(&(*means)[i]);
+      const auto* weight = caf::get_if<double>(&(*weights)[i]);
+      if (!mean || !weight)
+        return make_error();
+      centroids.push_back({*mean, *weight});
+    }
+    auto other = sketch::t_digest::make(
+      digest_.compression(), std::move(centroids),
+      to_double<Type>(make_view(*min)), to_double<Type>(make_view(*max)));
+    if (!other)
+      return std::move(other.error());
+    digest_.merge(*other);
+    return {};
+  }
+
+  double quantile_ = 0.5;
+  sketch::t_digest digest_ = {};
+};
+
+/// Returns the type of the values that a state type of a quantile aggregation
+/// function summarizes, if the given type is such a state type.
+std::optional<type> summarized_type(const type& input_type) {
+  const auto* state = caf::get_if<record_type>(&input_type);
+  if (!state || state->num_fields() != 4)
+    return std::nullopt;
+  const auto min = state->field(0);
+  if (min.name != "min" || state->field(1).name != "max"
+      || state->field(2).name != "means" || state->field(3).name != "weights")
+    return std::nullopt;
+  return min.type;
+}
+
+/// The plugin for a quantile aggregation function, e.g., `approx_p90` for the
+/// 90th percentile.
+template <int Percentile>
+class plugin : public virtual aggregation_function_plugin {
+  static_assert(Percentile > 0 && Percentile < 100);
+
+  caf::error initialize([[maybe_unused]] data config) override {
+    return {};
+  }
+
+  [[nodiscard]] std::string name() const override {
+    if constexpr (Percentile == 50)
+      return "approx_median";
+    else
+      return fmt::format("approx_p{}", Percentile);
+  };
+
+  [[nodiscard]] bool supports_partial_aggregation() const override {
+    return true;
+  }
+
+  [[nodiscard]] caf::expected<std::unique_ptr<aggregation_function>>
+  make_aggregation_function(const type& input_type) const override {
+    // Merging partial results creates the function for the state type.
+    const auto value_type = summarized_type(input_type).value_or(input_type);
+    auto f = [&]<concrete_type Type>(const Type& type)
+      -> caf::expected<std::unique_ptr<aggregation_function>> {
+      if constexpr (numeric_type<Type>) {
+        return std::make_unique<quantile_function<Type>>(
+          input_type, static_cast<double>(Percentile) / 100.0);
+      } else {
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("{} aggregation function does not "
+                                           "support type {}",
+                                           name(), type));
+      }
+    };
+    return caf::visit(f, value_type);
+  }
+};
+
+} // namespace
+
+} // namespace vast::plugins::approx_quantile
+
+VAST_REGISTER_PLUGIN(vast::plugins::approx_quantile::plugin<50>)
+VAST_REGISTER_PLUGIN(vast::plugins::approx_quantile::plugin<90>)
+VAST_REGISTER_PLUGIN(vast::plugins::approx_quantile::plugin<99>)
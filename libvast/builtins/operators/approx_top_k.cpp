@@ -0,0 +1,209 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <vast/aggregation_function.hpp>
+#include <vast/hash/hash.hpp>
+#include <vast/plugin.hpp>
+#include <vast/sketch/space_saving.hpp>
+
+#include <optional>
+#include <vector>
+
+namespace vast::plugins::approx_top_k {
+
+namespace {
+
+/// The number of most frequent values that the function returns.
+constexpr auto top_k = size_t{10};
+
+/// The number of counters of the sketch. Many more counters than returned
+/// values make the returned values and their order accurate for skewed data.
+constexpr auto capacity = size_t{10 * top_k};
+
+template <concrete_type Type>
+struct data_hash {
+  [[nodiscard]] size_t operator()(const type_to_data_t<Type>& value) const {
+    return hash(make_view(value));
+  }
+};
+
+template <concrete_type Type, bool IsList>
+class approx_top_k_function final : public aggregation_function {
+public:
+  using sketch_type
+    = sketch::space_saving<type_to_data_t<Type>, data_hash<Type>>;
+
+  approx_top_k_function(type input_type, type value_type) noexcept
+    : aggregation_function(std::move(input_type)),
+      value_type_{std::move(value_type)} {
+    // nop
+  }
+
+private:
+  [[nodiscard]] type output_type() const override {
+    return type{list_type{value_type_}};
+  }
+
+  /// The state holds the counters of the sketch as separate lists of values,
+  /// counts, and errors.
+  [[nodiscard]] type state_type() const override {
+    return type{record_type{
+      {"values", list_type{value_type_}},
+      {"counts", list_type{uint64_type{}}},
+      {"errors", list_type{uint64_type{}}},
+    }};
+  }
+
+  void add(const data_view& view) override {
+    if constexpr (IsList) {
+      if (caf::holds_alternative<caf::none_t>(view))
+        return;
+      for (const auto& value_view : caf::get<vast::view<list>>(view))
+        insert(value_view);
+    } else {
+      insert(view);
+    }
+  }
+
+  [[nodiscard]] caf::expected<data> finish() && override {
+    auto result = list{};
+    for (auto& counter : sketch_.top(top_k))
+      result.emplace_back(std::move(counter.key));
+    return data{std::move(result)};
+  }
+
+  [[nodiscard]] caf::expected<data> save() const override {
+    const auto counters = sketch_.counters();
+    if (counters.empty())
+      return data{};
+    auto values = list{};
+    auto counts = list{};
+    auto errors = list{};
+    values.reserve(counters.size());
+    counts.reserve(counters.size());
+    errors.reserve(counters.size());
+    for (const auto& counter : counters) {
+      values.emplace_back(counter.key);
+      counts.emplace_back(counter.count);
+      errors.emplace_back(counter.error);
+    }
+    return data{record{
+      {"values", std::move(values)},
+      {"counts", std::move(counts)},
+      {"errors", std::move(errors)},
+    }};
+  }
+
+  [[nodiscard]] caf::error merge(const data& state) override {
+    if (caf::holds_alternative<caf::none_t>(state))
+      return {};
+    const auto make_error = [&] {
+      return caf::make_error(ec::type_clash,
+                             fmt::format("approx_top_k aggregation function "
+                                         "cannot merge state {}",
+                                         state));
+    };
+    const auto* fields = caf::get_if<record>(&state);
+    if (!fields)
+      return make_error();
+    const auto get_list = [&](std::string_view name) -> const list* {
+      const auto it = fields->find(name);
+      return it != fields->end() ? caf::get_if<list>(&it->second) : nullptr;
+    };
+    const auto* values = get_list("values");
+    const auto* counts = get_list("counts");
+    const auto* errors = get_list("errors");
+    if (!values || !counts || !errors || values->size() != counts->size()
+        || values->size() != errors->size())
+      return make_error();
+    using data_type = type_to_data_t<Type>;
+    auto counters = std::vector<typename sketch_type::counter>{};
+    counters.reserve(values->size());
+    for (size_t i = 0; i < values->size(); ++i) {
+      const auto* value = caf::get_if<data_type>(&(*values)[i]);
+      const auto* count = caf::get_if<uint64_t>(&(*counts)[i]);
+      const auto* error = caf::get_if<uint64_t>(&(*errors)[i]);
+      if (!value || !count || !error)
+        return make_error();
+      counters.push_back({*value, *count, *error});
+    }
+    auto other = sketch_type{capacity};
+    other.assign(std::move(counters));
+    sketch_.merge(other);
+    return {};
+  }
+
+  void insert(const data_view& view) {
+    using view_type = vast::view<type_to_data_t<Type>>;
+    if (caf::holds_alternative<caf::none_t>(view))
+      return;
+    sketch_.add(materialize(caf::get<view_type>(view)));
+  }
+
+  type value_type_ = {};
+  sketch_type sketch_ = sketch_type{capacity};
+};
+
+/// Returns the type of the values that a state type of the function
+/// summarizes, if the given type is such a state type.
+std::optional<type> summarized_type(const type& input_type) {
+  const auto* state = caf::get_if<record_type>(&input_type);
+  if (!state || state->num_fields() != 3)
+    return std::nullopt;
+  const auto values = state->field(0);
+  const auto* values_type = caf::get_if<list_type>(&values.type);
+  if (values.name != "values" || !values_type
+      || state->field(1).name != "counts" || state->field(2).name != "errors")
+    return std::nullopt;
+  return values_type->value_type();
+}
+
+class plugin : public virtual aggregation_function_plugin {
+  caf::error initialize([[maybe_unused]] data config) override {
+    return {};
+  }
+
+  [[nodiscard]] std::string name() const override {
+    return "approx_top_k";
+  };
+
+  [[nodiscard]] bool supports_partial_aggregation() const override {
+    return true;
+  }
+
+  [[nodiscard]] caf::expected<std::unique_ptr<aggregation_function>>
+  make_aggregation_function(const type& input_type) const override {
+    // Merging partial results creates the function for the state type, which
+    // holds the values regardless of whether the input is a list.
+    if (auto value_type = summarized_type(input_type)) {
+      auto f = [&]<concrete_type Type>(
+                 const Type&) -> std::unique_ptr<aggregation_function> {
+        return std::make_unique<approx_top_k_function<Type, false>>(
+          input_type, *value_type);
+      };
+      return caf::visit(f, *value_type);
+    }
+    const auto* list = caf::get_if<list_type>(&input_type);
+    const auto value_type = list ? list->value_type() : input_type;
+    auto f = [&]<concrete_type Type>(
+               const Type&) -> std::unique_ptr<aggregation_function> {
+      if (list)
+        return std::make_unique<approx_top_k_function<Type, true>>(input_type,
+                                                                   value_type);
+      return std::make_unique<approx_top_k_function<Type, false>>(input_type,
+                                                                  value_type);
+    };
+    return caf::visit(f, value_type);
+  }
+};
+
+} // namespace
+
+} // namespace vast::plugins::approx_top_k
+
+VAST_REGISTER_PLUGIN(vast::plugins::approx_top_k::plugin)
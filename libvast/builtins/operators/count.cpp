@@ -42,6 +42,23 @@ private:
     return count_;
   }
 
+  [[nodiscard]] caf::expected<data> save() const override {
+    return count_;
+  }
+
+  [[nodiscard]] caf::error merge(const data& state) override {
+    if (caf::holds_alternative<caf::none_t>(state))
+      return {};
+    const auto* count = caf::get_if<uint64_t>(&state);
+    if (!count)
+      return caf::make_error(ec::type_clash,
+                             fmt::format("count aggregation function cannot "
+                                         "merge state {}",
+                                         state));
+    count_ += *count;
+    return {};
+  }
+
   uint64_t count_ = {};
 };
 
@@ -54,6 +71,10 @@ class plugin : public virtual aggregation_function_plugin {
     return "count";
   };
 
+  [[nodiscard]] bool supports_partial_aggregation() const override {
+    return true;
+  }
+
   [[nodiscard]] caf::expected<std::unique_ptr<aggregation_function>>
   make_aggregation_function(const type& input_type) const override {
     return std::make_unique<count_function>(input_type);
@@ -64,23 +64,13 @@ private:
   }
 
   void add(const data_view& view) override {
-    using view_type = vast::view<type_to_data_t<Type>>;
-    const auto handle_value_view = [&](const data_view& view) {
-      if (caf::holds_alternative<caf::none_t>(view))
-        return;
-      const auto& typed_view = caf::get<view_type>(view);
-      if (!distinct_.contains(typed_view)) {
-        const auto [it, inserted] = distinct_.insert(materialize(typed_view));
-        VAST_ASSERT(inserted);
-      }
-    };
     if constexpr (IsList) {
       if (caf::holds_alternative<caf::none_t>(view))
         return;
       for (const auto& value_view : caf::get<vast::view<list>>(view))
-        handle_value_view(value_view);
+        insert(value_view);
     } else {
-      handle_value_view(view);
+      insert(view);
     }
   }
 
@@ -93,6 +83,41 @@ private:
     return data{std::move(result)};
   }
 
+  [[nodiscard]] caf::expected<data> save() const override {
+    auto result = list{};
+    result.reserve(distinct_.size());
+    for (const auto& value : distinct_)
+      result.emplace_back(value);
+    return data{std::move(result)};
+  }
+
+  [[nodiscard]] caf::error merge(const data& state) override {
+    // The state is a list of distinct values regardless of whether the input
+    // is a list.
+    if (caf::holds_alternative<caf::none_t>(state))
+      return {};
+    const auto* values = caf::get_if<list>(&state);
+    if (!values)
+      return caf::make_error(ec::type_clash,
+                             fmt::format("distinct aggregation function "
+                                         "cannot merge state {}",
+                                         state));
+    for (const auto& value : *values)
+      insert(make_view(value));
+    return {};
+  }
+
+  void insert(const data_view& view) {
+    using view_type = vast::view<type_to_data_t<Type>>;
+    if (caf::holds_alternative<caf::none_t>(view))
+      return;
+    const auto& typed_view = caf::get<view_type>(view);
+    if (!distinct_.contains(typed_view)) {
+      const auto [it, inserted] = distinct_.insert(materialize(typed_view));
+      VAST_ASSERT(inserted);
+    }
+  }
+
   tsl::robin_set<type_to_data_t<Type>, heterogeneous_data_hash<Type>,
                  heterogeneous_data_equal<Type>>
     distinct_ = {};
@@ -107,6 +132,10 @@ class plugin : public virtual aggregation_function_plugin {
     return "distinct";
   };
 
+  [[nodiscard]] bool supports_partial_aggregation() const override {
+    return true;
+  }
+
   [[nodiscard]] caf::expected<std::unique_ptr<aggregation_function>>
   make_aggregation_function(const type& input_type) const override {
     const auto* list = caf::get_if<list_type>(&input_type);
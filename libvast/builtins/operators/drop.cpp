@@ -49,53 +49,65 @@ struct configuration {
 };
 
 /// Drops the specifed fields from the input.
-class drop_operator : public pipeline_operator {
+class drop_operator : public column_pipeline_operator {
 public:
   explicit drop_operator(configuration config) noexcept
     : config_{std::move(config)} {
     // nop
   }
 
-  caf::error add(table_slice slice) override {
-    VAST_DEBUG("drop operator adds batch");
+  caf::expected<column_transformation>
+  bind_columns(const type& schema) const override {
     // Determine whether we want to drop the entire batch first.
     const auto drop_schema
       = std::any_of(config_.schemas.begin(), config_.schemas.end(),
                     [&](const auto& dropped_schema) {
-                      return dropped_schema == slice.schema().name();
+                      return dropped_schema == schema.name();
                     });
     if (drop_schema)
-      return caf::none;
+      return column_transformation{
+        .discard = true,
+      };
     // Apply the transformation.
     auto transform_fn
-      = [&](struct record_type::field, std::shared_ptr<arrow::Array>) noexcept
+      = [](struct record_type::field, std::shared_ptr<arrow::Array>) noexcept
       -> std::vector<
         std::pair<struct record_type::field, std::shared_ptr<arrow::Array>>> {
       return {};
     };
     auto transformations = std::vector<indexed_transformation>{};
     for (const auto& field : config_.fields)
-      for (auto&& index : caf::get<record_type>(slice.schema())
-                            .resolve_key_suffix(field, slice.schema().name()))
+      for (auto&& index : caf::get<record_type>(schema).resolve_key_suffix(
+             field, schema.name()))
         transformations.push_back({std::move(index), transform_fn});
     // transform_columns requires the transformations to be sorted, and that may
     // not necessarily be true if we have multiple fields configured, so we sort
     // again in that case.
     if (config_.fields.size() > 1)
       std::sort(transformations.begin(), transformations.end());
-    transformed_.push_back(transform_columns(slice, transformations));
-    return caf::none;
+    return column_transformation{
+      .transformations = std::move(transformations),
+    };
   }
 
-  caf::expected<std::vector<table_slice>> finish() override {
-    VAST_DEBUG("drop operator finished transformation");
-    return std::exchange(transformed_, {});
+  /// Dropping fields and schemas works batch by batch, so the stores can drop
+  /// them before shipping the matching events.
+  [[nodiscard]] std::optional<pipeline_pushdown> pushdown() const override {
+    const auto to_list = [](const std::vector<std::string>& xs) {
+      return list{xs.begin(), xs.end()};
+    };
+    return pipeline_pushdown{
+      .store_operator = pipeline_operator_definition{
+        .name = "drop",
+        .options = {
+          {"fields", to_list(config_.fields)},
+          {"schemas", to_list(config_.schemas)},
+        },
+      },
+    };
   }
 
 private:
-  /// The slices being transformed.
-  std::vector<table_slice> transformed_;
-
   /// The underlying configuration of the transformation.
   configuration config_;
 };
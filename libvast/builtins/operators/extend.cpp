@@ -100,35 +100,31 @@ struct configuration {
   indexed_transformation::function_type transformation = {};
 };
 
-class extend_operator : public pipeline_operator {
+class extend_operator : public column_pipeline_operator {
 public:
   explicit extend_operator(configuration config) noexcept
     : config_{std::move(config)} {
     // nop
   }
 
-  caf::error add(table_slice slice) override {
-    const auto& schema_rt = caf::get<record_type>(slice.schema());
+  caf::expected<column_transformation>
+  bind_columns(const type& schema) const override {
+    const auto& schema_rt = caf::get<record_type>(schema);
     for (const auto& field : config_.fields)
       if (schema_rt.resolve_key(field).has_value())
         return caf::make_error(ec::invalid_configuration,
                                fmt::format("cannot extend {} with field {} "
                                            "as it already has a field with "
                                            "this name",
-                                           slice.schema(), field));
-    transformed_.push_back(transform_columns(
-      slice, {{offset{schema_rt.num_fields() - 1}, config_.transformation}}));
-    return caf::none;
-  }
-
-  caf::expected<std::vector<table_slice>> finish() override {
-    return std::exchange(transformed_, {});
+                                           schema, field));
+    return column_transformation{
+      .transformations = {
+        {offset{schema_rt.num_fields() - 1}, config_.transformation},
+      },
+    };
   }
 
 private:
-  /// The transformed slices.
-  std::vector<table_slice> transformed_ = {};
-
   /// The underlying configuration of the transformation.
   configuration config_ = {};
 };
@@ -17,6 +17,7 @@
 #include <vast/error.hpp>
 #include <vast/hash/default_hash.hpp>
 #include <vast/hash/hash_append.hpp>
+#include <vast/hash_column.hpp>
 #include <vast/optional.hpp>
 #include <vast/pipeline.hpp>
 #include <vast/plugin.hpp>
@@ -25,6 +26,8 @@
 #include <arrow/scalar.h>
 #include <fmt/format.h>
 
+#include <array>
+
 namespace vast::plugins::hash {
 
 namespace {
@@ -52,40 +55,40 @@ struct configuration {
   }
 };
 
-class hash_operator : public pipeline_operator {
+class hash_operator : public column_pipeline_operator {
 public:
   explicit hash_operator(configuration configuration);
 
-  [[nodiscard]] caf::error add(table_slice slice) override {
-    VAST_TRACE("hash operator adds batch");
+  [[nodiscard]] caf::expected<column_transformation>
+  bind_columns(const type& schema) const override {
     // Get the target field if it exists.
-    const auto& schema_rt = caf::get<record_type>(slice.schema());
+    const auto& schema_rt = caf::get<record_type>(schema);
     auto column_index = schema_rt.resolve_key(config_.field);
-    if (!column_index) {
-      transformed_.push_back(std::move(slice));
-      return caf::none;
-    }
+    if (!column_index)
+      return column_transformation{};
     // Apply the transformation.
-    auto transform_fn = [&](struct record_type::field field,
-                            std::shared_ptr<arrow::Array> array) noexcept
+    auto transform_fn = [this](struct record_type::field field,
+                               std::shared_ptr<arrow::Array> array) noexcept
       -> std::vector<
         std::pair<struct record_type::field, std::shared_ptr<arrow::Array>>> {
+      auto digests = std::vector<default_hash::result_type>(array->length());
+      if (config_.salt)
+        hash_column<default_hash>(field.type, *array, digests, 0,
+                                  *config_.salt);
+      else
+        hash_column<default_hash>(field.type, *array, digests, 0);
       auto hashes_builder
         = string_type::make_arrow_builder(arrow::default_memory_pool());
-      if (config_.salt) {
-        for (const auto& value : values(field.type, *array)) {
-          const auto digest = vast::hash(value, *config_.salt);
-          const auto append_result
-            = hashes_builder->Append(fmt::format("{:x}", digest));
-          VAST_ASSERT(append_result.ok(), append_result.ToString().c_str());
-        }
-      } else {
-        for (const auto& value : values(field.type, *array)) {
-          const auto digest = vast::hash(value);
-          const auto append_result
-            = hashes_builder->Append(fmt::format("{:x}", digest));
-          VAST_ASSERT(append_result.ok(), append_result.ToString().c_str());
-        }
+      const auto reserve_result = hashes_builder->Reserve(array->length());
+      VAST_ASSERT(reserve_result.ok(), reserve_result.ToString().c_str());
+      // A 64-bit digest has at most 16 hexadecimal digits.
+      auto buffer = std::array<char, 16>{};
+      for (const auto digest : digests) {
+        const auto* end = fmt::format_to(buffer.data(), "{:x}", digest);
+        const auto append_result = hashes_builder->Append(
+          std::string_view{buffer.data(), detail::narrow_cast<size_t>(
+                                            end - buffer.data())});
+        VAST_ASSERT(append_result.ok(), append_result.ToString().c_str());
       }
       return {
         {
@@ -101,20 +104,12 @@ public:
         },
       };
     };
-    transformed_.push_back(
-      transform_columns(slice, {{*column_index, std::move(transform_fn)}}));
-    return caf::none;
-  }
-
-  [[nodiscard]] caf::expected<std::vector<table_slice>> finish() override {
-    VAST_DEBUG("hash operator finished transformation");
-    return std::exchange(transformed_, {});
+    return column_transformation{
+      .transformations = {{*column_index, std::move(transform_fn)}},
+    };
   }
 
 private:
-  /// The slices being transformed.
-  std::vector<table_slice> transformed_;
-
   /// The underlying configuration of the transformation.
   configuration config_ = {};
 };
@@ -43,6 +43,13 @@ public:
     return std::exchange(buffer_, {});
   }
 
+  /// The query can stop looking for more events once it found enough.
+  [[nodiscard]] std::optional<pipeline_pushdown> pushdown() const override {
+    return pipeline_pushdown{
+      .limit = remaining_,
+    };
+  }
+
 private:
   std::vector<table_slice> buffer_ = {};
   uint64_t remaining_ = {};
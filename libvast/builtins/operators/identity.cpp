@@ -20,24 +20,14 @@ namespace vast::plugins::identity {
 namespace {
 
 // Does nothing with the input.
-class identity_operator : public pipeline_operator {
+class identity_operator : public stateless_pipeline_operator {
 public:
   identity_operator() noexcept = default;
 
-  caf::error add(table_slice slice) override {
-    VAST_TRACE("identity operator adds batch");
-    transformed_.push_back(std::move(slice));
-    return caf::none;
+  caf::expected<table_slice> apply(table_slice slice) const override {
+    VAST_TRACE("identity operator applies to batch");
+    return slice;
   }
-
-  caf::expected<std::vector<table_slice>> finish() override {
-    VAST_DEBUG("identity operator finished transformation");
-    return std::exchange(transformed_, {});
-  }
-
-private:
-  /// The slices being transformed.
-  std::vector<table_slice> transformed_ = {};
 };
 
 class plugin final : public virtual pipeline_operator_plugin {
@@ -39,6 +39,15 @@ private:
     return data{max_};
   }
 
+  [[nodiscard]] caf::expected<data> save() const override {
+    return data{max_};
+  }
+
+  [[nodiscard]] caf::error merge(const data& state) override {
+    add(make_view(state));
+    return {};
+  }
+
   std::optional<type_to_data_t<Type>> max_ = {};
 };
 
@@ -51,6 +60,10 @@ class plugin : public virtual aggregation_function_plugin {
     return "max";
   };
 
+  [[nodiscard]] bool supports_partial_aggregation() const override {
+    return true;
+  }
+
   [[nodiscard]] caf::expected<std::unique_ptr<aggregation_function>>
   make_aggregation_function(const type& input_type) const override {
     auto f = detail::overload{
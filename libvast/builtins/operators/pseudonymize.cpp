@@ -15,6 +15,7 @@
 #include <vast/concept/parseable/vast/pipeline.hpp>
 #include <vast/detail/inspection_common.hpp>
 #include <vast/ip.hpp>
+#include <vast/ip_pseudonymizer.hpp>
 #include <vast/pipeline_operator.hpp>
 #include <vast/plugin.hpp>
 #include <vast/table_slice_builder.hpp>
@@ -22,6 +23,8 @@
 
 #include <arrow/table.h>
 
+#include <mutex>
+
 namespace vast::plugins::pseudonymize {
 
 /// The configuration of the pseudonymize pipeline operator.
@@ -48,28 +51,28 @@ struct configuration {
   }
 };
 
-class pseudonymize_operator : public pipeline_operator {
+class pseudonymize_operator : public column_pipeline_operator {
 public:
   pseudonymize_operator(configuration config) : config_{std::move(config)} {
     parse_seed_string();
   }
 
-  /// Applies the transformation to an Arrow Record Batch with a corresponding
-  /// VAST schema.
-  [[nodiscard]] caf::error add(table_slice slice) override {
+  /// Binds the transformation to the IP address fields of a schema.
+  [[nodiscard]] caf::expected<column_transformation>
+  bind_columns(const type& schema) const override {
     std::vector<indexed_transformation> transformations;
-    auto transformation = [&](struct record_type::field field,
-                              std::shared_ptr<arrow::Array> array) noexcept
+    auto transformation = [this](struct record_type::field field,
+                                 std::shared_ptr<arrow::Array> array) noexcept
       -> std::vector<
         std::pair<struct record_type::field, std::shared_ptr<arrow::Array>>> {
       auto builder = ip_type::make_arrow_builder(arrow::default_memory_pool());
+      auto pseudonymizer = acquire_pseudonymizer();
       auto address_view_generator
         = values(ip_type{}, caf::get<type_to_arrow_array_t<ip_type>>(*array));
       for (const auto& address : address_view_generator) {
         auto append_status = arrow::Status{};
         if (address) {
-          auto pseudonymized_address
-            = vast::ip::pseudonymize(*address, config_.seed_bytes);
+          auto pseudonymized_address = (*pseudonymizer)(*address);
           append_status
             = append_builder(ip_type{}, *builder, pseudonymized_address);
         } else {
@@ -77,17 +80,16 @@ public:
         }
         VAST_ASSERT(append_status.ok(), append_status.ToString().c_str());
       }
+      release_pseudonymizer(std::move(pseudonymizer));
       auto new_array = builder->Finish().ValueOrDie();
       return {
         {field, new_array},
       };
     };
     for (const auto& field_name : config_.fields) {
-      for (const auto& index :
-           caf::get<record_type>(slice.schema())
-             .resolve_key_suffix(field_name, slice.schema().name())) {
-        auto index_type
-          = caf::get<record_type>(slice.schema()).field(index).type;
+      for (const auto& index : caf::get<record_type>(schema).resolve_key_suffix(
+             field_name, schema.name())) {
+        auto index_type = caf::get<record_type>(schema).field(index).type;
         if (!caf::holds_alternative<ip_type>(index_type)) {
           VAST_DEBUG("pseudonymize operator skips field '{}' of unsupported "
                      "type '{}'",
@@ -101,22 +103,40 @@ public:
     transformations.erase(std::unique(transformations.begin(),
                                       transformations.end()),
                           transformations.end());
-    transformed_.push_back(transform_columns(slice, transformations));
-    return caf::none;
+    return column_transformation{
+      .transformations = std::move(transformations),
+    };
   }
 
-  /// Retrieves the result of the transformation.
-  [[nodiscard]] caf::expected<std::vector<table_slice>> finish() override {
-    return std::exchange(transformed_, {});
+private:
+  /// Takes an idle pseudonymizer, or creates a new one if all pseudonymizers
+  /// are in use by concurrent transformations.
+  std::unique_ptr<ip_pseudonymizer> acquire_pseudonymizer() const {
+    auto lock = std::lock_guard{pseudonymizers_mutex_};
+    if (pseudonymizers_.empty())
+      return std::make_unique<ip_pseudonymizer>(config_.seed_bytes);
+    auto result = std::move(pseudonymizers_.back());
+    pseudonymizers_.pop_back();
+    return result;
   }
 
-private:
-  /// Cache for transformed batches.
-  std::vector<table_slice> transformed_ = {};
+  /// Returns a pseudonymizer for use by subsequent transformations, retaining
+  /// the prefixes that it memoized.
+  void
+  release_pseudonymizer(std::unique_ptr<ip_pseudonymizer> pseudonymizer) const {
+    auto lock = std::lock_guard{pseudonymizers_mutex_};
+    pseudonymizers_.push_back(std::move(pseudonymizer));
+  }
 
   /// Step-specific configuration, including the seed and field names.
   configuration config_ = {};
 
+  /// The idle pseudonymizers.
+  mutable std::vector<std::unique_ptr<ip_pseudonymizer>> pseudonymizers_ = {};
+
+  /// Protects the idle pseudonymizers.
+  mutable std::mutex pseudonymizers_mutex_ = {};
+
   void parse_seed_string() {
     auto max_seed_size = std::min(
       vast::ip::pseudonymization_seed_array_size * 2, config_.seed.size());
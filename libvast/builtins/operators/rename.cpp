@@ -7,7 +7,6 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
 #include <vast/arrow_table_slice.hpp>
-#include <vast/cast.hpp>
 #include <vast/concept/convertible/data.hpp>
 #include <vast/concept/convertible/to.hpp>
 #include <vast/concept/parseable/to.hpp>
@@ -68,69 +67,45 @@ struct configuration {
   }
 };
 
-class rename_operator : public pipeline_operator {
+class rename_operator : public column_pipeline_operator {
 public:
   rename_operator(configuration config) : config_{std::move(config)} {
     // nop
   }
 
-  /// Applies the transformation to an Arrow Record Batch with a corresponding
-  /// VAST schema.
-  [[nodiscard]] caf::error add(table_slice slice) override {
+  /// Binds the renaming of fields and schemas to a schema.
+  [[nodiscard]] caf::expected<column_transformation>
+  bind_columns(const type& schema) const override {
+    auto result = column_transformation{};
     // Step 1: Adjust field names.
-    if (!config_.fields.empty()) {
-      auto field_transformations = std::vector<indexed_transformation>{};
-      for (const auto& field : config_.fields) {
-        for (const auto& index :
-             caf::get<record_type>(slice.schema())
-               .resolve_key_suffix(field.from, slice.schema().name())) {
-          auto transformation
-            = [&](struct record_type::field old_field,
-                  std::shared_ptr<arrow::Array> array) noexcept
-            -> std::vector<std::pair<struct record_type::field,
-                                     std::shared_ptr<arrow::Array>>> {
-            return {
-              {{field.to, old_field.type}, array},
-            };
+    for (const auto& field : config_.fields) {
+      for (const auto& index : caf::get<record_type>(schema).resolve_key_suffix(
+             field.from, schema.name())) {
+        auto transformation
+          = [to = field.to](struct record_type::field old_field,
+                            std::shared_ptr<arrow::Array> array) noexcept
+          -> std::vector<std::pair<struct record_type::field,
+                                   std::shared_ptr<arrow::Array>>> {
+          return {
+            {{to, old_field.type}, array},
           };
-          field_transformations.push_back({index, std::move(transformation)});
-        }
+        };
+        result.transformations.push_back({index, std::move(transformation)});
       }
-      std::sort(field_transformations.begin(), field_transformations.end());
-      slice = transform_columns(slice, field_transformations);
     }
+    std::sort(result.transformations.begin(), result.transformations.end());
     // Step 2: Adjust schema names.
-    if (!config_.schemas.empty()) {
-      const auto schema_mapping
-        = std::find_if(config_.schemas.begin(), config_.schemas.end(),
-                       [&](const auto& name_mapping) noexcept {
-                         return name_mapping.from == slice.schema().name();
-                       });
-      if (schema_mapping == config_.schemas.end()) {
-        transformed_.push_back(std::move(slice));
-        return caf::none;
-      }
-      auto rename_schema = [&](const concrete_type auto& pruned_schema) {
-        VAST_ASSERT(!slice.schema().has_attributes());
-        return type{schema_mapping->to, pruned_schema};
-      };
-      auto renamed_schema = caf::visit(rename_schema, slice.schema());
-      slice = cast(std::move(slice), renamed_schema);
-    }
-    // Finally, store the result for later retrieval.
-    transformed_.push_back(std::move(slice));
-    return caf::none;
-  } // namespace vast::plugins::rename
-
-  /// Retrieves the result of the transformation.
-  [[nodiscard]] caf::expected<std::vector<table_slice>> finish() override {
-    return std::exchange(transformed_, {});
+    const auto schema_mapping
+      = std::find_if(config_.schemas.begin(), config_.schemas.end(),
+                     [&](const auto& name_mapping) noexcept {
+                       return name_mapping.from == schema.name();
+                     });
+    if (schema_mapping != config_.schemas.end())
+      result.schema_name = schema_mapping->to;
+    return result;
   }
 
 private:
-  /// Cache for transformed batches.
-  std::vector<table_slice> transformed_ = {};
-
   /// Step-specific configuration, including the schema name mapping.
   configuration config_ = {};
 };
@@ -133,6 +133,20 @@ public:
     // nop
   }
 
+  [[nodiscard]] bool transforms_columns() const override {
+    return true;
+  }
+
+  [[nodiscard]] caf::expected<column_transformation>
+  bind_columns(const type& schema) const override {
+    auto config = bound_configuration::make(schema, config_);
+    if (!config)
+      return std::move(config.error());
+    return column_transformation{
+      .transformations = std::move(config->transformations),
+    };
+  }
+
   caf::error add(table_slice slice) override {
     auto config = bound_config_.find(slice.schema());
     if (config == bound_config_.end()) {
@@ -47,6 +47,15 @@ private:
     return std::move(sample_);
   }
 
+  [[nodiscard]] caf::expected<data> save() const override {
+    return sample_;
+  }
+
+  [[nodiscard]] caf::error merge(const data& state) override {
+    add(make_view(state));
+    return {};
+  }
+
   data sample_ = {};
 };
 
@@ -59,6 +68,10 @@ class plugin : public virtual aggregation_function_plugin {
     return "sample";
   };
 
+  [[nodiscard]] bool supports_partial_aggregation() const override {
+    return true;
+  }
+
   [[nodiscard]] caf::expected<std::unique_ptr<aggregation_function>>
   make_aggregation_function(const type& input_type) const override {
     return std::make_unique<sample_function>(input_type);
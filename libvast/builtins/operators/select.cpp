@@ -45,37 +45,41 @@ struct configuration {
   }
 };
 
-class select_operator : public pipeline_operator {
+class select_operator : public column_pipeline_operator {
 public:
   explicit select_operator(configuration config) noexcept
     : config_{std::move(config)} {
     // nop
   }
 
-  /// Projects an arrow record batch.
-  /// @returns The new schema and the projected record batch.
-  caf::error add(table_slice slice) override {
-    VAST_TRACE("select operator adds batch");
+  /// Selects the configured fields of a schema.
+  caf::expected<column_transformation>
+  bind_columns(const type& schema) const override {
     auto indices = std::vector<offset>{};
     for (const auto& field : config_.fields)
-      for (auto&& index : caf::get<record_type>(slice.schema())
-                            .resolve_key_suffix(field, slice.schema().name()))
+      for (auto&& index : caf::get<record_type>(schema).resolve_key_suffix(
+             field, schema.name()))
         indices.push_back(std::move(index));
     std::sort(indices.begin(), indices.end());
-    slice = select_columns(slice, indices);
-    transformed_.push_back(std::move(slice));
-    return caf::none;
+    return column_transformation{
+      .selection = std::move(indices),
+    };
   }
 
-  caf::expected<std::vector<table_slice>> finish() override {
-    VAST_TRACE("select operator finished transformation");
-    return std::exchange(transformed_, {});
+  /// Selecting fields works batch by batch, so the stores can project the
+  /// matching events before shipping them.
+  [[nodiscard]] std::optional<pipeline_pushdown> pushdown() const override {
+    return pipeline_pushdown{
+      .store_operator = pipeline_operator_definition{
+        .name = "select",
+        .options = {
+          {"fields", list{config_.fields.begin(), config_.fields.end()}},
+        },
+      },
+    };
   }
 
 private:
-  /// The slices being transformed.
-  std::vector<table_slice> transformed_ = {};
-
   /// The underlying configuration of the transformation.
   configuration config_ = {};
 };
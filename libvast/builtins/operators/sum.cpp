@@ -41,6 +41,15 @@ private:
     return data{sum_};
   }
 
+  [[nodiscard]] caf::expected<data> save() const override {
+    return data{sum_};
+  }
+
+  [[nodiscard]] caf::error merge(const data& state) override {
+    add(make_view(state));
+    return {};
+  }
+
   std::optional<type_to_data_t<Type>> sum_ = {};
 };
 
@@ -53,6 +62,10 @@ class plugin : public virtual aggregation_function_plugin {
     return "sum";
   };
 
+  [[nodiscard]] bool supports_partial_aggregation() const override {
+    return true;
+  }
+
   [[nodiscard]] caf::expected<std::unique_ptr<aggregation_function>>
   make_aggregation_function(const type& input_type) const override {
     auto f = detail::overload{
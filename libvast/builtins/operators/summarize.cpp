@@ -13,25 +13,48 @@
 #include <vast/concept/parseable/core.hpp>
 #include <vast/concept/parseable/vast/pipeline.hpp>
 #include <vast/concept/parseable/vast/time.hpp>
+#include <vast/concept/printable/vast/uuid.hpp>
 #include <vast/error.hpp>
+#include <vast/detail/inspection_common.hpp>
+#include <vast/detail/type_traits.hpp>
+#include <vast/hash/hash.hpp>
 #include <vast/hash/hash_append.hpp>
+#include <vast/hash_column.hpp>
 #include <vast/pipeline.hpp>
 #include <vast/plugin.hpp>
+#include <vast/si_literals.hpp>
 #include <vast/table_slice_builder.hpp>
 #include <vast/type.hpp>
+#include <vast/uuid.hpp>
 
+#include <arrow/array.h>
+#include <arrow/builder.h>
 #include <arrow/compute/api_scalar.h>
+#include <arrow/compute/api_vector.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/scalar.h>
 #include <arrow/type.h>
 #include <caf/expected.hpp>
-#include <tsl/robin_map.h>
+#include <tsl/robin_set.h>
 
 #include <algorithm>
+#include <bit>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <memory>
+#include <span>
 #include <utility>
+#include <vector>
 
 namespace vast::plugins::summarize {
 
 namespace {
 
+using namespace binary_byte_literals;
+
 /// Converts a duration into the options required for Arrow Compute's
 /// {Round,Floor,Ceil}Temporal functions.
 /// @param time_resolution The multiple to round to.
@@ -49,6 +72,15 @@ make_round_temporal_options(duration time_resolution) noexcept {
   };
 }
 
+/// The modes of a summarize pipeline operator. Besides aggregating its input
+/// directly, the operator can aggregate disjoint subsets of the input into
+/// partial results, which another summarize operator then merges.
+enum class aggregation_mode {
+  full,    ///< Aggregate the input into the final results.
+  partial, ///< Aggregate the input into partial results.
+  merge,   ///< Merge partial results into the final results.
+};
+
 /// The configuration of a summarize pipeline operator, for example:
 ///
 ///   summarize:
@@ -65,6 +97,16 @@ make_round_temporal_options(duration time_resolution) noexcept {
 ///       max_ts:
 ///         max: :timestamp
 ///
+/// Additionally, the operator can aggregate its input in time windows, and
+/// emit the results of every window as soon as it closes:
+///
+///   summarize:
+///     window:
+///       field: ts
+///       size: 1 minute
+///       slide: 30 seconds
+///       allowed-lateness: 10 seconds
+///
 struct configuration {
   /// Create a configuration from the operator configuration.
   /// @param config The configuration of the summarize pipeline operator.
@@ -96,9 +138,41 @@ struct configuration {
         result.aggregations = std::move(*aggregations);
         continue;
       }
+      if (key == "mode") {
+        if (const auto* mode = caf::get_if<std::string>(&value)) {
+          if (*mode == "full") {
+            result.mode = aggregation_mode::full;
+            continue;
+          }
+          if (*mode == "partial") {
+            result.mode = aggregation_mode::partial;
+            continue;
+          }
+          if (*mode == "merge") {
+            result.mode = aggregation_mode::merge;
+            continue;
+          }
+        }
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("unexpected config key: "
+                                           "mode {} is not one of full, "
+                                           "partial, or merge",
+                                           value));
+      }
+      if (key == "window") {
+        auto window = parse_window(value);
+        if (!window)
+          return window.error();
+        result.window = std::move(*window);
+        continue;
+      }
       return caf::make_error(ec::invalid_configuration,
                              fmt::format("unexpected config key: {}", key));
     }
+    if (result.window && result.mode != aggregation_mode::full)
+      return caf::make_error(ec::invalid_configuration,
+                             "unexpected config key: window requires the "
+                             "full aggregation mode");
     return result;
   }
 
@@ -109,6 +183,16 @@ struct configuration {
     std::string output;                        ///< The output field name.
   };
 
+  /// The configuration of time windows. Every window spans `size`, and a new
+  /// window starts every `slide`, i.e., windows are tumbling if both are equal
+  /// and sliding otherwise.
+  struct windowing {
+    std::string field;              ///< Unresolved time extractor.
+    duration size = {};             ///< The length of a window.
+    duration slide = {};            ///< The distance between windows.
+    duration allowed_lateness = {}; ///< The delay before windows close.
+  };
+
   /// Unresolved group-by extractors.
   std::vector<std::string> group_by_extractors = {};
 
@@ -118,6 +202,120 @@ struct configuration {
   /// Configuration for aggregation columns.
   std::vector<aggregation> aggregations = {};
 
+  /// Whether to aggregate fully, partially, or to merge partial results.
+  aggregation_mode mode = aggregation_mode::full;
+
+  /// Time windows to aggregate in, if any.
+  std::optional<windowing> window = {};
+
+  /// Parse the time windows from their configuration.
+  /// @param config The relevant configuration subsection.
+  static caf::expected<windowing> parse_window(const data& config) {
+    const auto* window_config = caf::get_if<record>(&config);
+    if (!window_config)
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("unexpected config key: window {} "
+                                         "is not a record",
+                                         config));
+    auto result = windowing{};
+    for (const auto& [key, value] : *window_config) {
+      if (key == "field") {
+        if (const auto* field = caf::get_if<std::string>(&value)) {
+          result.field = *field;
+          continue;
+        }
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("unexpected config key: window "
+                                           "field {} is not a string",
+                                           value));
+      }
+      auto* target = key == "size"               ? &result.size
+                     : key == "slide"            ? &result.slide
+                     : key == "allowed-lateness" ? &result.allowed_lateness
+                                                 : nullptr;
+      if (!target)
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("unexpected config key: window.{}",
+                                           key));
+      if (const auto* value_duration = caf::get_if<duration>(&value)) {
+        *target = *value_duration;
+        continue;
+      }
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("unexpected config key: window.{} "
+                                         "{} is not a duration",
+                                         key, value));
+    }
+    if (result.field.empty())
+      return caf::make_error(ec::invalid_configuration,
+                             "unexpected config key: window requires a field");
+    if (result.size <= duration::zero())
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("unexpected config key: window size "
+                                         "{} is not positive",
+                                         data{result.size}));
+    if (result.slide == duration::zero())
+      result.slide = result.size;
+    if (result.slide < duration::zero() || result.slide > result.size
+        || result.size % result.slide != duration::zero())
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("unexpected config key: window slide "
+                                         "{} does not evenly divide the "
+                                         "window size {}",
+                                         data{result.slide},
+                                         data{result.size}));
+    if (result.allowed_lateness < duration::zero())
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("unexpected config key: window "
+                                         "allowed-lateness {} is negative",
+                                         data{result.allowed_lateness}));
+    return result;
+  }
+
+  /// Converts the configuration back into the options of a summarize pipeline
+  /// operator.
+  [[nodiscard]] record to_record() const {
+    auto group_by = list{};
+    group_by.reserve(group_by_extractors.size());
+    for (const auto& extractor : group_by_extractors)
+      group_by.emplace_back(extractor);
+    auto aggregate = record{};
+    for (const auto& aggregation : aggregations) {
+      auto extractors = list{};
+      extractors.reserve(aggregation.input_extractors.size());
+      for (const auto& extractor : aggregation.input_extractors)
+        extractors.emplace_back(extractor);
+      aggregate.emplace(aggregation.output,
+                        record{{aggregation.function_name,
+                                std::move(extractors)}});
+    }
+    auto result = record{
+      {"group-by", std::move(group_by)},
+      {"aggregate", std::move(aggregate)},
+    };
+    if (time_resolution)
+      result.emplace("time-resolution", *time_resolution);
+    switch (mode) {
+      case aggregation_mode::full:
+        result.emplace("mode", std::string{"full"});
+        break;
+      case aggregation_mode::partial:
+        result.emplace("mode", std::string{"partial"});
+        break;
+      case aggregation_mode::merge:
+        result.emplace("mode", std::string{"merge"});
+        break;
+    }
+    if (window)
+      result.emplace("window", record{
+                                 {"field", window->field},
+                                 {"size", window->size},
+                                 {"slide", window->slide},
+                                 {"allowed-lateness", window->allowed_lateness},
+                               });
+    return result;
+  }
+
 private:
   /// Parse the unresolved group-by-extractors from their configuration.
   /// @param config The relevant configuration subsection.
@@ -209,6 +407,58 @@ private:
   }
 };
 
+/// The plugin configuration of the summarize pipeline operator, which bounds
+/// the memory that the groups of an operator may occupy, for example:
+///
+///   plugins:
+///     summarize:
+///       memory-budget: 536870912
+///       spill-directory: /var/tmp/vast
+///
+struct spill_configuration {
+  /// The approximate number of bytes that the groups of a summarize operator
+  /// may occupy before they spill to disk, or 0 for no limit.
+  uint64_t memory_budget = 1_GiB;
+
+  /// The directory for spill files. Defaults to the temporary directory of
+  /// the system.
+  std::string spill_directory = {};
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, spill_configuration& x) {
+    return detail::apply_all(f, x.memory_budget, x.spill_directory);
+  }
+
+  static const record_type& schema() noexcept {
+    static auto result = record_type{
+      {"memory-budget", uint64_type{}},
+      {"spill-directory", string_type{}},
+    };
+    return result;
+  }
+};
+
+/// Counters for the spilling of the groups of a summarize operator.
+struct spill_statistics {
+  /// The number of bytes written to spill files.
+  uint64_t bytes = 0;
+
+  /// The number of times that groups were spilled to disk.
+  uint64_t passes = 0;
+
+  /// The number of spill files that were merged back.
+  uint64_t partitions = 0;
+};
+
+/// Removes the names and attributes from a type.
+type prune(const type& x) noexcept {
+  return caf::visit(
+    [](const concrete_type auto& pruned) noexcept {
+      return type{pruned};
+    },
+    x);
+}
+
 /// A group-by column that was bound to a given schema.
 struct group_by_column {
   /// Creates a set of group-by columns by binding the configuration to a
@@ -248,6 +498,31 @@ struct group_by_column {
     return result;
   }
 
+  /// Creates the group-by columns for partial results, which are all fields
+  /// of the partial results except for the aggregation columns.
+  /// @param schema The schema of the partial results.
+  /// @param config The configuration that produced the partial results.
+  static std::vector<group_by_column>
+  make_for_partial_results(const type& schema, const configuration& config) {
+    auto result = std::vector<group_by_column>{};
+    const auto& schema_rt = caf::get<record_type>(schema);
+    for (size_t index = 0; index < schema_rt.num_fields(); ++index) {
+      auto field = schema_rt.field(index);
+      const auto is_aggregation = std::any_of(
+        config.aggregations.begin(), config.aggregations.end(),
+        [&](const configuration::aggregation& aggregation) noexcept {
+          return aggregation.output == field.name;
+        });
+      if (is_aggregation)
+        continue;
+      auto& column = result.emplace_back();
+      column.input = offset{index};
+      column.name = std::string{field.name};
+      column.type = field.type;
+    }
+    return result;
+  }
+
   /// Compare two group-by columns for equality. This is required for
   /// deduplication of group-by columns.
   friend bool
@@ -300,13 +575,6 @@ struct aggregation_column {
       std::sort(inputs.begin(), inputs.end());
       inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
       // Check that all columns resolve to the same (pruned) type.
-      const auto prune = [](const class type& type) noexcept {
-        return caf::visit(
-          [](const concrete_type auto& pruned) noexcept {
-            return vast::type{pruned};
-          },
-          type);
-      };
       auto input_type = prune(schema_rt.field(inputs.front()).type);
       const auto type_mismatch = std::any_of(
         inputs.begin() + 1, inputs.end(), [&](const offset& input) noexcept {
@@ -342,6 +610,51 @@ struct aggregation_column {
       column.input_type = std::move(input_type);
       column.output_name = aggregation.output;
       column.output_type = std::move(output_type);
+      column.state_type = (*instance)->state_type();
+    }
+    return result;
+  }
+
+  /// Creates the aggregation columns for partial results, which hold the
+  /// partial aggregation state in place of the aggregated values. Merging the
+  /// states uses aggregation functions that take the state type as input.
+  /// @param schema The schema of the partial results.
+  /// @param config The configuration that produced the partial results.
+  static caf::expected<std::vector<aggregation_column>>
+  make_for_partial_results(const type& schema, const configuration& config) {
+    auto result = std::vector<aggregation_column>{};
+    const auto& schema_rt = caf::get<record_type>(schema);
+    for (const auto& aggregation : config.aggregations) {
+      for (size_t index = 0; index < schema_rt.num_fields(); ++index) {
+        auto field = schema_rt.field(index);
+        if (field.name != aggregation.output)
+          continue;
+        const auto* aggregation_function
+          = plugins::find<aggregation_function_plugin>(
+            aggregation.function_name);
+        if (!aggregation_function)
+          return caf::make_error(ec::invalid_configuration,
+                                 fmt::format("unknown aggregation function {}",
+                                             aggregation.function_name));
+        auto state_type = prune(field.type);
+        auto instance
+          = aggregation_function->make_aggregation_function(state_type);
+        if (!instance)
+          return caf::make_error(ec::invalid_configuration,
+                                 fmt::format("aggregation function {} failed "
+                                             "to instantiate for state type "
+                                             "{}: {}",
+                                             aggregation.function_name,
+                                             state_type, instance.error()));
+        auto& column = result.emplace_back();
+        column.function_name = aggregation.function_name;
+        column.inputs = {offset{index}};
+        column.input_type = std::move(state_type);
+        column.output_name = aggregation.output;
+        column.output_type = (*instance)->output_type();
+        column.state_type = (*instance)->state_type();
+        break;
+      }
     }
     return result;
   }
@@ -360,110 +673,945 @@ struct aggregation_column {
 
   /// The output field's type.
   class type output_type = {};
+
+  /// The type of the partial aggregation state.
+  class type state_type = {};
 };
 
-/// The key by which aggregations are grouped. Essentially, this is a vector of
-/// data. We create a new type here to support a custom hash and equality
-/// operation to support lookups with non-materialized keys.
-struct group_by_key : std::vector<data> {
-  using vector::vector;
+/// Mixes the hash of a single value into the digest of a row.
+/// @param digest The digest of the row so far.
+/// @param value The hash of the value.
+constexpr uint64_t mix_hash(uint64_t digest, uint64_t value) noexcept {
+  // The finalizer of SplitMix64, applied to the combination of both inputs.
+  value ^= digest + 0x9e3779b97f4a7c15 + (digest << 6) + (digest >> 2);
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+  return value ^ (value >> 31);
+}
+
+/// The hash of a null value in a group-by column.
+constexpr auto null_hash = uint64_t{0x5bd1e9955bd1e995};
+
+/// Accesses the storage array of an Arrow array of the given type, which
+/// differs from the array itself for extension types.
+template <concrete_type Type>
+const type_to_arrow_array_storage_t<Type>&
+storage_of(const arrow::Array& array) noexcept {
+  if constexpr (arrow::is_extension_type<type_to_arrow_type_t<Type>>::value)
+    return static_cast<const type_to_arrow_array_storage_t<Type>&>(
+      *caf::get<type_to_arrow_array_t<Type>>(array).storage());
+  else
+    return caf::get<type_to_arrow_array_t<Type>>(array);
+}
+
+/// Calls a function for the indices of all non-null elements of an array.
+void for_each_valid(const arrow::Array& array, auto&& f) {
+  if (array.null_count() == 0) {
+    for (int64_t row = 0; row < array.length(); ++row)
+      f(row);
+    return;
+  }
+  for (int64_t row = 0; row < array.length(); ++row)
+    if (array.IsValid(row))
+      f(row);
+}
+
+/// The group-by values of a single column for all groups of an aggregation.
+class key_column {
+public:
+  virtual ~key_column() noexcept = default;
+
+  /// Mixes the hashes of all values of an array into the digests of its rows.
+  /// @param array The group-by values of a batch.
+  /// @param digests The digest for every row of the batch.
+  virtual void
+  hash(const arrow::Array& array, std::span<uint64_t> digests) const = 0;
+
+  /// Checks whether a value is the group-by value of a group.
+  /// @param array The group-by values of a batch.
+  /// @param row The row of the value to check.
+  /// @param group The group to compare against.
+  [[nodiscard]] virtual bool
+  equals(const arrow::Array& array, int64_t row, size_t group) const = 0;
+
+  /// Adds a value as the group-by value of a new group.
+  /// @param array The group-by values of a batch.
+  /// @param row The row of the value to add.
+  virtual void append(const arrow::Array& array, int64_t row) = 0;
+
+  /// Appends the group-by values of all groups to a builder.
+  /// @param builder The builder for the output column.
+  virtual arrow::Status finish(arrow::ArrayBuilder& builder) const = 0;
+
+  /// @returns The approximate number of bytes that the values occupy.
+  [[nodiscard]] virtual size_t memusage() const = 0;
 };
 
-/// A view on a group-by key.
-struct group_by_key_view : std::vector<data_view> {
-  using vector::vector;
-
-  /// Materializes a view on a group-by key.
-  /// @param views The group-by key view to materialize.
-  friend group_by_key materialize(const group_by_key_view& views) {
-    auto result = group_by_key{};
-    result.reserve(views.size());
-    for (const auto& view : views)
-      result.push_back(materialize(view));
+/// A key column that stores its values in a typed vector. Comparing against
+/// and hashing values happens directly on the Arrow arrays without
+/// materializing them.
+template <concrete_type Type>
+class typed_key_column final : public key_column {
+public:
+  explicit typed_key_column(Type type) noexcept : type_{std::move(type)} {
+    // nop
+  }
+
+private:
+  void
+  hash(const arrow::Array& array, std::span<uint64_t> digests) const override {
+    if constexpr (is_fixed_width) {
+      const auto& storage = storage_of<Type>(array);
+      for (int64_t row = 0; row < array.length(); ++row) {
+        const auto value = array.IsNull(row)
+                             ? null_hash
+                             : hash_value(value_at(type_, storage, row));
+        digests[row] = mix_hash(digests[row], value);
+      }
+    } else {
+      auto hashes = std::vector<default_hash::result_type>(array.length());
+      hash_column<default_hash>(type_, array, hashes, 0);
+      for (int64_t row = 0; row < array.length(); ++row)
+        digests[row] = mix_hash(digests[row], hashes[row]);
+    }
+  }
+
+  [[nodiscard]] bool
+  equals(const arrow::Array& array, int64_t row, size_t group) const override {
+    if (array.IsNull(row))
+      return nulls_[group] != 0;
+    return nulls_[group] == 0
+           && value_at(type_, storage_of<Type>(array), row)
+                == make_view(values_[group]);
+  }
+
+  void append(const arrow::Array& array, int64_t row) override {
+    if (array.IsNull(row)) {
+      values_.emplace_back();
+      nulls_.push_back(1);
+      return;
+    }
+    values_.push_back(
+      materialize(value_at(type_, storage_of<Type>(array), row)));
+    nulls_.push_back(0);
+    if constexpr (std::is_same_v<Type, string_type>)
+      heap_bytes_ += values_.back().size();
+  }
+
+  arrow::Status finish(arrow::ArrayBuilder& builder) const override {
+    auto& typed_builder = caf::get<type_to_arrow_builder_t<Type>>(builder);
+    for (size_t group = 0; group < values_.size(); ++group) {
+      auto status = nulls_[group] != 0
+                      ? typed_builder.AppendNull()
+                      : append_builder(type_, typed_builder,
+                                       make_view(values_[group]));
+      if (!status.ok())
+        return status;
+    }
+    return arrow::Status::OK();
+  }
+
+  [[nodiscard]] size_t memusage() const override {
+    return values_.capacity() * sizeof(type_to_data_t<Type>)
+           + nulls_.capacity() + heap_bytes_;
+  }
+
+  /// Whether the values have a fixed-width bit representation.
+  static constexpr bool is_fixed_width
+    = detail::is_any_v<Type, bool_type, int64_type, uint64_type,
+                       enumeration_type, double_type, duration_type, time_type>;
+
+  /// Hashes a single fixed-width value. Fixed-width values use their bit
+  /// representation directly, which the digest mixing spreads sufficiently.
+  static uint64_t hash_value(view<type_to_data_t<Type>> value) noexcept
+    requires(is_fixed_width) {
+    if constexpr (detail::is_any_v<Type, bool_type, int64_type, uint64_type,
+                                   enumeration_type>) {
+      return static_cast<uint64_t>(value);
+    } else if constexpr (std::is_same_v<Type, double_type>) {
+      // Positive and negative zero compare equal, so they must hash equally.
+      return value == 0.0 ? 0 : std::bit_cast<uint64_t>(value);
+    } else if constexpr (std::is_same_v<Type, duration_type>) {
+      return static_cast<uint64_t>(value.count());
+    } else if constexpr (std::is_same_v<Type, time_type>) {
+      return static_cast<uint64_t>(value.time_since_epoch().count());
+    }
+  }
+
+  Type type_ = {};
+  std::vector<type_to_data_t<Type>> values_ = {};
+  std::vector<uint8_t> nulls_ = {};
+  size_t heap_bytes_ = 0;
+};
+
+/// A key column for types without a typed representation, e.g., lists and
+/// records, that stores its values as data.
+class generic_key_column final : public key_column {
+public:
+  explicit generic_key_column(type type) noexcept : type_{std::move(type)} {
+    // nop
+  }
+
+private:
+  void
+  hash(const arrow::Array& array, std::span<uint64_t> digests) const override {
+    auto hashes = std::vector<default_hash::result_type>(array.length());
+    hash_column<default_hash>(type_, array, hashes, 0);
+    for (int64_t row = 0; row < array.length(); ++row)
+      digests[row] = mix_hash(digests[row], hashes[row]);
+  }
+
+  [[nodiscard]] bool
+  equals(const arrow::Array& array, int64_t row, size_t group) const override {
+    return value_at(type_, array, row) == make_view(values_[group]);
+  }
+
+  void append(const arrow::Array& array, int64_t row) override {
+    values_.push_back(materialize(value_at(type_, array, row)));
+  }
+
+  arrow::Status finish(arrow::ArrayBuilder& builder) const override {
+    for (const auto& value : values_)
+      if (auto status = append_builder(type_, builder, make_view(value));
+          !status.ok())
+        return status;
+    return arrow::Status::OK();
+  }
+
+  /// Nested values are not accounted for, so this is a lower bound.
+  [[nodiscard]] size_t memusage() const override {
+    return values_.capacity() * sizeof(data);
+  }
+
+  type type_ = {};
+  std::vector<data> values_ = {};
+};
+
+/// Creates the key column for a group-by column.
+std::unique_ptr<key_column> make_key_column(const group_by_column& column) {
+  auto f = []<concrete_type Type>(
+             const Type& type) -> std::unique_ptr<key_column> {
+    if constexpr (detail::is_any_v<Type, bool_type, int64_type, uint64_type,
+                                   double_type, duration_type, time_type,
+                                   string_type, ip_type, subnet_type,
+                                   enumeration_type>)
+      return std::make_unique<typed_key_column<Type>>(type);
+    else
+      return std::make_unique<generic_key_column>(vast::type{type});
+  };
+  return caf::visit(f, column.type);
+}
+
+/// A flat open-addressing hash table that assigns dense group ids to the rows
+/// of a batch by their group-by values.
+///
+/// The table hashes the group-by columns of a batch column by column, and then
+/// probes with linear probing. The slots only hold the digest and id of a
+/// group; the group-by values themselves live in typed key columns, which
+/// also compare the rows against the groups on a digest match.
+class group_table {
+public:
+  /// Creates an empty table.
+  /// @param columns The group-by columns.
+  explicit group_table(const std::vector<group_by_column>& columns) {
+    columns_.reserve(columns.size());
+    for (const auto& column : columns)
+      columns_.push_back(make_key_column(column));
+    slots_.resize(initial_capacity);
+  }
+
+  /// Assigns group ids to all rows of a batch, creating new groups for
+  /// group-by values that were not seen before.
+  /// @param arrays The group-by columns of the batch.
+  /// @param rows The number of rows of the batch.
+  /// @returns The group id for every row of the batch.
+  std::span<const uint32_t>
+  assign(const arrow::ArrayVector& arrays, int64_t rows) {
+    VAST_ASSERT(arrays.size() == columns_.size());
+    const auto num_rows = detail::narrow_cast<size_t>(rows);
+    digests_.assign(num_rows, 0);
+    for (size_t column = 0; column < columns_.size(); ++column)
+      columns_[column]->hash(*arrays[column], digests_);
+    group_ids_.resize(num_rows);
+    for (size_t row = 0; row < num_rows; ++row) {
+      // Consecutive rows frequently belong to the same group, so we check
+      // against the previous row before probing.
+      if (row > 0 && digests_[row] == digests_[row - 1]
+          && equals(arrays, row, group_ids_[row - 1])) {
+        group_ids_[row] = group_ids_[row - 1];
+        continue;
+      }
+      group_ids_[row] = find_or_insert(arrays, row);
+    }
+    return group_ids_;
+  }
+
+  /// @returns The number of groups.
+  [[nodiscard]] size_t size() const noexcept {
+    return size_;
+  }
+
+  /// @returns The digest of the group-by values for every group.
+  [[nodiscard]] std::span<const uint64_t> digests() const noexcept {
+    return group_digests_;
+  }
+
+  /// @returns The approximate number of bytes that the table occupies.
+  [[nodiscard]] size_t memusage() const {
+    auto result = slots_.capacity() * sizeof(slot)
+                  + group_digests_.capacity() * sizeof(uint64_t)
+                  + digests_.capacity() * sizeof(uint64_t)
+                  + group_ids_.capacity() * sizeof(uint32_t);
+    for (const auto& column : columns_)
+      result += column->memusage();
     return result;
   }
+
+  /// Appends the group-by values of all groups to a builder.
+  /// @param column The index of the group-by column.
+  /// @param builder The builder for the output column.
+  arrow::Status finish(size_t column, arrow::ArrayBuilder& builder) const {
+    return columns_[column]->finish(builder);
+  }
+
+private:
+  /// A slot of the table. Empty slots have the group id *empty*.
+  struct slot {
+    uint64_t digest = 0;
+    uint32_t group = empty;
+  };
+
+  static constexpr auto empty = std::numeric_limits<uint32_t>::max();
+
+  static constexpr auto initial_capacity = size_t{1024};
+
+  [[nodiscard]] bool
+  equals(const arrow::ArrayVector& arrays, size_t row, uint32_t group) const {
+    const auto i = detail::narrow_cast<int64_t>(row);
+    for (size_t column = 0; column < columns_.size(); ++column)
+      if (!columns_[column]->equals(*arrays[column], i, group))
+        return false;
+    return true;
+  }
+
+  uint32_t find_or_insert(const arrow::ArrayVector& arrays, size_t row) {
+    const auto digest = digests_[row];
+    const auto mask = slots_.size() - 1;
+    for (auto index = digest & mask;; index = (index + 1) & mask) {
+      auto& entry = slots_[index];
+      if (entry.group == empty) {
+        const auto group = detail::narrow_cast<uint32_t>(size_++);
+        for (size_t column = 0; column < columns_.size(); ++column)
+          columns_[column]->append(*arrays[column],
+                                   detail::narrow_cast<int64_t>(row));
+        entry = {digest, group};
+        group_digests_.push_back(digest);
+        // Keep the load factor below one half to keep probe sequences short.
+        if (2 * size_ > slots_.size())
+          grow();
+        return group;
+      }
+      if (entry.digest == digest && equals(arrays, row, entry.group))
+        return entry.group;
+    }
+  }
+
+  void grow() {
+    auto slots = std::vector<slot>(slots_.size() * 2);
+    const auto mask = slots.size() - 1;
+    for (const auto& entry : slots_) {
+      if (entry.group == empty)
+        continue;
+      auto index = entry.digest & mask;
+      while (slots[index].group != empty)
+        index = (index + 1) & mask;
+      slots[index] = entry;
+    }
+    slots_ = std::move(slots);
+  }
+
+  std::vector<std::unique_ptr<key_column>> columns_ = {};
+  std::vector<slot> slots_ = {};
+  size_t size_ = 0;
+  std::vector<uint64_t> group_digests_ = {};
+  std::vector<uint64_t> digests_ = {};
+  std::vector<uint32_t> group_ids_ = {};
+};
+
+/// The aggregation state of a single aggregation column for all groups.
+class accumulator {
+public:
+  virtual ~accumulator() noexcept = default;
+
+  /// Updates the state of the groups with the values of a batch.
+  /// @param arrays The input columns of the batch.
+  /// @param group_ids The group id for every row of the batch.
+  /// @param num_groups The number of groups including the ones created for
+  /// the batch.
+  virtual void add(const arrow::ArrayVector& arrays,
+                   std::span<const uint32_t> group_ids, size_t num_groups)
+    = 0;
+
+  /// Appends the results for all groups to a builder.
+  /// @param builder The builder for the output column.
+  virtual caf::error finish(arrow::ArrayBuilder& builder) = 0;
+
+  /// Appends the partial aggregation state for all groups to a builder. The
+  /// state of the typed accumulators equals their result.
+  /// @param builder The builder for the state column.
+  virtual caf::error save(arrow::ArrayBuilder& builder) {
+    return finish(builder);
+  }
+
+  /// @returns The approximate number of bytes that the state occupies.
+  [[nodiscard]] virtual size_t memusage() const = 0;
+};
+
+/// Counts the non-null values per group.
+class count_accumulator final : public accumulator {
+  void add(const arrow::ArrayVector& arrays,
+           std::span<const uint32_t> group_ids, size_t num_groups) override {
+    counts_.resize(num_groups);
+    for (const auto& array : arrays)
+      for_each_valid(*array, [&](int64_t row) {
+        ++counts_[group_ids[row]];
+      });
+  }
+
+  caf::error finish(arrow::ArrayBuilder& builder) override {
+    auto& typed_builder
+      = caf::get<type_to_arrow_builder_t<uint64_type>>(builder);
+    if (auto status = typed_builder.AppendValues(counts_); !status.ok())
+      return caf::make_error(ec::system_error,
+                             fmt::format("failed to append counts: {}",
+                                         status.ToString()));
+    return {};
+  }
+
+  [[nodiscard]] size_t memusage() const override {
+    return counts_.capacity() * sizeof(uint64_t);
+  }
+
+  std::vector<uint64_t> counts_ = {};
+};
+
+/// The operations of the typed accumulators.
+enum class fold {
+  sum,
+  min,
+  max,
+};
+
+/// Folds the non-null values per group into a single value.
+template <concrete_type Type, fold Fold>
+class fold_accumulator final : public accumulator {
+public:
+  explicit fold_accumulator(Type type) noexcept : type_{std::move(type)} {
+    // nop
+  }
+
+private:
+  void add(const arrow::ArrayVector& arrays,
+           std::span<const uint32_t> group_ids, size_t num_groups) override {
+    values_.resize(num_groups);
+    valid_.resize(num_groups);
+    for (const auto& array : arrays) {
+      const auto& storage = storage_of<Type>(*array);
+      for_each_valid(*array, [&](int64_t row) {
+        const auto group = group_ids[row];
+        const auto value = value_at(type_, storage, row);
+        if (valid_[group] == 0) {
+          values_[group] = value;
+          valid_[group] = 1;
+        } else if constexpr (Fold == fold::sum) {
+          values_[group] = values_[group] + value;
+        } else if constexpr (Fold == fold::min) {
+          if (value < values_[group])
+            values_[group] = value;
+        } else if constexpr (Fold == fold::max) {
+          if (value > values_[group])
+            values_[group] = value;
+        }
+      });
+    }
+  }
+
+  caf::error finish(arrow::ArrayBuilder& builder) override {
+    auto& typed_builder = caf::get<type_to_arrow_builder_t<Type>>(builder);
+    for (size_t group = 0; group < values_.size(); ++group) {
+      auto status = valid_[group] == 0
+                      ? typed_builder.AppendNull()
+                      : append_builder(type_, typed_builder, values_[group]);
+      if (!status.ok())
+        return caf::make_error(ec::system_error,
+                               fmt::format("failed to append aggregated "
+                                           "value: {}",
+                                           status.ToString()));
+    }
+    return {};
+  }
+
+  [[nodiscard]] size_t memusage() const override {
+    return values_.capacity() * sizeof(type_to_data_t<Type>)
+           + valid_.capacity();
+  }
+
+  Type type_ = {};
+  std::vector<type_to_data_t<Type>> values_ = {};
+  std::vector<uint8_t> valid_ = {};
+};
+
+/// Collects the distinct non-null values per group into a sorted list.
+template <concrete_type Type>
+class distinct_accumulator final : public accumulator {
+public:
+  distinct_accumulator(Type type, class type output_type) noexcept
+    : type_{std::move(type)}, output_type_{std::move(output_type)} {
+    // nop
+  }
+
+private:
+  using value_type = type_to_data_t<Type>;
+
+  struct value_hash {
+    using is_transparent = void;
+
+    size_t operator()(view<value_type> value) const noexcept {
+      return vast::hash(value);
+    }
+
+    size_t operator()(const value_type& value) const noexcept
+      requires(!std::is_same_v<view<value_type>, value_type>) {
+      return vast::hash(make_view(value));
+    }
+  };
+
+  struct value_equal {
+    using is_transparent = void;
+
+    bool operator()(const value_type& lhs, const value_type& rhs) const {
+      return lhs == rhs;
+    }
+
+    bool operator()(view<value_type> lhs, const value_type& rhs) const
+      requires(!std::is_same_v<view<value_type>, value_type>) {
+      return lhs == make_view(rhs);
+    }
+
+    bool operator()(const value_type& lhs, view<value_type> rhs) const
+      requires(!std::is_same_v<view<value_type>, value_type>) {
+      return make_view(lhs) == rhs;
+    }
+  };
+
+  using set_type = tsl::robin_set<value_type, value_hash, value_equal>;
+
+  void add(const arrow::ArrayVector& arrays,
+           std::span<const uint32_t> group_ids, size_t num_groups) override {
+    sets_.resize(num_groups);
+    for (const auto& array : arrays) {
+      const auto& storage = storage_of<Type>(*array);
+      for_each_valid(*array, [&](int64_t row) {
+        auto& set = sets_[group_ids[row]];
+        const auto value = value_at(type_, storage, row);
+        if (set.contains(value))
+          return;
+        set.insert(materialize(value));
+        // Every value additionally occupies a bucket with its hash.
+        bytes_ += sizeof(value_type) + sizeof(uint64_t);
+        if constexpr (std::is_same_v<Type, string_type>)
+          bytes_ += value.size();
+      });
+    }
+  }
+
+  caf::error finish(arrow::ArrayBuilder& builder) override {
+    for (auto& set : sets_) {
+      auto values = std::vector<value_type>{
+        std::make_move_iterator(set.begin()),
+        std::make_move_iterator(set.end())};
+      std::sort(values.begin(), values.end());
+      auto result = list{};
+      result.reserve(values.size());
+      for (auto& value : values)
+        result.emplace_back(std::move(value));
+      const auto status
+        = append_builder(output_type_, builder, make_data_view(result));
+      if (!status.ok())
+        return caf::make_error(ec::system_error,
+                               fmt::format("failed to append distinct values: "
+                                           "{}",
+                                           status.ToString()));
+    }
+    return {};
+  }
+
+  [[nodiscard]] size_t memusage() const override {
+    return sets_.capacity() * sizeof(set_type) + bytes_;
+  }
+
+  Type type_ = {};
+  class type output_type_ = {};
+  std::vector<set_type> sets_ = {};
+  size_t bytes_ = 0;
 };
 
-/// The hash functor for enabling use of *group_by_key* as a key in unordered
-/// map data structures with transparent lookup.
-struct group_by_key_hash {
-  size_t operator()(const group_by_key& x) const noexcept {
-    auto hasher = xxh64{};
-    for (const auto& value : x)
-      hash_append(hasher, make_view(value));
-    return hasher.finish();
+/// Aggregates with the aggregation function plugin, using one instance of the
+/// function per group. This supports all aggregation functions, including
+/// those that have no typed accumulator.
+class function_accumulator final : public accumulator {
+public:
+  function_accumulator(const aggregation_column& column,
+                       aggregation_mode mode) noexcept
+    : column_{column}, mode_{mode} {
+    // nop
   }
 
-  size_t operator()(const group_by_key_view& x) const noexcept {
-    auto hasher = xxh64{};
-    for (const auto& value : x)
-      hash_append(hasher, value);
-    return hasher.finish();
+private:
+  void add(const arrow::ArrayVector& arrays,
+           std::span<const uint32_t> group_ids, size_t num_groups) override {
+    const auto* plugin
+      = plugins::find<aggregation_function_plugin>(column_.function_name);
+    VAST_ASSERT(plugin);
+    functions_.reserve(num_groups);
+    while (functions_.size() < num_groups) {
+      auto function = plugin->make_aggregation_function(column_.input_type);
+      // We check whether it's possible to create the aggregation function for
+      // the column's input type ahead of time, so there's no need to check
+      // again here.
+      VAST_ASSERT(function);
+      functions_.push_back(std::move(*function));
+    }
+    // Partial results hold one state per row, which we merge one by one.
+    if (mode_ == aggregation_mode::merge) {
+      for (const auto& array : arrays) {
+        for (int64_t row = 0; row < array->length(); ++row) {
+          auto err = functions_[group_ids[row]]->merge(
+            materialize(value_at(column_.input_type, *array, row)));
+          if (err && !error_)
+            error_ = std::move(err);
+        }
+      }
+      return;
+    }
+    // Feed runs of consecutive rows that belong to the same group to the
+    // function at once.
+    const auto update = [&](uint32_t group, int64_t offset, int64_t length) {
+      auto& function = *functions_[group];
+      for (const auto& array : arrays) {
+        if (length == 1)
+          function.add(value_at(column_.input_type, *array, offset));
+        else
+          function.add(*array->Slice(offset, length));
+      }
+    };
+    const auto rows = detail::narrow_cast<int64_t>(group_ids.size());
+    auto first_row = int64_t{0};
+    for (auto row = int64_t{1}; row < rows; ++row) {
+      if (group_ids[row] == group_ids[first_row])
+        continue;
+      update(group_ids[first_row], first_row, row - first_row);
+      first_row = row;
+    }
+    if (rows > 0)
+      update(group_ids[first_row], first_row, rows - first_row);
   }
+
+  caf::error finish(arrow::ArrayBuilder& builder) override {
+    return append(builder, column_.output_type,
+                  [](aggregation_function& function) {
+                    return std::move(function).finish();
+                  });
+  }
+
+  caf::error save(arrow::ArrayBuilder& builder) override {
+    return append(builder, column_.state_type,
+                  [](aggregation_function& function) {
+                    return function.save();
+                  });
+  }
+
+  /// The state of the functions is opaque, so we assume a fixed size per
+  /// group.
+  [[nodiscard]] size_t memusage() const override {
+    constexpr auto function_size = size_t{64};
+    return functions_.capacity() * sizeof(void*)
+           + functions_.size() * function_size;
+  }
+
+  /// Appends a value for every group to a builder and discards the
+  /// functions.
+  /// @param builder The builder for the output column.
+  /// @param result_type The type of the values.
+  /// @param f The function to retrieve the value from an aggregation function.
+  caf::error
+  append(arrow::ArrayBuilder& builder, const type& result_type, auto f) {
+    if (error_)
+      return std::exchange(error_, {});
+    for (auto& function : std::exchange(functions_, {})) {
+      auto value = f(*function);
+      if (!value)
+        return value.error();
+      const auto status
+        = append_builder(result_type, builder, make_data_view(*value));
+      if (!status.ok())
+        return caf::make_error(ec::system_error,
+                               fmt::format("failed to append aggregated {}: {}",
+                                           *value, status.ToString()));
+    }
+    return {};
+  }
+
+  aggregation_column column_ = {};
+  aggregation_mode mode_ = {};
+  std::vector<std::unique_ptr<aggregation_function>> functions_ = {};
+  caf::error error_ = {};
 };
 
-/// The equality functor for enabling use of *group_by_key* as a key in
-/// unordered map data structures with transparent lookup.
-struct group_by_key_equal {
-  using is_transparent = void;
+/// Creates the accumulator for an aggregation column. The common aggregation
+/// functions for fixed-width and string types use typed accumulators that
+/// keep their state in columnar arrays, and all others fall back to the
+/// aggregation function plugins. The partial aggregation state of the
+/// functions with typed accumulators equals their result, so the typed
+/// accumulators produce partial results as is, and merge them by folding the
+/// states.
+std::unique_ptr<accumulator>
+make_accumulator(const aggregation_column& column, aggregation_mode mode) {
+  if (column.function_name == "count") {
+    if (mode == aggregation_mode::merge)
+      return std::make_unique<fold_accumulator<uint64_type, fold::sum>>(
+        uint64_type{});
+    return std::make_unique<count_accumulator>();
+  }
+  auto f = [&]<concrete_type Type>(
+             const Type& type) -> std::unique_ptr<accumulator> {
+    constexpr auto is_number
+      = detail::is_any_v<Type, int64_type, uint64_type, double_type,
+                         duration_type>;
+    constexpr auto is_ordered = is_number || std::is_same_v<Type, time_type>;
+    if constexpr (is_number) {
+      if (column.function_name == "sum")
+        return std::make_unique<fold_accumulator<Type, fold::sum>>(type);
+    }
+    if constexpr (is_ordered) {
+      if (column.function_name == "min")
+        return std::make_unique<fold_accumulator<Type, fold::min>>(type);
+      if (column.function_name == "max")
+        return std::make_unique<fold_accumulator<Type, fold::max>>(type);
+    }
+    if constexpr (is_ordered || std::is_same_v<Type, string_type>) {
+      if (column.function_name == "distinct")
+        return std::make_unique<distinct_accumulator<Type>>(type,
+                                                            column.output_type);
+    }
+    return std::make_unique<function_accumulator>(column, mode);
+  };
+  return caf::visit(f, column.input_type);
+}
 
-  bool
-  operator()(const group_by_key_view& x, const group_by_key& y) const noexcept {
-    return std::equal(x.begin(), x.end(), y.begin(), y.end(),
-                      [](const auto& lhs, const auto& rhs) {
-                        return lhs == make_view(rhs);
-                      });
+/// A spill file that holds the partial results of one hash partition of the
+/// groups of an aggregation. The file is removed when it goes out of scope.
+class spill_file {
+public:
+  spill_file() noexcept = default;
+  spill_file(const spill_file&) = delete;
+  spill_file& operator=(const spill_file&) = delete;
+
+  spill_file(spill_file&& other) noexcept
+    : path_{std::exchange(other.path_, {})},
+      stream_{std::move(other.stream_)},
+      writer_{std::move(other.writer_)} {
+    // nop
+  }
+
+  spill_file& operator=(spill_file&& other) noexcept {
+    remove();
+    path_ = std::exchange(other.path_, {});
+    stream_ = std::move(other.stream_);
+    writer_ = std::move(other.writer_);
+    return *this;
+  }
+
+  ~spill_file() noexcept {
+    remove();
   }
 
-  bool
-  operator()(const group_by_key& x, const group_by_key_view& y) const noexcept {
-    return std::equal(x.begin(), x.end(), y.begin(), y.end(),
-                      [](const auto& lhs, const auto& rhs) {
-                        return make_view(lhs) == rhs;
-                      });
+  /// @returns Whether the file holds any partial results.
+  [[nodiscard]] bool empty() const noexcept {
+    return path_.empty();
   }
 
-  bool operator()(const group_by_key& x, const group_by_key& y) const noexcept {
-    return x == y;
+  /// Appends partial results to the file, creating it if necessary.
+  /// @param batch The partial results.
+  /// @param directory The directory to create the file in.
+  /// @returns The number of written bytes.
+  caf::expected<uint64_t> write(const arrow::RecordBatch& batch,
+                                const std::filesystem::path& directory) {
+    if (!writer_) {
+      auto err = std::error_code{};
+      std::filesystem::create_directories(directory, err);
+      if (err)
+        return caf::make_error(ec::filesystem_error,
+                               fmt::format("failed to create spill directory "
+                                           "{}: {}",
+                                           directory.string(), err.message()));
+      path_ = directory
+              / fmt::format("vast-summarize-{}.arrows", uuid::random());
+      auto stream = arrow::io::FileOutputStream::Open(path_.string());
+      if (!stream.ok())
+        return caf::make_error(ec::filesystem_error,
+                               fmt::format("failed to open spill file {}: {}",
+                                           path_.string(),
+                                           stream.status().ToString()));
+      stream_ = stream.MoveValueUnsafe();
+      auto writer = arrow::ipc::MakeStreamWriter(stream_, batch.schema());
+      if (!writer.ok())
+        return caf::make_error(ec::system_error,
+                               fmt::format("failed to create writer for spill "
+                                           "file {}: {}",
+                                           path_.string(),
+                                           writer.status().ToString()));
+      writer_ = writer.MoveValueUnsafe();
+    }
+    const auto offset = stream_->Tell();
+    auto status = writer_->WriteRecordBatch(batch);
+    const auto new_offset = stream_->Tell();
+    if (!status.ok() || !offset.ok() || !new_offset.ok())
+      return caf::make_error(ec::filesystem_error,
+                             fmt::format("failed to write spill file {}: {}",
+                                         path_.string(), status.ToString()));
+    return detail::narrow_cast<uint64_t>(*new_offset - *offset);
+  }
+
+  /// Reads all partial results back from the file.
+  /// @param f The function to call for every batch of partial results.
+  caf::error read(auto&& f) {
+    if (writer_) {
+      auto status = writer_->Close();
+      if (status.ok())
+        status = stream_->Close();
+      writer_ = {};
+      stream_ = {};
+      if (!status.ok())
+        return caf::make_error(ec::filesystem_error,
+                               fmt::format("failed to close spill file {}: {}",
+                                           path_.string(), status.ToString()));
+    }
+    auto input = arrow::io::ReadableFile::Open(path_.string());
+    if (!input.ok())
+      return caf::make_error(ec::filesystem_error,
+                             fmt::format("failed to open spill file {}: {}",
+                                         path_.string(),
+                                         input.status().ToString()));
+    auto reader = arrow::ipc::RecordBatchStreamReader::Open(*input);
+    if (!reader.ok())
+      return caf::make_error(ec::filesystem_error,
+                             fmt::format("failed to read spill file {}: {}",
+                                         path_.string(),
+                                         reader.status().ToString()));
+    while (true) {
+      auto batch = (*reader)->Next();
+      if (!batch.ok())
+        return caf::make_error(ec::filesystem_error,
+                               fmt::format("failed to read spill file {}: {}",
+                                           path_.string(),
+                                           batch.status().ToString()));
+      if (!*batch)
+        return {};
+      f(batch.MoveValueUnsafe());
+    }
   }
 
-  bool operator()(const group_by_key_view& x,
-                  const group_by_key_view& y) const noexcept {
-    return x == y;
+private:
+  void remove() noexcept {
+    if (writer_)
+      static_cast<void>(writer_->Close());
+    if (stream_)
+      static_cast<void>(stream_->Close());
+    writer_ = {};
+    stream_ = {};
+    if (path_.empty())
+      return;
+    auto err = std::error_code{};
+    std::filesystem::remove(std::exchange(path_, {}), err);
+    if (err)
+      VAST_WARN("summarize operator failed to remove spill file: {}",
+                err.message());
   }
+
+  std::filesystem::path path_ = {};
+  std::shared_ptr<arrow::io::FileOutputStream> stream_ = {};
+  std::shared_ptr<arrow::ipc::RecordBatchWriter> writer_ = {};
 };
 
 /// A configured aggregation that is bound to a single schema.
+///
+/// When its groups exceed the memory budget, the aggregation writes the
+/// partial aggregation state of its groups to spill files, partitioned by the
+/// hash of their group-by values, and starts over with no groups. Every group
+/// is then in exactly one partition, so finishing the aggregation merges the
+/// partitions one after the other in a second pass, which requires only the
+/// groups of a single partition to fit into memory.
 class aggregation {
 public:
-  /// The buckets to aggregate into. Essentially, this is an ordered list of
-  /// aggregation functions which are incrementally fed input from rows with
-  /// matching group-by keys.
-  using bucket = std::vector<std::unique_ptr<aggregation_function>>;
-
   /// Create an aggregation by binding the summarize pipeline operator
   /// configuration to a given schema.
   [[nodiscard]] static caf::expected<aggregation>
-  make(const type& schema, const configuration& config) noexcept {
-    auto group_by_columns = group_by_column::make(schema, config);
-    if (!group_by_columns)
-      return group_by_columns.error();
-    auto aggregation_columns = aggregation_column::make(schema, config);
-    if (!aggregation_columns)
-      return aggregation_columns.error();
+  make(const type& schema, const configuration& config,
+       const spill_configuration& spill_config) noexcept {
     auto result = aggregation{};
-    result.group_by_columns = std::move(*group_by_columns);
-    result.aggregation_columns = std::move(*aggregation_columns);
-    result.output_schema = [&]() noexcept -> type {
+    result.config = config;
+    result.spill_config = spill_config;
+    result.mode = config.mode;
+    if (config.mode == aggregation_mode::merge) {
+      if (schema.attribute("summarize") != "partial")
+        return caf::make_error(ec::invalid_argument,
+                               fmt::format("schema {} does not hold partial "
+                                           "results",
+                                           schema));
+      result.group_by_columns
+        = group_by_column::make_for_partial_results(schema, config);
+      auto aggregation_columns
+        = aggregation_column::make_for_partial_results(schema, config);
+      if (!aggregation_columns)
+        return aggregation_columns.error();
+      result.aggregation_columns = std::move(*aggregation_columns);
+    } else {
+      auto group_by_columns = group_by_column::make(schema, config);
+      if (!group_by_columns)
+        return group_by_columns.error();
+      auto aggregation_columns = aggregation_column::make(schema, config);
+      if (!aggregation_columns)
+        return aggregation_columns.error();
+      result.group_by_columns = std::move(*group_by_columns);
+      result.aggregation_columns = std::move(*aggregation_columns);
+    }
+    const auto make_schema = [&](bool partial) noexcept -> type {
       auto fields = std::vector<record_type::field_view>{};
       fields.reserve(result.group_by_columns.size()
                      + result.aggregation_columns.size());
       for (const auto& column : result.group_by_columns)
         fields.emplace_back(column.name, column.type);
       for (const auto& column : result.aggregation_columns)
-        fields.emplace_back(column.output_name, column.output_type);
+        fields.emplace_back(column.output_name, partial ? column.state_type
+                                                        : column.output_type);
+      // We mark partial results, so that merging them does not mistake other
+      // batches for partial results.
+      if (partial)
+        return {schema.name(), record_type{fields}, {{"summarize", "partial"}}};
       return {schema.name(), record_type{fields}};
-    }();
+    };
+    result.output_schema
+      = make_schema(config.mode == aggregation_mode::partial);
+    result.state_schema = make_schema(true);
+    result.spillable = std::all_of(
+      result.aggregation_columns.begin(), result.aggregation_columns.end(),
+      [](const aggregation_column& column) {
+        const auto* plugin
+          = plugins::find<aggregation_function_plugin>(column.function_name);
+        return plugin && plugin->supports_partial_aggregation();
+      });
+    result.reset();
     return result;
   }
 
@@ -472,129 +1620,204 @@ public:
   /// configured schema.
   void add(const std::shared_ptr<arrow::RecordBatch>& batch) {
     VAST_ASSERT(batch);
-    // Determine the inputs only once ahead of time.
+    VAST_ASSERT(batch->num_rows() > 0);
     const auto group_by_arrays = make_group_by_arrays(*batch);
     const auto aggregation_arrays = make_aggregation_arrays(*batch);
-    // Helper lambda for updating a bucket.
-    const auto update_bucket = [&](bucket& bucket, int offset,
-                                   int length) noexcept {
-      VAST_ASSERT(length > 0);
-      if (length == 1) {
-        for (size_t column = 0; column < aggregation_columns.size(); ++column) {
-          for (const auto& array : aggregation_arrays[column])
-            bucket[column]->add(
-              value_at(aggregation_columns[column].input_type, *array, offset));
-        }
-      } else {
-        for (size_t column = 0; column < aggregation_columns.size(); ++column) {
-          for (const auto& array : aggregation_arrays[column])
-            bucket[column]->add(*array->Slice(offset, length));
-        }
-      }
-    };
-    // A key view used to determine the bucket for the current row.
-    auto reusable_key_view = group_by_key_view{};
-    reusable_key_view.resize(group_by_columns.size(), {});
-    // Helper lambda for finding a bucket, or creating a new one lazily.
-    const auto find_or_create_bucket = [&](int row) -> bucket* {
-      for (size_t column = 0; column < group_by_columns.size(); ++column)
-        reusable_key_view[column] = value_at(group_by_columns[column].type,
-                                             *group_by_arrays[column], row);
-      if (auto bucket = buckets.find(reusable_key_view);
-          bucket != buckets.end())
-        return bucket.value().get();
-      auto new_bucket = std::make_shared<bucket>();
-      new_bucket->reserve(aggregation_columns.size());
-      for (const auto& column : aggregation_columns) {
-        auto function
-          = plugins::find<aggregation_function_plugin>(column.function_name)
-              ->make_aggregation_function(column.input_type);
-        // We check whether it's possible to create the aggregation function for
-        // the column's input type ahead of time, so there's no need to check
-        // again here.
-        VAST_ASSERT(function);
-        new_bucket->push_back(std::move(*function));
-      }
-      auto [it, inserted] = buckets.emplace(materialize(reusable_key_view),
-                                            std::move(new_bucket));
-      VAST_ASSERT(inserted);
-      return it.value().get();
-    };
-    // Iterate over all rows of the batch, and determine a sliding window of
-    // rows beloging to the same batch as large as possible, and then update the
-    // corresponding bucket.
-    auto first_row = 0;
-    auto* first_bucket = find_or_create_bucket(first_row);
-    VAST_ASSERT(batch->num_rows() > 0);
-    for (auto row = 1; row < batch->num_rows(); ++row) {
-      auto* bucket = find_or_create_bucket(row);
-      if (bucket == first_bucket)
+    const auto group_ids = groups->assign(group_by_arrays, batch->num_rows());
+    for (size_t column = 0; column < accumulators.size(); ++column)
+      accumulators[column]->add(aggregation_arrays[column], group_ids,
+                                groups->size());
+  }
+
+  /// @returns The approximate number of bytes that the groups occupy.
+  [[nodiscard]] size_t memusage() const {
+    auto result = groups->memusage();
+    for (const auto& accumulator : accumulators)
+      result += accumulator->memusage();
+    return result;
+  }
+
+  /// @returns Whether the groups can move out of memory, which requires all
+  /// aggregation functions to support partial aggregation.
+  [[nodiscard]] bool can_spill() const noexcept {
+    return mode == aggregation_mode::partial || spillable;
+  }
+
+  /// Moves the groups out of memory. Partial aggregations finish their groups
+  /// early instead of spilling them, since merging the partial results
+  /// combines the groups anyway.
+  /// @param statistics The counters to update.
+  /// @pre `can_spill()`
+  caf::error spill(spill_statistics& statistics) {
+    VAST_ASSERT(can_spill());
+    if (groups->size() == 0)
+      return {};
+    if (mode == aggregation_mode::partial) {
+      auto batch = finish_groups(output_schema, true);
+      reset();
+      if (!batch)
+        return batch.error();
+      flushed.emplace_back(std::move(*batch), output_schema);
+      return {};
+    }
+    auto batch = finish_groups(state_schema, true);
+    if (!batch)
+      return batch.error();
+    // We partition by the upper bits of the digests, as the group table uses
+    // the lower bits.
+    auto partition_rows = std::vector<std::vector<uint32_t>>(spill_partitions);
+    const auto digests = groups->digests();
+    for (size_t group = 0; group < digests.size(); ++group)
+      partition_rows[digests[group] >> (64 - spill_partition_bits)].push_back(
+        detail::narrow_cast<uint32_t>(group));
+    reset();
+    spill_files.resize(spill_partitions);
+    auto err = std::error_code{};
+    const auto directory
+      = spill_config.spill_directory.empty()
+          ? std::filesystem::temp_directory_path(err)
+          : std::filesystem::path{spill_config.spill_directory};
+    if (err)
+      return caf::make_error(ec::filesystem_error,
+                             fmt::format("failed to locate the temporary "
+                                         "directory: {}",
+                                         err.message()));
+    for (size_t partition = 0; partition < spill_partitions; ++partition) {
+      const auto& rows = partition_rows[partition];
+      if (rows.empty())
         continue;
-      update_bucket(*first_bucket, first_row, row - first_row);
-      first_row = row;
-      first_bucket = bucket;
+      auto indices_builder = arrow::UInt32Builder{};
+      auto status = indices_builder.AppendValues(rows);
+      auto indices = std::shared_ptr<arrow::Array>{};
+      if (status.ok())
+        status = indices_builder.Finish(&indices);
+      if (!status.ok())
+        return caf::make_error(ec::system_error,
+                               fmt::format("failed to partition groups: {}",
+                                           status.ToString()));
+      auto partition_batch = arrow::compute::Take(*batch, indices);
+      if (!partition_batch.ok())
+        return caf::make_error(
+          ec::system_error, fmt::format("failed to partition groups: {}",
+                                        partition_batch.status().ToString()));
+      auto bytes = spill_files[partition].write(
+        *partition_batch->record_batch(), directory);
+      if (!bytes)
+        return bytes.error();
+      statistics.bytes += *bytes;
     }
-    update_bucket(*first_bucket, first_row,
-                  detail::narrow_cast<int>(batch->num_rows()) - first_row);
+    ++statistics.passes;
+    return {};
   }
 
-  /// Finish the buckets into a new batch.
-  [[nodiscard]] caf::expected<table_slice> finish() {
-    VAST_ASSERT(output_schema);
-    auto builder = caf::get<record_type>(output_schema)
-                     .make_arrow_builder(arrow::default_memory_pool());
+  /// Finish the groups into new batches. Unless the aggregation spilled, the
+  /// result is a single batch with one row per group in the order in which
+  /// the groups first occurred.
+  /// @param statistics The counters to update.
+  [[nodiscard]] caf::expected<std::vector<table_slice>>
+  finish(spill_statistics& statistics) {
+    auto result = std::exchange(flushed, {});
+    if (spill_files.empty()) {
+      auto batch
+        = finish_groups(output_schema, mode == aggregation_mode::partial);
+      reset();
+      if (!batch)
+        return batch.error();
+      result.emplace_back(std::move(*batch), output_schema);
+      return result;
+    }
+    if (auto err = spill(statistics))
+      return err;
+    // The second pass merges the partial results of every partition, without
+    // spilling again.
+    auto merge_config = config;
+    merge_config.mode = aggregation_mode::merge;
+    auto merge_spill_config = spill_config;
+    merge_spill_config.memory_budget = 0;
+    auto merge = make(state_schema, merge_config, merge_spill_config);
+    if (!merge)
+      return merge.error();
+    auto files = std::exchange(spill_files, {});
+    for (auto& file : files) {
+      if (file.empty())
+        continue;
+      auto err = file.read([&](std::shared_ptr<arrow::RecordBatch> batch) {
+        if (batch->num_rows() > 0)
+          merge->add(batch);
+      });
+      if (err)
+        return err;
+      file = spill_file{};
+      auto merged = merge->finish(statistics);
+      if (!merged)
+        return merged.error();
+      for (auto& slice : *merged)
+        if (slice.rows() > 0)
+          result.push_back(std::move(slice));
+      ++statistics.partitions;
+    }
+    return result;
+  }
+
+private:
+  /// The number of bits of the digests that select the spill partition.
+  static constexpr auto spill_partition_bits = 6;
+
+  /// The number of spill partitions.
+  static constexpr auto spill_partitions = size_t{1} << spill_partition_bits;
+
+  /// Discards all groups.
+  void reset() {
+    groups = std::make_unique<group_table>(group_by_columns);
+    accumulators.clear();
+    accumulators.reserve(aggregation_columns.size());
+    for (const auto& column : aggregation_columns)
+      accumulators.push_back(make_accumulator(column, mode));
+  }
+
+  /// Finish the groups into a new batch without discarding them.
+  /// @param schema The schema of the batch.
+  /// @param save Whether to finish the partial aggregation state instead of
+  /// the results.
+  [[nodiscard]] caf::expected<std::shared_ptr<arrow::RecordBatch>>
+  finish_groups(const type& schema, bool save) {
+    VAST_ASSERT(schema);
+    auto builder = caf::get<record_type>(schema).make_arrow_builder(
+      arrow::default_memory_pool());
     VAST_ASSERT(builder);
-    const auto num_rows = detail::narrow_cast<int>(buckets.size());
-    const auto reserve_status = builder->Reserve(num_rows);
-    if (!reserve_status.ok())
+    const auto num_rows = detail::narrow_cast<int64_t>(groups->size());
+    if (auto status = builder->AppendValues(num_rows, nullptr); !status.ok())
       return caf::make_error(ec::system_error,
-                             fmt::format("failed to reserve: {}",
-                                         reserve_status.ToString()));
-    for (auto [key, bucket] : std::exchange(buckets, {})) {
-      const auto append_row_status = builder->Append();
-      if (!append_row_status.ok())
+                             fmt::format("failed to append rows: {}",
+                                         status.ToString()));
+    for (size_t column = 0; column < group_by_columns.size(); ++column) {
+      const auto status = groups->finish(
+        column, *builder->field_builder(detail::narrow_cast<int>(column)));
+      if (!status.ok())
         return caf::make_error(ec::system_error,
-                               fmt::format("failed to append row: {}",
-                                           append_row_status.ToString()));
-      for (size_t column = 0; column < key.size(); ++column) {
-        const auto append_status = append_builder(
-          group_by_columns[column].type,
-          *builder->field_builder(detail::narrow_cast<int>(column)),
-          make_data_view(key[column]));
-        if (!append_status.ok())
-          return caf::make_error(ec::system_error,
-                                 fmt::format("failed to append grouped {}: {}",
-                                             key[column],
-                                             append_status.ToString()));
-      }
-      for (size_t column = 0; column < bucket->size(); ++column) {
-        auto value = std::move(*(*bucket)[column]).finish();
-        if (!value)
-          return value.error();
-        const auto append_status
-          = append_builder(aggregation_columns[column].output_type,
-                           *builder->field_builder(
-                             detail::narrow_cast<int>(key.size() + column)),
-                           make_data_view(*value));
-        if (!append_status.ok())
-          return caf::make_error(
-            ec::system_error, fmt::format("failed to append aggregated {}: {}",
-                                          *value, append_status.ToString()));
-      }
+                               fmt::format("failed to append grouped {}: {}",
+                                           group_by_columns[column].name,
+                                           status.ToString()));
+    }
+    for (size_t column = 0; column < accumulators.size(); ++column) {
+      auto& field_builder = *builder->field_builder(
+        detail::narrow_cast<int>(group_by_columns.size() + column));
+      auto err = save ? accumulators[column]->save(field_builder)
+                      : accumulators[column]->finish(field_builder);
+      if (err)
+        return err;
     }
     auto array = builder->Finish();
     if (!array.ok())
       return caf::make_error(ec::system_error,
                              fmt::format("failed to finish: {}",
                                          array.status().ToString()));
-    auto batch = arrow::RecordBatch::Make(
-      output_schema.to_arrow_schema(), num_rows,
+    return arrow::RecordBatch::Make(
+      schema.to_arrow_schema(), num_rows,
       caf::get<type_to_arrow_array_t<record_type>>(*array.MoveValueUnsafe())
         .fields());
-    return table_slice{batch, output_schema};
   }
 
-private:
   /// Read the input arrays for the configured group-by columns.
   /// @param batch The record batch to extract from.
   arrow::ArrayVector
@@ -640,13 +1863,275 @@ private:
   /// The configured and bound aggregation columns.
   std::vector<aggregation_column> aggregation_columns = {};
 
+  /// The configuration of the aggregation.
+  configuration config = {};
+
+  /// The configuration of the memory budget and spilling.
+  spill_configuration spill_config = {};
+
+  /// Whether to aggregate fully, partially, or to merge partial results.
+  aggregation_mode mode = aggregation_mode::full;
+
   /// The output schema.
   type output_schema = {};
 
-  /// The buckets for the ongoing aggregation.
-  tsl::robin_map<group_by_key, std::shared_ptr<bucket>, group_by_key_hash,
-                 group_by_key_equal>
-    buckets = {};
+  /// The schema of the partial aggregation state.
+  type state_schema = {};
+
+  /// Whether all aggregation functions support partial aggregation.
+  bool spillable = false;
+
+  /// Partial results that a partial aggregation finished early.
+  std::vector<table_slice> flushed = {};
+
+  /// The spill files for every partition, if the groups spilled.
+  std::vector<spill_file> spill_files = {};
+
+  /// The groups of the ongoing aggregation.
+  std::unique_ptr<group_table> groups = {};
+
+  /// The aggregation state for every aggregation column.
+  std::vector<std::unique_ptr<accumulator>> accumulators = {};
+};
+
+/// An aggregation of a single schema in time windows. Every window aggregates
+/// the rows whose time falls into it separately, and finishes as soon as the
+/// watermark passes its end, i.e., when no more input can fall into it.
+///
+/// The watermark trails the latest time seen by the allowed lateness. Rows
+/// that fall only into windows that already closed are late and dropped.
+class windowed_aggregation {
+public:
+  /// Create a windowed aggregation by binding the summarize pipeline operator
+  /// configuration to a given schema.
+  /// @pre `config.window`
+  [[nodiscard]] static caf::expected<windowed_aggregation>
+  make(const type& schema, const configuration& config,
+       const spill_configuration& spill_config) noexcept {
+    VAST_ASSERT(config.window);
+    auto result = windowed_aggregation{};
+    const auto& schema_rt = caf::get<record_type>(schema);
+    for (auto offset :
+         schema_rt.resolve_key_suffix(config.window->field, schema.name())) {
+      if (!caf::holds_alternative<time_type>(schema_rt.field(offset).type))
+        continue;
+      if (result.time_column)
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("window field {} is ambiguous for "
+                                           "schema {}",
+                                           config.window->field, schema));
+      result.time_column = std::move(offset);
+    }
+    if (!result.time_column)
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("window field {} did not resolve to "
+                                         "a time column for schema {}",
+                                         config.window->field, schema));
+    // Binding the configuration eagerly rejects schemas that the windows
+    // cannot aggregate before they receive any input.
+    if (auto probe = aggregation::make(schema, config, spill_config); !probe)
+      return probe.error();
+    result.schema = schema;
+    result.config = config;
+    result.spill_config = spill_config;
+    return result;
+  }
+
+  /// Aggregate a batch into the windows that its rows fall into.
+  /// @param batch The record batch to aggregate. Must exactly match the
+  /// configured schema.
+  caf::error add(const std::shared_ptr<arrow::RecordBatch>& batch) {
+    VAST_ASSERT(batch);
+    const auto& window = *config.window;
+    const auto times_array
+      = static_cast<arrow::FieldPath>(*time_column).Get(*batch).ValueOrDie();
+    const auto& times
+      = caf::get<type_to_arrow_array_t<time_type>>(*times_array);
+    auto window_rows = std::map<time, std::vector<uint32_t>>{};
+    auto max_time = std::optional<time>{};
+    for (int64_t row = 0; row < times.length(); ++row) {
+      if (times.IsNull(row))
+        continue;
+      const auto t = value_at(time_type{}, times, row);
+      if (!max_time || t > *max_time)
+        max_time = t;
+      // The row falls into all windows that start after t - size, up to the
+      // latest window that starts at or before t. Earlier windows close
+      // first, so the row is late if its latest window closed already.
+      auto late = true;
+      for (auto start = floor(t, window.slide); start + window.size > t;
+           start -= window.slide) {
+        if (is_closed(start))
+          break;
+        window_rows[start].push_back(detail::narrow_cast<uint32_t>(row));
+        late = false;
+      }
+      if (late)
+        ++late_rows;
+    }
+    for (auto& [start, rows] : window_rows) {
+      auto it = windows.find(start);
+      if (it == windows.end()) {
+        auto aggregation = aggregation::make(schema, config, spill_config);
+        if (!aggregation)
+          return aggregation.error();
+        it = windows.emplace(start, std::move(*aggregation)).first;
+      }
+      if (detail::narrow_cast<int64_t>(rows.size()) == batch->num_rows()) {
+        it->second.add(batch);
+        continue;
+      }
+      auto indices_builder = arrow::UInt32Builder{};
+      auto status = indices_builder.AppendValues(rows);
+      auto indices = std::shared_ptr<arrow::Array>{};
+      if (status.ok())
+        status = indices_builder.Finish(&indices);
+      if (!status.ok())
+        return caf::make_error(ec::system_error,
+                               fmt::format("failed to assign rows to "
+                                           "windows: {}",
+                                           status.ToString()));
+      auto window_batch = arrow::compute::Take(batch, indices);
+      if (!window_batch.ok())
+        return caf::make_error(
+          ec::system_error, fmt::format("failed to assign rows to windows: {}",
+                                        window_batch.status().ToString()));
+      it->second.add(window_batch->record_batch());
+    }
+    if (max_time) {
+      const auto candidate = *max_time - window.allowed_lateness;
+      if (!watermark || candidate > *watermark)
+        watermark = candidate;
+    }
+    return {};
+  }
+
+  /// @returns The approximate number of bytes that the groups of all open
+  /// windows occupy.
+  [[nodiscard]] size_t memusage() const {
+    auto result = size_t{0};
+    for (const auto& [start, aggregation] : windows)
+      result += aggregation.memusage();
+    return result;
+  }
+
+  /// @returns Whether the groups can move out of memory.
+  [[nodiscard]] bool can_spill() const noexcept {
+    return std::all_of(windows.begin(), windows.end(), [](const auto& entry) {
+      return entry.second.can_spill();
+    });
+  }
+
+  /// Moves the groups of all open windows out of memory.
+  /// @param statistics The counters to update.
+  /// @pre `can_spill()`
+  caf::error spill(spill_statistics& statistics) {
+    for (auto& [start, aggregation] : windows)
+      if (auto err = aggregation.spill(statistics))
+        return err;
+    return {};
+  }
+
+  /// Finish all windows that closed, in the order of their start, and keep
+  /// the open windows. The results begin with the `window_start` and
+  /// `window_end` columns, followed by the columns of the aggregation.
+  /// @param statistics The counters to update.
+  /// @param all Whether to finish the open windows as well, which happens
+  /// at the end of the stream.
+  [[nodiscard]] caf::expected<std::vector<table_slice>>
+  finish(spill_statistics& statistics, bool all) {
+    auto result = std::vector<table_slice>{};
+    while (!windows.empty() && (all || is_closed(windows.begin()->first))) {
+      auto node = windows.extract(windows.begin());
+      const auto start = node.key();
+      auto slices = node.mapped().finish(statistics);
+      if (!slices)
+        return slices.error();
+      for (auto& slice : *slices) {
+        if (slice.rows() == 0)
+          continue;
+        auto windowed_slice = add_window_columns(
+          slice, start, start + config.window->size);
+        if (!windowed_slice)
+          return windowed_slice.error();
+        result.push_back(std::move(*windowed_slice));
+      }
+    }
+    return result;
+  }
+
+  /// Retrieves and resets the number of dropped late rows.
+  uint64_t take_late_rows() noexcept {
+    return std::exchange(late_rows, 0);
+  }
+
+private:
+  /// Rounds a point in time down to a multiple of a duration since the epoch.
+  static time floor(time t, duration multiple) noexcept {
+    auto remainder = t.time_since_epoch() % multiple;
+    if (remainder < duration::zero())
+      remainder += multiple;
+    return t - remainder;
+  }
+
+  /// @returns Whether the window with the given start closed.
+  [[nodiscard]] bool is_closed(time start) const noexcept {
+    return watermark && start + config.window->size <= *watermark;
+  }
+
+  /// Prepends the bounds of a window to the results of its aggregation.
+  static caf::expected<table_slice>
+  add_window_columns(const table_slice& slice, time start, time end) {
+    const auto& slice_schema = caf::get<record_type>(slice.schema());
+    auto fields = std::vector<record_type::field_view>{};
+    fields.reserve(slice_schema.num_fields() + 2);
+    fields.emplace_back("window_start", time_type{});
+    fields.emplace_back("window_end", time_type{});
+    for (auto&& field : slice_schema.fields())
+      fields.push_back(field);
+    auto schema = type{slice.schema().name(), record_type{fields}};
+    const auto batch = to_record_batch(slice);
+    auto columns = arrow::ArrayVector{};
+    columns.reserve(fields.size());
+    for (const auto bound : {start, end}) {
+      auto column = arrow::MakeArrayFromScalar(
+        arrow::TimestampScalar{bound.time_since_epoch().count(),
+                               time_type::to_arrow_type()},
+        batch->num_rows());
+      if (!column.ok())
+        return caf::make_error(ec::system_error,
+                               fmt::format("failed to add window bounds: {}",
+                                           column.status().ToString()));
+      columns.push_back(column.MoveValueUnsafe());
+    }
+    columns.insert(columns.end(), batch->columns().begin(),
+                   batch->columns().end());
+    return table_slice{arrow::RecordBatch::Make(schema.to_arrow_schema(),
+                                                batch->num_rows(),
+                                                std::move(columns)),
+                       schema};
+  }
+
+  /// The schema of the input.
+  type schema = {};
+
+  /// The configuration of the aggregation.
+  configuration config = {};
+
+  /// The configuration of the memory budget and spilling.
+  spill_configuration spill_config = {};
+
+  /// The offset of the time column that assigns rows to windows.
+  std::optional<offset> time_column = {};
+
+  /// The latest time seen minus the allowed lateness, if any rows arrived.
+  std::optional<time> watermark = {};
+
+  /// The open windows by their start.
+  std::map<time, aggregation> windows = {};
+
+  /// The number of dropped late rows since the last report.
+  uint64_t late_rows = 0;
 };
 
 /// The summarize pipeline operator implementation.
@@ -654,8 +2139,10 @@ class summarize_operator : public pipeline_operator {
 public:
   /// Creates a pipeline operator from its configuration.
   /// @param config The parsed configuration of the summarize operator.
-  explicit summarize_operator(configuration config) noexcept
-    : config_{std::move(config)} {
+  /// @param spill_config The configuration of the memory budget.
+  summarize_operator(configuration config,
+                     spill_configuration spill_config) noexcept
+    : config_{std::move(config)}, spill_config_{std::move(spill_config)} {
     // nop
   }
 
@@ -666,15 +2153,57 @@ private:
     return true;
   }
 
+  /// Signal that the summarize operator emits the results of its windows as
+  /// they close, if configured with windows.
+  [[nodiscard]] bool is_incremental() const override {
+    return config_.window.has_value();
+  }
+
+  /// Splits the operator into a partial aggregation and a merge of the
+  /// partial results, which requires all of its aggregation functions to
+  /// support partial aggregation.
+  [[nodiscard]] std::optional<pipeline_operator_definition>
+  split_partial() override {
+    VAST_ASSERT(aggregations_.empty());
+    VAST_ASSERT(blacklist_.empty());
+    if (config_.mode != aggregation_mode::full || config_.window)
+      return std::nullopt;
+    for (const auto& aggregation : config_.aggregations) {
+      const auto* plugin = plugins::find<aggregation_function_plugin>(
+        aggregation.function_name);
+      if (!plugin || !plugin->supports_partial_aggregation())
+        return std::nullopt;
+    }
+    auto partial = config_;
+    partial.mode = aggregation_mode::partial;
+    config_.mode = aggregation_mode::merge;
+    return pipeline_operator_definition{
+      .name = "summarize",
+      .options = partial.to_record(),
+    };
+  }
+
   /// Adds a batch to the operator, which effectively calls the corresponding
   /// add for the lazily created aggregation for the schema.
   [[nodiscard]] caf::error add(table_slice slice) override {
+    if (config_.window)
+      return add(windowed_aggregations_, std::move(slice));
+    return add(aggregations_, std::move(slice));
+  }
+
+  /// Adds a batch to the lazily created aggregation for its schema.
+  /// @param aggregations The aggregations by schema.
+  /// @param slice The batch to add.
+  template <class Aggregation>
+  caf::error add(std::unordered_map<type, Aggregation>& aggregations,
+                 table_slice slice) {
     // Try to find whether we have an aggregation already for the schema to
     // forward the batch to it.
-    if (auto aggregation = aggregations_.find(slice.schema());
-        aggregation != aggregations_.end()) {
-      aggregation->second.add(to_record_batch(slice));
-      return {};
+    if (auto aggregation = aggregations.find(slice.schema());
+        aggregation != aggregations.end()) {
+      if (auto err = add_batch(aggregation->second, to_record_batch(slice)))
+        return err;
+      return enforce_memory_budget();
     }
     // Note: We intentionally decouple the lifetime of the type's underlying
     // chunk here in order to make sure that no data is held alive for the
@@ -687,7 +2216,8 @@ private:
       return {};
     }
     // We didn't have one, so we create a new one for this schema.
-    auto aggregation = aggregation::make(decoupled_schema, config_);
+    auto aggregation
+      = Aggregation::make(decoupled_schema, config_, spill_config_);
     if (!aggregation) {
       VAST_WARN("summarize operator does not apply to schema {} and leaves "
                 "events unchanged: {}",
@@ -696,27 +2226,137 @@ private:
                          std::vector{std::move(slice)});
       return {};
     }
-    auto [it, inserted] = aggregations_.emplace(std::move(decoupled_schema),
-                                                std::move(*aggregation));
+    auto [it, inserted] = aggregations.emplace(std::move(decoupled_schema),
+                                               std::move(*aggregation));
     VAST_ASSERT(inserted);
-    it->second.add(to_record_batch(slice));
+    if (auto err = add_batch(it->second, to_record_batch(slice)))
+      return err;
+    return enforce_memory_budget();
+  }
+
+  /// Adds a batch to an aggregation.
+  static caf::error
+  add_batch(aggregation& aggregation,
+            const std::shared_ptr<arrow::RecordBatch>& batch) {
+    aggregation.add(batch);
     return {};
   }
 
-  /// Retrieves the results of all configured aggregations.
+  /// Adds a batch to a windowed aggregation.
+  static caf::error
+  add_batch(windowed_aggregation& aggregation,
+            const std::shared_ptr<arrow::RecordBatch>& batch) {
+    return aggregation.add(batch);
+  }
+
+  /// Moves the groups of all aggregations that can spill out of memory if
+  /// they exceed the memory budget together. Aggregations that cannot spill
+  /// do not count towards the budget, as spilling the others again and again
+  /// would not bring the memory usage below the budget.
+  caf::error enforce_memory_budget() {
+    if (spill_config_.memory_budget == 0)
+      return {};
+    auto spillable_memusage = size_t{0};
+    auto memusage = size_t{0};
+    const auto measure = [&](const auto& aggregations) {
+      for (const auto& [schema, aggregation] : aggregations) {
+        const auto aggregation_memusage = aggregation.memusage();
+        memusage += aggregation_memusage;
+        if (aggregation.can_spill())
+          spillable_memusage += aggregation_memusage;
+      }
+    };
+    measure(aggregations_);
+    measure(windowed_aggregations_);
+    if (memusage > spill_config_.memory_budget && !warned_budget_
+        && memusage > spillable_memusage) {
+      warn_unspillable(aggregations_);
+      warn_unspillable(windowed_aggregations_);
+      warned_budget_ = true;
+    }
+    if (spillable_memusage <= spill_config_.memory_budget)
+      return {};
+    if (auto err = spill(aggregations_))
+      return err;
+    return spill(windowed_aggregations_);
+  }
+
+  /// Warns about all aggregations that cannot spill.
+  /// @param aggregations The aggregations by schema.
+  template <class Aggregation>
+  void warn_unspillable(
+    const std::unordered_map<type, Aggregation>& aggregations) const {
+    for (const auto& [schema, aggregation] : aggregations)
+      if (!aggregation.can_spill())
+        VAST_WARN("summarize operator exceeds its memory budget of {} "
+                  "bytes for schema {}, but cannot spill to disk because "
+                  "not all of its aggregation functions support partial "
+                  "aggregation",
+                  spill_config_.memory_budget, schema);
+  }
+
+  /// Moves the groups of all aggregations out of memory that can spill.
+  /// @param aggregations The aggregations by schema.
+  template <class Aggregation>
+  caf::error spill(std::unordered_map<type, Aggregation>& aggregations) {
+    for (auto& [schema, aggregation] : aggregations)
+      if (aggregation.can_spill())
+        if (auto err = aggregation.spill(statistics_))
+          return err;
+    return {};
+  }
+
+  /// Retrieves the results of all configured aggregations. Windowed
+  /// aggregations only yield the results of the windows that closed, and keep
+  /// aggregating into the open windows until the stream ends.
   [[nodiscard]] caf::expected<std::vector<table_slice>> finish() override {
     auto result = std::vector<table_slice>{};
     result.reserve(aggregations_.size());
     for (auto& [schema, aggregation] : aggregations_) {
-      auto batch = aggregation.finish();
-      if (!batch)
-        return batch.error();
-      result.push_back(std::move(*batch));
+      auto batches = aggregation.finish(statistics_);
+      if (!batches)
+        return batches.error();
+      result.insert(result.end(), std::make_move_iterator(batches->begin()),
+                    std::make_move_iterator(batches->end()));
+    }
+    for (auto& [schema, aggregation] : windowed_aggregations_) {
+      auto batches = aggregation.finish(statistics_, ended_);
+      if (!batches)
+        return batches.error();
+      result.insert(result.end(), std::make_move_iterator(batches->begin()),
+                    std::make_move_iterator(batches->end()));
     }
     for (auto& [schema, batches] : blacklist_) {
       result.reserve(result.size() + batches.size());
       result.insert(result.end(), std::make_move_iterator(batches.begin()),
                     std::make_move_iterator(batches.end()));
+      batches.clear();
+    }
+    return result;
+  }
+
+  /// Makes windowed aggregations yield the results of their open windows,
+  /// which would otherwise never close.
+  void end_stream() override {
+    ended_ = true;
+  }
+
+  /// Reports the spilled bytes and the number of passes, if the operator
+  /// spilled to disk, and the number of late events that windowed
+  /// aggregations dropped.
+  [[nodiscard]] std::vector<system::data_point> take_metrics() override {
+    auto result = std::vector<system::data_point>{};
+    const auto statistics = std::exchange(statistics_, {});
+    if (statistics.passes > 0) {
+      result.push_back({"summarize.spill.bytes", statistics.bytes});
+      result.push_back({"summarize.spill.passes", statistics.passes});
+      result.push_back({"summarize.spill.partitions", statistics.partitions});
+    }
+    if (config_.window) {
+      auto late_rows = uint64_t{0};
+      for (auto& [schema, aggregation] : windowed_aggregations_)
+        late_rows += aggregation.take_late_rows();
+      result.push_back({"summarize.window.late", late_rows});
     }
     return result;
   }
@@ -724,19 +2364,73 @@ private:
   /// The underlying configuration of the summary transformation.
   configuration config_ = {};
 
+  /// The configuration of the memory budget and spilling.
+  spill_configuration spill_config_ = {};
+
+  /// The counters for spilling since the last report.
+  spill_statistics statistics_ = {};
+
+  /// Whether the operator warned about aggregations that exceed the memory
+  /// budget but cannot spill.
+  bool warned_budget_ = false;
+
+  /// Whether the stream ended, after which windowed aggregations yield the
+  /// results of their open windows as well.
+  bool ended_ = false;
+
   /// The currently in-progress aggregations.
   std::unordered_map<type, aggregation> aggregations_ = {};
 
+  /// The currently in-progress windowed aggregations.
+  std::unordered_map<type, windowed_aggregation> windowed_aggregations_ = {};
+
   /// Batches that do not apply to any aggregation.
   std::unordered_map<type, std::vector<table_slice>> blacklist_ = {};
 };
 
+/// Overrides the plugin configuration of the memory budget with the options
+/// of an individual operator, and removes them from the options.
+/// @param config The options of the summarize pipeline operator.
+/// @param spill_config The plugin configuration of the memory budget.
+caf::expected<spill_configuration>
+make_spill_configuration(record& config, spill_configuration spill_config) {
+  if (auto it = config.find("memory-budget"); it != config.end()) {
+    const auto* memory_budget = caf::get_if<uint64_t>(&it->second);
+    if (!memory_budget)
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("unexpected config key: "
+                                         "memory-budget {} is not an unsigned "
+                                         "integer",
+                                         it->second));
+    spill_config.memory_budget = *memory_budget;
+    config.erase(it);
+  }
+  if (auto it = config.find("spill-directory"); it != config.end()) {
+    const auto* spill_directory = caf::get_if<std::string>(&it->second);
+    if (!spill_directory)
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("unexpected config key: "
+                                         "spill-directory {} is not a string",
+                                         it->second));
+    spill_config.spill_directory = *spill_directory;
+    config.erase(it);
+  }
+  return spill_config;
+}
+
 caf::expected<std::unique_ptr<pipeline_operator>>
-make_summarize_operator(const record& config) {
-  auto parsed_config = configuration::make(config);
+make_summarize_operator(const record& config,
+                        const spill_configuration& spill_config) {
+  auto operator_config = config;
+  auto operator_spill_config
+    = make_spill_configuration(operator_config, spill_config);
+  if (!operator_spill_config)
+    return operator_spill_config.error();
+  auto parsed_config = configuration::make(operator_config);
   if (!parsed_config)
     return parsed_config.error();
-  return std::make_unique<summarize_operator>(std::move(*parsed_config));
+  return std::make_unique<summarize_operator>(
+    std::move(*parsed_config), std::move(*operator_spill_config));
 }
 
 std::vector<std::string>
@@ -755,7 +2449,8 @@ get_keys_from_legacy_sections(const data& legacy_section) {
 /// change legacy config into newer format
 caf::expected<std::unique_ptr<pipeline_operator>>
 try_handle_deprecations(const record& config,
-                        const std::vector<std::string>& sections_to_reformat) {
+                        const std::vector<std::string>& sections_to_reformat,
+                        const spill_configuration& spill_config) {
   auto new_config = config;
   auto aggregate = record{};
   for (const auto& section : sections_to_reformat) {
@@ -776,16 +2471,16 @@ try_handle_deprecations(const record& config,
     new_config.erase(section);
   }
   new_config.emplace("aggregate", std::move(aggregate));
-  return make_summarize_operator(new_config);
+  return make_summarize_operator(new_config, spill_config);
 }
 
 /// The summarize pipeline operator plugin.
 class plugin final : public virtual pipeline_operator_plugin {
 public:
-  caf::error initialize([[maybe_unused]] data config) override {
-    // Native plugins never have any plugin-specific configuration, so there's
-    // nothing to do here.
-    return {};
+  caf::error initialize(data options) override {
+    if (caf::holds_alternative<caf::none_t>(options))
+      return caf::none;
+    return convert(options, spill_config_);
   }
 
   [[nodiscard]] std::string name() const override {
@@ -801,7 +2496,7 @@ public:
     }
     // new format detected. Proceed as usual
     if (sections_to_reformat.empty())
-      return make_summarize_operator(config);
+      return make_summarize_operator(config, spill_config_);
     if (config.contains("aggregate")) {
       return caf::make_error(
         ec::invalid_configuration,
@@ -811,21 +2506,21 @@ public:
                     "names",
                     fmt::join(sections_to_reformat, "', '")));
     }
-    return try_handle_deprecations(config, sections_to_reformat);
+    return try_handle_deprecations(config, sections_to_reformat,
+                                   spill_config_);
   }
 
   [[nodiscard]] std::pair<std::string_view,
                           caf::expected<std::unique_ptr<pipeline_operator>>>
   make_pipeline_operator(std::string_view pipeline) const override {
     using parsers::end_of_pipeline_operator, parsers::required_ws,
-      parsers::optional_ws, parsers::duration, parsers::extractor_list,
-      parsers::aggregation_function_list;
+      parsers::optional_ws, parsers::duration, parsers::extractor,
+      parsers::extractor_list, parsers::aggregation_function_list;
     const auto* f = pipeline.begin();
     const auto* const l = pipeline.end();
     const auto p = required_ws >> aggregation_function_list >> required_ws
                    >> ("by") >> required_ws >> extractor_list
-                   >> -(required_ws >> "resolution" >> required_ws >> duration)
-                   >> optional_ws >> end_of_pipeline_operator;
+                   >> -(required_ws >> "resolution" >> required_ws >> duration);
     std::tuple<std::vector<std::tuple<caf::optional<std::string>, std::string,
                                       std::vector<std::string>>>,
                std::vector<std::string>, std::optional<vast::duration>>
@@ -861,12 +2556,50 @@ public:
     }
     config.group_by_extractors = std::move(std::get<1>(parsed_aggregations));
     config.time_resolution = std::move(std::get<2>(parsed_aggregations));
+    // The optional window clause follows the grouping, e.g., `window ts 1 min
+    // slide 30 sec lateness 10 sec`.
+    const auto window_parser
+      = required_ws >> "window" >> required_ws >> extractor >> required_ws
+        >> duration;
+    const auto slide_parser
+      = required_ws >> "slide" >> required_ws >> duration;
+    const auto lateness_parser
+      = required_ws >> "lateness" >> required_ws >> duration;
+    auto parsed_window = std::tuple<std::string, vast::duration>{};
+    if (window_parser(f, l, parsed_window)) {
+      auto window_config = record{
+        {"field", std::move(std::get<0>(parsed_window))},
+        {"size", std::get<1>(parsed_window)},
+      };
+      auto parsed_duration = vast::duration{};
+      if (slide_parser(f, l, parsed_duration))
+        window_config.emplace("slide", parsed_duration);
+      if (lateness_parser(f, l, parsed_duration))
+        window_config.emplace("allowed-lateness", parsed_duration);
+      auto window = configuration::parse_window(window_config);
+      if (!window)
+        return {std::string_view{f, l}, std::move(window.error())};
+      config.window = std::move(*window);
+    }
+    const auto end_parser = optional_ws >> end_of_pipeline_operator;
+    if (!end_parser(f, l, unused)) {
+      return {
+        std::string_view{f, l},
+        caf::make_error(ec::syntax_error, fmt::format("failed to parse "
+                                                      "summarize "
+                                                      "operator: '{}'",
+                                                      pipeline)),
+      };
+    }
 
     return {
       std::string_view{f, l},
-      std::make_unique<summarize_operator>(std::move(config)),
+      std::make_unique<summarize_operator>(std::move(config), spill_config_),
     };
   }
+
+private:
+  spill_configuration spill_config_ = {};
 };
 
 } // namespace
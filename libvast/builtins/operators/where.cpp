@@ -47,7 +47,7 @@ struct configuration {
 };
 
 // Selects matching rows from the input.
-class where_operator : public pipeline_operator {
+class where_operator : public stateless_pipeline_operator {
 public:
   /// Constructs a *where* pipeline operator.
   /// @pre *expr* must be normalized and validated
@@ -62,31 +62,28 @@ public:
 
   /// Applies the transformation to a record batch with a corresponding vast
   /// schema.
-  [[nodiscard]] caf::error add(table_slice slice) override {
-    VAST_TRACE("where operator adds batch");
+  [[nodiscard]] caf::expected<table_slice>
+  apply(table_slice slice) const override {
+    VAST_TRACE("where operator applies to batch");
     auto tailored_expr = tailor(expr_, slice.schema());
-    if (!tailored_expr) {
-      transformed_.clear();
-      return tailored_expr.error();
-    }
+    if (!tailored_expr)
+      return std::move(tailored_expr.error());
     // TODO: Replace this with an Arrow-native filter function as soon as we are
     // able to directly evaluate expressions on a record batch.
     if (auto new_slice = filter(slice, *tailored_expr))
-      transformed_.push_back(*new_slice);
-    return caf::none;
+      return std::move(*new_slice);
+    return table_slice{};
   }
 
-  /// Retrieves the result of the transformation.
-  [[nodiscard]] caf::expected<std::vector<table_slice>> finish() override {
-    VAST_DEBUG("where operator finished transformation");
-    return std::exchange(transformed_, {});
+  /// The expression can narrow down the query directly.
+  [[nodiscard]] std::optional<pipeline_pushdown> pushdown() const override {
+    return pipeline_pushdown{
+      .filter = expr_,
+    };
   }
 
 private:
   expression expr_ = {};
-
-  /// The slices being transformed.
-  std::vector<table_slice> transformed_ = {};
 };
 
 class plugin final : public virtual pipeline_operator_plugin {
@@ -10,8 +10,10 @@
 #include <vast/chunk.hpp>
 #include <vast/concept/convertible/data.hpp>
 #include <vast/data.hpp>
+#include <vast/defaults.hpp>
 #include <vast/detail/collect.hpp>
 #include <vast/detail/generator.hpp>
+#include <vast/detail/inspection_common.hpp>
 #include <vast/detail/narrow.hpp>
 #include <vast/error.hpp>
 #include <vast/fwd.hpp>
@@ -21,9 +23,10 @@
 
 #include <arrow/io/file.h>
 #include <arrow/io/memory.h>
-#include <arrow/ipc/feather.h>
 #include <arrow/ipc/reader.h>
+#include <arrow/ipc/writer.h>
 #include <arrow/table.h>
+#include <arrow/util/compression.h>
 #include <arrow/util/iterator.h>
 #include <arrow/util/key_value_metadata.h>
 
@@ -33,23 +36,62 @@ namespace {
 
 /// Configuration for the Feather plugin.
 struct configuration {
+  /// The codec for compressing the record batches; one of "zstd", "lz4", or
+  /// "uncompressed".
+  std::string compression{"zstd"};
+
+  /// The maximum number of rows per record batch.
+  uint64_t chunk_size{defaults::import::table_slice_size};
+
   int64_t zstd_compression_level{
     arrow::util::Codec::DefaultCompressionLevel(arrow::Compression::ZSTD)
       .ValueOrDie()};
 
   template <class Inspector>
   friend auto inspect(Inspector& f, configuration& x) {
-    return f.apply(x.zstd_compression_level);
+    return detail::apply_all(f, x.compression, x.chunk_size,
+                             x.zstd_compression_level);
   }
 
   static const record_type& schema() noexcept {
     static auto result = record_type{
+      {"compression", string_type{}},
+      {"chunk-size", uint64_type{}},
       {"zstd-compression-level", int64_type{}},
     };
     return result;
   }
 };
 
+/// Creates the codec for compressing record batches.
+/// @returns The codec, or nullptr for uncompressed record batches.
+caf::expected<std::shared_ptr<arrow::util::Codec>>
+make_codec(const configuration& config) {
+  auto type = arrow::Compression::UNCOMPRESSED;
+  auto level = arrow::util::kUseDefaultCompressionLevel;
+  if (config.compression == "zstd") {
+    type = arrow::Compression::ZSTD;
+    level = detail::narrow<int>(config.zstd_compression_level);
+  } else if (config.compression == "lz4") {
+    type = arrow::Compression::LZ4_FRAME;
+  } else if (config.compression != "uncompressed") {
+    return caf::make_error(ec::invalid_configuration,
+                           fmt::format("unsupported feather compression '{}'; "
+                                       "expected 'zstd', 'lz4', or "
+                                       "'uncompressed'",
+                                       config.compression));
+  }
+  if (type == arrow::Compression::UNCOMPRESSED)
+    return std::shared_ptr<arrow::util::Codec>{};
+  auto codec = arrow::util::Codec::Create(type, level);
+  if (!codec.ok())
+    return caf::make_error(ec::invalid_configuration,
+                           fmt::format("failed to create {} codec: {}",
+                                       config.compression,
+                                       codec.status().ToString()));
+  return std::shared_ptr<arrow::util::Codec>{codec.MoveValueUnsafe()};
+}
+
 auto derive_import_time(const std::shared_ptr<arrow::Array>& time_col) {
   return value_at(time_type{}, *time_col, time_col->length() - 1);
 }
@@ -200,8 +242,9 @@ private:
 
 class active_feather_store final : public active_store {
 public:
-  explicit active_feather_store(const configuration& config)
-    : feather_config_(config) {
+  active_feather_store(std::shared_ptr<arrow::util::Codec> codec,
+                       uint64_t chunk_size)
+    : codec_{std::move(codec)}, chunk_size_{chunk_size} {
   }
 
   [[nodiscard]] caf::error add(std::vector<table_slice> new_slices) override {
@@ -230,15 +273,27 @@ public:
     if (!table.ok())
       return caf::make_error(ec::system_error, table.status().ToString());
     auto output_stream = arrow::io::BufferOutputStream::Create().ValueOrDie();
-    auto write_properties = arrow::ipc::feather::WriteProperties::Defaults();
-    // TODO: Set write_properties.chunksize to the expected batch size
-    write_properties.compression = arrow::Compression::ZSTD;
-    write_properties.compression_level
-      = detail::narrow<int>(feather_config_.zstd_compression_level);
-    const auto write_status = ::arrow::ipc::feather::WriteTable(
-      *table.ValueUnsafe(), output_stream.get(), write_properties);
-    if (!write_status.ok())
-      return caf::make_error(ec::system_error, write_status.ToString());
+    // This writes the same Arrow IPC file that arrow::ipc::feather::WriteTable
+    // produces for Feather V2, but gives us control over the IPC options. With
+    // use_threads, Arrow compresses the buffers of every record batch in
+    // parallel on its CPU thread pool, which matters for wide schemas.
+    auto write_options = arrow::ipc::IpcWriteOptions::Defaults();
+    write_options.use_threads = true;
+    write_options.unify_dictionaries = true;
+    write_options.allow_64bit = true;
+    write_options.codec = codec_;
+    auto writer = arrow::ipc::MakeFileWriter(
+      output_stream.get(), table.ValueUnsafe()->schema(), write_options);
+    if (!writer.ok())
+      return caf::make_error(ec::system_error, writer.status().ToString());
+    // Record batches never span table slices, so a chunk size that matches
+    // the table slice size keeps the slices intact.
+    if (auto status = writer.ValueUnsafe()->WriteTable(
+          *table.ValueUnsafe(), detail::narrow<int64_t>(chunk_size_));
+        !status.ok())
+      return caf::make_error(ec::system_error, status.ToString());
+    if (auto status = writer.ValueUnsafe()->Close(); !status.ok())
+      return caf::make_error(ec::system_error, status.ToString());
     auto buffer = output_stream->Finish();
     if (!buffer.ok())
       return caf::make_error(ec::system_error, buffer.status().ToString());
@@ -259,7 +314,8 @@ public:
 
 private:
   std::vector<table_slice> slices_ = {};
-  configuration feather_config_ = {};
+  std::shared_ptr<arrow::util::Codec> codec_ = {};
+  uint64_t chunk_size_ = {};
   size_t num_events_ = {};
 };
 
@@ -267,7 +323,18 @@ class plugin final : public virtual store_plugin {
   [[nodiscard]] caf::error initialize(data options) override {
     if (caf::holds_alternative<caf::none_t>(options))
       return caf::none;
-    return convert(options, feather_config_);
+    auto config = configuration{};
+    if (auto err = convert(options, config))
+      return err;
+    // We create the codec once to reject invalid options right away instead
+    // of failing whenever a partition is created.
+    if (auto codec = make_codec(config); !codec)
+      return std::move(codec.error());
+    if (config.chunk_size == 0)
+      return caf::make_error(ec::invalid_configuration,
+                             "feather chunk-size must be positive");
+    feather_config_ = std::move(config);
+    return caf::none;
   }
 
   [[nodiscard]] std::string name() const override {
@@ -281,11 +348,17 @@ class plugin final : public virtual store_plugin {
 
   [[nodiscard]] caf::expected<std::unique_ptr<active_store>>
   make_active_store(const caf::settings& vast_config) const override {
-    const auto default_compression_level
-      = arrow::util::Codec::DefaultCompressionLevel(arrow::Compression::ZSTD)
-          .ValueOrDie();
-    return std::make_unique<active_feather_store>(configuration{caf::get_or(
-      vast_config, "vast.zstd-compression-level", default_compression_level)});
+    auto config = feather_config_;
+    config.zstd_compression_level
+      = caf::get_or(vast_config, "vast.zstd-compression-level",
+                    config.zstd_compression_level);
+    // Only the compression level can be invalid here, as `initialize`
+    // validated the remaining options already.
+    auto codec = make_codec(config);
+    if (!codec)
+      return std::move(codec.error());
+    return std::make_unique<active_feather_store>(std::move(*codec),
+                                                  config.chunk_size);
   }
 
 private:
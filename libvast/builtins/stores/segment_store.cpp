@@ -13,6 +13,7 @@
 #include <vast/fbs/utils.hpp>
 #include <vast/ids.hpp>
 #include <vast/logger.hpp>
+#include <vast/pipeline.hpp>
 #include <vast/plugin.hpp>
 #include <vast/query_context.hpp>
 #include <vast/segment.hpp>
@@ -97,7 +98,7 @@ handle_lookup(Actor& self, const vast::query_context& query_context,
     }
   }
   auto handle_query = detail::overload{
-    [&](const count_query_context& count) {
+    [&](const count_query_context& count) -> caf::error {
       if (count.mode == count_query_context::estimate)
         die("logic error detected");
       for (size_t i = 0; i < slices.size(); ++i) {
@@ -107,21 +108,45 @@ handle_lookup(Actor& self, const vast::query_context& query_context,
         num_hits += result;
         self->send(count.sink, result);
       }
+      return {};
     },
-    [&](const extract_query_context& extract) {
+    [&](const extract_query_context& extract) -> caf::error {
       VAST_ASSERT(slices.size() == checkers.size());
+      // Queries that ask for pipeline operators get their results instead of
+      // the matching events.
+      auto operators = std::optional<pipeline>{};
+      if (!extract.operators.empty()) {
+        auto made = pipeline::make("segment-store", extract.operators);
+        if (!made)
+          return made.error();
+        operators = std::move(*made);
+      }
       for (size_t i = 0; i < slices.size(); ++i) {
         const auto& slice = slices[i];
         const auto& checker = checkers[i];
         auto final_slice = filter(slice, checker, ids);
         if (final_slice) {
           num_hits += final_slice->rows();
-          self->send(extract.sink, *final_slice);
+          if (!operators) {
+            self->send(extract.sink, *final_slice);
+            continue;
+          }
+          if (auto err = operators->add(std::move(*final_slice)))
+            return err;
         }
       }
+      if (operators) {
+        auto results = operators->finish();
+        if (!results)
+          return results.error();
+        for (auto& result : *results)
+          self->send(extract.sink, std::move(result));
+      }
+      return {};
     },
   };
-  caf::visit(handle_query, query_context.cmd);
+  if (auto err = caf::visit(handle_query, query_context.cmd))
+    return err;
   return num_hits;
 }
 
@@ -43,6 +43,28 @@ public:
   /// Finish the aggregation into a single materialized value.
   [[nodiscard]] virtual caf::expected<data> finish() && = 0;
 
+  /// Return the type of the partial aggregation state of the function.
+  /// @note The default implementation returns the output type. To merge
+  /// partial states, the *summarize* pipeline operator creates the function
+  /// with the state type as input type, so functions that support partial
+  /// aggregation must accept their state type as input.
+  [[nodiscard]] virtual type state_type() const;
+
+  /// Save the partial aggregation state, which allows for aggregating disjoint
+  /// subsets of the input in parallel and merging the results afterwards.
+  /// @post The result is either *nil* or matches the state type.
+  /// @note The default implementation returns an error, i.e., functions do not
+  /// support partial aggregation by default.
+  [[nodiscard]] virtual caf::expected<data> save() const;
+
+  /// Merge a partial aggregation state that another instance of the function
+  /// saved.
+  /// @param state The partial aggregation state to merge.
+  /// @pre *state* is either *nil* or matches the state type.
+  /// @note The default implementation returns an error, i.e., functions do not
+  /// support partial aggregation by default.
+  [[nodiscard]] virtual caf::error merge(const data& state);
+
 protected:
   /// Constructs the aggregation function. Must be called from implementing base
   /// classes.
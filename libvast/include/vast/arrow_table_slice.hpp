@@ -369,6 +369,21 @@ std::pair<type, std::shared_ptr<arrow::RecordBatch>> transform_columns(
   type schema, const std::shared_ptr<arrow::RecordBatch>& batch,
   const std::vector<indexed_transformation>& transformations) noexcept;
 
+/// Applies a list of transformations to an Arrow record batch whose resulting
+/// schema is known in advance. This avoids computing the same resulting schema
+/// for every batch when applying the transformations to many batches of the
+/// same schema.
+/// @param result_schema The Arrow schema that `transform_columns` returns for
+/// *schema* and *transformations*.
+/// @pre VAST schema and Arrow schema must match.
+/// @pre Transformations must be sorted by index.
+/// @pre Transformation indices must not be a subset of the following
+/// transformation's index.
+std::shared_ptr<arrow::RecordBatch> transform_columns(
+  const type& schema, const std::shared_ptr<arrow::RecordBatch>& batch,
+  const std::vector<indexed_transformation>& transformations,
+  const std::shared_ptr<arrow::Schema>& result_schema) noexcept;
+
 /// Applies a list of transformations to a table slice.
 /// @pre Transformations must be sorted by index.
 /// @pre Transformation indices must not be a subset of the following
@@ -386,6 +401,19 @@ std::pair<type, std::shared_ptr<arrow::RecordBatch>>
 select_columns(type schema, const std::shared_ptr<arrow::RecordBatch>& batch,
                const std::vector<offset>& indices) noexcept;
 
+/// Remove all unspecified columns from an Arrow record batch whose resulting
+/// schema is known in advance.
+/// @param result_schema The Arrow schema that `select_columns` returns for
+/// *schema* and *indices*.
+/// @pre VAST schema and Arrow schema must match.
+/// @pre Indices must be sorted.
+/// @pre Indices must not be a subset of the following index.
+std::shared_ptr<arrow::RecordBatch>
+select_columns(const type& schema,
+               const std::shared_ptr<arrow::RecordBatch>& batch,
+               const std::vector<offset>& indices,
+               const std::shared_ptr<arrow::Schema>& result_schema) noexcept;
+
 /// Remove all unspecified columns from a table slice.
 /// @pre Indices must be sorted.
 /// @pre Indices must not be a subset of the following index.
@@ -243,34 +243,7 @@ struct json_printer : printer_base<json_printer> {
 
   private:
     bool should_skip(view<data> x) noexcept {
-      if (options_.omit_nulls && caf::holds_alternative<caf::none_t>(x)) {
-        return true;
-      }
-      if (options_.omit_empty_lists && caf::holds_alternative<view<list>>(x)) {
-        const auto& ys = caf::get<view<list>>(x);
-        return std::all_of(ys.begin(), ys.end(),
-                           [this](const view<data>& y) noexcept {
-                             return should_skip(y);
-                           });
-      }
-      if (options_.omit_empty_maps && caf::holds_alternative<view<map>>(x)) {
-        const auto& ys = caf::get<view<map>>(x);
-        return std::all_of(
-          ys.begin(), ys.end(),
-          [this](const view<map>::view_type::value_type& y) noexcept {
-            return should_skip(y.second);
-          });
-      }
-      if (options_.omit_empty_records
-          && caf::holds_alternative<view<record>>(x)) {
-        const auto& ys = caf::get<view<record>>(x);
-        return std::all_of(
-          ys.begin(), ys.end(),
-          [this](const view<record>::view_type::value_type& y) noexcept {
-            return should_skip(y.second);
-          });
-      }
-      return false;
+      return json_printer::should_skip(x, options_);
     }
 
     void indent() noexcept {
@@ -323,7 +296,43 @@ struct json_printer : printer_base<json_printer> {
     return print(out, make_view(d));
   }
 
+  /// @returns Whether printing a record omits a field with the value *x*.
+  [[nodiscard]] bool should_skip(const view<data>& x) const noexcept {
+    return should_skip(x, options_);
+  }
+
 private:
+  static bool
+  should_skip(const view<data>& x, const options& opts) noexcept {
+    if (opts.omit_nulls && caf::holds_alternative<caf::none_t>(x)) {
+      return true;
+    }
+    if (opts.omit_empty_lists && caf::holds_alternative<view<list>>(x)) {
+      const auto& ys = caf::get<view<list>>(x);
+      return std::all_of(ys.begin(), ys.end(),
+                         [&](const view<data>& y) noexcept {
+                           return should_skip(y, opts);
+                         });
+    }
+    if (opts.omit_empty_maps && caf::holds_alternative<view<map>>(x)) {
+      const auto& ys = caf::get<view<map>>(x);
+      return std::all_of(
+        ys.begin(), ys.end(),
+        [&](const view<map>::view_type::value_type& y) noexcept {
+          return should_skip(y.second, opts);
+        });
+    }
+    if (opts.omit_empty_records && caf::holds_alternative<view<record>>(x)) {
+      const auto& ys = caf::get<view<record>>(x);
+      return std::all_of(
+        ys.begin(), ys.end(),
+        [&](const view<record>::view_type::value_type& y) noexcept {
+          return should_skip(y.second, opts);
+        });
+    }
+    return false;
+  }
+
   options options_ = {};
 };
 
@@ -33,6 +33,17 @@ namespace import {
 /// Maximum size for sources that generate table slices.
 inline constexpr size_t table_slice_size = 65'536; // 64 Ki
 
+/// Lower bound for the table slice size when adapting it to the input rate.
+inline constexpr size_t min_table_slice_size = 1'024; // 1 Ki
+
+/// Upper bound for the table slice size when adapting it to the input rate.
+inline constexpr size_t max_table_slice_size = 1'048'576; // 1 Mi
+
+/// The time it should take to fill a table slice when adapting the table slice
+/// size to the input rate.
+inline constexpr std::chrono::milliseconds batch_target_latency
+  = std::chrono::seconds{1};
+
 /// The default table slice type when arrow is available.
 inline constexpr auto table_slice_type = table_slice_encoding::arrow;
 
@@ -51,6 +62,18 @@ inline constexpr std::chrono::milliseconds read_timeout
 /// Path for reading input events or `-` for reading from STDIN.
 inline constexpr std::string_view read = "-";
 
+/// Number of datagrams that a shard of the sharded datagram source receives
+/// per system call.
+inline constexpr size_t udp_batch_size = 256;
+
+/// Maximum size of a single datagram for the sharded datagram source. Larger
+/// datagrams get truncated.
+inline constexpr size_t udp_max_datagram_size = 8'192; // 8 KiB
+
+/// Maximum number of table slices that the shards of the sharded datagram
+/// source buffer before they start dropping input.
+inline constexpr size_t udp_max_buffered_slices = 64;
+
 /// Contains settings for the csv subcommand.
 struct csv {
   static constexpr std::string_view separator = ",";
@@ -108,6 +131,17 @@ struct infer {
 
   /// Number of bytes to buffer from input.
   static constexpr size_t buffer_size = 8'192;
+
+  /// Maximum number of bytes to look at for inferring JSON.
+  static constexpr size_t max_bytes = 256 * 1'024 * 1'024;
+
+  /// The minimum estimated number of distinct values of a string field for
+  /// suggesting a hash index.
+  static constexpr uint64_t index_min_distinct = 1'000;
+
+  /// The minimum ratio of distinct values to occurrences of a string field
+  /// for suggesting a hash index.
+  static constexpr double index_min_ratio = 0.5;
 };
 
 // -- constants for the index --------------------------------------------------
@@ -181,6 +215,10 @@ inline constexpr const bool numeric_durations = false;
 /// Whether to omit null fields.
 inline constexpr const bool omit_nulls = false;
 
+/// The maximum number of bytes of a streaming response that may be on the way
+/// to the client before the export stops evaluating further partitions.
+inline constexpr const size_t max_inflight_bytes = 4 * 1024 * 1024;
+
 } // namespace export_
 
 } // namespace rest
@@ -233,6 +271,26 @@ inline constexpr size_t taste_partitions = 5;
 /// Maximum number of concurrent INDEX queries.
 inline constexpr size_t num_query_supervisors = 10;
 
+/// Lower bound for the number of partitions that a query asks the INDEX to
+/// evaluate at once.
+inline constexpr size_t min_partition_window = 1;
+
+/// Upper bound for the number of partitions that a query asks the INDEX to
+/// evaluate at once, or 0 for the number of available cores.
+inline constexpr size_t max_partition_window = 0;
+
+/// The memory budget in bytes for caching the results of queries against
+/// passive partitions, or 0 to disable the cache.
+inline constexpr size_t query_cache_size = 64 * 1'024 * 1'024; // 64 MiB
+
+/// Number of threads that apply stateless pipeline operators to batches
+/// concurrently, or 0 for one per available core.
+inline constexpr size_t pipeline_threads = 0;
+
+/// The maximum combined size in bytes of the batches that a pipeline
+/// transforms concurrently.
+inline constexpr size_t pipeline_memory_budget = 256 * 1'024 * 1'024; // 256 MiB
+
 /// The store backend to use.
 inline constexpr const char* store_backend = "feather";
 
@@ -0,0 +1,84 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vast::detail {
+
+/// A fixed set of worker threads for CPU-bound tasks that do not fit the actor
+/// model, e.g., transforming many batches of a single pipeline at once.
+///
+/// Every worker owns a queue of tasks. Tasks submitted from a worker go to the
+/// queue of that worker, and all other tasks go to the queues in round-robin
+/// order. A worker runs the oldest task of its own queue first, and steals the
+/// newest task from the queue of another worker once its own queue is empty.
+class thread_pool {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using task = std::function<void()>;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// Starts the worker threads.
+  /// @param num_threads The number of worker threads, or 0 for one per
+  ///        available core.
+  explicit thread_pool(size_t num_threads);
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+  thread_pool(thread_pool&&) = delete;
+  thread_pool& operator=(thread_pool&&) = delete;
+
+  /// Runs all remaining tasks and joins the worker threads.
+  ~thread_pool();
+
+  // -- properties -------------------------------------------------------------
+
+  /// @returns The number of worker threads.
+  [[nodiscard]] size_t size() const;
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Schedules a task for execution on one of the worker threads.
+  /// @param f The task to run. Must not throw.
+  void submit(task f);
+
+private:
+  struct queue {
+    std::mutex mutex;
+    std::deque<task> tasks;
+  };
+
+  /// The main loop of a worker thread.
+  void run(size_t index);
+
+  /// Takes a task from the queue of a worker, or steals one from another queue.
+  /// @returns Whether a task was available.
+  bool take(size_t index, task& f);
+
+  std::vector<std::unique_ptr<queue>> queues_ = {};
+  std::vector<std::thread> threads_ = {};
+  std::atomic<size_t> next_queue_ = 0;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t pending_ = 0;
+  bool stopping_ = false;
+};
+
+} // namespace vast::detail
@@ -0,0 +1,85 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include <caf/expected.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace vast::detail {
+
+/// A UDP socket that receives many datagrams per system call. On Linux, this
+/// uses `recvmmsg(2)` and reports the number of datagrams the kernel dropped
+/// because the socket's receive buffer overflowed (`SO_RXQ_OVFL`). Other
+/// platforms fall back to one `recvfrom(2)` per datagram.
+class udp_batch_receiver {
+public:
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// Binds a new receiver to a UDP port on all interfaces.
+  /// @param port The port to bind to, or 0 to pick an ephemeral port.
+  /// @param batch_size The maximum number of datagrams per call to `receive`.
+  /// @param max_datagram_size The maximum size of a single datagram; larger
+  ///        datagrams get truncated.
+  /// @param reuse_port Whether to set `SO_REUSEPORT` so that multiple
+  ///        receivers can share the same port, with the kernel distributing
+  ///        datagrams among them.
+  static caf::expected<udp_batch_receiver>
+  make(uint16_t port, size_t batch_size, size_t max_datagram_size,
+       bool reuse_port);
+
+  udp_batch_receiver(const udp_batch_receiver&) = delete;
+  udp_batch_receiver& operator=(const udp_batch_receiver&) = delete;
+  udp_batch_receiver(udp_batch_receiver&& other) noexcept;
+  udp_batch_receiver& operator=(udp_batch_receiver&& other) noexcept;
+
+  /// The destructor closes the socket.
+  ~udp_batch_receiver();
+
+  // -- properties -------------------------------------------------------------
+
+  /// Waits up to `timeout` for datagrams and receives as many as are
+  /// available, up to the batch size.
+  /// @returns The number of received datagrams, which may be 0 if the timeout
+  ///          expired.
+  caf::expected<size_t> receive(std::chrono::microseconds timeout);
+
+  /// Accesses a datagram from the last call to `receive`.
+  /// @pre `i < ` the result of the last call to `receive`.
+  [[nodiscard]] std::span<const char> datagram(size_t i) const;
+
+  /// @returns The port the socket is bound to.
+  [[nodiscard]] uint16_t port() const;
+
+  /// @returns The number of datagrams that the kernel dropped for this socket
+  ///          since it was opened.
+  [[nodiscard]] uint64_t kernel_drops() const;
+
+private:
+  udp_batch_receiver(int fd, size_t batch_size, size_t max_datagram_size);
+
+  /// Updates the kernel drop counter from the raw `SO_RXQ_OVFL` value, which
+  /// is a wrapping 32-bit counter.
+  void update_kernel_drops(uint32_t counter);
+
+  int fd_ = -1;
+  size_t batch_size_ = 0;
+  size_t max_datagram_size_ = 0;
+  std::vector<char> buffer_ = {};
+  std::vector<char> control_ = {};
+  std::vector<size_t> sizes_ = {};
+  uint32_t last_drop_counter_ = 0;
+  uint64_t kernel_drops_ = 0;
+};
+
+} // namespace vast::detail
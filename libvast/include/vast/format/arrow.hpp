@@ -19,10 +19,13 @@
 #include <arrow/io/api.h>
 #include <arrow/ipc/reader.h>
 #include <arrow/ipc/writer.h>
+#include <arrow/util/compression.h>
 #include <caf/error.hpp>
 #include <caf/expected.hpp>
 
 #include <memory>
+#include <span>
+#include <string_view>
 #include <vector>
 
 namespace vast::format::arrow {
@@ -59,6 +62,60 @@ private:
   batch_writer_ptr current_batch_writer_;
 };
 
+/// Serializes table slices into Arrow IPC streams in memory. The resulting
+/// chunks reference the buffers of the record batches rather than copying
+/// them, unless the buffers get compressed. Consecutive slices of the same
+/// schema share a stream; a change of the schema ends the current stream and
+/// starts a new one, just like the writer does.
+class ipc_chunk_writer {
+public:
+  /// Creates a writer.
+  /// @param compression The compression codec for the buffers of the record
+  ///        batches, e.g., `UNCOMPRESSED`, `LZ4_FRAME`, or `ZSTD`.
+  /// @returns The writer, or an error if the codec is not available.
+  static caf::expected<ipc_chunk_writer>
+  make(::arrow::Compression::type compression);
+
+  ipc_chunk_writer(ipc_chunk_writer&&) noexcept;
+  ipc_chunk_writer& operator=(ipc_chunk_writer&&) noexcept;
+  ~ipc_chunk_writer() noexcept;
+
+  /// Appends a table slice to the current stream.
+  caf::error write(const table_slice& slice);
+
+  /// Ends the current stream, if there is one.
+  caf::error close();
+
+  /// Retrieves the chunks that were written since the last call.
+  std::vector<chunk_ptr> take();
+
+private:
+  class output_stream;
+
+  ipc_chunk_writer();
+
+  std::unique_ptr<output_stream> out_;
+  ::arrow::ipc::IpcWriteOptions options_;
+  type schema_;
+  std::shared_ptr<::arrow::ipc::RecordBatchWriter> batch_writer_;
+};
+
+/// Serializes table slices into Arrow IPC streams at once.
+/// @param slices The table slices to serialize.
+/// @param compression The compression codec for the buffers of the record
+///        batches.
+/// @returns The serialized streams, or an error.
+/// @relates ipc_chunk_writer
+caf::expected<std::vector<chunk_ptr>>
+to_ipc_streams(std::span<const table_slice> slices,
+               ::arrow::Compression::type compression);
+
+/// Parses the name of a buffer compression for Arrow IPC streams.
+/// @param name One of `none`, `lz4`, and `zstd`.
+/// @returns The compression codec, or an error for unknown names.
+caf::expected<::arrow::Compression::type>
+to_ipc_compression(std::string_view name);
+
 /// Arrow InputStream API implementation over `std::istream`.
 /// Implemented by adapting `arrow::io::StdinStream adapted to use `std::istream`.
 class arrow_istream_wrapper : public ::arrow::io::InputStream {
@@ -16,13 +16,17 @@
 #include "vast/format/multi_schema_reader.hpp"
 #include "vast/format/writer.hpp"
 #include "vast/module.hpp"
+#include "vast/type.hpp"
 
 #include <caf/expected.hpp>
 #include <caf/settings.hpp>
 
 #include <chrono>
+#include <memory>
 #include <optional>
 #include <simdjson.h>
+#include <string>
+#include <unordered_map>
 
 namespace vast::format::json {
 
@@ -32,12 +36,21 @@ namespace vast::format::json {
 caf::error
 add(const ::simdjson::dom::object& object, table_slice_builder& builder);
 
+/// A writer for NDJSON. It prints table slices column-wise into a contiguous
+/// buffer, based on a plan that it prepares once per schema, and writes the
+/// buffer to the output stream in one go.
 class writer : public format::writer {
 public:
   using super = format::writer;
 
   writer(std::unique_ptr<std::ostream> out, const caf::settings& options);
 
+  writer(writer&&) noexcept;
+
+  writer& operator=(writer&&) noexcept;
+
+  ~writer() noexcept override;
+
   caf::error write(const table_slice& x) override;
 
   caf::expected<void> flush() override;
@@ -49,8 +62,24 @@ public:
   std::ostream& out();
 
 private:
+  /// The precomputed printing instructions for a field of a schema.
+  struct field_plan;
+
+  /// The arrays that hold the values of a field in a record batch.
+  struct column;
+
+  void print_record(const field_plan& plan, const column& col, int64_t row);
+
+  void print_value(const field_plan& plan, const column& col, int64_t row);
+
+  [[nodiscard]] bool
+  skip(const field_plan& plan, const column& col, int64_t row) const;
+
   std::unique_ptr<std::ostream> out_;
+  json_printer::options options_;
   json_printer printer_;
+  std::string buffer_ = {};
+  std::unordered_map<type, std::unique_ptr<field_plan>> plans_ = {};
 };
 
 /// A reader for JSON data. It operates with a *selector* to determine the
@@ -175,6 +175,7 @@ struct legacy_enumeration_type;
 struct field_extractor;
 struct flow;
 struct legacy_integer_type;
+struct indexed_transformation;
 struct invocation;
 struct legacy_list_type;
 struct legacy_map_type;
@@ -331,6 +332,7 @@ using writer_ptr = std::unique_ptr<writer>;
 namespace system {
 
 class configuration;
+class query_result_cache;
 
 struct accountant_config;
 struct active_partition_state;
@@ -0,0 +1,78 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/detail/bit.hpp"
+#include "vast/hash/concepts.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace vast {
+
+/// An incremental hash algorithm that collects the bytes of a value, and then
+/// hashes them with a single invocation of a oneshot hash algorithm. This
+/// yields the same digest as hashing the same bytes incrementally, but avoids
+/// setting up an incremental hash state, which dominates the cost of hashing
+/// short values.
+///
+/// Unlike other hash algorithms, a buffered hash is reusable: `finish`
+/// discards the collected bytes, so that the next call to `add` begins a new
+/// value with the same seed.
+template <oneshot_hash HashAlgorithm>
+class buffered_hash {
+public:
+  static constexpr detail::endian endian = HashAlgorithm::endian;
+
+  using result_type = typename HashAlgorithm::result_type;
+  using seed_type = typename HashAlgorithm::seed_type;
+
+  /// The number of bytes that the hash collects without allocating.
+  static constexpr size_t inline_capacity = 128;
+
+  explicit buffered_hash(seed_type seed = {}) noexcept : seed_{seed} {
+  }
+
+  void add(std::span<const std::byte> bytes) noexcept {
+    if (heap_buffer_.empty()) {
+      if (size_ + bytes.size() <= inline_capacity) {
+        if (!bytes.empty())
+          std::memcpy(inline_buffer_.data() + size_, bytes.data(),
+                      bytes.size());
+        size_ += bytes.size();
+        return;
+      }
+      heap_buffer_.assign(inline_buffer_.begin(),
+                          inline_buffer_.begin() + size_);
+    }
+    heap_buffer_.insert(heap_buffer_.end(), bytes.begin(), bytes.end());
+  }
+
+  result_type finish() noexcept {
+    const auto bytes = heap_buffer_.empty()
+                         ? std::span<const std::byte>{inline_buffer_.data(),
+                                                      size_}
+                         : std::span<const std::byte>{heap_buffer_};
+    const auto result = HashAlgorithm::make(bytes, seed_);
+    size_ = 0;
+    heap_buffer_.clear();
+    return result;
+  }
+
+private:
+  seed_type seed_ = {};
+  size_t size_ = 0;
+  std::array<std::byte, inline_capacity> inline_buffer_ = {};
+  std::vector<std::byte> heap_buffer_ = {};
+};
+
+} // namespace vast
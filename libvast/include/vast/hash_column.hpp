@@ -0,0 +1,88 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/arrow_table_slice.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/detail/narrow.hpp"
+#include "vast/detail/type_traits.hpp"
+#include "vast/hash/buffered_hash.hpp"
+#include "vast/hash/hash_append.hpp"
+#include "vast/type.hpp"
+#include "vast/view.hpp"
+
+#include <arrow/array.h>
+
+#include <cstdint>
+#include <span>
+
+namespace vast {
+
+/// Computes the digest of every value of an Arrow array at once. The digest of
+/// a row equals `seeded_hash<HashAlgorithm>{seed}(value, suffix...)`, where
+/// `value` is the data view of the row, i.e., the column hashes the same as
+/// hashing its values one by one.
+///
+/// The function dispatches on the type only once per column instead of once
+/// per value, reads the values of basic types directly from the buffers of the
+/// array, and hashes every value with a single oneshot invocation of the hash
+/// algorithm.
+///
+/// @param type The type of the array.
+/// @param array The values to hash.
+/// @param digests The digest for every row of the array.
+/// @param seed The seed of the hash algorithm.
+/// @param suffix Additional values to hash after every value, e.g., a salt.
+/// @pre `digests.size() == array.length()`
+template <oneshot_hash HashAlgorithm, class... Suffix>
+void hash_column(const type& type, const arrow::Array& array,
+                 std::span<typename HashAlgorithm::result_type> digests,
+                 typename HashAlgorithm::seed_type seed,
+                 const Suffix&... suffix) noexcept {
+  VAST_ASSERT(digests.size() == detail::narrow_cast<size_t>(array.length()));
+  auto hasher = buffered_hash<HashAlgorithm>{seed};
+  auto hash_row = [&](const auto& value) noexcept {
+    hash_append(hasher, value);
+    (hash_append(hasher, suffix), ...);
+    return hasher.finish();
+  };
+  auto f = [&]<concrete_type Type>(const Type& typed) noexcept {
+    if constexpr (detail::is_any_v<Type, bool_type, int64_type, uint64_type,
+                                   double_type, duration_type, time_type,
+                                   string_type, ip_type>) {
+      // A data view hashes the index of its alternative before the value.
+      constexpr auto tag = static_cast<uint8_t>(
+        caf::detail::tl_index_of<data_view::types,
+                                 view<type_to_data_t<Type>>>::value);
+      const auto null_digest = hash_row(data_view{});
+      const auto& storage = [&]() -> decltype(auto) {
+        if constexpr (arrow::is_extension_type<
+                        type_to_arrow_type_t<Type>>::value)
+          return static_cast<const type_to_arrow_array_storage_t<Type>&>(
+            *caf::get<type_to_arrow_array_t<Type>>(array).storage());
+        else
+          return caf::get<type_to_arrow_array_t<Type>>(array);
+      }();
+      for (int64_t row = 0; row < array.length(); ++row) {
+        if (array.IsNull(row)) {
+          digests[row] = null_digest;
+          continue;
+        }
+        hash_append(hasher, tag);
+        digests[row] = hash_row(value_at(typed, storage, row));
+      }
+    } else {
+      for (int64_t row = 0; row < array.length(); ++row)
+        digests[row] = hash_row(value_at(type, array, row));
+    }
+  };
+  caf::visit(f, type);
+}
+
+} // namespace vast
@@ -8,14 +8,20 @@
 
 #pragma once
 
+#include <vast/chunk.hpp>
 #include <vast/data.hpp>
 #include <vast/detail/inspection_common.hpp>
 #include <vast/type.hpp>
 
 #include <caf/actor_addr.hpp>
+#include <caf/error.hpp>
 #include <caf/optional.hpp>
 
+#include <functional>
+
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace vast {
 
@@ -27,6 +33,9 @@ enum class http_method : uint8_t {
 enum class http_content_type : uint16_t {
   json,
   ldjson,
+  arrow_stream,
+  ndjson,
+  event_stream,
 };
 
 enum class http_status_code : uint16_t {
@@ -74,6 +83,10 @@ struct rest_endpoint {
   /// Response content type.
   http_content_type content_type;
 
+  /// Additional response content types that clients can select with the
+  /// `Accept` header of a request.
+  std::vector<http_content_type> alternative_content_types = {};
+
   template <class Inspector>
   friend auto inspect(Inspector& f, rest_endpoint& e) {
     auto params = e.params ? type{*e.params} : type{};
@@ -88,7 +101,9 @@ struct rest_endpoint {
       .fields(f.field("endpoint-id", e.endpoint_id),
               f.field("method", e.method), f.field("path", e.path),
               f.field("params", params), f.field("version", e.version),
-              f.field("content-type", e.content_type));
+              f.field("content-type", e.content_type),
+              f.field("alternative-content-types",
+                      e.alternative_content_types));
   }
 };
 
@@ -103,6 +118,27 @@ public:
   /// Append data to the response body.
   virtual void append(std::string body) = 0;
 
+  /// Append a chunk to the response body. The default implementation copies
+  /// the chunk, but implementations may reference the chunk instead.
+  virtual void append_chunk(chunk_ptr body) {
+    if (body)
+      append(std::string{reinterpret_cast<const char*>(body->data()),
+                         body->size()});
+  }
+
+  /// Send the data appended so far to the client without waiting for the end
+  /// of the response. Responses that get flushed use chunked transfer
+  /// encoding. The default implementation sends all data at the end and
+  /// invokes the callback immediately.
+  /// @param on_written The callback to invoke once the data was written to
+  ///        the socket, or with an error if the write failed. Producers use
+  ///        it to apply backpressure. Note that the callback runs outside of
+  ///        the actor system.
+  virtual void flush(std::function<void(caf::error)> on_written) {
+    if (on_written)
+      on_written(caf::error{});
+  }
+
   /// Return an HTTP error code and close the connection.
   //  TODO: Add a `&&` qualifier to ensure one-time use.
   virtual void abort(uint16_t error_code, std::string message) = 0;
@@ -115,6 +151,27 @@ public:
 
   /// The response corresponding to this request.
   std::shared_ptr<http_response> response;
+
+  /// The content type of the response as negotiated with the client.
+  http_content_type content_type = http_content_type::json;
 };
 
+/// @returns Whether responses of a content type stream their events
+/// incrementally rather than rendering them all at once.
+bool is_streaming(http_content_type type);
+
+/// @returns The media type that identifies a content type in HTTP headers.
+std::string_view to_media_type(http_content_type type);
+
+/// Selects the content type of the response to a request from the types an
+/// endpoint supports, according to the preferences that the client expressed
+/// in the `Accept` header. Clients that do not send an `Accept` header or that
+/// accept none of the supported types get the default content type of the
+/// endpoint.
+/// @param endpoint The endpoint that handles the request.
+/// @param accept The value of the `Accept` header of the request.
+/// @returns The negotiated content type.
+http_content_type
+negotiate_content_type(const rest_endpoint& endpoint, std::string_view accept);
+
 } // namespace vast
@@ -16,6 +16,7 @@
 #include "vast/detail/stable_map.hpp"
 #include "vast/detail/type_traits.hpp"
 #include "vast/fbs/value_index.hpp"
+#include "vast/hash/buffered_hash.hpp"
 #include "vast/hash/hash.hpp"
 #include "vast/hash/legacy_hash.hpp"
 #include "vast/logger.hpp"
@@ -82,7 +83,11 @@ public:
   /// @returns The chopped digest.
   static digest_type hash(data_view x, size_t seed = 0) {
     digest_type result;
-    auto digest = seeded_hash<hash_algorithm>{seed}(x);
+    // Hashing the collected bytes of the value at once yields the same digest
+    // as hashing them incrementally, but avoids the setup of the hash state.
+    auto hasher = buffered_hash<hash_algorithm>{seed};
+    hash_append(hasher, x);
+    auto digest = hasher.finish();
     std::memcpy(result.data(), &digest, Bytes);
     return result;
   }
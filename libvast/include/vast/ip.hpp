@@ -11,6 +11,7 @@
 #include "vast/detail/bit.hpp"
 #include "vast/detail/byte_swap.hpp"
 #include "vast/detail/operators.hpp"
+#include "vast/hash/buffered_hash.hpp"
 #include "vast/hash/hash.hpp"
 #include "vast/hash/legacy_hash.hpp"
 #include "vast/hash/uniquely_hashable.hpp"
@@ -89,6 +90,8 @@ public:
   }
 
   /// Construct a pseudonymized address using the Crypto-PAn algorithm.
+  /// Prefer an `ip_pseudonymizer` for pseudonymizing many addresses with the
+  /// same seed.
   /// @param original The address to be pseudonymized.
   /// @param seed 256-bit seed for the cipher and padding.
   /// @returns A copy of the `original` address with pseudonymized bytes.
@@ -203,6 +206,10 @@ struct is_uniquely_represented<ip>
 template <>
 struct is_uniquely_hashable<ip, legacy_hash> : std::false_type {};
 
+template <>
+struct is_uniquely_hashable<ip, buffered_hash<legacy_hash>>
+  : std::false_type {};
+
 inline auto hash_append(legacy_hash& h, const ip& x) {
   if (x.is_v4())
     hash_append(h, as_bytes(x).subspan<12, 4>());
@@ -210,6 +217,13 @@ inline auto hash_append(legacy_hash& h, const ip& x) {
     hash_append(h, as_bytes(x).subspan<0, 16>());
 }
 
+inline auto hash_append(buffered_hash<legacy_hash>& h, const ip& x) {
+  if (x.is_v4())
+    hash_append(h, as_bytes(x).subspan<12, 4>());
+  else
+    hash_append(h, as_bytes(x).subspan<0, 16>());
+}
+
 } // namespace vast
 
 namespace std {
@@ -0,0 +1,104 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/ip.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace vast {
+
+/// Pseudonymizes IP addresses with the prefix-preserving Crypto-PAn algorithm.
+///
+/// Crypto-PAn encrypts one block per bit of an address, where the input of
+/// the block for the n-th bit depends only on the n-bit prefix of the address.
+/// The pseudonymizer keeps a single cipher context for all addresses,
+/// encrypts all blocks of an address with a single cipher invocation, and
+/// memoizes the pad bits of previously seen prefixes in a binary trie, so that
+/// addresses with a common prefix only encrypt the blocks of the bits after
+/// that prefix.
+///
+/// A pseudonymizer is not thread-safe.
+class ip_pseudonymizer {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using seed_type
+    = std::array<ip::byte_type, ip::pseudonymization_seed_array_size>;
+
+  // -- constants --------------------------------------------------------------
+
+  /// The default maximum number of prefixes in the cache.
+  static constexpr size_t default_cache_capacity = size_t{1} << 18;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// Creates a pseudonymizer.
+  /// @param seed 256-bit seed for the cipher and padding.
+  /// @param cache_capacity The maximum number of prefixes to memoize. The
+  ///        pseudonymizer clears the cache when it exceeds the capacity.
+  explicit ip_pseudonymizer(const seed_type& seed,
+                            size_t cache_capacity = default_cache_capacity);
+
+  ip_pseudonymizer(const ip_pseudonymizer&) = delete;
+  ip_pseudonymizer& operator=(const ip_pseudonymizer&) = delete;
+  ip_pseudonymizer(ip_pseudonymizer&&) noexcept;
+  ip_pseudonymizer& operator=(ip_pseudonymizer&&) noexcept;
+
+  ~ip_pseudonymizer() noexcept;
+
+  // -- properties -------------------------------------------------------------
+
+  /// @returns The number of memoized prefixes.
+  [[nodiscard]] size_t cache_size() const;
+
+  // -- operations -------------------------------------------------------------
+
+  /// Pseudonymizes a single address.
+  /// @param original The address to be pseudonymized.
+  /// @returns A copy of the `original` address with pseudonymized bytes.
+  ip operator()(const ip& original);
+
+private:
+  /// A memoized prefix.
+  struct node {
+    /// The indices of the nodes for the prefixes that extend this prefix by a
+    /// 0 or a 1 bit, respectively, or 0 if not memoized yet.
+    std::array<uint32_t, 2> children = {};
+
+    /// The pad bit of the bit that follows the prefix.
+    uint8_t pad_bit = 0;
+  };
+
+  /// The encryption state that requires OpenSSL.
+  struct cipher;
+
+  /// Computes the pad bits for a sequence of bits in network byte order.
+  void make_one_time_pad(std::span<const ip::byte_type> bytes,
+                         std::span<ip::byte_type> one_time_pad);
+
+  /// Encrypts the blocks for the prefixes of the given lengths, and stores the
+  /// most significant bit of every result in `pad_bits_`.
+  void encrypt_prefixes(std::span<const ip::byte_type> bytes, size_t first,
+                        size_t last);
+
+  std::unique_ptr<cipher> cipher_;
+  size_t cache_capacity_ = 0;
+  std::vector<node> trie_ = {};
+  std::vector<ip::byte_type> blocks_ = {};
+  std::vector<ip::byte_type> encrypted_blocks_ = {};
+  std::array<uint8_t, 128> pad_bits_ = {};
+};
+
+} // namespace vast
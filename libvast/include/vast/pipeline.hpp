@@ -8,14 +8,59 @@
 
 #pragma once
 
+#include "vast/defaults.hpp"
+#include "vast/detail/thread_pool.hpp"
 #include "vast/ids.hpp"
 #include "vast/pipeline_operator.hpp"
 #include "vast/type.hpp"
 
+#include <caf/settings.hpp>
+
+#include <memory>
 #include <queue>
+#include <span>
 
 namespace vast {
 
+/// Controls how pipelines apply their leading stateless operators to multiple
+/// batches concurrently.
+struct pipeline_parallelism {
+  /// The number of threads that transform batches, or 0 for one per available
+  /// core. A single thread disables the concurrent transformation.
+  size_t threads = defaults::system::pipeline_threads;
+
+  /// The maximum combined size of the batches that are being transformed at
+  /// once, in bytes.
+  uint64_t memory_budget = defaults::system::pipeline_memory_budget;
+
+  /// Reads the configuration from the `vast.pipeline-threads` and
+  /// `vast.pipeline-memory-budget` options.
+  static caf::expected<pipeline_parallelism>
+  make(const caf::settings& settings);
+};
+
+/// The leading operators of a pipeline that the query engine evaluates
+/// instead of the pipeline. The query engine filters the events, applies the
+/// store operators close to the data, and then limits the number of events
+/// that reach the remaining pipeline.
+struct pipeline_pushdown_plan {
+  /// A predicate to conjoin with the query expression.
+  std::optional<expression> filter = {};
+
+  /// The operators that the stores apply to the matching events, in order.
+  std::vector<pipeline_operator_definition> store_operators = {};
+
+  /// The maximum number of events, or 0 for no limit.
+  uint64_t limit = 0;
+
+  /// Whether the last store operator is a partial aggregation, whose results
+  /// the remaining pipeline merges.
+  bool merge_partials = false;
+
+  /// Describes the plan in a human-readable form.
+  [[nodiscard]] record explain() const;
+};
+
 class pipeline {
 public:
   /// Parse a pipeline from its textual representation.
@@ -26,6 +71,13 @@ public:
   parse(std::string name, std::string_view repr,
         std::vector<std::string> schema_names = {});
 
+  /// Create a pipeline from the definitions of its operators.
+  /// @param name the pipeline name
+  /// @param definitions the definitions of the pipeline operators
+  static caf::expected<pipeline>
+  make(std::string name,
+       std::span<const pipeline_operator_definition> definitions);
+
   pipeline(std::string name, std::vector<std::string>&& schema_names);
 
   ~pipeline() = default;
@@ -38,9 +90,27 @@ public:
 
   void add_operator(std::unique_ptr<pipeline_operator> op);
 
+  /// Applies the leading stateless operators of the pipeline to multiple
+  /// batches concurrently, using a thread pool that all pipelines of the
+  /// process share. The results retain the order of the batches.
+  void parallelize(const pipeline_parallelism& parallelism);
+
   /// Returns true if any of the pipeline operators is aggregate.
   [[nodiscard]] bool is_aggregate() const;
 
+  /// Returns true if any of the pipeline operators is aggregate and only
+  /// yields its results at the end of the stream.
+  [[nodiscard]] bool requires_end_of_stream() const;
+
+  /// Moves the leading operators of a pipeline that applies to all schemas
+  /// into the query, as far as the query engine can evaluate them. An
+  /// aggregation that follows the moved operators splits into a partial
+  /// aggregation in the stores and a final merge, unless the plan limits the
+  /// number of events.
+  /// @returns The operators that the query engine evaluates instead.
+  /// @pre No input was added to the pipeline.
+  [[nodiscard]] pipeline_pushdown_plan push_down();
+
   /// Tests whether the transform applies to events of the given type.
   [[nodiscard]] bool applies_to(std::string_view event_name) const;
 
@@ -53,6 +123,12 @@ public:
 
   [[nodiscard]] const std::string& name() const;
 
+  /// Signals the end of the stream to all operators of the pipeline.
+  void end_stream();
+
+  /// Retrieves and resets the metrics that the pipeline operators collected.
+  [[nodiscard]] std::vector<system::data_point> take_metrics();
+
 private:
   // Returns the list of schemas that the transform should apply to.
   // An empty vector means that the transform should apply to everything.
@@ -65,10 +141,21 @@ private:
   /// @note The offsets of the slices may not be preserved.
   [[nodiscard]] caf::expected<std::vector<table_slice>> finish_batch();
 
+  /// Fuses consecutive operators that transform columns into a single
+  /// operator, which transforms every batch in one pass and computes the
+  /// resulting schema only once per input schema.
+  void fuse_operators();
+
   /// Applies the pipeline operator to every batch in the queue.
   caf::error process_queue(pipeline_operator& op,
                            std::vector<table_slice>& result, bool check_schema);
 
+  /// Applies a sequence of stateless pipeline operators to every batch in the
+  /// queue, transforming multiple batches concurrently.
+  caf::error process_queue_parallel(
+    std::span<const std::unique_ptr<pipeline_operator>> ops,
+    std::vector<table_slice>& result);
+
   /// Grant access to the pipelines engine so it can call
   /// add_batch/finsih_batch.
   friend class pipeline_executor;
@@ -87,6 +174,16 @@ private:
 
   /// The import timestamps collected since the last call to finish.
   std::vector<time> import_timestamps_ = {};
+
+  /// Whether the operators are fused already.
+  bool fused_ = false;
+
+  /// The threads for transforming batches concurrently, if enabled.
+  std::shared_ptr<detail::thread_pool> thread_pool_ = {};
+
+  /// The maximum combined size of the batches that are being transformed
+  /// concurrently.
+  uint64_t memory_budget_ = 0;
 };
 
 class pipeline_executor {
@@ -103,10 +200,21 @@ public:
   pipeline_executor() = default;
   explicit pipeline_executor(std::vector<pipeline>&&);
 
-  /// Returns an error if any of the pipelines is an aggregate and
-  /// aggregates are not allowed.
+  /// Returns an error if any of the pipelines is an aggregate that requires
+  /// the end of the stream and aggregates are not allowed. Incremental
+  /// aggregates are always allowed.
   caf::error validate(enum allow_aggregate_pipelines);
 
+  /// Applies the leading stateless operators of all pipelines to multiple
+  /// batches concurrently.
+  void parallelize(const pipeline_parallelism& parallelism);
+
+  /// Moves the leading operators of the only pipeline into the query.
+  /// @returns The operators that the query engine evaluates instead, which
+  /// is empty if there is not exactly one pipeline.
+  /// @pre No input was added to the executor.
+  pipeline_pushdown_plan push_down();
+
   /// Starts applying relevant pipelines to the table.
   caf::error add(table_slice&&);
 
@@ -114,9 +222,17 @@ public:
   /// @note The offsets of the slices may not be preserved.
   caf::expected<std::vector<table_slice>> finish();
 
+  /// Signals the end of the stream to all pipelines, so that the next call to
+  /// `finish` also yields the results that incremental operators held back.
+  void end_stream();
+
   /// Get a list of the pipelines.
   const std::vector<pipeline>& pipelines();
 
+  /// Retrieves and resets the metrics that the operators of all pipelines
+  /// collected.
+  std::vector<system::data_point> take_metrics();
+
 private:
   static caf::error
   process_queue(pipeline& transform, std::deque<table_slice>& queue);
@@ -135,6 +251,11 @@ private:
 
   /// The slices being transformed.
   std::unordered_map<vast::type, std::deque<table_slice>> to_transform_;
+
+  /// Whether the next call to `finish` must run all pipelines once, even
+  /// without input, to retrieve the results held back until the end of the
+  /// stream.
+  bool ended_ = false;
 };
 
 } // namespace vast
@@ -8,15 +8,84 @@
 
 #pragma once
 
+#include "vast/fwd.hpp"
+
+#include "vast/data.hpp"
+#include "vast/error.hpp"
+#include "vast/expression.hpp"
+#include "vast/system/report.hpp"
 #include "vast/table_slice.hpp"
 
 #include <arrow/record_batch.h>
 #include <caf/expected.hpp>
+#include <fmt/format.h>
 
+#include <optional>
 #include <queue>
+#include <utility>
 
 namespace vast {
 
+/// The definition of a pipeline operator, i.e., the name of its plugin and the
+/// options to create it from.
+struct pipeline_operator_definition {
+  /// The name of the pipeline operator plugin, or empty for no operator.
+  std::string name = {};
+
+  /// The options of the pipeline operator.
+  record options = {};
+
+  friend bool operator==(const pipeline_operator_definition& lhs,
+                         const pipeline_operator_definition& rhs)
+    = default;
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, pipeline_operator_definition& x) {
+    return f.object(x)
+      .pretty_name("vast.pipeline_operator_definition")
+      .fields(f.field("name", x.name), f.field("options", x.options));
+  }
+};
+
+/// The part of a pipeline operator that the query engine can evaluate instead
+/// of the operator while looking up the events.
+struct pipeline_pushdown {
+  /// A predicate that the events must satisfy.
+  std::optional<expression> filter = {};
+
+  /// An operator that the stores apply to every batch of matching events
+  /// before shipping it, e.g., a projection.
+  std::optional<pipeline_operator_definition> store_operator = {};
+
+  /// The maximum number of events.
+  std::optional<uint64_t> limit = {};
+};
+
+/// The column transformation that a pipeline operator applies to all batches
+/// of a single schema. Pipelines fuse the column transformations of
+/// consecutive operators into a single pass over every batch.
+struct column_transformation {
+  /// Whether the operator drops batches of the schema entirely.
+  bool discard = false;
+
+  /// The transformations to apply first, sorted by index.
+  std::vector<indexed_transformation> transformations = {};
+
+  /// The columns to keep after applying the transformations, sorted, or
+  /// nullopt for keeping all columns.
+  std::optional<std::vector<offset>> selection = {};
+
+  /// The new name of the schema after applying the transformations and the
+  /// selection, if any.
+  std::optional<std::string> schema_name = {};
+};
+
+/// Applies a column transformation to a table slice.
+/// @returns The transformed table slice, which has no rows if the
+/// transformation discards the slice or removes all its columns.
+table_slice transform_columns(table_slice slice,
+                              const column_transformation& transformation);
+
 /// An individual pipeline operator. This is mainly used in the plugin API,
 /// later code deals with a complete `transform`.
 class pipeline_operator {
@@ -29,6 +98,61 @@ public:
     return false;
   }
 
+  /// Returns true for aggregate pipeline operators that emit their results
+  /// incrementally while receiving input, and therefore do not depend on a
+  /// final call to `finish` at the end of the stream. They may hold back
+  /// incomplete results until `end_stream` is called, though.
+  /// @note pipeline operators are not incremental by default.
+  [[nodiscard]] virtual bool is_incremental() const {
+    return false;
+  }
+
+  /// Returns true for pipeline operators that transform every batch
+  /// independently of all other batches, which allows for applying them to
+  /// multiple batches concurrently.
+  /// @note pipeline operators are not stateless by default.
+  [[nodiscard]] virtual bool is_stateless() const {
+    return false;
+  }
+
+  /// Returns true for pipeline operators that only transform, select, or
+  /// rename the columns of their input, and can describe that through
+  /// `bind_columns`.
+  /// @note pipeline operators do not transform columns by default.
+  [[nodiscard]] virtual bool transforms_columns() const {
+    return false;
+  }
+
+  /// Describes the column transformation of the operator for a schema.
+  /// @note Must be safe to call from multiple threads at once. The returned
+  /// transformations may be applied to many batches of the schema for the
+  /// lifetime of the operator.
+  /// @pre `transforms_columns()`
+  [[nodiscard]] virtual caf::expected<column_transformation>
+  bind_columns(const type& schema) const;
+
+  /// Splits an aggregate operator into a partial aggregation that runs on
+  /// disjoint subsets of the input in parallel, and a final merge of the
+  /// partial results. After a successful split, the operator expects the
+  /// results of the partial operator as its input.
+  /// @returns The definition of the partial operator, or nullopt if the
+  /// operator does not support partial aggregation.
+  /// @pre No input was added to the operator.
+  /// @note pipeline operators do not support partial aggregation by default.
+  [[nodiscard]] virtual std::optional<pipeline_operator_definition>
+  split_partial() {
+    return std::nullopt;
+  }
+
+  /// Describes how the query engine can evaluate the operator instead.
+  /// @returns The pushdown of the operator, or nullopt if the operator must
+  /// run in the pipeline.
+  /// @pre No input was added to the operator.
+  /// @note pipeline operators cannot be pushed down by default.
+  [[nodiscard]] virtual std::optional<pipeline_pushdown> pushdown() const {
+    return std::nullopt;
+  }
+
   /// Starts applyings the transformation to a batch with a corresponding vast
   /// schema.
   [[nodiscard]] virtual caf::error add(table_slice slice) = 0;
@@ -37,6 +161,69 @@ public:
   /// TODO: add another function abort() to free up internal resources.
   /// NOTE: If there is nothing to transform return an empty vector.
   [[nodiscard]] virtual caf::expected<std::vector<table_slice>> finish() = 0;
+
+  /// Signals that no more input follows, after which `finish` also yields
+  /// the results that an incremental operator held back because they were
+  /// incomplete.
+  /// @note The default implementation does nothing.
+  virtual void end_stream() {
+    // nop
+  }
+
+  /// Retrieves and resets the metrics that the operator collected since the
+  /// last call.
+  /// @note pipeline operators do not collect metrics by default.
+  [[nodiscard]] virtual std::vector<system::data_point> take_metrics() {
+    return {};
+  }
+};
+
+/// A pipeline operator that transforms every batch independently of all other
+/// batches, e.g., a projection or a filter.
+class stateless_pipeline_operator : public pipeline_operator {
+public:
+  [[nodiscard]] bool is_stateless() const final {
+    return true;
+  }
+
+  /// Applies the transformation to a single batch.
+  /// @returns The transformed batch, which has no rows if the operator drops
+  /// the batch entirely.
+  /// @note Must be safe to call from multiple threads at once.
+  [[nodiscard]] virtual caf::expected<table_slice>
+  apply(table_slice slice) const = 0;
+
+  [[nodiscard]] caf::error add(table_slice slice) final {
+    auto result = apply(std::move(slice));
+    if (!result)
+      return std::move(result.error());
+    if (result->rows() > 0)
+      transformed_.push_back(std::move(*result));
+    return caf::none;
+  }
+
+  [[nodiscard]] caf::expected<std::vector<table_slice>> finish() final {
+    return std::exchange(transformed_, {});
+  }
+
+private:
+  /// The transformed batches.
+  std::vector<table_slice> transformed_ = {};
+};
+
+/// A pipeline operator that only transforms, selects, or renames the columns of
+/// its input.
+class column_pipeline_operator : public stateless_pipeline_operator {
+public:
+  [[nodiscard]] bool transforms_columns() const final {
+    return true;
+  }
+
+  [[nodiscard]] caf::expected<column_transformation>
+  bind_columns(const type& schema) const override = 0;
+
+  [[nodiscard]] caf::expected<table_slice>
+  apply(table_slice slice) const final;
 };
 
 caf::expected<std::unique_ptr<pipeline_operator>>
@@ -281,6 +281,14 @@ public:
   /// function.
   [[nodiscard]] virtual caf::expected<std::unique_ptr<aggregation_function>>
   make_aggregation_function(const type& input_type) const = 0;
+
+  /// Returns whether the aggregation functions support partial aggregation,
+  /// i.e., can save and merge their aggregation state.
+  /// @note Aggregation functions do not support partial aggregation by
+  /// default.
+  [[nodiscard]] virtual bool supports_partial_aggregation() const {
+    return false;
+  }
 };
 
 // -- store plugin ------------------------------------------------------------
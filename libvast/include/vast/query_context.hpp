@@ -12,6 +12,7 @@
 #include "vast/detail/inspection_common.hpp"
 #include "vast/detail/overload.hpp"
 #include "vast/expression.hpp"
+#include "vast/pipeline_operator.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/uuid.hpp"
 
@@ -48,16 +49,22 @@ struct count_query_context {
 struct extract_query_context {
   system::receiver_actor<table_slice> sink;
 
+  /// The operators that the stores apply to the matching events close to the
+  /// data, so that they ship the results of the operators instead, e.g.,
+  /// projections or a partial aggregation. Empty if the query ships the
+  /// matching events.
+  std::vector<pipeline_operator_definition> operators = {};
+
   friend bool operator==(const extract_query_context& lhs,
                          const extract_query_context& rhs) {
-    return lhs.sink == rhs.sink;
+    return lhs.sink == rhs.sink && lhs.operators == rhs.operators;
   }
 
   template <class Inspector>
   friend auto inspect(Inspector& f, extract_query_context& x) {
     return f.object(x)
       .pretty_name("vast.query.extract")
-      .fields(f.field("sink", x.sink));
+      .fields(f.field("sink", x.sink), f.field("operators", x.operators));
   }
 };
 
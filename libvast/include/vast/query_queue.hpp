@@ -12,6 +12,7 @@
 
 #include "vast/query_context.hpp"
 #include "vast/system/actors.hpp"
+#include "vast/time.hpp"
 #include "vast/uuid.hpp"
 
 #include <vector>
@@ -70,12 +71,13 @@ public:
   /// to a list of query IDs.
   struct entry {
     entry(uuid partition_id, type schema, uint64_t priority,
-          std::vector<uuid> queries, bool erased)
+          std::vector<uuid> queries, bool erased, time max_import_time = {})
       : partition{std::move(partition_id)},
         schema{std::move(schema)},
         priority{priority},
         queries{std::move(queries)},
-        erased{erased} {
+        erased{erased},
+        max_import_time{max_import_time} {
     }
 
     uuid partition;
@@ -84,6 +86,10 @@ public:
     std::vector<uuid> queries;
     bool erased = false;
 
+    /// The import time of the newest event in the partition. Among partitions
+    /// of equal priority, the newest partitions go first.
+    time max_import_time = {};
+
     friend bool operator<(const entry& lhs, const entry& rhs) noexcept;
     friend bool operator==(const entry& lhs, const uuid& rhs) noexcept;
 
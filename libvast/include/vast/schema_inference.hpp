@@ -0,0 +1,143 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/defaults.hpp"
+#include "vast/type.hpp"
+
+#include <caf/error.hpp>
+#include <caf/expected.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <simdjson.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vast {
+
+/// Infers a record type from a sample of JSON documents.
+///
+/// The inference accumulates observations for every field rather than a type
+/// per document: the kinds of values it has seen, how often the field was
+/// present, and an estimate of the number of distinct values. This allows for
+/// merging the observations of several instances, e.g., when multiple threads
+/// look at disjoint parts of the sample, and derives the type only when all
+/// observations are in. Fields that only occur in some documents become part
+/// of the union of all fields, and fields with values of different kinds get
+/// widened to a type that can represent all of them.
+class schema_inference {
+public:
+  // -- member types -----------------------------------------------------------
+
+  /// The configuration of the type derivation.
+  struct options {
+    /// The minimum estimated number of distinct values of a string field to
+    /// suggest a hash index for it.
+    uint64_t index_min_distinct = defaults::infer::index_min_distinct;
+
+    /// The minimum ratio of distinct values to occurrences of a string field
+    /// to suggest a hash index for it.
+    double index_min_ratio = defaults::infer::index_min_ratio;
+  };
+
+  /// Measurements for a single field of the inferred type.
+  struct field_statistics {
+    /// The dot-separated path to the field.
+    std::string key;
+
+    /// The number of occurrences with a value other than null.
+    uint64_t count = 0;
+
+    /// The number of occurrences with a null value.
+    uint64_t nulls = 0;
+
+    /// The share of occurrences of the enclosing record that contain the
+    /// field.
+    double frequency = 0.0;
+
+    /// The estimated number of distinct values.
+    uint64_t distinct = 0;
+  };
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  schema_inference();
+  ~schema_inference() noexcept;
+  schema_inference(schema_inference&&) noexcept;
+  schema_inference& operator=(schema_inference&&) noexcept;
+
+  // -- properties -------------------------------------------------------------
+
+  /// @returns The number of observed documents.
+  [[nodiscard]] uint64_t documents() const;
+
+  /// @returns The number of lines that failed to parse as a JSON object.
+  [[nodiscard]] uint64_t invalid() const;
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Observes a single JSON document.
+  /// @param document The document to observe.
+  /// @param position The position of the document in the sample, which orders
+  ///        the fields of the inferred type by their first occurrence.
+  /// @returns An error if the document is not a JSON object.
+  caf::error add(const ::simdjson::dom::element& document,
+                 uint64_t position = 0);
+
+  /// Parses and observes every line of newline-delimited JSON. Lines that
+  /// fail to parse are counted, but otherwise skipped.
+  /// @param input The newline-delimited JSON.
+  /// @param position The position of the first line in the sample.
+  void add_lines(std::string_view input, uint64_t position = 0);
+
+  /// Merges the observations of another instance into this one.
+  void merge(schema_inference&& other);
+
+  // -- type derivation --------------------------------------------------------
+
+  /// Derives a record type from the observations.
+  /// @param name The name of the resulting type.
+  /// @param opts The configuration of the derivation.
+  /// @returns The inferred type, or an error if no document was observed.
+  [[nodiscard]] caf::expected<type>
+  make_type(std::string name, const options& opts) const;
+
+  /// @returns The measurements for all fields of the inferred type, in the
+  /// order in which their first occurrence was observed.
+  [[nodiscard]] std::vector<field_statistics> statistics() const;
+
+private:
+  /// The accumulated observations for a value in the documents.
+  struct node;
+
+  std::unique_ptr<node> root_;
+  uint64_t documents_ = 0;
+  uint64_t invalid_ = 0;
+  ::simdjson::dom::parser parser_ = {};
+};
+
+/// Infers the schema of newline-delimited JSON from an input stream in
+/// parallel. The calling thread reads blocks of complete lines and shards
+/// them across the workers, which observe their blocks independently before
+/// their observations get merged.
+/// @param prefix Input that was already consumed from *input*.
+/// @param input The stream to read the remaining input from.
+/// @param num_workers The number of threads that parse the input.
+/// @param max_bytes The maximum number of bytes to look at, or 0 to read the
+///        entire input.
+/// @returns The observations of all workers.
+schema_inference
+infer_json_schema(std::string prefix, std::istream& input, size_t num_workers,
+                  size_t max_bytes);
+
+} // namespace vast
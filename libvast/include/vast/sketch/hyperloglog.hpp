@@ -0,0 +1,104 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This HyperLogLog sketch follows Flajolet et al., "HyperLogLog: the analysis
+// of a near-optimal cardinality estimation algorithm", with the small range
+// correction by linear counting. As the sketch takes 64-bit hash digests as
+// input, it needs no large range correction.
+//
+#pragma once
+
+#include <caf/error.hpp>
+#include <caf/expected.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace vast::sketch {
+
+/// A HyperLogLog sketch that estimates the number of distinct hash digests it
+/// has seen in constant space.
+///
+/// The leading *p* bits of a digest select one of *2^p* registers, and every
+/// register holds the maximum rank of the remaining bits of its digests, i.e.,
+/// the position of their leftmost 1-bit. The relative standard error of the
+/// estimate is about *1.04 / sqrt(2^p)*. Sketches with the same precision merge
+/// into the sketch of the union of their inputs.
+class hyperloglog {
+public:
+  /// The smallest supported precision.
+  static constexpr uint8_t min_precision = 4;
+
+  /// The largest supported precision.
+  static constexpr uint8_t max_precision = 18;
+
+  /// The default precision, which uses 4 KiB of registers for a relative
+  /// standard error of about 1.6%.
+  static constexpr uint8_t default_precision = 12;
+
+  /// Constructs an empty sketch with the default precision.
+  hyperloglog();
+
+  /// Constructs an empty sketch.
+  /// @param precision The number of leading digest bits that select a
+  /// register.
+  /// @returns The sketch iff the precision is in the supported range.
+  static caf::expected<hyperloglog> make(uint8_t precision);
+
+  /// Restores a sketch from its registers.
+  /// @param registers The registers of a sketch.
+  /// @returns The sketch iff the number of registers corresponds to a
+  /// supported precision and all ranks are valid.
+  static caf::expected<hyperloglog> make(std::vector<uint8_t> registers);
+
+  /// Adds a hash digest to the sketch.
+  /// @param digest The digest to add.
+  void add(uint64_t digest) noexcept;
+
+  /// Merges another sketch into this sketch.
+  /// @param other The sketch to merge.
+  /// @returns An error if the sketches have different precisions.
+  caf::error merge(const hyperloglog& other);
+
+  /// Estimates the number of distinct digests added to the sketch.
+  [[nodiscard]] double estimate() const noexcept;
+
+  /// Retrieves the precision of the sketch.
+  [[nodiscard]] uint8_t precision() const noexcept;
+
+  /// Retrieves the registers of the sketch.
+  [[nodiscard]] std::span<const uint8_t> registers() const noexcept;
+
+  // -- concepts --------------------------------------------------------------
+
+  friend size_t mem_usage(const hyperloglog& x) noexcept;
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, hyperloglog& x) {
+    auto load_callback = [&x]() {
+      return x.registers_.size() == size_t{1} << x.precision_
+             && x.precision_ >= min_precision
+             && x.precision_ <= max_precision;
+    };
+    return f.object(x)
+      .pretty_name("vast.sketch.hyperloglog")
+      .on_load(load_callback)
+      .fields(f.field("precision", x.precision_),
+              f.field("registers", x.registers_));
+  }
+
+private:
+  hyperloglog(uint8_t precision, std::vector<uint8_t> registers) noexcept;
+
+  uint8_t precision_ = default_precision;
+  std::vector<uint8_t> registers_ = {};
+};
+
+} // namespace vast::sketch
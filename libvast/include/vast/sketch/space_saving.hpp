@@ -0,0 +1,216 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This Space-Saving sketch follows Metwally et al., "Efficient Computation of
+// Frequent and Top-k Elements in Data Streams", and merges sketches as
+// described by Agarwal et al., "Mergeable Summaries". Instead of the original
+// stream summary, it keeps its counters in an indexed min-heap.
+//
+#pragma once
+
+#include "vast/detail/assert.hpp"
+
+#include <tsl/robin_map.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace vast::sketch {
+
+/// A Space-Saving sketch that finds the most frequent elements of a stream
+/// with a fixed number of counters.
+///
+/// When all counters are in use, a new element replaces the element with the
+/// smallest count, and inherits its count as overestimation error. Every
+/// element whose true count exceeds `n / capacity` for a stream of `n`
+/// elements is guaranteed to have a counter, and the count of every counter
+/// exceeds the true count of its element by at most its error.
+template <class Key, class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+class space_saving {
+public:
+  /// The estimated count of an element.
+  struct counter {
+    Key key = {};       ///< The element.
+    uint64_t count = 0; ///< The upper bound of the count of the element.
+    uint64_t error = 0; ///< The maximum overestimation of the count.
+  };
+
+  /// The default number of counters.
+  static constexpr size_t default_capacity = 100;
+
+  /// Constructs an empty sketch.
+  /// @param capacity The number of counters.
+  /// @pre `capacity > 0`
+  explicit space_saving(size_t capacity = default_capacity)
+    : capacity_{capacity} {
+    VAST_ASSERT(capacity_ > 0);
+  }
+
+  /// Adds an element to the sketch.
+  /// @param key The element to add.
+  /// @param count The number of occurrences of the element.
+  void add(const Key& key, uint64_t count = 1) {
+    if (auto it = positions_.find(key); it != positions_.end()) {
+      const auto position = it->second;
+      heap_[position].count += count;
+      sift_down(position);
+      return;
+    }
+    if (heap_.size() < capacity_) {
+      positions_.emplace(key, heap_.size());
+      heap_.push_back({key, count, 0});
+      sift_up(heap_.size() - 1);
+      return;
+    }
+    // Replace the element with the smallest count.
+    auto& smallest = heap_.front();
+    positions_.erase(smallest.key);
+    positions_.emplace(key, 0);
+    smallest.error = smallest.count;
+    smallest.count += count;
+    smallest.key = key;
+    sift_down(0);
+  }
+
+  /// Merges another sketch into this sketch.
+  /// @param other The sketch to merge.
+  void merge(const space_saving& other) {
+    // Elements without a counter in a full sketch may have occurred up to as
+    // often as its smallest count.
+    const auto min_count = [](const space_saving& sketch) {
+      if (sketch.heap_.size() < sketch.capacity_)
+        return uint64_t{0};
+      return sketch.heap_.front().count;
+    };
+    const auto this_min = min_count(*this);
+    const auto other_min = min_count(other);
+    auto merged = std::vector<counter>{};
+    merged.reserve(heap_.size() + other.heap_.size());
+    for (const auto& entry : heap_) {
+      auto result = entry;
+      if (auto it = other.positions_.find(entry.key);
+          it != other.positions_.end()) {
+        result.count += other.heap_[it->second].count;
+        result.error += other.heap_[it->second].error;
+      } else {
+        result.count += other_min;
+        result.error += other_min;
+      }
+      merged.push_back(std::move(result));
+    }
+    for (const auto& entry : other.heap_) {
+      if (positions_.contains(entry.key))
+        continue;
+      auto result = entry;
+      result.count += this_min;
+      result.error += this_min;
+      merged.push_back(std::move(result));
+    }
+    assign(std::move(merged));
+  }
+
+  /// Retrieves the elements with the highest counts.
+  /// @param k The maximum number of elements to retrieve.
+  /// @returns The counters of up to *k* elements, ordered by their counts in
+  /// descending order.
+  [[nodiscard]] std::vector<counter> top(size_t k) const {
+    auto result = std::vector<counter>{heap_.begin(), heap_.end()};
+    const auto size = std::min(k, result.size());
+    std::partial_sort(result.begin(), result.begin() + size, result.end(),
+                      [](const counter& lhs, const counter& rhs) {
+                        return lhs.count > rhs.count;
+                      });
+    result.resize(size);
+    return result;
+  }
+
+  /// Retrieves all counters in unspecified order.
+  [[nodiscard]] std::span<const counter> counters() const noexcept {
+    return heap_;
+  }
+
+  /// Replaces all counters of the sketch, e.g., to restore a sketch from its
+  /// counters. Keeps only the counters with the highest counts if there are
+  /// more counters than the capacity.
+  /// @param counters The new counters.
+  /// @pre The keys of *counters* are unique.
+  void assign(std::vector<counter> counters) {
+    if (counters.size() > capacity_) {
+      std::nth_element(counters.begin(), counters.begin() + capacity_,
+                       counters.end(),
+                       [](const counter& lhs, const counter& rhs) {
+                         return lhs.count > rhs.count;
+                       });
+      counters.resize(capacity_);
+    }
+    heap_ = std::move(counters);
+    std::make_heap(heap_.begin(), heap_.end(), greater_count);
+    positions_.clear();
+    positions_.reserve(heap_.size());
+    for (size_t position = 0; position < heap_.size(); ++position) {
+      [[maybe_unused]] const auto [_, inserted]
+        = positions_.emplace(heap_[position].key, position);
+      VAST_ASSERT(inserted);
+    }
+  }
+
+  /// Retrieves the number of counters.
+  [[nodiscard]] size_t capacity() const noexcept {
+    return capacity_;
+  }
+
+private:
+  /// The comparator that makes `std::make_heap` build a min-heap.
+  static bool greater_count(const counter& lhs, const counter& rhs) noexcept {
+    return lhs.count > rhs.count;
+  }
+
+  /// Swaps two counters of the heap and updates their positions.
+  void swap_counters(size_t lhs, size_t rhs) {
+    std::swap(heap_[lhs], heap_[rhs]);
+    positions_[heap_[lhs].key] = lhs;
+    positions_[heap_[rhs].key] = rhs;
+  }
+
+  /// Restores the heap property after the count at a position decreased.
+  void sift_up(size_t position) {
+    while (position > 0) {
+      const auto parent = (position - 1) / 2;
+      if (heap_[parent].count <= heap_[position].count)
+        return;
+      swap_counters(parent, position);
+      position = parent;
+    }
+  }
+
+  /// Restores the heap property after the count at a position increased.
+  void sift_down(size_t position) {
+    while (true) {
+      auto smallest = position;
+      for (const auto child : {2 * position + 1, 2 * position + 2})
+        if (child < heap_.size() && heap_[child].count < heap_[smallest].count)
+          smallest = child;
+      if (smallest == position)
+        return;
+      swap_counters(smallest, position);
+      position = smallest;
+    }
+  }
+
+  size_t capacity_ = default_capacity;
+  std::vector<counter> heap_ = {};
+  tsl::robin_map<Key, size_t, Hash, KeyEqual> positions_ = {};
+};
+
+} // namespace vast::sketch
@@ -0,0 +1,130 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This t-digest is a merging digest as described by Dunning and Ertl,
+// "Computing Extremely Accurate Quantiles Using t-Digests". It buffers added
+// values and periodically merges them into its sorted centroids, bounding the
+// size of every centroid with the scale function k1(q) = d / 2pi * asin(2q-1).
+//
+#pragma once
+
+#include <caf/expected.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace vast::sketch {
+
+/// A t-digest that estimates quantiles of a stream of numbers in bounded
+/// space.
+///
+/// The digest summarizes its input in clusters of nearby values, so called
+/// centroids, which are small at the tails of the distribution and larger
+/// towards the median. This makes the estimates of extreme quantiles more
+/// accurate than those of quantiles close to the median. Digests merge into
+/// the digest of the union of their inputs.
+class t_digest {
+public:
+  /// A cluster of values, represented by their mean and their total weight.
+  struct centroid {
+    double mean = 0.0;   ///< The mean of the values.
+    double weight = 0.0; ///< The total weight of the values.
+
+    friend bool operator==(const centroid&, const centroid&) = default;
+
+    template <class Inspector>
+    friend auto inspect(Inspector& f, centroid& x) {
+      return f.object(x)
+        .pretty_name("vast.sketch.t_digest.centroid")
+        .fields(f.field("mean", x.mean), f.field("weight", x.weight));
+    }
+  };
+
+  /// The default compression, which bounds the number of centroids at about
+  /// 100 and estimates quantiles with an error well below 1%.
+  static constexpr double default_compression = 100.0;
+
+  /// Constructs an empty digest.
+  /// @param compression The compression parameter that trades off accuracy
+  /// for space.
+  explicit t_digest(double compression = default_compression);
+
+  /// Restores a digest from its centroids.
+  /// @param compression The compression parameter of the digest.
+  /// @param centroids The centroids of the digest, in order of their means.
+  /// @param min The smallest value in the digest.
+  /// @param max The largest value in the digest.
+  /// @returns The digest iff the centroids are sorted, have positive
+  /// weights, and lie within the bounds.
+  static caf::expected<t_digest> make(double compression,
+                                      std::vector<centroid> centroids,
+                                      double min, double max);
+
+  /// Adds a value to the digest.
+  /// @param value The value to add. NaN values are ignored.
+  /// @param weight The weight of the value.
+  /// @pre `weight > 0`
+  void add(double value, double weight = 1.0);
+
+  /// Merges another digest into this digest.
+  /// @param other The digest to merge.
+  void merge(const t_digest& other);
+
+  /// Estimates a quantile of the values in the digest.
+  /// @param q The quantile to estimate.
+  /// @returns The estimate, or nullopt if the digest is empty.
+  /// @pre `0 <= q && q <= 1`
+  [[nodiscard]] std::optional<double> quantile(double q) const;
+
+  /// Retrieves the total weight of the values in the digest.
+  [[nodiscard]] double weight() const noexcept;
+
+  /// Retrieves the smallest value in the digest.
+  [[nodiscard]] double min() const noexcept;
+
+  /// Retrieves the largest value in the digest.
+  [[nodiscard]] double max() const noexcept;
+
+  /// Retrieves the compression parameter of the digest.
+  [[nodiscard]] double compression() const noexcept;
+
+  /// Retrieves the centroids of the digest in order of their means.
+  [[nodiscard]] std::span<const centroid> centroids() const;
+
+  // -- concepts --------------------------------------------------------------
+
+  friend size_t mem_usage(const t_digest& x) noexcept;
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, t_digest& x) {
+    if constexpr (!Inspector::is_loading)
+      x.compress();
+    return f.object(x)
+      .pretty_name("vast.sketch.t_digest")
+      .fields(f.field("compression", x.compression_),
+              f.field("centroids", x.centroids_), f.field("min", x.min_),
+              f.field("max", x.max_), f.field("weight", x.weight_));
+  }
+
+private:
+  /// Merges the buffered values into the centroids.
+  /// @note Compression does not change the observable state of the digest,
+  /// which is why const member functions may trigger it.
+  void compress() const;
+
+  double compression_ = default_compression;
+  double min_ = 0.0;
+  double max_ = 0.0;
+  double weight_ = 0.0;
+  mutable std::vector<centroid> centroids_ = {};
+  mutable std::vector<centroid> buffer_ = {};
+};
+
+} // namespace vast::sketch
@@ -11,6 +11,7 @@
 #include "vast/fwd.hpp"
 
 #include "vast/detail/generator.hpp"
+#include "vast/pipeline.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/table_slice.hpp"
 #include "vast/uuid.hpp"
@@ -50,6 +51,11 @@ public:
   /// @return The results of applying the extract query to each table slice.
   [[nodiscard]] virtual detail::generator<table_slice>
   extract(expression expr, ids selection) const;
+
+  /// Retrieves and resets the metrics that the store collected while
+  /// evaluating queries since the last call.
+  /// @note stores do not collect metrics by default.
+  [[nodiscard]] virtual std::vector<system::data_point> take_metrics();
 };
 
 /// A base class for passive stores used by the store plugin.
@@ -94,7 +100,11 @@ struct base_query_state {
 struct count_query_state : public base_query_state<uint64_t> {};
 
 /// Keeps track of all relevant state for an in-progress extract query.
-struct extract_query_state : public base_query_state<table_slice> {};
+struct extract_query_state : public base_query_state<table_slice> {
+  /// The operators that transform the results before they are shipped, if
+  /// the query asks for any.
+  std::optional<pipeline> operators = {};
+};
 
 /// The state of the default passive store actor implementation.
 struct default_passive_store_state {
@@ -261,6 +261,8 @@ using index_actor = typed_actor_fwd<
   auto(atom::resolve, expression)->caf::result<catalog_lookup_result>,
   // Queries PARTITION actors for a given query id.
   auto(atom::query, uuid, uint32_t)->caf::result<void>,
+  // Cancels the evaluation of the remaining partitions for a given query id.
+  auto(atom::stop, uuid)->caf::result<void>,
   // Erases the given partition from the INDEX.
   auto(atom::erase, uuid)->caf::result<atom::done>,
   // Erases the given set of partitions from the INDEX.
@@ -16,6 +16,7 @@
 #include "vast/query_context.hpp"
 #include "vast/query_options.hpp"
 #include "vast/system/actors.hpp"
+#include "vast/system/partition_request_window.hpp"
 #include "vast/system/query_status.hpp"
 #include "vast/table_slice.hpp"
 #include "vast/uuid.hpp"
@@ -49,6 +50,13 @@ struct exporter_state {
   /// Stores a pipeline_executor for transforming the results.
   pipeline_executor pipeline = {};
 
+  /// Whether the stores pre-aggregate the results, in which case the pipeline
+  /// merges the partial results of all partitions once the query is done.
+  bool merge_partials = false;
+
+  /// Explains which operators of the pipeline the query evaluates instead.
+  record pushdown = {};
+
   /// Stores a handle to the SINK that processes results.
   caf::actor sink = {};
 
@@ -59,7 +67,7 @@ struct exporter_state {
   /// Stores a handle to the ACCOUNTANT that collects various statistics.
   accountant_actor accountant = {};
 
-  /// Caches tailored candidate checkers.
+  /// Caches tailored candidate checkers for continuous queries.
   std::unordered_map<type, expression> checkers = {};
 
   /// Caches results for the SINK.
@@ -78,6 +86,19 @@ struct exporter_state {
   /// Stores the query ID we receive from the INDEX.
   uuid id = {};
 
+  /// The maximum number of events to export, or 0 for all of them. The
+  /// exporter cancels the evaluation of the remaining partitions once it
+  /// reached the limit.
+  uint64_t max_events = 0;
+
+  /// Sizes the number of partitions that we ask the INDEX for at once.
+  partition_request_window partition_window = {};
+
+  /// The number of events and table slices we received since requesting the
+  /// current set of partitions.
+  uint64_t round_events = 0;
+  size_t round_slices = 0;
+
   /// Used to send table slices to the sink in a streaming manner.
   caf::stream_source_ptr<caf::broadcast_downstream_manager<table_slice>> source
     = {};
@@ -85,10 +106,16 @@ struct exporter_state {
 
 /// The EXPORTER gradually requests more results from the index until no more
 /// results are available or the requested number of events is reached.
-/// It also performs a candidate check to filter out false positives.
+/// The INDEX evaluates the newest candidate partitions first, so that queries
+/// for a limited number of events only need to look at a few partitions.
+/// Results of historical queries arrive pre-filtered from the stores, whereas
+/// the exporter performs a candidate check for the events of continuous
+/// queries that it receives from the importer.
 /// @param self The actor handle of the exporter.
 /// @param expr The AST of the query.
 /// @param options The query options.
+/// @param export_max_events The maximum number of events to export, or 0 for
+///        all of them.
 /// @param pipelines The applied pipelines.
 /// @param index The index actor.
 exporter_actor::behavior_type
@@ -28,6 +28,7 @@
 #include <caf/event_based_actor.hpp>
 #include <caf/typed_response_promise.hpp>
 
+#include <memory>
 #include <queue>
 #include <unordered_map>
 #include <vector>
@@ -140,6 +141,10 @@ struct index_counters {
 
   /// How many partitions were scheduled for queries.
   size_t partition_scheduled = 0;
+
+  /// How many queries were answered from the result cache without sending
+  /// them to a partition.
+  size_t cached_lookups = 0;
 };
 
 /// The state of the index actor.
@@ -230,6 +235,11 @@ struct index_state {
 
   void schedule_lookups();
 
+  /// Tries to answer a query for a partition from the result cache.
+  /// @returns Whether the query no longer needs to be sent to the partition.
+  bool answer_from_cache(const uuid& query_id, const uuid& partition_id,
+                         const type& schema);
+
   // -- introspection ----------------------------------------------------------
 
   /// Flushes collected metrics to the accountant.
@@ -268,6 +278,10 @@ struct index_state {
   /// The set of partitions that exist on disk.
   std::unordered_set<uuid> persisted_partitions = {};
 
+  /// The results of earlier queries against passive partitions, which are
+  /// shared with the partitions. Unset if the cache is disabled.
+  std::shared_ptr<query_result_cache> query_cache = {};
+
   /// This set to true after the index finished reading the catalog state
   /// from disk.
   bool accept_queries = {};
@@ -0,0 +1,135 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/defaults.hpp"
+#include "vast/system/instrumentation.hpp"
+#include "vast/time.hpp"
+
+#include <caf/settings.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vast::system {
+
+/// Sizes the number of partitions that a query asks the INDEX to evaluate at
+/// once.
+///
+/// The INDEX evaluates the requested partitions of a query concurrently and
+/// signals completion once all of them are done, so the window bounds how
+/// many cores a single query can use. Much like TCP congestion control, the
+/// window starts small and doubles after every round until it reaches a
+/// threshold, after which it grows by one partition per round. A round that
+/// takes much longer than the fastest round so far indicates that the
+/// requested partitions queue up in the INDEX instead of being evaluated
+/// concurrently, and shrinks the window by a quarter. A consumer that falls
+/// behind the results halves the window and lowers the threshold.
+///
+/// For queries that need a limited number of results, the window also does not
+/// exceed the number of partitions that are expected to produce the remaining
+/// results, going by the hits per partition observed so far.
+class partition_request_window {
+public:
+  // -- member types -----------------------------------------------------------
+
+  /// The configuration of the window.
+  struct options {
+    /// The lower bound for the window size.
+    size_t min_size = defaults::system::min_partition_window;
+
+    /// The upper bound for the window size, or 0 for the number of available
+    /// cores.
+    size_t max_size = defaults::system::max_partition_window;
+  };
+
+  /// The outcome of a round.
+  enum class decision {
+    keep,
+    grow,
+    shrink,
+  };
+
+  /// Counters for the rounds of the window.
+  struct statistics {
+    uint64_t rounds = 0;
+    uint64_t partitions = 0;
+    uint64_t hits = 0;
+    uint64_t grown = 0;
+    uint64_t shrunk = 0;
+  };
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// Constructs a window of the minimum size with the default configuration.
+  partition_request_window();
+
+  /// Constructs a window of the minimum size.
+  /// @param opts The configuration of the window.
+  explicit partition_request_window(options opts);
+
+  /// Reads the configuration from the `vast.min-partition-window` and
+  /// `vast.max-partition-window` options.
+  static options make_options(const caf::settings& settings);
+
+  // -- properties -------------------------------------------------------------
+
+  /// @returns The current window size.
+  [[nodiscard]] size_t size() const;
+
+  /// @returns The upper bound for the window size.
+  [[nodiscard]] size_t max_size() const;
+
+  /// @returns The duration of the last complete round.
+  [[nodiscard]] duration latency() const;
+
+  /// @returns Whether a round is in progress.
+  [[nodiscard]] bool in_flight() const;
+
+  /// Retrieves and resets the round counters.
+  statistics take_statistics();
+
+  // -- observers --------------------------------------------------------------
+
+  /// Computes the number of partitions to request for the next round.
+  /// @param remaining The number of candidate partitions that were not yet
+  ///        requested.
+  /// @param demand The number of results that the consumer still needs, or 0
+  ///        if it needs all of them.
+  /// @returns The number of partitions to request, which is 0 only if
+  ///          *remaining* is 0.
+  [[nodiscard]] size_t next(size_t remaining, size_t demand = 0) const;
+
+  /// Marks the start of a round.
+  /// @param partitions The number of requested partitions.
+  /// @param now The current time.
+  void start(size_t partitions, stopwatch::time_point now);
+
+  /// Marks the end of the round in progress.
+  /// @param hits The number of results that the round produced.
+  /// @param backlogged Whether the consumer of the results falls behind.
+  /// @param now The current time.
+  /// @returns How the window size changed.
+  /// @pre `in_flight()`
+  decision finish(uint64_t hits, bool backlogged, stopwatch::time_point now);
+
+private:
+  options options_;
+  size_t size_;
+  size_t threshold_;
+  size_t round_partitions_ = 0;
+  stopwatch::time_point round_start_ = {};
+  duration latency_ = {};
+  duration fastest_ = duration::max();
+  uint64_t total_partitions_ = 0;
+  uint64_t total_hits_ = 0;
+  statistics statistics_ = {};
+};
+
+} // namespace vast::system
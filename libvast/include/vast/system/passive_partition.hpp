@@ -26,6 +26,7 @@
 #include <caf/typed_event_based_actor.hpp>
 
 #include <filesystem>
+#include <memory>
 #include <span>
 #include <unordered_map>
 #include <vector>
@@ -99,6 +100,9 @@ struct passive_partition_state {
   /// Actor handle of the filesystem.
   filesystem_actor filesystem = {};
 
+  /// The cache for query results that is shared with the INDEX, if enabled.
+  std::shared_ptr<query_result_cache> cache = {};
+
   /// The store to retrieve the data from.
   store_actor store = {};
 
@@ -145,9 +149,11 @@ struct partition_chunk {
 /// @param accountant the accountant to send metrics to.
 /// @param filesystem The actor handle of the filesystem actor.
 /// @param path The path where the partition flatbuffer can be found.
+/// @param cache The cache for query results, or nullptr to disable caching.
 partition_actor::behavior_type passive_partition(
   partition_actor::stateful_pointer<passive_partition_state> self, uuid id,
   accountant_actor accountant, filesystem_actor filesystem,
-  const std::filesystem::path& path);
+  const std::filesystem::path& path,
+  std::shared_ptr<query_result_cache> cache);
 
 } // namespace vast::system
@@ -0,0 +1,143 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/expression.hpp"
+#include "vast/ids.hpp"
+#include "vast/uuid.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace vast::system {
+
+/// Caches the results of evaluating an expression against a passive partition.
+///
+/// Passive partitions are immutable, so the results of a query that runs over
+/// the same partition again remain valid until the partition is erased. The
+/// INDEX uses the cache to answer repeated queries without loading the
+/// partition, and passive partitions use it to skip the evaluation of their
+/// indexes. The cache is keyed by partition ID and the normalized expression
+/// that is tailored to the schema of the partition, and it is shared between
+/// actors running on different threads.
+///
+/// The cache evicts the least recently used entries when their combined size
+/// exceeds the memory budget.
+class query_result_cache {
+public:
+  // -- member types -----------------------------------------------------------
+
+  /// The cached results for a single expression and partition.
+  struct entry {
+    /// The candidate IDs that the indexes of the partition yield.
+    std::optional<ids> hits = {};
+
+    /// The exact number of events that match the expression.
+    std::optional<uint64_t> count = {};
+  };
+
+  /// Counters for the lookups of the cache.
+  struct statistics {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t invalidations = 0;
+  };
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// Constructs an empty cache.
+  /// @param capacity The memory budget in bytes.
+  explicit query_result_cache(size_t capacity);
+
+  // -- properties -------------------------------------------------------------
+
+  /// @returns The memory budget in bytes.
+  [[nodiscard]] size_t capacity() const;
+
+  /// @returns The number of cached entries.
+  [[nodiscard]] size_t size() const;
+
+  /// @returns The approximate memory usage of all cached entries in bytes.
+  [[nodiscard]] size_t memusage() const;
+
+  /// Retrieves and resets the lookup counters.
+  statistics take_statistics();
+
+  // -- lookup -----------------------------------------------------------------
+
+  /// Retrieves the cached results and marks them as recently used.
+  /// @param partition The ID of the partition.
+  /// @param expr The expression tailored to the schema of the partition.
+  /// @returns The cached results, if any.
+  std::optional<entry> lookup(const uuid& partition, const expression& expr);
+
+  /// Retrieves the cached candidate IDs without counting the lookup towards
+  /// the statistics, for partitions that evaluate a query that the INDEX
+  /// already looked up.
+  /// @param partition The ID of the partition.
+  /// @param expr The expression tailored to the schema of the partition.
+  /// @returns The cached candidate IDs, if any.
+  std::optional<ids> find_hits(const uuid& partition, const expression& expr);
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Caches the candidate IDs for an expression.
+  /// @param partition The ID of the partition.
+  /// @param expr The expression tailored to the schema of the partition.
+  /// @param hits The candidate IDs.
+  void insert_hits(const uuid& partition, const expression& expr, ids hits);
+
+  /// Caches the exact number of results for an expression.
+  /// @param partition The ID of the partition.
+  /// @param expr The expression tailored to the schema of the partition.
+  /// @param count The number of matching events.
+  void insert_count(const uuid& partition, const expression& expr,
+                    uint64_t count);
+
+  /// Removes all entries of a partition.
+  /// @param partition The ID of the partition.
+  void erase(const uuid& partition);
+
+private:
+  struct node {
+    uuid partition;
+    expression expr;
+    entry value;
+    size_t memusage;
+  };
+
+  using list_type = std::list<node>;
+
+  using partition_map = std::unordered_map<expression, list_type::iterator>;
+
+  /// Inserts or updates an entry. Requires holding the lock.
+  template <class Update>
+  void upsert(const uuid& partition, const expression& expr, Update update);
+
+  /// Evicts the least recently used entries until the entries fit into the
+  /// memory budget. Requires holding the lock.
+  void shrink();
+
+  /// Removes a single entry. Requires holding the lock.
+  void remove(list_type::iterator it);
+
+  mutable std::mutex mutex_;
+  size_t capacity_;
+  size_t memusage_ = 0;
+  list_type entries_ = {};
+  std::unordered_map<uuid, partition_map> partitions_ = {};
+  statistics statistics_ = {};
+};
+
+} // namespace vast::system
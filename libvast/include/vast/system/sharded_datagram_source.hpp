@@ -0,0 +1,176 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/detail/streambuf.hpp"
+#include "vast/detail/udp_batch_receiver.hpp"
+#include "vast/pipeline.hpp"
+#include "vast/system/actors.hpp"
+#include "vast/system/instrumentation.hpp"
+#include "vast/system/source.hpp"
+
+#include <caf/stateful_actor.hpp>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace vast::system {
+
+/// A bounded queue of table slices that the shards of a SHARDED DATAGRAM
+/// SOURCE produce and the source actor consumes.
+struct datagram_slice_queue {
+  /// Creates a queue that holds up to `capacity` slices.
+  explicit datagram_slice_queue(size_t capacity);
+
+  /// Appends slices to the queue.
+  /// @returns `true` if the consumer must be woken up.
+  bool push(std::vector<table_slice>&& slices);
+
+  /// Removes up to `num` slices from the queue.
+  std::vector<table_slice> pop(size_t num);
+
+  /// @returns `true` if the queue holds at least `capacity` slices.
+  bool full() const;
+
+private:
+  mutable std::mutex mutex_ = {};
+  std::deque<table_slice> slices_ = {};
+  size_t capacity_ = 0;
+  bool notified_ = false;
+};
+
+/// A worker thread of the SHARDED DATAGRAM SOURCE. Each shard owns one of the
+/// sockets that share the listening port, and parses the datagrams it receives
+/// with its own reader instance.
+class datagram_shard {
+public:
+  // -- constructors, destructors, and assignment operators --------------------
+
+  datagram_shard(detail::udp_batch_receiver receiver, format::reader_ptr reader,
+                 size_t table_slice_size,
+                 std::shared_ptr<datagram_slice_queue> queue);
+
+  datagram_shard(const datagram_shard&) = delete;
+  datagram_shard& operator=(const datagram_shard&) = delete;
+
+  /// The destructor stops and joins the worker thread.
+  ~datagram_shard();
+
+  // -- thread management ------------------------------------------------------
+
+  /// Spawns the worker thread.
+  /// @param source The actor to wake up when new slices are available.
+  void start(caf::actor source);
+
+  /// Stops and joins the worker thread.
+  void stop();
+
+  // -- properties -------------------------------------------------------------
+
+  /// Sets the module of the shard's reader.
+  caf::error module(vast::module mod);
+
+  /// Retrieves and resets the parsing metrics of this shard.
+  measurement take_metrics();
+
+  /// @returns The number of datagrams the kernel dropped for this shard's
+  ///          socket since it was opened.
+  uint64_t kernel_drops() const;
+
+  /// Retrieves and resets the number of datagrams that the shard discarded
+  /// because the source had no capacity left.
+  uint64_t take_dropped_datagrams();
+
+private:
+  void run(caf::actor source);
+
+  /// Parses the buffered datagrams and hands the resulting slices over to the
+  /// source.
+  void flush(const caf::actor& source);
+
+  detail::udp_batch_receiver receiver_;
+  format::reader_ptr reader_;
+  size_t table_slice_size_;
+  std::shared_ptr<datagram_slice_queue> queue_;
+  std::string buffer_ = {};
+  /// The view on `buffer_` that the reader parses. The reader owns the input
+  /// stream over it, which outlives a single call to `flush`.
+  detail::arraybuf<> input_buffer_{nullptr, 0};
+  size_t buffered_datagrams_ = 0;
+  std::mutex reader_mutex_ = {};
+  measurement metrics_ = {};
+  std::atomic<uint64_t> kernel_drops_ = 0;
+  std::atomic<uint64_t> dropped_datagrams_ = 0;
+  std::atomic<bool> running_ = false;
+  std::thread thread_ = {};
+};
+
+struct sharded_datagram_source_state : source_state {
+  // -- member types -----------------------------------------------------------
+
+  using super = source_state;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  using super::super;
+
+  /// Stops all shards before the state goes out of scope.
+  ~sharded_datagram_source_state();
+
+  // -- member variables -------------------------------------------------------
+
+  /// The worker shards, each owning one socket of the listening port.
+  std::vector<std::unique_ptr<datagram_shard>> shards = {};
+
+  /// The slices produced by the shards that wait for capacity in the stream.
+  std::shared_ptr<datagram_slice_queue> queue = {};
+
+  /// The kernel drop counters at the time of the last report.
+  uint64_t reported_kernel_drops = 0;
+
+  // -- utility functions -----------------------------------------------------
+
+  /// Sends the source report, including the UDP-specific drop counters.
+  void send_udp_report();
+};
+
+/// An event producer for high-rate UDP inputs that spreads the load over
+/// multiple sockets bound to the same port via `SO_REUSEPORT`. Every socket is
+/// served by a dedicated thread that receives datagrams in batches and parses
+/// them with its own reader, so the actor only forwards the produced slices.
+/// Datagrams are treated as newline-delimited input, which makes this suitable
+/// for line-based formats like syslog or JSON.
+/// @param self The actor handle.
+/// @param udp_listening_port The requested port.
+/// @param shard_readers One reader instance per shard; the number of readers
+///        determines the number of shards.
+/// @param reader The reader instance that holds the module.
+/// @param table_slice_size The maximum size for a table slice.
+/// @param max_events The optional maximum amount of events to import.
+/// @param catalog The catalog for the type-registry component.
+/// @param local_module Additional local modules to consider.
+/// @param type_filter Restriction for considered types.
+/// @param accountant_actor The actor handle for the accountant component.
+/// @param pipelines The input transformations to apply.
+caf::behavior sharded_datagram_source(
+  caf::stateful_actor<sharded_datagram_source_state>* self,
+  uint16_t udp_listening_port, std::vector<format::reader_ptr> shard_readers,
+  format::reader_ptr reader, size_t table_slice_size,
+  std::optional<size_t> max_events, const catalog_actor& catalog,
+  vast::module local_module, std::string type_filter,
+  accountant_actor accountant, std::vector<pipeline>&& pipelines);
+
+} // namespace vast::system
@@ -18,6 +18,7 @@
 #include "vast/system/instrumentation.hpp"
 #include "vast/system/report.hpp"
 #include "vast/system/status.hpp"
+#include "vast/system/table_slice_size_controller.hpp"
 
 #include <caf/broadcast_downstream_manager.hpp>
 #include <caf/stream_source.hpp>
@@ -81,6 +82,9 @@ struct source_state {
   /// The maximum size for a table slice.
   size_t table_slice_size = {};
 
+  /// Adapts the table slice size to the input rate, if enabled.
+  std::optional<table_slice_size_controller> slice_size_controller = {};
+
   /// Current metrics for the accountant.
   measurement metrics = {};
 
@@ -118,11 +122,15 @@ struct source_state {
 /// @param type_filter Restriction for considered types.
 /// @param accountant_actor The actor handle for the accountant component.
 /// @param input_transformations The input transformations to be applied.
+/// @param slice_size_options The bounds and the target latency for adapting
+///        the table slice size to the input rate, or `std::nullopt` to always
+///        use `table_slice_size`.
 caf::behavior
 source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
        size_t table_slice_size, std::optional<size_t> max_events,
        const catalog_actor& catalog, vast::module local_module,
        std::string type_filter, accountant_actor accountant,
-       std::vector<pipeline>&& input_pipelines);
+       std::vector<pipeline>&& input_pipelines,
+       std::optional<table_slice_size_controller::options> slice_size_options);
 
 } // namespace vast::system
@@ -0,0 +1,102 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/defaults.hpp"
+#include "vast/system/instrumentation.hpp"
+#include "vast/time.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vast::system {
+
+/// Adapts the size of the table slices that a SOURCE produces to its input.
+///
+/// The controller measures the rate at which the source produces events over
+/// windows of the target latency, and picks the table slice size such that
+/// filling a slice takes about as long as the target latency. Slices that are
+/// too small for a high-rate input do not amortize the per-slice overhead in
+/// the importer, the index, and the stores, while slices that are too large
+/// for a low-rate input delay the time until events become queryable.
+///
+/// If the source used up all of its credit in every round of a window, the
+/// input outpaces the downstream components and the controller grows the size
+/// regardless of the measured rate. The size changes by a factor of two at
+/// most once per window to avoid oscillation.
+class table_slice_size_controller {
+public:
+  // -- member types -----------------------------------------------------------
+
+  /// The configuration of the controller.
+  struct options {
+    /// The lower bound for the table slice size.
+    size_t min_size = defaults::import::min_table_slice_size;
+
+    /// The upper bound for the table slice size.
+    size_t max_size = defaults::import::max_table_slice_size;
+
+    /// The desired time it takes to fill a table slice.
+    duration target_latency = defaults::import::batch_target_latency;
+  };
+
+  /// The outcome of an observation.
+  enum class decision {
+    keep,
+    grow,
+    shrink,
+  };
+
+  /// Counters for the decisions of the controller.
+  struct statistics {
+    uint64_t grown = 0;
+    uint64_t shrunk = 0;
+  };
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// Constructs a controller.
+  /// @param initial_size The initial table slice size, which gets clamped to
+  ///        the configured bounds.
+  /// @param opts The configuration of the controller.
+  /// @pre `0 < opts.min_size && opts.min_size <= opts.max_size`
+  table_slice_size_controller(size_t initial_size, options opts);
+
+  // -- properties -------------------------------------------------------------
+
+  /// @returns The current table slice size.
+  [[nodiscard]] size_t size() const;
+
+  /// @returns The events per second produced in the last complete window.
+  [[nodiscard]] double rate() const;
+
+  /// Retrieves and resets the decision counters.
+  statistics take_statistics();
+
+  // -- observers --------------------------------------------------------------
+
+  /// Accounts for a round of reading events.
+  /// @param events The number of produced events.
+  /// @param capacity The number of events the round was allowed to produce.
+  /// @param now The current time.
+  /// @returns How the table slice size changed, which it does only at the end
+  ///          of a window.
+  decision observe(size_t events, size_t capacity, stopwatch::time_point now);
+
+private:
+  options options_;
+  size_t size_;
+  double rate_ = 0.0;
+  statistics statistics_ = {};
+  stopwatch::time_point window_start_ = {};
+  uint64_t window_events_ = 0;
+  bool window_saturated_ = true;
+};
+
+} // namespace vast::system
@@ -9,6 +9,8 @@
 #include "vast/aggregation_function.hpp"
 
 #include "vast/arrow_table_slice.hpp"
+#include "vast/data.hpp"
+#include "vast/error.hpp"
 
 namespace vast {
 
@@ -17,6 +19,24 @@ void aggregation_function::add(const arrow::Array& array) {
     add(value);
 }
 
+type aggregation_function::state_type() const {
+  return output_type();
+}
+
+caf::expected<data> aggregation_function::save() const {
+  return caf::make_error(ec::unimplemented,
+                         fmt::format("aggregation function for input type {} "
+                                     "does not support partial aggregation",
+                                     input_type_));
+}
+
+caf::error aggregation_function::merge(const data&) {
+  return caf::make_error(ec::unimplemented,
+                         fmt::format("aggregation function for input type {} "
+                                     "does not support partial aggregation",
+                                     input_type_));
+}
+
 aggregation_function::aggregation_function(type input_type) noexcept
   : input_type_{std::move(input_type)} {
   // nop
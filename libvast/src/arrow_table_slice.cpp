@@ -289,8 +289,19 @@ arrow_table_slice<FlatBuffer>::record_batch() const noexcept {
 
 // -- utility functions -------------------------------------------------------
 
-std::pair<type, std::shared_ptr<arrow::RecordBatch>> transform_columns(
-  type schema, const std::shared_ptr<arrow::RecordBatch>& batch,
+namespace {
+
+/// The current unpacked layer of a transformation, i.e., the pieces required to
+/// re-assemble the current layer of both the record type and the record batch.
+struct unpacked_layer {
+  std::vector<struct record_type::field> fields;
+  arrow::ArrayVector arrays;
+};
+
+/// Applies a list of transformations to the top-level layer of a record batch.
+/// @pre *transformations* must not be empty.
+unpacked_layer transform_layer(
+  const type& schema, const std::shared_ptr<arrow::RecordBatch>& batch,
   const std::vector<indexed_transformation>& transformations) noexcept {
   VAST_ASSERT(batch->schema()->Equals(schema.to_arrow_schema()),
               "VAST schema and Arrow schema must match");
@@ -307,13 +318,6 @@ std::pair<type, std::shared_ptr<arrow::RecordBatch>> transform_columns(
                   }),
               "transformation indices must not be a subset of the following "
               "transformation's index");
-  // The current unpacked layer of the transformation, i.e., the pieces required
-  // to re-assemble the current layer of both the record type and the record
-  // batch.
-  struct unpacked_layer {
-    std::vector<struct record_type::field> fields;
-    arrow::ArrayVector arrays;
-  };
   const auto impl
     = [](const auto& impl, unpacked_layer layer, offset index, auto& current,
          const auto sentinel) noexcept -> unpacked_layer {
@@ -384,8 +388,6 @@ std::pair<type, std::shared_ptr<arrow::RecordBatch>> transform_columns(
     }
     return result;
   };
-  if (transformations.empty())
-    return {schema, batch};
   auto current = transformations.begin();
   const auto sentinel = transformations.end();
   auto layer = unpacked_layer{
@@ -399,37 +401,15 @@ std::pair<type, std::shared_ptr<arrow::RecordBatch>> transform_columns(
   // Run the possibly recursive implementation.
   layer = impl(impl, std::move(layer), {0}, current, sentinel);
   VAST_ASSERT(current == sentinel, "index out of bounds");
-  // Re-assemble the record batch after the transformation.
   VAST_ASSERT(layer.fields.size() == layer.arrays.size());
-  if (layer.fields.empty())
-    return {};
-  auto new_schema = type{record_type{layer.fields}};
-  new_schema.assign_metadata(schema);
-  auto arrow_schema = new_schema.to_arrow_schema();
-  const auto num_rows = layer.arrays[0]->length();
-  return {
-    std::move(new_schema),
-    arrow::RecordBatch::Make(std::move(arrow_schema), num_rows,
-                             std::move(layer.arrays)),
-  };
+  return layer;
 }
 
-table_slice transform_columns(
-  const table_slice& slice,
-  const std::vector<indexed_transformation>& transformations) noexcept {
-  auto [schema, batch] = transform_columns(
-    slice.schema(), to_record_batch(slice), transformations);
-  if (!schema)
-    return {};
-  auto result = table_slice{batch, std::move(schema)};
-  result.offset(slice.offset());
-  result.import_time(slice.import_time());
-  return result;
-}
-
-std::pair<type, std::shared_ptr<arrow::RecordBatch>>
-select_columns(type schema, const std::shared_ptr<arrow::RecordBatch>& batch,
-               const std::vector<offset>& indices) noexcept {
+/// Removes all unspecified columns from the top-level layer of a record batch.
+/// @pre *indices* must not be empty.
+unpacked_layer select_layer(const type& schema,
+                            const std::shared_ptr<arrow::RecordBatch>& batch,
+                            const std::vector<offset>& indices) noexcept {
   VAST_ASSERT(batch->schema()->Equals(schema.to_arrow_schema()),
               "VAST schema and Arrow schema must match");
   VAST_ASSERT(std::is_sorted(indices.begin(), indices.end()), "indices must be "
@@ -444,13 +424,6 @@ select_columns(type schema, const std::shared_ptr<arrow::RecordBatch>& batch,
                               return lhs_mismatch == lhs.end();
                             }),
     "indices must not be a subset of the following index");
-  // The current unpacked layer of the transformation, i.e., the pieces required
-  // to re-assemble the current layer of both the record type and the record
-  // batch.
-  struct unpacked_layer {
-    std::vector<struct record_type::field> fields;
-    arrow::ArrayVector arrays;
-  };
   const auto impl
     = [](const auto& impl, unpacked_layer layer, offset index, auto& current,
          const auto sentinel) noexcept -> unpacked_layer {
@@ -509,8 +482,6 @@ select_columns(type schema, const std::shared_ptr<arrow::RecordBatch>& batch,
     }
     return result;
   };
-  if (indices.empty())
-    return {};
   auto current = indices.begin();
   const auto sentinel = indices.end();
   auto layer = unpacked_layer{
@@ -524,8 +495,13 @@ select_columns(type schema, const std::shared_ptr<arrow::RecordBatch>& batch,
   // Run the possibly recursive implementation, starting at the last field.
   layer = impl(impl, std::move(layer), {0}, current, sentinel);
   VAST_ASSERT(current == sentinel, "index out of bounds");
-  // Re-assemble the record batch after the transformation.
   VAST_ASSERT(layer.fields.size() == layer.arrays.size());
+  return layer;
+}
+
+/// Re-assembles the schema and the record batch from a transformed layer.
+std::pair<type, std::shared_ptr<arrow::RecordBatch>>
+assemble_layer(const type& schema, unpacked_layer layer) noexcept {
   if (layer.fields.empty())
     return {};
   auto new_schema = type{record_type{layer.fields}};
@@ -539,6 +515,69 @@ select_columns(type schema, const std::shared_ptr<arrow::RecordBatch>& batch,
   };
 }
 
+} // namespace
+
+std::pair<type, std::shared_ptr<arrow::RecordBatch>> transform_columns(
+  type schema, const std::shared_ptr<arrow::RecordBatch>& batch,
+  const std::vector<indexed_transformation>& transformations) noexcept {
+  if (transformations.empty())
+    return {schema, batch};
+  auto layer = transform_layer(schema, batch, transformations);
+  return assemble_layer(schema, std::move(layer));
+}
+
+std::shared_ptr<arrow::RecordBatch> transform_columns(
+  const type& schema, const std::shared_ptr<arrow::RecordBatch>& batch,
+  const std::vector<indexed_transformation>& transformations,
+  const std::shared_ptr<arrow::Schema>& result_schema) noexcept {
+  if (transformations.empty())
+    return batch;
+  auto layer = transform_layer(schema, batch, transformations);
+  if (layer.arrays.empty())
+    return {};
+  VAST_ASSERT(result_schema->num_fields()
+              == detail::narrow_cast<int>(layer.arrays.size()));
+  return arrow::RecordBatch::Make(result_schema, batch->num_rows(),
+                                  std::move(layer.arrays));
+}
+
+table_slice transform_columns(
+  const table_slice& slice,
+  const std::vector<indexed_transformation>& transformations) noexcept {
+  auto [schema, batch] = transform_columns(
+    slice.schema(), to_record_batch(slice), transformations);
+  if (!schema)
+    return {};
+  auto result = table_slice{batch, std::move(schema)};
+  result.offset(slice.offset());
+  result.import_time(slice.import_time());
+  return result;
+}
+
+std::pair<type, std::shared_ptr<arrow::RecordBatch>>
+select_columns(type schema, const std::shared_ptr<arrow::RecordBatch>& batch,
+               const std::vector<offset>& indices) noexcept {
+  if (indices.empty())
+    return {};
+  return assemble_layer(schema, select_layer(schema, batch, indices));
+}
+
+std::shared_ptr<arrow::RecordBatch>
+select_columns(const type& schema,
+               const std::shared_ptr<arrow::RecordBatch>& batch,
+               const std::vector<offset>& indices,
+               const std::shared_ptr<arrow::Schema>& result_schema) noexcept {
+  if (indices.empty())
+    return {};
+  auto layer = select_layer(schema, batch, indices);
+  if (layer.arrays.empty())
+    return {};
+  VAST_ASSERT(result_schema->num_fields()
+              == detail::narrow_cast<int>(layer.arrays.size()));
+  return arrow::RecordBatch::Make(result_schema, batch->num_rows(),
+                                  std::move(layer.arrays));
+}
+
 table_slice select_columns(const table_slice& slice,
                            const std::vector<offset>& indices) noexcept {
   auto [schema, batch]
@@ -0,0 +1,115 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/detail/thread_pool.hpp"
+
+#include "vast/detail/assert.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace vast::detail {
+
+namespace {
+
+/// The pool and the index of the worker that runs on the current thread.
+thread_local const thread_pool* current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+} // namespace
+
+thread_pool::thread_pool(size_t num_threads) {
+  if (num_threads == 0)
+    num_threads
+      = std::max(size_t{1}, size_t{std::thread::hardware_concurrency()});
+  queues_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i)
+    queues_.push_back(std::make_unique<queue>());
+  threads_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i)
+    threads_.emplace_back([this, i] {
+      run(i);
+    });
+}
+
+thread_pool::~thread_pool() {
+  {
+    auto lock = std::lock_guard{mutex_};
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto& thread : threads_)
+    thread.join();
+}
+
+size_t thread_pool::size() const {
+  return threads_.size();
+}
+
+void thread_pool::submit(task f) {
+  VAST_ASSERT(f);
+  const auto index = current_pool == this
+                       ? current_index
+                       : next_queue_.fetch_add(1, std::memory_order_relaxed)
+                           % queues_.size();
+  {
+    auto lock = std::lock_guard{queues_[index]->mutex};
+    queues_[index]->tasks.push_back(std::move(f));
+  }
+  // We count the task only after queueing it, so that every worker that
+  // claims a pending task is guaranteed to find one.
+  {
+    auto lock = std::lock_guard{mutex_};
+    ++pending_;
+  }
+  cv_.notify_one();
+}
+
+void thread_pool::run(size_t index) {
+  current_pool = this;
+  current_index = index;
+  while (true) {
+    {
+      auto lock = std::unique_lock{mutex_};
+      cv_.wait(lock, [this] {
+        return pending_ > 0 || stopping_;
+      });
+      if (pending_ == 0)
+        return;
+      --pending_;
+    }
+    auto f = task{};
+    while (!take(index, f))
+      std::this_thread::yield();
+    f();
+  }
+}
+
+bool thread_pool::take(size_t index, task& f) {
+  {
+    auto& own = *queues_[index];
+    auto lock = std::lock_guard{own.mutex};
+    if (!own.tasks.empty()) {
+      f = std::move(own.tasks.front());
+      own.tasks.pop_front();
+      return true;
+    }
+  }
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    auto& victim = *queues_[(index + i) % queues_.size()];
+    auto lock = std::lock_guard{victim.mutex};
+    if (!victim.tasks.empty()) {
+      f = std::move(victim.tasks.back());
+      victim.tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace vast::detail
@@ -0,0 +1,219 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#if !defined(_GNU_SOURCE)
+#  define _GNU_SOURCE // for recvmmsg(2)
+#endif
+
+#include "vast/detail/udp_batch_receiver.hpp"
+
+#include "vast/config.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/error.hpp"
+
+#include <fmt/format.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <utility>
+
+namespace vast::detail {
+
+namespace {
+
+#if VAST_LINUX
+constexpr auto control_size = CMSG_SPACE(sizeof(uint32_t));
+#else
+constexpr auto control_size = size_t{0};
+#endif
+
+} // namespace
+
+caf::expected<udp_batch_receiver>
+udp_batch_receiver::make(uint16_t port, size_t batch_size,
+                         size_t max_datagram_size, bool reuse_port) {
+  VAST_ASSERT(batch_size > 0);
+  VAST_ASSERT(max_datagram_size > 0);
+  auto fail = [](int fd, std::string_view what) {
+    auto err = caf::make_error(ec::system_error,
+                               fmt::format("failed to {}: {}", what,
+                                           std::strerror(errno)));
+    if (fd >= 0)
+      ::close(fd);
+    return err;
+  };
+  auto fd = ::socket(AF_INET6, SOCK_DGRAM, 0);
+  if (fd < 0)
+    return fail(fd, "create UDP socket");
+  // Accept both IPv4 and IPv6 datagrams.
+  int off = 0;
+  if (::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) < 0)
+    return fail(fd, "disable IPV6_V6ONLY");
+  int on = 1;
+  if (reuse_port
+      && ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0)
+    return fail(fd, "set SO_REUSEPORT");
+#if VAST_LINUX
+  if (::setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) < 0)
+    return fail(fd, "set SO_RXQ_OVFL");
+#endif
+  ::sockaddr_in6 addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin6_family = AF_INET6;
+  addr.sin6_addr = in6addr_any;
+  addr.sin6_port = htons(port);
+  if (::bind(fd, reinterpret_cast<::sockaddr*>(&addr), sizeof(addr)) < 0)
+    return fail(fd, fmt::format("bind to UDP port {}", port));
+  return udp_batch_receiver{fd, batch_size, max_datagram_size};
+}
+
+udp_batch_receiver::udp_batch_receiver(int fd, size_t batch_size,
+                                       size_t max_datagram_size)
+  : fd_{fd},
+    batch_size_{batch_size},
+    max_datagram_size_{max_datagram_size},
+    buffer_(batch_size * max_datagram_size),
+    control_(batch_size * control_size),
+    sizes_(batch_size) {
+  // nop
+}
+
+udp_batch_receiver::udp_batch_receiver(udp_batch_receiver&& other) noexcept
+  : fd_{std::exchange(other.fd_, -1)},
+    batch_size_{other.batch_size_},
+    max_datagram_size_{other.max_datagram_size_},
+    buffer_{std::move(other.buffer_)},
+    control_{std::move(other.control_)},
+    sizes_{std::move(other.sizes_)},
+    last_drop_counter_{other.last_drop_counter_},
+    kernel_drops_{other.kernel_drops_} {
+  // nop
+}
+
+udp_batch_receiver&
+udp_batch_receiver::operator=(udp_batch_receiver&& other) noexcept {
+  if (fd_ >= 0)
+    ::close(fd_);
+  fd_ = std::exchange(other.fd_, -1);
+  batch_size_ = other.batch_size_;
+  max_datagram_size_ = other.max_datagram_size_;
+  buffer_ = std::move(other.buffer_);
+  control_ = std::move(other.control_);
+  sizes_ = std::move(other.sizes_);
+  last_drop_counter_ = other.last_drop_counter_;
+  kernel_drops_ = other.kernel_drops_;
+  return *this;
+}
+
+udp_batch_receiver::~udp_batch_receiver() {
+  if (fd_ >= 0)
+    ::close(fd_);
+}
+
+caf::expected<size_t>
+udp_batch_receiver::receive(std::chrono::microseconds timeout) {
+  VAST_ASSERT(fd_ >= 0);
+  auto pfd = ::pollfd{fd_, POLLIN, 0};
+  auto timeout_ms
+    = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+  auto ready = ::poll(&pfd, 1, static_cast<int>(timeout_ms));
+  if (ready < 0) {
+    if (errno == EINTR)
+      return 0u;
+    return caf::make_error(ec::system_error,
+                           fmt::format("failed to poll UDP socket: {}",
+                                       std::strerror(errno)));
+  }
+  if (ready == 0)
+    return 0u;
+#if VAST_LINUX
+  auto iovecs = std::vector<::iovec>(batch_size_);
+  auto headers = std::vector<::mmsghdr>(batch_size_);
+  for (size_t i = 0; i < batch_size_; ++i) {
+    iovecs[i].iov_base = buffer_.data() + i * max_datagram_size_;
+    iovecs[i].iov_len = max_datagram_size_;
+    auto& hdr = headers[i].msg_hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_iov = &iovecs[i];
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control_.data() + i * control_size;
+    hdr.msg_controllen = control_size;
+  }
+  auto received = ::recvmmsg(fd_, headers.data(),
+                             static_cast<unsigned>(batch_size_), MSG_DONTWAIT,
+                             nullptr);
+  if (received < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+      return 0u;
+    return caf::make_error(ec::system_error,
+                           fmt::format("failed to receive UDP datagrams: {}",
+                                       std::strerror(errno)));
+  }
+  for (int i = 0; i < received; ++i) {
+    sizes_[i] = headers[i].msg_len;
+    auto* hdr = &headers[i].msg_hdr;
+    for (auto* cmsg = CMSG_FIRSTHDR(hdr); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+        auto counter = uint32_t{0};
+        std::memcpy(&counter, CMSG_DATA(cmsg), sizeof(counter));
+        update_kernel_drops(counter);
+      }
+    }
+  }
+  return static_cast<size_t>(received);
+#else
+  auto received = size_t{0};
+  while (received < batch_size_) {
+    auto* buf = buffer_.data() + received * max_datagram_size_;
+    auto n = ::recvfrom(fd_, buf, max_datagram_size_, MSG_DONTWAIT, nullptr,
+                        nullptr);
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        break;
+      return caf::make_error(ec::system_error,
+                             fmt::format("failed to receive UDP datagram: {}",
+                                         std::strerror(errno)));
+    }
+    sizes_[received++] = static_cast<size_t>(n);
+  }
+  return received;
+#endif
+}
+
+std::span<const char> udp_batch_receiver::datagram(size_t i) const {
+  VAST_ASSERT(i < batch_size_);
+  return {buffer_.data() + i * max_datagram_size_,
+          std::min(sizes_[i], max_datagram_size_)};
+}
+
+uint16_t udp_batch_receiver::port() const {
+  ::sockaddr_in6 addr;
+  ::socklen_t len = sizeof(addr);
+  if (::getsockname(fd_, reinterpret_cast<::sockaddr*>(&addr), &len) < 0)
+    return 0;
+  return ntohs(addr.sin6_port);
+}
+
+uint64_t udp_batch_receiver::kernel_drops() const {
+  return kernel_drops_;
+}
+
+void udp_batch_receiver::update_kernel_drops(uint32_t counter) {
+  // The counter wraps around, so we accumulate the differences instead.
+  kernel_drops_ += static_cast<uint32_t>(counter - last_drop_counter_);
+  last_drop_counter_ = counter;
+}
+
+} // namespace vast::detail
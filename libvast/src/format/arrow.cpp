@@ -8,8 +8,10 @@
 
 #include "vast/format/arrow.hpp"
 
+#include "vast/chunk.hpp"
 #include "vast/detail/assert.hpp"
 #include "vast/error.hpp"
+#include "vast/table_slice.hpp"
 #include "vast/type.hpp"
 
 #include <arrow/api.h>
@@ -22,6 +24,144 @@
 
 namespace vast::format::arrow {
 
+/// An Arrow OutputStream that collects the written data as a sequence of
+/// chunks. Large buffers become chunks of their own that share ownership of
+/// the buffer, while small writes such as the IPC message headers and padding
+/// get coalesced.
+class ipc_chunk_writer::output_stream final : public ::arrow::io::OutputStream {
+public:
+  /// Buffers smaller than this get copied, because the overhead of an
+  /// additional chunk outweighs the cost of copying them.
+  static constexpr auto min_shared_size = int64_t{4096};
+
+  output_stream() {
+    set_mode(::arrow::io::FileMode::WRITE);
+  }
+
+  ::arrow::Status Close() override {
+    flush_pending();
+    closed_ = true;
+    return ::arrow::Status::OK();
+  }
+
+  bool closed() const override {
+    return closed_;
+  }
+
+  ::arrow::Result<int64_t> Tell() const override {
+    return position_;
+  }
+
+  ::arrow::Status Write(const void* data, int64_t nbytes) override {
+    const auto* first = static_cast<const std::byte*>(data);
+    pending_.insert(pending_.end(), first, first + nbytes);
+    position_ += nbytes;
+    return ::arrow::Status::OK();
+  }
+
+  ::arrow::Status Write(const std::shared_ptr<::arrow::Buffer>& data) override {
+    if (data->size() < min_shared_size)
+      return Write(data->data(), data->size());
+    flush_pending();
+    chunks_.push_back(chunk::make(data));
+    position_ += data->size();
+    return ::arrow::Status::OK();
+  }
+
+  std::vector<chunk_ptr> take() {
+    flush_pending();
+    return std::exchange(chunks_, {});
+  }
+
+private:
+  void flush_pending() {
+    if (!pending_.empty())
+      chunks_.push_back(chunk::make(std::exchange(pending_, {})));
+  }
+
+  std::vector<chunk_ptr> chunks_ = {};
+  std::vector<std::byte> pending_ = {};
+  int64_t position_ = 0;
+  bool closed_ = false;
+};
+
+ipc_chunk_writer::ipc_chunk_writer()
+  : out_{std::make_unique<output_stream>()},
+    options_{::arrow::ipc::IpcWriteOptions::Defaults()} {
+}
+
+ipc_chunk_writer::ipc_chunk_writer(ipc_chunk_writer&&) noexcept = default;
+
+ipc_chunk_writer&
+ipc_chunk_writer::operator=(ipc_chunk_writer&&) noexcept = default;
+
+ipc_chunk_writer::~ipc_chunk_writer() noexcept = default;
+
+caf::expected<ipc_chunk_writer>
+ipc_chunk_writer::make(::arrow::Compression::type compression) {
+  auto result = ipc_chunk_writer{};
+  if (compression != ::arrow::Compression::UNCOMPRESSED) {
+    auto codec = ::arrow::util::Codec::Create(compression);
+    if (!codec.ok())
+      return caf::make_error(ec::invalid_argument,
+                             fmt::format("failed to create codec: {}",
+                                         codec.status().ToString()));
+    result.options_.codec = codec.MoveValueUnsafe();
+  }
+  return result;
+}
+
+caf::error ipc_chunk_writer::write(const table_slice& slice) {
+  if (slice.rows() == 0)
+    return {};
+  auto batch = to_record_batch(slice);
+  VAST_ASSERT(batch != nullptr);
+  if (!batch_writer_ || schema_ != slice.schema()) {
+    if (auto err = close())
+      return err;
+    auto writer_result
+      = ::arrow::ipc::MakeStreamWriter(out_.get(), batch->schema(), options_);
+    if (!writer_result.ok())
+      return caf::make_error(ec::unspecified, "failed to open IPC stream",
+                             writer_result.status().ToString());
+    batch_writer_ = writer_result.MoveValueUnsafe();
+    schema_ = slice.schema();
+  }
+  if (auto status = batch_writer_->WriteRecordBatch(*batch); !status.ok())
+    return caf::make_error(ec::unspecified, "failed to write record batch",
+                           status.ToString());
+  return {};
+}
+
+caf::error ipc_chunk_writer::close() {
+  if (!batch_writer_)
+    return {};
+  auto status = batch_writer_->Close();
+  batch_writer_ = nullptr;
+  if (!status.ok())
+    return caf::make_error(ec::unspecified, "failed to close IPC stream",
+                           status.ToString());
+  return {};
+}
+
+std::vector<chunk_ptr> ipc_chunk_writer::take() {
+  return out_->take();
+}
+
+caf::expected<std::vector<chunk_ptr>>
+to_ipc_streams(std::span<const table_slice> slices,
+               ::arrow::Compression::type compression) {
+  auto writer = ipc_chunk_writer::make(compression);
+  if (!writer)
+    return writer.error();
+  for (const auto& slice : slices)
+    if (auto err = writer->write(slice))
+      return err;
+  if (auto err = writer->close())
+    return err;
+  return writer->take();
+}
+
 writer::writer() {
   out_ = std::make_shared<::arrow::io::StdoutStream>();
 }
@@ -70,6 +210,20 @@ bool writer::schema(const std::shared_ptr<::arrow::Schema>& schema) {
   return false;
 }
 
+caf::expected<::arrow::Compression::type>
+to_ipc_compression(std::string_view name) {
+  if (name == "none")
+    return ::arrow::Compression::UNCOMPRESSED;
+  if (name == "lz4")
+    return ::arrow::Compression::LZ4_FRAME;
+  if (name == "zstd")
+    return ::arrow::Compression::ZSTD;
+  return caf::make_error(ec::invalid_argument,
+                         fmt::format("unknown compression '{}'; expected one "
+                                     "of 'none', 'lz4', or 'zstd'",
+                                     name));
+}
+
 arrow_istream_wrapper::arrow_istream_wrapper(std::shared_ptr<std::istream> input)
   : input_(std::move(input)), pos_(0) {
   set_mode(::arrow::io::FileMode::READ);
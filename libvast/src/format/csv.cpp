@@ -548,7 +548,7 @@ caf::error reader::read_impl(size_t max_events, size_t max_slice_size,
     }
     ++produced;
     ++batch_events_;
-    if (builder_->rows() == max_slice_size)
+    if (builder_->rows() >= max_slice_size)
       if (auto err = finish(callback))
         return err;
   }
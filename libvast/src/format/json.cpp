@@ -19,6 +19,9 @@
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/data.hpp"
 #include "vast/data.hpp"
+#include "vast/detail/escapers.hpp"
+#include "vast/detail/narrow.hpp"
+#include "vast/detail/overload.hpp"
 #include "vast/format/json/default_selector.hpp"
 #include "vast/format/json/field_selector.hpp"
 #include "vast/logger.hpp"
@@ -33,6 +36,12 @@
 #include <caf/expected.hpp>
 #include <caf/none.hpp>
 
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
 namespace vast::format::json {
 
 // -- utility -----------------------------------------------------------------
@@ -1052,10 +1061,194 @@ add(const ::simdjson::dom::object& object, table_slice_builder& builder) {
 
 // -- writer ------------------------------------------------------------------
 
+namespace {
+
+/// The size at which the writer hands its buffer to the output stream, even if
+/// it did not finish printing a table slice.
+constexpr size_t max_buffer_size = 1'024 * 1'024;
+
+/// Checks whether any byte of a word requires escaping in a JSON string, i.e.,
+/// is a control character, a quotation mark, or a reverse solidus. The checks
+/// operate on all eight bytes at once.
+constexpr bool needs_escaping(uint64_t word) {
+  constexpr auto ones = ~uint64_t{0} / 255;
+  constexpr auto highs = ones * 128;
+  auto has_zero = [&](uint64_t x) {
+    return ((x - ones) & ~x & highs) != 0;
+  };
+  auto has_less = [&](uint64_t x, uint64_t n) {
+    return ((x - ones * n) & ~x & highs) != 0;
+  };
+  return has_less(word, 0x20) || has_zero(word ^ (ones * '"'))
+         || has_zero(word ^ (ones * '\\')) || has_zero(word ^ (ones * 0x7f));
+}
+
+/// Appends a quoted and escaped string to a buffer. The output is identical to
+/// printing with the `json_escaper`, but copies runs of characters that need
+/// no escaping in bulk.
+void append_string(std::string& buffer, std::string_view x) {
+  buffer += '"';
+  const auto* first = x.data();
+  const auto* last = x.data() + x.size();
+  const auto* run = first;
+  while (first != last) {
+    if (last - first >= 8) {
+      auto word = uint64_t{};
+      std::memcpy(&word, first, sizeof(word));
+      if (!needs_escaping(word)) {
+        first += 8;
+        continue;
+      }
+    }
+    // Look at the bytes one by one until the end of the word.
+    for (const auto* end = std::min(first + 8, last); first != end; ++first) {
+      const auto c = static_cast<unsigned char>(*first);
+      if (c >= 0x20 && c != '"' && c != '\\' && c != 0x7f)
+        continue;
+      buffer.append(run, first);
+      const auto* f = first;
+      detail::json_escaper(f, std::back_inserter(buffer));
+      run = first + 1;
+    }
+  }
+  buffer.append(run, last);
+  buffer += '"';
+}
+
+/// Appends a double like the `json_printer`.
+void append_double(std::string& buffer, double x) {
+  if (double i; std::modf(x, &i) == 0.0) // NOLINT
+    fmt::format_to(std::back_inserter(buffer), "{}.0", i);
+  else
+    fmt::format_to(std::back_inserter(buffer), "{}", x);
+}
+
+template <class Integer>
+void append_integer(std::string& buffer, Integer x) {
+  char digits[std::numeric_limits<Integer>::digits10 + 2];
+  auto [end, ec] = std::to_chars(std::begin(digits), std::end(digits), x);
+  VAST_ASSERT_CHEAP(ec == std::errc{});
+  buffer.append(digits, end);
+}
+
+template <class Printer, class T>
+void append_quoted(std::string& buffer, const Printer& printer, const T& x) {
+  auto out = std::back_inserter(buffer);
+  *out++ = '"';
+  const auto ok = printer.print(out, x);
+  VAST_ASSERT_CHEAP(ok);
+  *out++ = '"';
+}
+
+} // namespace
+
+struct writer::field_plan {
+  enum class value_kind {
+    boolean,
+    int64,
+    uint64,
+    real,
+    duration,
+    time,
+    string,
+    ip,
+    subnet,
+    record,
+    other,
+  };
+
+  field_plan(vast::type type, std::string name, bool flattened)
+    : type{std::move(type)}, name{std::move(name)} {
+    auto f = detail::overload{
+      [](const bool_type&) {
+        return value_kind::boolean;
+      },
+      [](const int64_type&) {
+        return value_kind::int64;
+      },
+      [](const uint64_type&) {
+        return value_kind::uint64;
+      },
+      [](const double_type&) {
+        return value_kind::real;
+      },
+      [](const duration_type&) {
+        return value_kind::duration;
+      },
+      [](const time_type&) {
+        return value_kind::time;
+      },
+      [](const string_type&) {
+        return value_kind::string;
+      },
+      [](const ip_type&) {
+        return value_kind::ip;
+      },
+      [](const subnet_type&) {
+        return value_kind::subnet;
+      },
+      [](const record_type&) {
+        return value_kind::record;
+      },
+      [](const auto&) {
+        return value_kind::other;
+      },
+    };
+    kind = caf::visit(f, this->type);
+    if (const auto* rt = caf::get_if<record_type>(&this->type)) {
+      for (auto&& field : rt->fields()) {
+        // Flattened records print the full path of their fields, and no
+        // braces except for the outermost record.
+        auto field_name = flattened && !this->name.empty()
+                            ? fmt::format("{}.{}", this->name, field.name)
+                            : std::string{field.name};
+        auto& nested = fields.emplace_back(field.type, std::move(field_name),
+                                           flattened);
+        append_string(nested.key, nested.name);
+        nested.key += ": ";
+      }
+    }
+  }
+
+  /// The type of the field.
+  vast::type type;
+
+  /// The name of the field, which includes the names of the enclosing records
+  /// when flattening.
+  std::string name;
+
+  /// The quoted and escaped name, followed by the separator.
+  std::string key = {};
+
+  /// The way of printing the field.
+  value_kind kind = value_kind::other;
+
+  /// The nested fields for a record.
+  std::vector<field_plan> fields = {};
+};
+
+struct writer::column {
+  column(const field_plan& plan, const arrow::Array& array) : array{&array} {
+    if (plan.kind != field_plan::value_kind::record)
+      return;
+    const auto& struct_array = static_cast<const arrow::StructArray&>(array);
+    fields.reserve(plan.fields.size());
+    for (size_t i = 0; i < plan.fields.size(); ++i)
+      fields.emplace_back(plan.fields[i],
+                          *struct_array.field(detail::narrow_cast<int>(i)));
+  }
+
+  /// The array of the field. Its lifetime is tied to the record batch.
+  const arrow::Array* array;
+
+  /// The columns of the nested fields for a record.
+  std::vector<column> fields = {};
+};
+
 writer::writer(std::unique_ptr<std::ostream> out, const caf::settings& options)
   : super(),
     out_{std::move(out)},
-    printer_{{
+    options_{
       .oneline = true,
       .flattened = get_or(options, "vast.export.json.flatten", false),
       .numeric_durations
@@ -1072,24 +1265,142 @@ writer::writer(std::unique_ptr<std::ostream> out, const caf::settings& options)
       .omit_empty_maps
       = get_or(options, "vast.export.json.omit-empty-maps",
                get_or(options, "vast.export.json.omit-empty", false)),
-    }} {
+    },
+    printer_{options_} {
   // nop
 }
 
+writer::writer(writer&&) noexcept = default;
+
+writer& writer::operator=(writer&&) noexcept = default;
+
+writer::~writer() noexcept = default;
+
 caf::error writer::write(const table_slice& x) {
   auto resolved_slice = resolve_enumerations(x);
-  auto type = caf::get<record_type>(resolved_slice.schema());
+  auto& plan = plans_[resolved_slice.schema()];
+  if (!plan)
+    plan = std::make_unique<field_plan>(resolved_slice.schema(), std::string{},
+                                        options_.flattened);
   auto array = to_record_batch(resolved_slice)->ToStructArray().ValueOrDie();
-  auto out_iter = std::ostream_iterator<char>{out()};
-  for (const auto& row : values(type, *array)) {
-    VAST_ASSERT_CHEAP(row);
-    const auto ok = printer_.print(out_iter, *row);
-    VAST_ASSERT_CHEAP(ok);
-    out_iter = fmt::format_to(out_iter, "\n");
+  const auto root = column{*plan, *array};
+  for (int64_t row = 0; row < array->length(); ++row) {
+    print_record(*plan, root, row);
+    buffer_ += '\n';
+    if (buffer_.size() >= max_buffer_size) {
+      out().write(buffer_.data(),
+                  detail::narrow_cast<std::streamsize>(buffer_.size()));
+      buffer_.clear();
+    }
   }
+  out().write(buffer_.data(),
+              detail::narrow_cast<std::streamsize>(buffer_.size()));
+  buffer_.clear();
   return {};
 }
 
+void writer::print_record(const field_plan& plan, const column& col,
+                          int64_t row) {
+  const auto braces = !options_.flattened || plan.name.empty();
+  if (braces)
+    buffer_ += '{';
+  auto printed_once = false;
+  for (size_t i = 0; i < plan.fields.size(); ++i) {
+    const auto& field = plan.fields[i];
+    const auto& field_col = col.fields[i];
+    if (skip(field, field_col, row))
+      continue;
+    if (printed_once)
+      buffer_ += ", ";
+    printed_once = true;
+    if (options_.flattened && field.kind == field_plan::value_kind::record
+        && !field_col.array->IsNull(row)) {
+      print_record(field, field_col, row);
+    } else {
+      buffer_ += field.key;
+      print_value(field, field_col, row);
+    }
+  }
+  if (braces)
+    buffer_ += '}';
+}
+
+void writer::print_value(const field_plan& plan, const column& col,
+                         int64_t row) {
+  const auto& array = *col.array;
+  if (array.IsNull(row)) {
+    buffer_ += "null";
+    return;
+  }
+  switch (plan.kind) {
+    case field_plan::value_kind::boolean:
+      buffer_ += value_at(bool_type{}, array, row) ? "true" : "false";
+      return;
+    case field_plan::value_kind::int64:
+      append_integer(buffer_, value_at(int64_type{}, array, row));
+      return;
+    case field_plan::value_kind::uint64:
+      append_integer(buffer_, value_at(uint64_type{}, array, row));
+      return;
+    case field_plan::value_kind::real:
+      append_double(buffer_, value_at(double_type{}, array, row));
+      return;
+    case field_plan::value_kind::duration: {
+      const auto x = value_at(duration_type{}, array, row);
+      if (options_.numeric_durations)
+        append_double(
+          buffer_,
+          std::chrono::duration_cast<std::chrono::duration<double>>(x).count());
+      else
+        append_quoted(buffer_, make_printer<duration>{}, x);
+      return;
+    }
+    case field_plan::value_kind::time:
+      append_quoted(buffer_, make_printer<time>{},
+                    value_at(time_type{}, array, row));
+      return;
+    case field_plan::value_kind::string:
+      append_string(buffer_, value_at(string_type{}, array, row));
+      return;
+    case field_plan::value_kind::ip:
+      append_quoted(buffer_, make_printer<ip>{}, value_at(ip_type{}, array, row));
+      return;
+    case field_plan::value_kind::subnet:
+      append_quoted(buffer_, make_printer<subnet>{},
+                    value_at(subnet_type{}, array, row));
+      return;
+    case field_plan::value_kind::record:
+      print_record(plan, col, row);
+      return;
+    case field_plan::value_kind::other: {
+      // Lists and maps are rare enough that the generic printer suffices.
+      auto out = std::back_inserter(buffer_);
+      const auto ok = printer_.print(out, value_at(plan.type, array, row));
+      VAST_ASSERT_CHEAP(ok);
+      return;
+    }
+  }
+}
+
+bool writer::skip(const field_plan& plan, const column& col,
+                  int64_t row) const {
+  if (col.array->IsNull(row))
+    return options_.omit_nulls;
+  switch (plan.kind) {
+    case field_plan::value_kind::record:
+      if (!options_.omit_empty_records)
+        return false;
+      for (size_t i = 0; i < plan.fields.size(); ++i)
+        if (!skip(plan.fields[i], col.fields[i], row))
+          return false;
+      return true;
+    case field_plan::value_kind::other:
+      return printer_.should_skip(value_at(plan.type, *col.array, row));
+    default:
+      return false;
+  }
+}
+
 caf::expected<void> writer::flush() {
   out_->flush();
   return {};
@@ -1233,7 +1544,7 @@ reader::read_impl(size_t max_events, size_t max_slice_size, consumer& cons) {
                                                 err)));
     produced++;
     batch_events_++;
-    if (bptr->rows() == max_slice_size)
+    if (bptr->rows() >= max_slice_size)
       if (auto err = finish(cons, bptr))
         return err;
   }
@@ -318,7 +318,7 @@ reader::read_impl(size_t max_events, size_t max_slice_size, consumer& f) {
                                         std::string{fields[i]}),
                         output_schema_);
       }
-      if (builder_->rows() == max_slice_size)
+      if (builder_->rows() >= max_slice_size)
         if (auto err = finish(f, {}, output_schema_))
           return err;
       ++produced;
@@ -0,0 +1,146 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/http_api.hpp"
+
+#include "vast/detail/string.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace vast {
+
+namespace {
+
+std::string_view trim(std::string_view str) {
+  auto is_space = [](char c) {
+    return c == ' ' || c == '\t';
+  };
+  while (!str.empty() && is_space(str.front()))
+    str.remove_prefix(1);
+  while (!str.empty() && is_space(str.back()))
+    str.remove_suffix(1);
+  return str;
+}
+
+bool iequals(std::string_view lhs, std::string_view rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                    [](char x, char y) {
+                      return ::tolower(x) == ::tolower(y);
+                    });
+}
+
+/// A single entry of an `Accept` header, e.g., `application/json;q=0.5`.
+struct media_range {
+  std::string_view type;
+  std::string_view subtype;
+  double quality = 1.0;
+};
+
+std::vector<media_range> parse_accept(std::string_view accept) {
+  auto result = std::vector<media_range>{};
+  for (auto entry : detail::split(accept, ",")) {
+    auto parts = detail::split(entry, ";");
+    if (parts.empty())
+      continue;
+    auto range = trim(parts[0]);
+    auto slash = range.find('/');
+    if (slash == std::string_view::npos)
+      continue;
+    auto x = media_range{
+      .type = trim(range.substr(0, slash)),
+      .subtype = trim(range.substr(slash + 1)),
+    };
+    for (size_t i = 1; i < parts.size(); ++i) {
+      auto param = trim(parts[i]);
+      if (param.size() > 2 && iequals(param.substr(0, 2), "q="))
+        x.quality = std::strtod(std::string{param.substr(2)}.c_str(), nullptr);
+    }
+    result.push_back(x);
+  }
+  return result;
+}
+
+/// @returns The quality that the most specific matching media range assigns
+/// to a media type, or a negative value if no range matches.
+double quality(const std::vector<media_range>& ranges,
+               std::string_view media_type) {
+  auto slash = media_type.find('/');
+  auto type = media_type.substr(0, slash);
+  auto subtype = media_type.substr(slash + 1);
+  auto result = -1.0;
+  auto specificity = -1;
+  for (const auto& range : ranges) {
+    auto current = -1;
+    if (range.type == "*" && range.subtype == "*")
+      current = 0;
+    else if (iequals(range.type, type) && range.subtype == "*")
+      current = 1;
+    else if (iequals(range.type, type) && iequals(range.subtype, subtype))
+      current = 2;
+    if (current > specificity) {
+      specificity = current;
+      result = range.quality;
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+bool is_streaming(http_content_type type) {
+  switch (type) {
+    case http_content_type::json:
+    case http_content_type::ldjson:
+      return false;
+    case http_content_type::arrow_stream:
+    case http_content_type::ndjson:
+    case http_content_type::event_stream:
+      return true;
+  }
+  // Unreachable.
+  return false;
+}
+
+std::string_view to_media_type(http_content_type type) {
+  switch (type) {
+    case http_content_type::json:
+      return "application/json";
+    case http_content_type::ldjson:
+      return "application/ld+json";
+    case http_content_type::arrow_stream:
+      return "application/vnd.apache.arrow.stream";
+    case http_content_type::ndjson:
+      return "application/x-ndjson";
+    case http_content_type::event_stream:
+      return "text/event-stream";
+  }
+  // Unreachable.
+  return "application/octet-stream";
+}
+
+http_content_type
+negotiate_content_type(const rest_endpoint& endpoint, std::string_view accept) {
+  if (endpoint.alternative_content_types.empty() || trim(accept).empty())
+    return endpoint.content_type;
+  const auto ranges = parse_accept(accept);
+  auto result = endpoint.content_type;
+  auto best = quality(ranges, to_media_type(result));
+  // The default content type wins ties.
+  for (auto alternative : endpoint.alternative_content_types) {
+    auto current = quality(ranges, to_media_type(alternative));
+    if (current > 0.0 && current > best) {
+      result = alternative;
+      best = current;
+    }
+  }
+  return result;
+}
+
+} // namespace vast
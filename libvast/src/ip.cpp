@@ -12,14 +12,11 @@
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/ip.hpp"
 #include "vast/data.hpp"
+#include "vast/ip_pseudonymizer.hpp"
 #include "vast/word.hpp"
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
-#include <openssl/crypto.h>
-#include <openssl/err.h>
-#include <openssl/evp.h>
-#include <openssl/ossl_typ.h>
 #include <sys/socket.h>
 
 #include <cstdlib>
@@ -33,75 +30,12 @@ inline uint32_t bitmask32(size_t bottom_bits) {
   return bottom_bits >= 32 ? 0xffffffff : ((uint32_t{1} << bottom_bits) - 1);
 }
 
-class address_encryptor {
-public:
-  explicit address_encryptor(const std::array<ip::byte_type, 32>& key) {
-    cipher_ = EVP_get_cipherbyname("aes-128-ecb");
-    block_size_ = EVP_CIPHER_block_size(cipher_);
-    pad_ = std::vector<ip::byte_type>(block_size_);
-    auto pad_out_len = 0;
-    EVP_CipherInit_ex(ctx_.get(), cipher_, nullptr, key.data(), nullptr, 1);
-    // use second 16-byte half of key for padding
-    EVP_CipherUpdate(ctx_.get(), pad_.data(), &pad_out_len,
-                     key.data() + block_size_, block_size_);
-  }
-
-  auto operator()(ip::byte_array bytes, size_t byte_offset) {
-    auto bytes_to_encrypt = std::span{bytes.begin() + byte_offset, bytes.end()};
-    auto one_time_pad = generate_one_time_pad(bytes_to_encrypt);
-    for (auto i = size_t{0}; i < bytes_to_encrypt.size(); ++i) {
-      bytes[i + byte_offset] = bytes_to_encrypt[i] ^ one_time_pad[i];
-    }
-    return bytes;
-  }
-
-private:
-  static constexpr inline auto msb_of_byte_mask = 0b10000000;
-  std::unique_ptr<EVP_CIPHER_CTX, std::function<void(EVP_CIPHER_CTX*)>> ctx_
-    = {EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free};
-  const EVP_CIPHER* cipher_ = {};
-  int block_size_ = {};
-  std::vector<ip::byte_type> pad_ = {};
-
-  std::vector<ip::byte_type>
-  generate_one_time_pad(std::span<ip::byte_type> bytes_to_encrypt) {
-    auto out_len = 0;
-    auto cipher_input = std::vector<ip::byte_type>(pad_);
-    auto cipher_output = std::vector<ip::byte_type>(pad_);
-    EVP_CipherUpdate(ctx_.get(), cipher_output.data(), &out_len,
-                     cipher_input.data(), block_size_);
-    auto byte_index = 0;
-    auto bit_index = 0;
-    auto one_time_pad = std::vector<ip::byte_type>(bytes_to_encrypt.size());
-    one_time_pad[byte_index] |= cipher_output[0] & msb_of_byte_mask;
-    for (auto i = size_t{0}; i < bytes_to_encrypt.size() * 8 - 1;) {
-      auto padding_mask = 0xff >> (bit_index + 1);
-      auto original_mask = ~padding_mask;
-      auto padding_byte = pad_[byte_index];
-      auto original_byte = bytes_to_encrypt[byte_index];
-      cipher_input[byte_index]
-        = (original_byte & original_mask) | (padding_byte & padding_mask);
-      EVP_CipherUpdate(ctx_.get(), cipher_output.data(), &out_len,
-                       cipher_input.data(), block_size_);
-      ++i;
-      byte_index = i / 8;
-      bit_index = i % 8;
-      one_time_pad[byte_index]
-        |= (cipher_output[0] & msb_of_byte_mask) >> bit_index;
-    }
-    return one_time_pad;
-  }
-};
-
 } // namespace
 
 ip ip::pseudonymize(
   const ip& original,
   const std::array<byte_type, pseudonymization_seed_array_size>& seed) {
-  auto byte_offset = (original.is_v4() ? 12 : 0);
-  address_encryptor encryptor(seed);
-  auto pseudonymized_bytes = encryptor(original.bytes_, byte_offset);
-  return ip(pseudonymized_bytes);
+  return ip_pseudonymizer{seed, 0}(original);
 }
 
 bool ip::is_v4() const {
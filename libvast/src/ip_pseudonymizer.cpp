@@ -0,0 +1,154 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/ip_pseudonymizer.hpp"
+
+#include "vast/detail/assert.hpp"
+#include "vast/detail/narrow.hpp"
+
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace vast {
+
+namespace {
+
+/// The block size of AES-128.
+constexpr auto block_size = size_t{16};
+
+/// The maximum number of bits of an address.
+constexpr auto max_bits = size_t{128};
+
+/// @returns The n-th most significant bit of a sequence of bytes.
+uint8_t bit(std::span<const ip::byte_type> bytes, size_t n) {
+  return (bytes[n / 8] >> (7 - n % 8)) & 1;
+}
+
+} // namespace
+
+struct ip_pseudonymizer::cipher {
+  /// Encrypts consecutive blocks at once. This lets OpenSSL pipeline the
+  /// blocks through the AES instructions of the CPU if available.
+  void encrypt(const ip::byte_type* input, ip::byte_type* output,
+               size_t num_blocks) {
+    auto output_size = 0;
+    [[maybe_unused]] auto success = EVP_CipherUpdate(
+      ctx.get(), output, &output_size, input,
+      detail::narrow_cast<int>(num_blocks * block_size));
+    VAST_ASSERT(success == 1);
+    VAST_ASSERT(detail::narrow_cast<size_t>(output_size)
+                == num_blocks * block_size);
+  }
+
+  std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> ctx
+    = {EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free};
+  std::array<ip::byte_type, block_size> pad = {};
+};
+
+ip_pseudonymizer::ip_pseudonymizer(const seed_type& seed,
+                                   size_t cache_capacity)
+  : cipher_{std::make_unique<cipher>()}, cache_capacity_{cache_capacity} {
+  const auto* aes = EVP_get_cipherbyname("aes-128-ecb");
+  VAST_ASSERT(aes);
+  VAST_ASSERT(detail::narrow_cast<size_t>(EVP_CIPHER_block_size(aes))
+              == block_size);
+  EVP_CipherInit_ex(cipher_->ctx.get(), aes, nullptr, seed.data(), nullptr, 1);
+  EVP_CIPHER_CTX_set_padding(cipher_->ctx.get(), 0);
+  // Use the second 16-byte half of the seed for padding.
+  cipher_->encrypt(seed.data() + block_size, cipher_->pad.data(), 1);
+  blocks_.resize(max_bits * block_size);
+  encrypted_blocks_.resize(max_bits * block_size);
+}
+
+ip_pseudonymizer::ip_pseudonymizer(ip_pseudonymizer&&) noexcept = default;
+
+ip_pseudonymizer&
+ip_pseudonymizer::operator=(ip_pseudonymizer&&) noexcept = default;
+
+ip_pseudonymizer::~ip_pseudonymizer() noexcept = default;
+
+size_t ip_pseudonymizer::cache_size() const {
+  return trie_.size();
+}
+
+ip ip_pseudonymizer::operator()(const ip& original) {
+  auto bytes = static_cast<ip::byte_array>(original);
+  // Crypto-PAn only encrypts the last four bytes of IPv4 addresses.
+  const auto byte_offset = original.is_v4() ? size_t{12} : size_t{0};
+  const auto bytes_to_encrypt = std::span{bytes}.subspan(byte_offset);
+  auto one_time_pad = ip::byte_array{};
+  make_one_time_pad(bytes_to_encrypt,
+                    std::span{one_time_pad}.first(bytes_to_encrypt.size()));
+  for (size_t i = 0; i < bytes_to_encrypt.size(); ++i)
+    bytes_to_encrypt[i] ^= one_time_pad[i];
+  return ip{bytes};
+}
+
+void ip_pseudonymizer::make_one_time_pad(
+  std::span<const ip::byte_type> bytes, std::span<ip::byte_type> one_time_pad) {
+  const auto num_bits = bytes.size() * 8;
+  VAST_ASSERT(num_bits <= max_bits);
+  VAST_ASSERT(one_time_pad.size() == bytes.size());
+  const auto use_cache = cache_capacity_ >= num_bits;
+  if (use_cache && trie_.size() + num_bits > cache_capacity_)
+    trie_.clear();
+  // Look up the pad bits of the longest memoized prefix. The node at depth n
+  // of the trie holds the pad bit for the n-bit prefix of the address.
+  auto known = size_t{0};
+  auto current = uint32_t{0};
+  if (use_cache && !trie_.empty()) {
+    pad_bits_[known++] = trie_[current].pad_bit;
+    while (known < num_bits) {
+      const auto child = trie_[current].children[bit(bytes, known - 1)];
+      if (child == 0)
+        break;
+      current = child;
+      pad_bits_[known++] = trie_[current].pad_bit;
+    }
+  }
+  // Encrypt the blocks for all remaining prefixes, and memoize their pad bits.
+  encrypt_prefixes(bytes, known, num_bits);
+  if (use_cache) {
+    for (auto depth = known; depth < num_bits; ++depth) {
+      const auto index = detail::narrow_cast<uint32_t>(trie_.size());
+      if (depth > 0)
+        trie_[current].children[bit(bytes, depth - 1)] = index;
+      trie_.push_back({.pad_bit = pad_bits_[depth]});
+      current = index;
+    }
+  }
+  std::fill(one_time_pad.begin(), one_time_pad.end(), ip::byte_type{0});
+  for (size_t depth = 0; depth < num_bits; ++depth)
+    one_time_pad[depth / 8] |= pad_bits_[depth] << (7 - depth % 8);
+}
+
+void ip_pseudonymizer::encrypt_prefixes(std::span<const ip::byte_type> bytes,
+                                        size_t first, size_t last) {
+  if (first == last)
+    return;
+  // The block for the n-bit prefix consists of the first n bits of the
+  // address, followed by the remaining bits of the pad.
+  for (auto depth = first; depth < last; ++depth) {
+    auto* block = blocks_.data() + (depth - first) * block_size;
+    std::memcpy(block, cipher_->pad.data(), block_size);
+    const auto full_bytes = depth / 8;
+    std::memcpy(block, bytes.data(), full_bytes);
+    if (const auto remaining_bits = depth % 8; remaining_bits > 0) {
+      const auto padding_mask = 0xff >> remaining_bits;
+      block[full_bytes] = (bytes[full_bytes] & ~padding_mask)
+                          | (cipher_->pad[full_bytes] & padding_mask);
+    }
+  }
+  cipher_->encrypt(blocks_.data(), encrypted_blocks_.data(), last - first);
+  for (auto depth = first; depth < last; ++depth)
+    pad_bits_[depth] = encrypted_blocks_[(depth - first) * block_size] >> 7;
+}
+
+} // namespace vast
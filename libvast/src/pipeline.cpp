@@ -8,21 +8,567 @@
 
 #include "vast/pipeline.hpp"
 
+#include "vast/arrow_table_slice.hpp"
 #include "vast/concept/parseable/string/char_class.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/detail/narrow.hpp"
+#include "vast/detail/settings.hpp"
 #include "vast/logger.hpp"
 #include "vast/plugin.hpp"
 #include "vast/table_slice_builder.hpp"
 #include "vast/table_slice_encoding.hpp"
 
+#include <arrow/array.h>
+#include <arrow/record_batch.h>
 #include <arrow/type.h>
+#include <arrow/util/byte_size.h>
 #include <caf/expected.hpp>
 #include <caf/none.hpp>
 #include <caf/type_id.hpp>
 
 #include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
 
 namespace vast {
 
+namespace {
+
+/// Creates a record batch without rows for a schema.
+std::shared_ptr<arrow::RecordBatch> make_empty_batch(const type& schema) {
+  auto builder = schema.make_arrow_builder(arrow::default_memory_pool());
+  auto array = builder->Finish().ValueOrDie();
+  return arrow::RecordBatch::Make(
+    schema.to_arrow_schema(), 0,
+    caf::get<type_to_arrow_array_t<record_type>>(*array).fields());
+}
+
+/// Checks whether an index equals another index or is a prefix of it.
+bool is_prefix(const offset& prefix, const offset& index) {
+  return prefix.size() <= index.size()
+         && std::equal(prefix.begin(), prefix.end(), index.begin());
+}
+
+/// Counts the fields that every transformation produces, by applying the
+/// transformations to the columns of a batch without rows.
+std::vector<size_t>
+count_outputs(const type& schema,
+              const std::shared_ptr<arrow::RecordBatch>& batch,
+              const std::vector<indexed_transformation>& transformations) {
+  const auto& layout = caf::get<record_type>(schema);
+  auto result = std::vector<size_t>{};
+  result.reserve(transformations.size());
+  for (const auto& transformation : transformations) {
+    const auto& index = transformation.index;
+    auto array = batch->column(detail::narrow_cast<int>(index[0]));
+    for (size_t i = 1; i < index.size(); ++i)
+      array = caf::get<type_to_arrow_array_t<record_type>>(*array).field(
+        detail::narrow_cast<int>(index[i]));
+    const auto field = layout.field(index);
+    result.push_back(
+      transformation.fun({std::string{field.name}, field.type}, array).size());
+  }
+  return result;
+}
+
+/// Composes two selections into one that selects the columns of the second
+/// selection from the input of the first.
+std::vector<offset> compose_selections(const std::vector<offset>& first,
+                                       const std::vector<offset>& second) {
+  auto result = std::vector<offset>{};
+  for (const auto& index : second) {
+    // Find the selected columns of the first selection below the column of
+    // the second selection, which are sorted and therefore adjacent.
+    auto begin = first.begin();
+    auto end = first.end();
+    auto prefix = offset{};
+    for (size_t depth = 0; depth < index.size(); ++depth) {
+      if (*begin == prefix) {
+        // The first selection keeps the record entirely.
+        prefix.insert(prefix.end(), index.begin() + depth, index.end());
+        break;
+      }
+      for (auto position = index[depth];; --position) {
+        VAST_ASSERT(begin != end);
+        const auto component = (*begin)[depth];
+        const auto next = std::find_if(begin, end, [&](const offset& x) {
+          return x[depth] != component;
+        });
+        if (position == 0) {
+          end = next;
+          prefix.push_back(component);
+          break;
+        }
+        begin = next;
+      }
+    }
+    if (is_prefix(*begin, prefix))
+      result.push_back(std::move(prefix));
+    else
+      result.insert(result.end(), begin, end);
+  }
+  return result;
+}
+
+/// The fused column transformations of consecutive pipeline operators, bound
+/// to a single input schema.
+/// @note Consecutive selections and consecutive transformations compose into
+/// a single pass. A transformation of a nested field of another
+/// transformation's output, or of a record that contains transformed fields,
+/// as well as a transformation that follows a selection or vice versa,
+/// requires a pass of its own.
+struct fused_plan {
+  /// A single pass over the columns of a batch.
+  struct pass {
+    /// The schema of the batches that the pass transforms.
+    type schema = {};
+
+    /// The transformations to apply, if the pass does not select columns.
+    std::vector<indexed_transformation> transformations = {};
+
+    /// The number of fields that every transformation produces.
+    std::vector<size_t> widths = {};
+
+    /// The columns to keep, if the pass selects columns.
+    std::optional<std::vector<offset>> selection = {};
+
+    /// The Arrow schema of the transformed batches.
+    std::shared_ptr<arrow::Schema> result_schema = {};
+  };
+
+  /// The field in the input of a transformation pass that a field of its
+  /// output originates from.
+  struct origin {
+    /// The index of the field in the input.
+    offset index = {};
+
+    /// The transformation that outputs the field and the position of the
+    /// field among its outputs, if a transformation outputs the field.
+    std::optional<std::pair<size_t, size_t>> output = {};
+  };
+
+  /// Returns the index of a transformation of a pass by its index.
+  static std::optional<size_t> find(const pass& x, const offset& index) {
+    const auto it = std::find_if(x.transformations.begin(),
+                                 x.transformations.end(),
+                                 [&](const indexed_transformation& y) {
+                                   return y.index == index;
+                                 });
+    if (it == x.transformations.end())
+      return std::nullopt;
+    return detail::narrow_cast<size_t>(
+      std::distance(x.transformations.begin(), it));
+  }
+
+  /// Returns the number of fields of the output of a pass that a field of its
+  /// input becomes.
+  static size_t
+  width(const pass& x, const type& field_type, const offset& index) {
+    if (auto transformation = find(x, index))
+      return x.widths[*transformation];
+    const auto* layout = caf::get_if<record_type>(&field_type);
+    const auto is_transformed = [&](const indexed_transformation& y) {
+      return is_prefix(index, y.index);
+    };
+    if (!layout
+        || std::none_of(x.transformations.begin(), x.transformations.end(),
+                        is_transformed))
+      return 1;
+    // A record whose fields the pass removes entirely disappears.
+    for (size_t i = 0; i < layout->num_fields(); ++i) {
+      auto nested_index = index;
+      nested_index.push_back(i);
+      if (width(x, layout->field(i).type, nested_index) > 0)
+        return 1;
+    }
+    return 0;
+  }
+
+  /// Finds the origin of a field of the output of a transformation pass.
+  /// @returns The origin, or nullopt if the field is nested in the output of a
+  /// transformation.
+  static std::optional<origin>
+  find_origin(const pass& x, const offset& index) {
+    auto result = origin{};
+    auto current = x.schema;
+    for (size_t depth = 0; depth < index.size(); ++depth) {
+      const auto* layout = caf::get_if<record_type>(&current);
+      if (!layout)
+        return std::nullopt;
+      auto position = index[depth];
+      auto next = std::optional<type>{};
+      for (size_t i = 0; i < layout->num_fields(); ++i) {
+        auto field_index = result.index;
+        field_index.push_back(i);
+        const auto field_type = layout->field(i).type;
+        const auto field_width = width(x, field_type, field_index);
+        if (position >= field_width) {
+          position -= field_width;
+          continue;
+        }
+        result.index = std::move(field_index);
+        if (auto transformation = find(x, result.index)) {
+          if (depth + 1 != index.size())
+            return std::nullopt;
+          result.output = {*transformation, position};
+          return result;
+        }
+        next = field_type;
+        break;
+      }
+      if (!next)
+        return std::nullopt;
+      current = std::move(*next);
+    }
+    return result;
+  }
+
+  /// Composes two consecutive transformation passes into one, if the second
+  /// pass transforms only fields that the first pass leaves untouched or
+  /// outputs directly.
+  static std::optional<pass>
+  compose_transformations(const pass& first, const pass& second) {
+    using function_type = indexed_transformation::function_type;
+    // The transformations of the second pass that apply to the outputs of
+    // every transformation of the first pass, by the position of the output.
+    auto outputs = std::vector<std::vector<std::pair<size_t, function_type>>>(
+      first.transformations.size());
+    auto widths = first.widths;
+    auto entries = std::vector<std::pair<indexed_transformation, size_t>>{};
+    for (size_t i = 0; i < second.transformations.size(); ++i) {
+      const auto& transformation = second.transformations[i];
+      auto origin = find_origin(first, transformation.index);
+      if (!origin)
+        return std::nullopt;
+      if (origin->output) {
+        const auto [index, position] = *origin->output;
+        outputs[index].emplace_back(position, transformation.fun);
+        widths[index] = widths[index] - 1 + second.widths[i];
+        continue;
+      }
+      for (const auto& other : first.transformations)
+        if (is_prefix(origin->index, other.index))
+          return std::nullopt;
+      entries.emplace_back(
+        indexed_transformation{std::move(origin->index), transformation.fun},
+        second.widths[i]);
+    }
+    for (size_t i = 0; i < first.transformations.size(); ++i) {
+      const auto& transformation = first.transformations[i];
+      if (outputs[i].empty()) {
+        entries.emplace_back(transformation, widths[i]);
+        continue;
+      }
+      auto fun = [transform = transformation.fun,
+                  targets = std::move(outputs[i])](
+                   struct record_type::field field,
+                   std::shared_ptr<arrow::Array> array) {
+        auto result = function_type::result_type{};
+        auto next = targets.begin();
+        auto position = size_t{0};
+        for (auto& [output_field, output_array] :
+             transform(std::move(field), std::move(array))) {
+          if (next != targets.end() && next->first == position++) {
+            for (auto& output : next->second(std::move(output_field),
+                                             std::move(output_array)))
+              result.push_back(std::move(output));
+            ++next;
+          } else {
+            result.emplace_back(std::move(output_field),
+                                std::move(output_array));
+          }
+        }
+        return result;
+      };
+      entries.emplace_back(
+        indexed_transformation{transformation.index, std::move(fun)},
+        widths[i]);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const auto& lhs, const auto& rhs) {
+                return lhs.first < rhs.first;
+              });
+    auto result = pass{
+      .schema = first.schema,
+      .result_schema = second.result_schema,
+    };
+    result.transformations.reserve(entries.size());
+    result.widths.reserve(entries.size());
+    for (auto& [transformation, width] : entries) {
+      result.transformations.push_back(std::move(transformation));
+      result.widths.push_back(width);
+    }
+    return result;
+  }
+
+  /// Appends a pass, composing it with the previous pass if possible.
+  void append(pass next) {
+    if (!passes.empty()) {
+      auto& previous = passes.back();
+      if (previous.selection && next.selection) {
+        previous.selection
+          = compose_selections(*previous.selection, *next.selection);
+        previous.result_schema = std::move(next.result_schema);
+        return;
+      }
+      if (!previous.selection && !next.selection) {
+        if (auto composed = compose_transformations(previous, next)) {
+          previous = std::move(*composed);
+          return;
+        }
+      }
+    }
+    passes.push_back(std::move(next));
+  }
+
+  /// Computes the passes and the resulting schemas once by applying the
+  /// column transformations to an empty batch.
+  static caf::expected<fused_plan>
+  make(std::span<const std::unique_ptr<pipeline_operator>> ops,
+       const type& schema) {
+    auto result = fused_plan{};
+    auto current = schema;
+    auto batch = make_empty_batch(schema);
+    for (const auto& op : ops) {
+      auto transformation = op->bind_columns(current);
+      if (!transformation)
+        return std::move(transformation.error());
+      if (transformation->discard) {
+        result.discard = true;
+        return result;
+      }
+      if (!transformation->transformations.empty()) {
+        auto [new_schema, new_batch]
+          = transform_columns(current, batch, transformation->transformations);
+        if (!new_schema) {
+          result.discard = true;
+          return result;
+        }
+        auto widths
+          = count_outputs(current, batch, transformation->transformations);
+        result.append({
+          .schema = std::move(current),
+          .transformations = std::move(transformation->transformations),
+          .widths = std::move(widths),
+          .result_schema = new_batch->schema(),
+        });
+        current = std::move(new_schema);
+        batch = std::move(new_batch);
+      }
+      if (transformation->selection) {
+        auto [new_schema, new_batch]
+          = select_columns(current, batch, *transformation->selection);
+        if (!new_schema) {
+          result.discard = true;
+          return result;
+        }
+        result.append({
+          .schema = std::move(current),
+          .selection = std::move(transformation->selection),
+          .result_schema = new_batch->schema(),
+        });
+        current = std::move(new_schema);
+        batch = std::move(new_batch);
+      }
+      if (transformation->schema_name) {
+        auto rename_schema = [&](const concrete_type auto& pruned_schema) {
+          VAST_ASSERT(!current.has_attributes());
+          return type{*transformation->schema_name, pruned_schema};
+        };
+        current = caf::visit(rename_schema, current);
+        batch = arrow::RecordBatch::Make(current.to_arrow_schema(), 0,
+                                         batch->columns());
+      }
+    }
+    result.identity = result.passes.empty() && current == schema;
+    result.arrow_schema = current.to_arrow_schema();
+    result.schema = std::move(current);
+    return result;
+  }
+
+  /// Transforms a batch of the bound schema.
+  [[nodiscard]] table_slice apply(table_slice slice) const {
+    if (discard)
+      return {};
+    if (identity)
+      return slice;
+    auto batch = to_record_batch(slice);
+    for (const auto& pass : passes) {
+      batch = pass.selection
+                ? select_columns(pass.schema, batch, *pass.selection,
+                                 pass.result_schema)
+                : transform_columns(pass.schema, batch, pass.transformations,
+                                    pass.result_schema);
+      if (!batch)
+        return {};
+    }
+    auto result = table_slice{
+      arrow::RecordBatch::Make(arrow_schema, batch->num_rows(),
+                               batch->columns()),
+      schema,
+    };
+    result.offset(slice.offset());
+    result.import_time(slice.import_time());
+    return result;
+  }
+
+  /// Whether the operators drop batches of the schema entirely.
+  bool discard = false;
+
+  /// Whether the operators leave batches of the schema unchanged.
+  bool identity = false;
+
+  /// The passes over the columns, in order.
+  std::vector<pass> passes = {};
+
+  /// The schema of the transformed batches.
+  type schema = {};
+
+  /// The Arrow schema of the transformed batches.
+  std::shared_ptr<arrow::Schema> arrow_schema = {};
+};
+
+/// Consecutive pipeline operators that transform columns, fused into a single
+/// operator. The operator binds the column transformations to every schema
+/// only once, and then applies them to every batch without creating
+/// intermediate table slices.
+class fused_pipeline_operator final : public stateless_pipeline_operator {
+public:
+  explicit fused_pipeline_operator(
+    std::vector<std::unique_ptr<pipeline_operator>> ops)
+    : operators_{std::move(ops)} {
+    VAST_ASSERT(!operators_.empty());
+  }
+
+  [[nodiscard]] caf::expected<table_slice>
+  apply(table_slice slice) const override {
+    auto plan = bind(slice.schema());
+    if (!plan)
+      return std::move(plan.error());
+    return (*plan)->apply(std::move(slice));
+  }
+
+  [[nodiscard]] std::vector<system::data_point> take_metrics() override {
+    auto result = std::vector<system::data_point>{};
+    for (auto& op : operators_) {
+      auto metrics = op->take_metrics();
+      result.insert(result.end(), std::make_move_iterator(metrics.begin()),
+                    std::make_move_iterator(metrics.end()));
+    }
+    return result;
+  }
+
+private:
+  /// Retrieves the plan for a schema from the cache, or creates it.
+  caf::expected<std::shared_ptr<const fused_plan>>
+  bind(const type& schema) const {
+    {
+      auto lock = std::lock_guard{mutex_};
+      if (auto it = plans_.find(schema); it != plans_.end())
+        return it->second;
+    }
+    auto plan = fused_plan::make(operators_, schema);
+    if (!plan)
+      return std::move(plan.error());
+    auto lock = std::lock_guard{mutex_};
+    auto [it, _] = plans_.try_emplace(
+      type{chunk::copy(schema)},
+      std::make_shared<const fused_plan>(std::move(*plan)));
+    return it->second;
+  }
+
+  /// The fused operators.
+  std::vector<std::unique_ptr<pipeline_operator>> operators_ = {};
+
+  /// Protects the cache of plans, which threads share when transforming
+  /// batches concurrently.
+  mutable std::mutex mutex_ = {};
+
+  /// The plans per input schema.
+  mutable std::unordered_map<type, std::shared_ptr<const fused_plan>> plans_
+    = {};
+};
+
+/// Returns the thread pool that all pipelines of the process share, creating
+/// it if no pipeline uses it currently.
+std::shared_ptr<detail::thread_pool> shared_thread_pool(size_t threads) {
+  static auto mutex = std::mutex{};
+  static auto pool = std::weak_ptr<detail::thread_pool>{};
+  auto lock = std::lock_guard{mutex};
+  if (auto result = pool.lock())
+    return result;
+  auto result = std::make_shared<detail::thread_pool>(threads);
+  pool = result;
+  return result;
+}
+
+/// The batches that a pipeline transforms concurrently. Every thread takes
+/// the next batch in order, as long as the batches in flight fit into the
+/// memory budget.
+struct morsel_queue {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<table_slice> slices;
+  std::vector<uint64_t> sizes;
+  std::vector<caf::error> errors;
+  std::function<caf::error(table_slice&)> transform;
+  uint64_t memory_budget = 0;
+  uint64_t in_flight = 0;
+  size_t next = 0;
+  size_t done = 0;
+
+  /// Transforms batches until no batches are left to take.
+  void run() {
+    while (true) {
+      auto index = size_t{0};
+      {
+        auto lock = std::unique_lock{mutex};
+        cv.wait(lock, [this] {
+          return next == slices.size() || in_flight == 0
+                 || in_flight + sizes[next] <= memory_budget;
+        });
+        if (next == slices.size())
+          return;
+        index = next++;
+        in_flight += sizes[index];
+      }
+      errors[index] = transform(slices[index]);
+      {
+        auto lock = std::lock_guard{mutex};
+        in_flight -= sizes[index];
+        ++done;
+      }
+      cv.notify_all();
+    }
+  }
+};
+
+} // namespace
+
+caf::expected<pipeline_parallelism>
+pipeline_parallelism::make(const caf::settings& settings) {
+  auto threads = caf::get_or(settings, "vast.pipeline-threads",
+                             static_cast<int64_t>(
+                               defaults::system::pipeline_threads));
+  if (threads < 0)
+    return caf::make_error(ec::invalid_configuration,
+                           fmt::format("vast.pipeline-threads must not be "
+                                       "negative, got {}",
+                                       threads));
+  auto memory_budget
+    = detail::get_bytesize(settings, "vast.pipeline-memory-budget",
+                           defaults::system::pipeline_memory_budget);
+  if (!memory_budget)
+    return std::move(memory_budget.error());
+  return pipeline_parallelism{
+    .threads = static_cast<size_t>(threads),
+    .memory_budget = *memory_budget,
+  };
+}
+
 caf::expected<pipeline> pipeline::parse(std::string name, std::string_view repr,
                                         std::vector<std::string> schema_names) {
   auto result = pipeline{std::move(name), std::move(schema_names)};
@@ -71,6 +617,36 @@ void pipeline::add_operator(std::unique_ptr<pipeline_operator> op) {
   operators_.emplace_back(std::move(op));
 }
 
+void pipeline::parallelize(const pipeline_parallelism& parallelism) {
+  if (parallelism.threads == 1) {
+    thread_pool_ = {};
+    return;
+  }
+  thread_pool_ = shared_thread_pool(parallelism.threads);
+  memory_budget_ = parallelism.memory_budget;
+}
+
+void pipeline::fuse_operators() {
+  auto result = std::vector<std::unique_ptr<pipeline_operator>>{};
+  const auto transforms_columns = [](const auto& op) {
+    return op->transforms_columns();
+  };
+  auto first = operators_.begin();
+  while (first != operators_.end()) {
+    if (!transforms_columns(*first)) {
+      result.push_back(std::move(*first++));
+      continue;
+    }
+    const auto last
+      = std::find_if_not(first, operators_.end(), transforms_columns);
+    result.push_back(std::make_unique<fused_pipeline_operator>(
+      std::vector<std::unique_ptr<pipeline_operator>>{
+        std::make_move_iterator(first), std::make_move_iterator(last)}));
+    first = last;
+  }
+  operators_ = std::move(result);
+}
+
 const std::string& pipeline::name() const {
   return name_;
 }
@@ -85,6 +661,100 @@ bool pipeline::is_aggregate() const {
   });
 }
 
+bool pipeline::requires_end_of_stream() const {
+  return std::any_of(operators_.begin(), operators_.end(), [](const auto& op) {
+    return op->is_aggregate() && !op->is_incremental();
+  });
+}
+
+record pipeline_pushdown_plan::explain() const {
+  auto operators = list{};
+  operators.reserve(store_operators.size());
+  for (const auto& op : store_operators)
+    operators.emplace_back(record{
+      {"name", op.name},
+      {"options", op.options},
+    });
+  return record{
+    {"filter", filter ? data{fmt::to_string(*filter)} : data{}},
+    {"store-operators", std::move(operators)},
+    {"limit", limit > 0 ? data{limit} : data{}},
+    {"merge-partials", merge_partials},
+  };
+}
+
+caf::expected<pipeline>
+pipeline::make(std::string name,
+               std::span<const pipeline_operator_definition> definitions) {
+  auto result = pipeline{std::move(name), {}};
+  for (const auto& definition : definitions) {
+    auto op = make_pipeline_operator(definition.name, definition.options);
+    if (!op)
+      return std::move(op.error());
+    result.add_operator(std::move(*op));
+  }
+  return result;
+}
+
+pipeline_pushdown_plan pipeline::push_down() {
+  auto result = pipeline_pushdown_plan{};
+  // The query runs before the pipeline could filter by schema, so only
+  // pipelines that apply to all schemas can be pushed down.
+  if (!schema_names_.empty())
+    return result;
+  // The query engine filters before applying the store operators, and limits
+  // the events last. Every operator that we move must fit into that order
+  // after the operators that we already moved.
+  auto pushed = operators_.begin();
+  for (; pushed != operators_.end(); ++pushed) {
+    const auto pushdown = (*pushed)->pushdown();
+    if (!pushdown)
+      break;
+    if (pushdown->filter) {
+      if (!result.store_operators.empty() || result.limit > 0)
+        break;
+      if (result.filter)
+        result.filter
+          = conjunction{std::move(*result.filter), *pushdown->filter};
+      else
+        result.filter = pushdown->filter;
+    } else if (pushdown->store_operator) {
+      if (result.limit > 0)
+        break;
+      result.store_operators.push_back(*pushdown->store_operator);
+    } else if (pushdown->limit) {
+      if (*pushdown->limit == 0)
+        break;
+      result.limit = result.limit > 0
+                       ? std::min(result.limit, *pushdown->limit)
+                       : *pushdown->limit;
+    }
+  }
+  operators_.erase(operators_.begin(), pushed);
+  if (result.limit == 0 && !operators_.empty()) {
+    if (auto partial = operators_.front()->split_partial()) {
+      result.store_operators.push_back(std::move(*partial));
+      result.merge_partials = true;
+    }
+  }
+  return result;
+}
+
+void pipeline::end_stream() {
+  for (auto& op : operators_)
+    op->end_stream();
+}
+
+std::vector<system::data_point> pipeline::take_metrics() {
+  auto result = std::vector<system::data_point>{};
+  for (auto& op : operators_) {
+    auto metrics = op->take_metrics();
+    result.insert(result.end(), std::make_move_iterator(metrics.begin()),
+                  std::make_move_iterator(metrics.end()));
+  }
+  return result;
+}
+
 bool pipeline::applies_to(std::string_view event_name) const {
   return schema_names_.empty()
          || std::find(schema_names_.begin(), schema_names_.end(), event_name)
@@ -182,11 +852,105 @@ pipeline::process_queue(pipeline_operator& op, std::vector<table_slice>& result,
   return caf::none;
 }
 
+caf::error pipeline::process_queue_parallel(
+  std::span<const std::unique_ptr<pipeline_operator>> ops,
+  std::vector<table_slice>& result) {
+  VAST_ASSERT(thread_pool_);
+  auto queue = std::make_shared<morsel_queue>();
+  queue->slices.reserve(to_transform_.size());
+  queue->sizes.reserve(to_transform_.size());
+  // As in the sequential case, the transform does not change slices of
+  // unconfigured event types.
+  auto skipped = std::vector<table_slice>{};
+  for (auto& slice : to_transform_) {
+    if (!applies_to(slice.schema().name())) {
+      skipped.push_back(std::move(slice));
+      continue;
+    }
+    queue->sizes.push_back(arrow::util::TotalBufferSize(
+      *to_record_batch(slice)));
+    queue->slices.push_back(std::move(slice));
+  }
+  to_transform_.clear();
+  queue->errors.resize(queue->slices.size());
+  queue->memory_budget = memory_budget_;
+  queue->transform = [ops](table_slice& slice) -> caf::error {
+    for (const auto& op : ops) {
+      const auto& stateless
+        = static_cast<const stateless_pipeline_operator&>(*op);
+      auto transformed = stateless.apply(std::move(slice));
+      if (!transformed) {
+        slice = {};
+        return caf::make_error(
+          static_cast<vast::ec>(transformed.error().code()),
+          fmt::format("transform aborts because of an error: {}",
+                      transformed.error()));
+      }
+      slice = std::move(*transformed);
+      if (slice.rows() == 0)
+        break;
+    }
+    return caf::none;
+  };
+  // The calling thread transforms batches as well, so we only need helpers
+  // for the remaining batches. Helpers that start late find no work left and
+  // return immediately; they must not touch anything but the queue.
+  const auto helpers
+    = std::min(thread_pool_->size(), queue->slices.size()) - 1;
+  for (size_t i = 0; i < helpers; ++i)
+    thread_pool_->submit([queue] {
+      queue->run();
+    });
+  if (!queue->slices.empty()) {
+    queue->run();
+    auto lock = std::unique_lock{queue->mutex};
+    queue->cv.wait(lock, [&] {
+      return queue->done == queue->slices.size();
+    });
+  }
+  for (auto& slice : skipped)
+    result.push_back(std::move(slice));
+  for (size_t i = 0; i < queue->slices.size(); ++i) {
+    if (queue->errors[i]) {
+      to_transform_.clear();
+      return std::move(queue->errors[i]);
+    }
+    if (queue->slices[i].rows() > 0)
+      to_transform_.push_back(std::move(queue->slices[i]));
+  }
+  return caf::none;
+}
+
 caf::expected<std::vector<table_slice>> pipeline::finish_batch() {
   VAST_DEBUG("applying {} pipeline {}", operators_.size(), name_);
   bool first_run = true;
   std::vector<table_slice> result{};
-  for (const auto& op : operators_) {
+  // We fuse the operators only once the first batch arrives, after the
+  // pipeline had the chance to push operators down into the query.
+  if (!fused_) {
+    fuse_operators();
+    fused_ = true;
+  }
+  auto first = operators_.begin();
+  // The leading stateless operators transform every batch independently, so
+  // we can run them on multiple batches at once.
+  if (thread_pool_ && to_transform_.size() > 1) {
+    const auto last
+      = std::find_if_not(operators_.begin(), operators_.end(),
+                         [](const auto& op) {
+                           return op->is_stateless();
+                         });
+    if (first != last) {
+      auto failed = process_queue_parallel({first, last}, result);
+      if (failed) {
+        to_transform_.clear();
+        return failed;
+      }
+      first = last;
+      first_run = false;
+    }
+  }
+  for (const auto& op : std::span{first, operators_.end()}) {
     auto failed = process_queue(*op, result, first_run);
     first_run = false;
     if (failed) {
@@ -218,7 +982,7 @@ caf::error
 pipeline_executor::validate(enum allow_aggregate_pipelines allow_aggregates) {
   const auto first_aggregate = std::find_if(
     pipelines_.begin(), pipelines_.end(), [](const auto& pipeline) {
-      return pipeline.is_aggregate();
+      return pipeline.requires_end_of_stream();
     });
   bool is_aggregate = first_aggregate != pipelines_.end();
   auto is_aggregate_allowed
@@ -231,6 +995,17 @@ pipeline_executor::validate(enum allow_aggregate_pipelines allow_aggregates) {
   return caf::none;
 }
 
+void pipeline_executor::parallelize(const pipeline_parallelism& parallelism) {
+  for (auto& pipeline : pipelines_)
+    pipeline.parallelize(parallelism);
+}
+
+pipeline_pushdown_plan pipeline_executor::push_down() {
+  if (pipelines_.size() != 1)
+    return {};
+  return pipelines_.front().push_down();
+}
+
 /// Apply relevant pipelines to the table slice.
 caf::error pipeline_executor::add(table_slice&& x) {
   VAST_TRACE("pipeline engine adds a slice");
@@ -315,11 +1090,40 @@ caf::expected<std::vector<table_slice>> pipeline_executor::finish() {
       result.push_back(std::move(slice));
     queue.clear();
   }
+  // At the end of the stream, the operators may yield results independently
+  // of any input. These pass through all later pipelines, which skip the
+  // slices of schemas that they do not apply to.
+  if (std::exchange(ended_, false)) {
+    auto queue = std::deque<table_slice>{};
+    for (auto& pipeline : pipelines_) {
+      auto failed = process_queue(pipeline, queue);
+      if (failed)
+        return failed;
+    }
+    for (auto& slice : queue)
+      result.push_back(std::move(slice));
+  }
   return result;
 }
 
+void pipeline_executor::end_stream() {
+  for (auto& pipeline : pipelines_)
+    pipeline.end_stream();
+  ended_ = true;
+}
+
 const std::vector<pipeline>& pipeline_executor::pipelines() {
   return pipelines_;
 }
 
+std::vector<system::data_point> pipeline_executor::take_metrics() {
+  auto result = std::vector<system::data_point>{};
+  for (auto& pipeline : pipelines_) {
+    auto metrics = pipeline.take_metrics();
+    result.insert(result.end(), std::make_move_iterator(metrics.begin()),
+                  std::make_move_iterator(metrics.end()));
+  }
+  return result;
+}
+
 } // namespace vast
@@ -8,6 +8,9 @@
 
 #include "vast/pipeline_operator.hpp"
 
+#include "vast/arrow_table_slice.hpp"
+#include "vast/cast.hpp"
+#include "vast/detail/assert.hpp"
 #include "vast/error.hpp"
 #include "vast/plugin.hpp"
 
@@ -15,6 +18,41 @@
 
 namespace vast {
 
+table_slice transform_columns(table_slice slice,
+                              const column_transformation& transformation) {
+  if (transformation.discard)
+    return {};
+  if (!transformation.transformations.empty())
+    slice = transform_columns(slice, transformation.transformations);
+  if (transformation.selection && slice.rows() > 0)
+    slice = select_columns(slice, *transformation.selection);
+  if (transformation.schema_name && slice.rows() > 0) {
+    auto rename_schema = [&](const concrete_type auto& pruned_schema) {
+      VAST_ASSERT(!slice.schema().has_attributes());
+      return type{*transformation.schema_name, pruned_schema};
+    };
+    auto renamed_schema = caf::visit(rename_schema, slice.schema());
+    slice = cast(std::move(slice), renamed_schema);
+  }
+  return slice;
+}
+
+caf::expected<column_transformation>
+pipeline_operator::bind_columns(const type& schema) const {
+  return caf::make_error(ec::logic_error,
+                         fmt::format("pipeline operator does not transform "
+                                     "columns of schema {}",
+                                     schema));
+}
+
+caf::expected<table_slice>
+column_pipeline_operator::apply(table_slice slice) const {
+  auto transformation = bind_columns(slice.schema());
+  if (!transformation)
+    return std::move(transformation.error());
+  return transform_columns(std::move(slice), *transformation);
+}
+
 // TODO: It would be more consistent with the rest of the code base to have a
 // `pipeline_operator_factory` to create the steps. All pipeline operators from
 // plugins would be registered at startup. However, that will require some more
@@ -24,7 +24,9 @@ std::size_t memusage(const std::vector<query_queue::entry>& entries) {
 
 bool operator<(const query_queue::entry& lhs,
                const query_queue::entry& rhs) noexcept {
-  return lhs.priority < rhs.priority;
+  if (lhs.priority != rhs.priority)
+    return lhs.priority < rhs.priority;
+  return lhs.max_import_time < rhs.max_import_time;
 }
 
 bool operator==(const query_queue::entry& lhs, const uuid& rhs) noexcept {
@@ -110,7 +112,7 @@ query_queue::insert(query_state&& query_state,
       partitions.push_back(query_queue::entry{
         cand.uuid, schema,
         query_state_it->second.query_contexts_per_type.begin()->second.priority,
-        std::vector{qid}, false});
+        std::vector{qid}, false, cand.max_import_time});
     }
   }
   // TODO: Insertion sort should be better.
@@ -187,10 +189,10 @@ std::optional<query_queue::entry> query_queue::next() {
   while (!partitions.empty()) {
     auto result = std::move(partitions.back());
     partitions.pop_back();
-    auto active
-      = entry{result.partition, result.schema, 0ull, {}, result.erased};
-    auto inactive
-      = entry{result.partition, result.schema, 0ull, {}, result.erased};
+    auto active = entry{result.partition, result.schema, 0ull, {},
+                        result.erased, result.max_import_time};
+    auto inactive = entry{result.partition, result.schema, 0ull, {},
+                          result.erased, result.max_import_time};
     std::partition_copy(
       std::make_move_iterator(result.queries.begin()),
       std::make_move_iterator(result.queries.end()),
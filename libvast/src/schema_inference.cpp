@@ -0,0 +1,505 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/schema_inference.hpp"
+
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/ip.hpp"
+#include "vast/concept/parseable/vast/subnet.hpp"
+#include "vast/concept/parseable/vast/time.hpp"
+#include "vast/detail/narrow.hpp"
+#include "vast/error.hpp"
+#include "vast/hash/hash.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <bit>
+#include <condition_variable>
+#include <deque>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+namespace vast {
+
+namespace {
+
+/// Estimates the number of distinct values from the k smallest hash values
+/// that were observed (KMV). Two sketches merge by keeping the k smallest
+/// values of their union, which yields the same sketch as observing all
+/// values in a single sketch.
+class distinct_sketch {
+public:
+  static constexpr size_t k = 256;
+
+  void add(uint64_t digest) {
+    if (digests_.size() == k && digest >= digests_.back())
+      return;
+    auto it = std::lower_bound(digests_.begin(), digests_.end(), digest);
+    if (it != digests_.end() && *it == digest)
+      return;
+    digests_.insert(it, digest);
+    if (digests_.size() > k)
+      digests_.pop_back();
+  }
+
+  void merge(const distinct_sketch& other) {
+    auto result = std::vector<uint64_t>{};
+    result.reserve(digests_.size() + other.digests_.size());
+    std::set_union(digests_.begin(), digests_.end(), other.digests_.begin(),
+                   other.digests_.end(), std::back_inserter(result));
+    if (result.size() > k)
+      result.resize(k);
+    digests_ = std::move(result);
+  }
+
+  [[nodiscard]] uint64_t estimate() const {
+    // Below k distinct values, the sketch counts exactly.
+    if (digests_.size() < k)
+      return digests_.size();
+    constexpr auto range
+      = static_cast<double>(std::numeric_limits<uint64_t>::max());
+    const auto fraction = static_cast<double>(digests_.back()) / range;
+    return static_cast<uint64_t>(static_cast<double>(k - 1) / fraction);
+  }
+
+private:
+  std::vector<uint64_t> digests_ = {};
+};
+
+/// The kinds of values that a node observed, as bits of a mask.
+enum kind : uint16_t {
+  null_kind = 1 << 0,
+  bool_kind = 1 << 1,
+  int64_kind = 1 << 2,
+  uint64_kind = 1 << 3,
+  double_kind = 1 << 4,
+  string_kind = 1 << 5,
+  ip_kind = 1 << 6,
+  subnet_kind = 1 << 7,
+  time_kind = 1 << 8,
+  duration_kind = 1 << 9,
+  list_kind = 1 << 10,
+  record_kind = 1 << 11,
+};
+
+uint16_t classify(std::string_view x) {
+  const auto str = std::string{x};
+  if (parsers::net(str))
+    return subnet_kind;
+  if (parsers::ip(str))
+    return ip_kind;
+  if (parsers::ymdhms(str))
+    return time_kind;
+  if (parsers::duration(str))
+    return duration_kind;
+  return string_kind;
+}
+
+} // namespace
+
+struct schema_inference::node {
+  explicit node(std::string name = {}) : name{std::move(name)} {
+    // nop
+  }
+
+  /// The name of the field, if the node belongs to a record.
+  std::string name;
+
+  /// The position of the document that first contained the node, which
+  /// orders the fields of a record deterministically after merging.
+  uint64_t first = std::numeric_limits<uint64_t>::max();
+
+  /// The number of observed values, including nulls.
+  uint64_t count = 0;
+
+  /// The number of observed nulls.
+  uint64_t nulls = 0;
+
+  /// The number of observed objects.
+  uint64_t records = 0;
+
+  /// The kinds of the observed values.
+  uint16_t kinds = 0;
+
+  /// Whether any signed integer was negative.
+  bool negative = false;
+
+  /// The fields of observed objects.
+  std::vector<std::unique_ptr<node>> fields = {};
+
+  /// Maps field names to their position in `fields`.
+  std::unordered_map<std::string_view, size_t> field_index = {};
+
+  /// The elements of observed arrays.
+  std::unique_ptr<node> element = {};
+
+  /// The distinct scalar values.
+  distinct_sketch distinct = {};
+
+  node& field(std::string_view key) {
+    if (auto it = field_index.find(key); it != field_index.end())
+      return *fields[it->second];
+    auto& result = fields.emplace_back(std::make_unique<node>(std::string{key}));
+    // The key points into the node, which does not move.
+    field_index.emplace(result->name, fields.size() - 1);
+    return *result;
+  }
+
+  void observe(const ::simdjson::dom::element& x, uint64_t position) {
+    first = std::min(first, position);
+    ++count;
+    switch (x.type()) {
+      case ::simdjson::dom::element_type::ARRAY:
+        kinds |= list_kind;
+        if (!element)
+          element = std::make_unique<node>();
+        for (auto y : x.get_array())
+          element->observe(y, position);
+        break;
+      case ::simdjson::dom::element_type::OBJECT:
+        kinds |= record_kind;
+        ++records;
+        for (auto [key, value] : x.get_object())
+          field(key).observe(value, position);
+        break;
+      case ::simdjson::dom::element_type::INT64: {
+        const auto value = x.get_int64().value();
+        kinds |= int64_kind;
+        negative = negative || value < 0;
+        distinct.add(hash(value));
+        break;
+      }
+      case ::simdjson::dom::element_type::UINT64:
+        kinds |= uint64_kind;
+        distinct.add(hash(x.get_uint64().value()));
+        break;
+      case ::simdjson::dom::element_type::DOUBLE:
+        kinds |= double_kind;
+        distinct.add(hash(std::bit_cast<uint64_t>(x.get_double().value())));
+        break;
+      case ::simdjson::dom::element_type::STRING: {
+        const auto value = x.get_string().value();
+        // Once a plain string was observed, the field ends up as a string
+        // anyway, so we can skip the expensive classification.
+        kinds |= (kinds & string_kind) ? string_kind : classify(value);
+        distinct.add(hash(value));
+        break;
+      }
+      case ::simdjson::dom::element_type::BOOL:
+        kinds |= bool_kind;
+        distinct.add(hash(x.get_bool().value()));
+        break;
+      case ::simdjson::dom::element_type::NULL_VALUE:
+        kinds |= null_kind;
+        ++nulls;
+        break;
+    }
+  }
+
+  void merge(node&& other) {
+    first = std::min(first, other.first);
+    count += other.count;
+    nulls += other.nulls;
+    records += other.records;
+    kinds |= other.kinds;
+    negative = negative || other.negative;
+    distinct.merge(other.distinct);
+    for (auto& x : other.fields) {
+      if (auto it = field_index.find(x->name); it != field_index.end()) {
+        fields[it->second]->merge(std::move(*x));
+      } else {
+        auto& result = fields.emplace_back(std::move(x));
+        field_index.emplace(result->name, fields.size() - 1);
+      }
+    }
+    if (other.element) {
+      if (element)
+        element->merge(std::move(*other.element));
+      else
+        element = std::move(other.element);
+    }
+  }
+
+  /// @returns The fields in the order of their first occurrence.
+  [[nodiscard]] std::vector<const node*> ordered_fields() const {
+    auto result = std::vector<const node*>{};
+    result.reserve(fields.size());
+    for (const auto& x : fields)
+      result.push_back(x.get());
+    std::stable_sort(result.begin(), result.end(), [](auto* lhs, auto* rhs) {
+      return lhs->first < rhs->first;
+    });
+    return result;
+  }
+
+  /// Widens the observed kinds to a type that can represent all values.
+  [[nodiscard]] type derive(const options& opts) const {
+    const auto observed = static_cast<uint16_t>(kinds & ~null_kind);
+    // Records and lists win over scalars, because the scalars are most
+    // likely placeholders for absent values.
+    if (observed & record_kind) {
+      if (fields.empty())
+        return type{map_type{string_type{}, string_type{}}};
+      auto result = std::vector<record_type::field_view>{};
+      result.reserve(fields.size());
+      for (const auto* x : ordered_fields())
+        result.push_back({x->name, x->derive(opts)});
+      return type{record_type{result}};
+    }
+    if (observed & list_kind) {
+      if (!element || element->count == 0)
+        return type{list_type{string_type{}}};
+      return type{list_type{element->derive(opts)}};
+    }
+    constexpr uint16_t numeric_kinds = int64_kind | uint64_kind | double_kind;
+    switch (observed) {
+      case bool_kind:
+        return type{bool_type{}};
+      case int64_kind:
+        return type{int64_type{}};
+      case uint64_kind:
+        return type{uint64_type{}};
+      case int64_kind | uint64_kind:
+        // Signed integers only show up as unsigned if they exceed the range
+        // of int64, so a mix is unsigned unless there are negative values.
+        if (!negative)
+          return type{uint64_type{}};
+        return type{double_type{}};
+      case ip_kind:
+        return type{ip_type{}};
+      case subnet_kind:
+        return type{subnet_type{}};
+      case time_kind:
+        return type{time_type{}};
+      case duration_kind:
+        return type{duration_type{}};
+      default:
+        break;
+    }
+    if (observed != 0 && (observed & ~numeric_kinds) == 0)
+      return type{double_type{}};
+    // Everything else, including fields that were only ever null, widens to
+    // strings. Strings with a high cardinality are likely identifiers that
+    // benefit from a hash index.
+    const auto values = count - nulls;
+    const auto distinct_values = distinct.estimate();
+    if (values > 0 && distinct_values >= opts.index_min_distinct
+        && static_cast<double>(distinct_values)
+             >= opts.index_min_ratio * static_cast<double>(values))
+      return type{string_type{}, {{"index", "hash"}}};
+    return type{string_type{}};
+  }
+
+  void collect(std::string_view prefix, uint64_t parent_records,
+               std::vector<field_statistics>& result) const {
+    for (const auto* x : ordered_fields()) {
+      auto key = prefix.empty() ? x->name : fmt::format("{}.{}", prefix, x->name);
+      result.push_back({
+        .key = key,
+        .count = x->count - x->nulls,
+        .nulls = x->nulls,
+        .frequency = static_cast<double>(x->count)
+                     / static_cast<double>(parent_records),
+        .distinct = x->distinct.estimate(),
+      });
+      x->collect(key, x->records, result);
+      if (x->element)
+        x->element->collect(key, x->element->records, result);
+    }
+  }
+};
+
+schema_inference::schema_inference() : root_{std::make_unique<node>()} {
+  // nop
+}
+
+schema_inference::~schema_inference() noexcept = default;
+
+schema_inference::schema_inference(schema_inference&&) noexcept = default;
+
+schema_inference&
+schema_inference::operator=(schema_inference&&) noexcept = default;
+
+uint64_t schema_inference::documents() const {
+  return documents_;
+}
+
+uint64_t schema_inference::invalid() const {
+  return invalid_;
+}
+
+caf::error schema_inference::add(const ::simdjson::dom::element& document,
+                                 uint64_t position) {
+  if (document.type() != ::simdjson::dom::element_type::OBJECT)
+    return caf::make_error(ec::type_clash, "JSON document is not an object");
+  root_->observe(document, position);
+  ++documents_;
+  return caf::none;
+}
+
+void schema_inference::add_lines(std::string_view input, uint64_t position) {
+  while (!input.empty()) {
+    auto end = input.find('\n');
+    auto line = input.substr(0, end);
+    input.remove_prefix(end == std::string_view::npos ? input.size() : end + 1);
+    if (!line.empty() && line.back() == '\r')
+      line.remove_suffix(1);
+    if (line.find_first_not_of(" \t") == std::string_view::npos)
+      continue;
+    auto document = parser_.parse(line);
+    if (document.error() != ::simdjson::error_code::SUCCESS
+        || add(document.value(), position++))
+      ++invalid_;
+  }
+}
+
+void schema_inference::merge(schema_inference&& other) {
+  root_->merge(std::move(*other.root_));
+  documents_ += other.documents_;
+  invalid_ += other.invalid_;
+}
+
+caf::expected<type>
+schema_inference::make_type(std::string name, const options& opts) const {
+  if (documents_ == 0)
+    return caf::make_error(ec::parse_error, "no JSON object to infer a type "
+                                            "from");
+  auto result = root_->derive(opts);
+  if (!caf::holds_alternative<record_type>(result))
+    return caf::make_error(ec::parse_error, "JSON objects have no fields");
+  return type{name, result};
+}
+
+std::vector<schema_inference::field_statistics>
+schema_inference::statistics() const {
+  auto result = std::vector<field_statistics>{};
+  if (documents_ > 0)
+    root_->collect({}, root_->records, result);
+  return result;
+}
+
+schema_inference
+infer_json_schema(std::string prefix, std::istream& input, size_t num_workers,
+                  size_t max_bytes) {
+  // Blocks are large enough to amortize the synchronization, and cut at line
+  // boundaries so that every worker sees complete documents.
+  constexpr size_t block_size = 4 * 1'024 * 1'024;
+  struct block {
+    std::string data;
+    uint64_t position;
+  };
+  // Every block reserves a range of positions for its documents, so that the
+  // field order does not depend on the scheduling of the workers.
+  constexpr uint64_t positions_per_block = uint64_t{1} << 32;
+  const auto limit
+    = max_bytes == 0 ? std::numeric_limits<size_t>::max() : max_bytes;
+  auto pending = std::move(prefix);
+  if (pending.size() > limit)
+    pending.resize(limit);
+  auto bytes_read = pending.size();
+  auto eof = false;
+  auto next_position = uint64_t{0};
+  auto next_block = [&]() -> std::optional<block> {
+    auto size = block_size;
+    auto cut = size_t{0};
+    while (true) {
+      const auto truncated = bytes_read >= limit;
+      if (pending.size() < size && !eof && !truncated) {
+        const auto offset = pending.size();
+        const auto n = std::min(size - offset, limit - bytes_read);
+        pending.resize(offset + n);
+        input.read(pending.data() + offset,
+                   detail::narrow_cast<std::streamsize>(n));
+        const auto got = detail::narrow_cast<size_t>(input.gcount());
+        pending.resize(offset + got);
+        bytes_read += got;
+        eof = got < n;
+        continue;
+      }
+      if (eof) {
+        cut = pending.size();
+        break;
+      }
+      if (auto end = pending.rfind('\n', size - 1); end != std::string::npos) {
+        cut = end + 1;
+        break;
+      }
+      // We drop an incomplete line at the end of a truncated input.
+      if (truncated)
+        break;
+      // A single line exceeds the block size, so the block grows.
+      size *= 2;
+    }
+    if (cut == 0)
+      return std::nullopt;
+    auto result = block{pending.substr(0, cut), next_position};
+    pending.erase(0, cut);
+    next_position += positions_per_block;
+    return result;
+  };
+  auto result = schema_inference{};
+  if (num_workers <= 1) {
+    while (auto x = next_block())
+      result.add_lines(x->data, x->position);
+    return result;
+  }
+  // The calling thread reads blocks into a bounded queue that the workers
+  // drain.
+  auto mtx = std::mutex{};
+  auto cv = std::condition_variable{};
+  auto queue = std::deque<block>{};
+  auto done = false;
+  const auto max_queued = 2 * num_workers;
+  auto partials = std::vector<schema_inference>(num_workers);
+  auto workers = std::vector<std::thread>{};
+  workers.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers.emplace_back([&, i] {
+      while (true) {
+        auto lock = std::unique_lock{mtx};
+        cv.wait(lock, [&] {
+          return done || !queue.empty();
+        });
+        if (queue.empty())
+          return;
+        auto x = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        cv.notify_all();
+        partials[i].add_lines(x.data, x.position);
+      }
+    });
+  }
+  while (auto x = next_block()) {
+    auto lock = std::unique_lock{mtx};
+    cv.wait(lock, [&] {
+      return queue.size() < max_queued;
+    });
+    queue.push_back(std::move(*x));
+    lock.unlock();
+    cv.notify_all();
+  }
+  {
+    auto lock = std::unique_lock{mtx};
+    done = true;
+  }
+  cv.notify_all();
+  for (auto& worker : workers)
+    worker.join();
+  for (auto& partial : partials)
+    result.merge(std::move(partial));
+  return result;
+}
+
+} // namespace vast
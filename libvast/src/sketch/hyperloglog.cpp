@@ -0,0 +1,130 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/sketch/hyperloglog.hpp"
+
+#include "vast/detail/assert.hpp"
+#include "vast/error.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace vast::sketch {
+
+hyperloglog::hyperloglog()
+  : hyperloglog{default_precision,
+                std::vector<uint8_t>(size_t{1} << default_precision)} {
+  // nop
+}
+
+caf::expected<hyperloglog> hyperloglog::make(uint8_t precision) {
+  if (precision < min_precision || precision > max_precision)
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("HyperLogLog precision {} is not in "
+                                       "[{}, {}]",
+                                       precision, min_precision,
+                                       max_precision));
+  return hyperloglog{precision, std::vector<uint8_t>(size_t{1} << precision)};
+}
+
+caf::expected<hyperloglog> hyperloglog::make(std::vector<uint8_t> registers) {
+  if (!std::has_single_bit(registers.size()))
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("number of HyperLogLog registers {} is "
+                                       "not a power of two",
+                                       registers.size()));
+  const auto precision
+    = static_cast<uint8_t>(std::countr_zero(registers.size()));
+  if (precision < min_precision || precision > max_precision)
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("HyperLogLog precision {} is not in "
+                                       "[{}, {}]",
+                                       precision, min_precision,
+                                       max_precision));
+  const auto max_rank = 64 - precision + 1;
+  if (std::any_of(registers.begin(), registers.end(), [&](uint8_t rank) {
+        return rank > max_rank;
+      }))
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("HyperLogLog registers exceed the "
+                                       "maximum rank {}",
+                                       max_rank));
+  return hyperloglog{precision, std::move(registers)};
+}
+
+void hyperloglog::add(uint64_t digest) noexcept {
+  const auto index = digest >> (64 - precision_);
+  const auto remainder = digest << precision_;
+  // The shift fills the lower bits with zeros, so the rank must not exceed
+  // the number of remaining bits plus one.
+  const auto rank = static_cast<uint8_t>(
+    std::min(std::countl_zero(remainder), 64 - precision_) + 1);
+  registers_[index] = std::max(registers_[index], rank);
+}
+
+caf::error hyperloglog::merge(const hyperloglog& other) {
+  if (precision_ != other.precision_)
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("cannot merge HyperLogLog sketches "
+                                       "with precisions {} and {}",
+                                       precision_, other.precision_));
+  for (size_t i = 0; i < registers_.size(); ++i)
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  return {};
+}
+
+double hyperloglog::estimate() const noexcept {
+  const auto m = static_cast<double>(registers_.size());
+  const auto alpha = [&] {
+    switch (registers_.size()) {
+      case 16:
+        return 0.673;
+      case 32:
+        return 0.697;
+      case 64:
+        return 0.709;
+      default:
+        return 0.7213 / (1.0 + 1.079 / m);
+    }
+  }();
+  auto sum = 0.0;
+  auto zeros = size_t{0};
+  for (const auto rank : registers_) {
+    sum += std::ldexp(1.0, -rank);
+    if (rank == 0)
+      ++zeros;
+  }
+  const auto raw_estimate = alpha * m * m / sum;
+  // Linear counting is more accurate for small cardinalities.
+  if (raw_estimate <= 2.5 * m && zeros > 0)
+    return m * std::log(m / static_cast<double>(zeros));
+  return raw_estimate;
+}
+
+uint8_t hyperloglog::precision() const noexcept {
+  return precision_;
+}
+
+std::span<const uint8_t> hyperloglog::registers() const noexcept {
+  return registers_;
+}
+
+size_t mem_usage(const hyperloglog& x) noexcept {
+  return sizeof(x) + x.registers_.capacity();
+}
+
+hyperloglog::hyperloglog(uint8_t precision,
+                         std::vector<uint8_t> registers) noexcept
+  : precision_{precision}, registers_{std::move(registers)} {
+  VAST_ASSERT(registers_.size() == size_t{1} << precision_);
+}
+
+} // namespace vast::sketch
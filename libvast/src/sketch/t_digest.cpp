@@ -0,0 +1,190 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/sketch/t_digest.hpp"
+
+#include "vast/detail/assert.hpp"
+#include "vast/error.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace vast::sketch {
+
+t_digest::t_digest(double compression) : compression_{compression} {
+  VAST_ASSERT(compression_ > 0.0);
+  buffer_.reserve(static_cast<size_t>(5.0 * compression_));
+}
+
+caf::expected<t_digest> t_digest::make(double compression,
+                                       std::vector<centroid> centroids,
+                                       double min, double max) {
+  if (!(compression > 0.0))
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("t-digest compression {} is not "
+                                       "positive",
+                                       compression));
+  auto result = t_digest{compression};
+  if (centroids.empty())
+    return result;
+  if (!(min <= max))
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("t-digest bounds [{}, {}] are empty",
+                                       min, max));
+  for (size_t i = 0; i < centroids.size(); ++i) {
+    const auto& current = centroids[i];
+    if (!(current.weight > 0.0) || !(current.mean >= min)
+        || !(current.mean <= max)
+        || (i > 0 && current.mean < centroids[i - 1].mean))
+      return caf::make_error(ec::invalid_argument,
+                             fmt::format("t-digest centroid {} with mean {} "
+                                         "and weight {} is invalid",
+                                         i, current.mean, current.weight));
+    result.weight_ += current.weight;
+  }
+  result.min_ = min;
+  result.max_ = max;
+  result.centroids_ = std::move(centroids);
+  return result;
+}
+
+void t_digest::add(double value, double weight) {
+  VAST_ASSERT(weight > 0.0);
+  if (std::isnan(value))
+    return;
+  if (weight_ == 0.0) {
+    min_ = value;
+    max_ = value;
+  } else {
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+  weight_ += weight;
+  buffer_.push_back({value, weight});
+  if (buffer_.size() >= static_cast<size_t>(5.0 * compression_))
+    compress();
+}
+
+void t_digest::merge(const t_digest& other) {
+  if (other.weight_ == 0.0)
+    return;
+  if (weight_ == 0.0) {
+    min_ = other.min_;
+    max_ = other.max_;
+  } else {
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+  weight_ += other.weight_;
+  buffer_.insert(buffer_.end(), other.centroids_.begin(),
+                 other.centroids_.end());
+  buffer_.insert(buffer_.end(), other.buffer_.begin(), other.buffer_.end());
+  compress();
+}
+
+std::optional<double> t_digest::quantile(double q) const {
+  VAST_ASSERT(q >= 0.0 && q <= 1.0);
+  compress();
+  if (centroids_.empty())
+    return std::nullopt;
+  if (q == 0.0)
+    return min_;
+  if (q == 1.0)
+    return max_;
+  // Every centroid represents its weight around its mean, so we interpolate
+  // linearly between the means of neighboring centroids, and between the
+  // outer centroids and the bounds.
+  const auto target = q * weight_;
+  const auto& first = centroids_.front();
+  if (target < first.weight / 2.0)
+    return min_ + (first.mean - min_) * target / (first.weight / 2.0);
+  auto cumulative = 0.0;
+  for (size_t i = 0; i + 1 < centroids_.size(); ++i) {
+    const auto& left = centroids_[i];
+    const auto& right = centroids_[i + 1];
+    const auto left_center = cumulative + left.weight / 2.0;
+    const auto right_center = cumulative + left.weight + right.weight / 2.0;
+    if (target < right_center) {
+      const auto fraction
+        = (target - left_center) / (right_center - left_center);
+      return left.mean + (right.mean - left.mean) * fraction;
+    }
+    cumulative += left.weight;
+  }
+  const auto& last = centroids_.back();
+  const auto last_center = weight_ - last.weight / 2.0;
+  const auto fraction
+    = std::min((target - last_center) / (last.weight / 2.0), 1.0);
+  return last.mean + (max_ - last.mean) * fraction;
+}
+
+double t_digest::weight() const noexcept {
+  return weight_;
+}
+
+double t_digest::min() const noexcept {
+  return min_;
+}
+
+double t_digest::max() const noexcept {
+  return max_;
+}
+
+double t_digest::compression() const noexcept {
+  return compression_;
+}
+
+std::span<const t_digest::centroid> t_digest::centroids() const {
+  compress();
+  return centroids_;
+}
+
+size_t mem_usage(const t_digest& x) noexcept {
+  return sizeof(x)
+         + (x.centroids_.capacity() + x.buffer_.capacity())
+             * sizeof(t_digest::centroid);
+}
+
+void t_digest::compress() const {
+  if (buffer_.empty())
+    return;
+  buffer_.insert(buffer_.end(), centroids_.begin(), centroids_.end());
+  std::sort(buffer_.begin(), buffer_.end(),
+            [](const centroid& lhs, const centroid& rhs) {
+              return lhs.mean < rhs.mean;
+            });
+  const auto k = [&](double q) {
+    return compression_ / (2.0 * std::numbers::pi) * std::asin(2.0 * q - 1.0);
+  };
+  centroids_.clear();
+  auto current = buffer_.front();
+  auto weight_so_far = 0.0;
+  for (size_t i = 1; i < buffer_.size(); ++i) {
+    const auto& next = buffer_[i];
+    const auto q_left = weight_so_far / weight_;
+    const auto q_right
+      = std::min((weight_so_far + current.weight + next.weight) / weight_, 1.0);
+    // Merge the next centroid into the current one as long as the merged
+    // centroid spans at most one unit of the scale function.
+    if (k(q_right) - k(q_left) <= 1.0) {
+      current.weight += next.weight;
+      current.mean += (next.mean - current.mean) * next.weight / current.weight;
+      continue;
+    }
+    weight_so_far += current.weight;
+    centroids_.push_back(current);
+    current = next;
+  }
+  centroids_.push_back(current);
+  buffer_.clear();
+}
+
+} // namespace vast::sketch
@@ -9,9 +9,11 @@
 #include "vast/store.hpp"
 
 #include "vast/atoms.hpp"
+#include "vast/chunk.hpp"
 #include "vast/detail/narrow.hpp"
 #include "vast/error.hpp"
 #include "vast/ids.hpp"
+#include "vast/pipeline.hpp"
 #include "vast/query_context.hpp"
 #include "vast/system/report.hpp"
 #include "vast/table_slice.hpp"
@@ -23,6 +25,23 @@ namespace vast {
 
 namespace {
 
+/// Reports the metrics that the store collected while evaluating a query.
+void report_store_metrics(const auto& self, const std::string& query_id,
+                          const std::string& issuer) {
+  auto metrics = self->state.store->take_metrics();
+  if (metrics.empty())
+    return;
+  self->send(self->state.accountant, atom::metrics_v,
+             system::report{
+               .data = std::move(metrics),
+               .metadata = {
+                 {"query", query_id},
+                 {"issuer", issuer},
+                 {"store-type", self->state.store_type},
+               },
+             });
+}
+
 // A query execution is performed incrementally on individual table slices.
 // On each invocation, only a single table slice is processed via filter
 // or count, then execution is paused to allow incremental processing and
@@ -107,6 +126,7 @@ handle_query(const auto& self, const query_context& query_context) {
                          {"issuer", issuer},
                          {"store-type", self->state.store_type},
                        });
+            report_store_metrics(self, id_str, issuer);
             self->state.running_counts.erase(it);
           },
           [self, expr = query_context.expr, query_id = query_context.id,
@@ -129,6 +149,19 @@ handle_query(const auto& self, const query_context& query_context) {
                                        *self, query_context.id)));
         return;
       }
+      if (!extract.operators.empty()) {
+        auto operators = pipeline::make("store", extract.operators);
+        if (!operators) {
+          self->state.running_extractions.erase(state);
+          rp.deliver(caf::make_error(
+            ec::invalid_argument,
+            fmt::format("{} failed to create pipeline operators for query "
+                        "{}: {}",
+                        *self, query_context.id, operators.error())));
+          return;
+        }
+        state->second.operators = std::move(*operators);
+      }
       state->second.generator
         = self->state.store->extract(*tailored_expr, query_context.ids);
       state->second.result_iterator = state->second.generator.begin();
@@ -167,6 +200,7 @@ handle_query(const auto& self, const query_context& query_context) {
                          {"issuer", issuer},
                          {"store-type", self->state.store_type},
                        });
+            report_store_metrics(self, id_str, issuer);
             self->state.running_extractions.erase(it);
           },
           [self, expr = query_context.expr, query_id = query_context.id,
@@ -184,6 +218,28 @@ handle_query(const auto& self, const query_context& query_context) {
   return rp;
 }
 
+/// Ships a result of an extract query to its sink, or applies the operators of
+/// the query to it and ships their results. Aggregating operators ship their
+/// results only after the last result.
+caf::error ship_extract_result(const auto& self, extract_query_state& state,
+                               table_slice slice, bool last) {
+  state.num_hits += slice.rows();
+  if (!state.operators) {
+    self->send(state.sink, std::move(slice));
+    return {};
+  }
+  if (auto err = state.operators->add(std::move(slice)))
+    return err;
+  if (!last && state.operators->is_aggregate())
+    return {};
+  auto results = state.operators->finish();
+  if (!results)
+    return std::move(results.error());
+  for (auto& result : *results)
+    self->send(state.sink, std::move(result));
+  return {};
+}
+
 auto remove_down_source(auto* self, const caf::down_msg& down_msg) {
   for (const auto& [query_id, state] : self->state.running_extractions) {
     if (state.sink->address() == down_msg.source) {
@@ -227,6 +283,10 @@ base_store::extract(expression expr, ids selection) const {
   }
 }
 
+std::vector<system::data_point> base_store::take_metrics() {
+  return {};
+}
+
 system::default_passive_store_actor::behavior_type
 default_passive_store(system::default_passive_store_actor::stateful_pointer<
                         default_passive_store_state>
@@ -307,9 +367,10 @@ default_passive_store(system::default_passive_store_actor::stateful_pointer<
         return {};
       }
       auto slice = *state.result_iterator;
-      state.num_hits += slice.rows();
-      self->send(state.sink, std::move(slice));
-      if (++state.result_iterator == state.generator.end()) {
+      const auto last = ++state.result_iterator == state.generator.end();
+      if (auto err = ship_extract_result(self, state, std::move(slice), last))
+        return err;
+      if (last) {
         return {};
       }
       return self->delegate(
@@ -411,11 +472,31 @@ system::default_active_store_actor::behavior_type default_active_store(
           // persist anything.
           if (self->state.erased)
             return;
+          const auto start = std::chrono::steady_clock::now();
+          auto input_bytes = uint64_t{};
+          for (const auto& slice : self->state.store->slices())
+            input_bytes += as_bytes(slice).size();
           auto chunk = self->state.store->finish();
           if (!chunk) {
             self->quit(std::move(chunk.error()));
             return;
           }
+          const auto output_bytes = uint64_t{(*chunk)->size()};
+          const auto metadata = system::metrics_metadata{
+            {"partition", self->state.path.stem().string()},
+            {"store-type", self->state.store_type},
+          };
+          self->send(self->state.accountant, atom::metrics_v,
+                     "active-store.persist.runtime",
+                     std::chrono::steady_clock::now() - start, metadata);
+          self->send(self->state.accountant, atom::metrics_v,
+                     "active-store.persist.bytes", output_bytes, metadata);
+          if (output_bytes > 0)
+            self->send(self->state.accountant, atom::metrics_v,
+                       "active-store.persist.compression-ratio",
+                       static_cast<double>(input_bytes)
+                         / static_cast<double>(output_bytes),
+                       metadata);
           self
             ->request(self->state.filesystem, caf::infinite, atom::write_v,
                       self->state.path, std::move(*chunk))
@@ -453,9 +534,10 @@ system::default_active_store_actor::behavior_type default_active_store(
         return {};
       }
       auto slice = *state.result_iterator;
-      state.num_hits += slice.rows();
-      self->send(state.sink, std::move(slice));
-      if (++state.result_iterator == state.generator.end()) {
+      const auto last = ++state.result_iterator == state.generator.end();
+      if (auto err = ship_extract_result(self, state, std::move(slice), last))
+        return err;
+      if (last) {
         return {};
       }
       return self->delegate(
@@ -40,7 +40,23 @@ command::opts_builder add_index_opts(command::opts_builder ob) {
     .add<int64_t>("max-taste-partitions", "maximum number of immediately "
                                           "scheduled partitions")
     .add<int64_t>("max-queries,q", "maximum number of "
-                                   "concurrent queries");
+                                   "concurrent queries")
+    .add<int64_t>("min-partition-window", "minimum number of partitions that "
+                                          "a query requests at once")
+    .add<int64_t>("max-partition-window", "maximum number of partitions that "
+                                          "a query requests at once (0 for "
+                                          "one per core)")
+    .add<int64_t>("max-inflight-export-bytes",
+                  "maximum number of bytes of a streaming REST export that "
+                  "may be on the way to the client")
+    .add<std::string>("query-cache-size", "memory budget for cached query "
+                                          "results (0 to disable)")
+    .add<int64_t>("pipeline-threads", "number of threads that apply pipeline "
+                                      "operators to batches concurrently (0 "
+                                      "for one per core)")
+    .add<std::string>("pipeline-memory-budget", "maximum size of the batches "
+                                                "that a pipeline transforms "
+                                                "concurrently");
 }
 
 auto make_count_command() {
@@ -118,7 +134,11 @@ auto make_infer_command() {
     "infer", "infers the schema from data",
     opts("?vast.infer")
       .add<int64_t>("buffer,b", "maximum number of bytes to buffer")
-      .add<std::string>("read,r", "path to the input data"));
+      .add<std::string>("read,r", "path to the input data")
+      .add<int64_t>("workers", "number of threads that infer JSON in "
+                               "parallel (0 for one per core)")
+      .add<uint64_t>("max-bytes", "maximum number of bytes to infer JSON "
+                                  "from (0 for the entire input)"));
 }
 
 auto make_kill_command() {
@@ -142,6 +162,13 @@ auto make_spawn_source_command() {
     opts("?vast.spawn.source")
       .add<std::string>("batch-encoding", "encoding type of table slices")
       .add<int64_t>("batch-size", "upper bound for the size of a table slice")
+      .add<int64_t>("batch-size-min", "lower bound for the adaptive size of a "
+                                      "table slice")
+      .add<int64_t>("batch-size-max", "upper bound for the adaptive size of a "
+                                      "table slice")
+      .add<std::string>("batch-target-latency", "adapt the size of table "
+                                                "slices such that filling one "
+                                                "takes this long")
       .add<std::string>("batch-timeout", "timeout after which batched "
                                          "table slices are forwarded")
       .add<std::string>("listen,l", "the endpoint to listen on "
@@ -152,6 +179,8 @@ auto make_spawn_source_command() {
       .add<std::string>("schema,S", "alternate schema as string")
       .add<std::string>("schema-file,s", "path to alternate schema")
       .add<std::string>("type,t", "filter event type based on prefix matching")
+      .add<int64_t>("udp-workers", "number of threads that receive and parse "
+                                   "datagrams when listening on a UDP port")
       .add<bool>("uds,d", "treat -r as listening UNIX domain socket"));
   spawn_source->add_subcommand("arrow",
                                "creates a new Arrow IPC source inside the node",
@@ -417,6 +446,13 @@ std::unique_ptr<command> make_import_command() {
     opts("?vast.import")
       .add<std::string>("batch-encoding", "encoding type of table slices")
       .add<int64_t>("batch-size", "upper bound for the size of a table slice")
+      .add<int64_t>("batch-size-min", "lower bound for the adaptive size of a "
+                                      "table slice")
+      .add<int64_t>("batch-size-max", "upper bound for the adaptive size of a "
+                                      "table slice")
+      .add<std::string>("batch-target-latency", "adapt the size of table "
+                                                "slices such that filling one "
+                                                "takes this long")
       .add<std::string>("batch-timeout", "timeout after which batched "
                                          "table slices are forwarded")
       .add<bool>("blocking,b", "block until the IMPORTER forwarded all data")
@@ -428,6 +464,8 @@ std::unique_ptr<command> make_import_command() {
       .add<std::string>("schema,S", "alternate schema as string")
       .add<std::string>("schema-file,s", "path to alternate schema")
       .add<std::string>("type,t", "filter event type based on prefix matching")
+      .add<int64_t>("udp-workers", "number of threads that receive and parse "
+                                   "datagrams when listening on a UDP port")
       .add<bool>("uds,d", "treat -r as listening UNIX domain socket"));
   import_->add_subcommand("zeek", "imports Zeek TSV logs from STDIN or file",
                           opts("?vast.import.zeek"));
@@ -16,6 +16,7 @@
 #include "vast/concept/printable/vast/expression.hpp"
 #include "vast/concept/printable/vast/uuid.hpp"
 #include "vast/detail/assert.hpp"
+#include "vast/detail/collect.hpp"
 #include "vast/detail/fill_status_map.hpp"
 #include "vast/detail/narrow.hpp"
 #include "vast/detail/tracepoint.hpp"
@@ -29,6 +30,7 @@
 #include "vast/system/status.hpp"
 #include "vast/table_slice.hpp"
 
+#include <caf/actor_system_config.hpp>
 #include <caf/attach_stream_sink.hpp>
 #include <caf/attach_stream_source.hpp>
 #include <caf/stream_slot.hpp>
@@ -80,27 +82,52 @@ void attach_stream(exporter_actor::stateful_pointer<exporter_state> self) {
         .ptr();
 }
 
-void ship_results(exporter_actor::stateful_pointer<exporter_state> self,
-                  table_slice slice) {
-  VAST_TRACE_SCOPE("");
+void finish_pipeline(exporter_actor::stateful_pointer<exporter_state> self) {
   auto& st = self->state;
-  VAST_DEBUG("{} relays {} events", *self, slice.rows());
-  // Ship the slice and update state.
-  st.query_status.shipped += slice.rows();
-  if (auto err = self->state.pipeline.add(std::move(slice))) {
-    VAST_ERROR("exporter failed to apply the transformation: {}", err);
-    return;
-  }
-  auto transformed = self->state.pipeline.finish();
+  auto transformed = st.pipeline.finish();
   if (!transformed) {
     VAST_ERROR("exporter failed to finish the transformation: {}",
                transformed.error());
     return;
   }
-  if (!self->state.source) [[unlikely]]
+  if (!st.source && !transformed->empty()) [[unlikely]]
     attach_stream(self);
   for (auto& t : *transformed)
-    self->state.results.push(std::move(t));
+    st.results.push(std::move(t));
+  if (st.accountant) {
+    auto metrics = st.pipeline.take_metrics();
+    if (!metrics.empty()) {
+      auto msg = report{
+        .data = std::move(metrics),
+        .metadata = {
+          {"query", fmt::to_string(st.query_context.id)},
+        },
+      };
+      self->send(st.accountant, atom::metrics_v, std::move(msg));
+    }
+  }
+}
+
+void ship_results(exporter_actor::stateful_pointer<exporter_state> self,
+                  std::vector<table_slice> slices) {
+  VAST_TRACE_SCOPE("");
+  auto& st = self->state;
+  // Feed all slices to the pipeline before finishing it once, so that a
+  // slice that the candidate check split into many runs does not cause as
+  // many pipeline executions.
+  for (auto& slice : slices) {
+    VAST_DEBUG("{} relays {} events", *self, slice.rows());
+    st.query_status.shipped += slice.rows();
+    if (auto err = st.pipeline.add(std::move(slice))) {
+      VAST_ERROR("exporter failed to apply the transformation: {}", err);
+      return;
+    }
+  }
+  // Partial results must be merged across all partitions, so we only finish
+  // the pipeline once the query is done.
+  if (st.merge_partials)
+    return;
+  finish_pipeline(self);
 }
 
 void report_statistics(exporter_actor::stateful_pointer<exporter_state> self) {
@@ -159,17 +186,80 @@ void request_more_hits(exporter_actor::stateful_pointer<exporter_state> self) {
   // hits by the INDEX.
   VAST_ASSERT(st.query_status.received < st.query_status.expected);
   auto remaining = st.query_status.expected - st.query_status.received;
-  // TODO: Figure out right number of partitions to ask for. For now, we
-  // bound the number by an arbitrary constant.
-  auto n = std::min(remaining, size_t{2});
+  auto demand
+    = st.max_events > 0 ? st.max_events - st.query_status.shipped : 0;
+  auto n = st.partition_window.next(remaining, demand);
   // Store how many partitions we schedule with our request. When receiving
   // 'done', we add this number to `received`.
   st.query_status.scheduled = n;
+  st.partition_window.start(n, stopwatch::now());
   // Request more hits from the INDEX.
   VAST_DEBUG("{} asks index to process {} more partitions", *self, n);
   self->send(st.index, atom::query_v, st.id, detail::narrow<uint32_t>(n));
 }
 
+/// Adapts the number of partitions to ask for to the duration of the last
+/// request and to how quickly the SINK consumes the results.
+void finish_round(exporter_actor::stateful_pointer<exporter_state> self) {
+  auto& st = self->state;
+  if (!st.partition_window.in_flight())
+    return;
+  // More results than the round produced still wait for the SINK.
+  auto backlogged = st.results.size() > st.round_slices;
+  auto decision = st.partition_window.finish(
+    std::exchange(st.round_events, 0), backlogged, stopwatch::now());
+  st.round_slices = 0;
+  if (decision == partition_request_window::decision::grow)
+    VAST_DEBUG("{} grows its partition window to {}", *self,
+               st.partition_window.size());
+  else if (decision == partition_request_window::decision::shrink)
+    VAST_DEBUG("{} shrinks its partition window to {}", *self,
+               st.partition_window.size());
+  if (st.accountant) {
+    auto stats = st.partition_window.take_statistics();
+    auto msg = report{
+      .data = {
+        {"exporter.partition-window.size",
+         uint64_t{st.partition_window.size()}},
+        {"exporter.partition-window.latency", st.partition_window.latency()},
+        {"exporter.partition-window.partitions", stats.partitions},
+        {"exporter.partition-window.hits", stats.hits},
+        {"exporter.partition-window.backlogged", uint64_t{backlogged}},
+      },
+      .metadata = {
+        {"query", fmt::to_string(st.query_context.id)},
+      },
+    };
+    self->send(st.accountant, atom::metrics_v, std::move(msg));
+  }
+}
+
+/// Stops the evaluation of further partitions once the exporter shipped the
+/// maximum number of events.
+void cancel_remaining_partitions(
+  exporter_actor::stateful_pointer<exporter_state> self) {
+  auto& st = self->state;
+  if (st.query_status.received == st.query_status.expected)
+    return;
+  auto skipped = st.query_status.expected - st.query_status.received
+                 - st.query_status.scheduled;
+  VAST_VERBOSE("{} reached the limit of {} events and skips {} of {} "
+               "partitions",
+               *self, st.max_events, skipped, st.query_status.expected);
+  self->send(st.index, atom::stop_v, st.id);
+  // The INDEX does not signal completion for cancelled queries, so we
+  // consider all partitions received. This also ends the stream to the SINK
+  // once it consumed the remaining results.
+  st.query_status.received = st.query_status.expected;
+  st.query_status.scheduled = 0;
+  if (st.accountant)
+    self->send(st.accountant, atom::metrics_v, "exporter.partitions.skipped",
+               uint64_t{skipped},
+               metrics_metadata{{"query", fmt::to_string(st.query_context.id)}});
+  if (!st.source)
+    self->send_exit(st.sink, caf::exit_reason::user_shutdown);
+}
+
 void handle_batch(exporter_actor::stateful_pointer<exporter_state> self,
                   table_slice slice) {
   VAST_ASSERT(slice.encoding() != table_slice_encoding::none);
@@ -193,14 +283,11 @@ void handle_batch(exporter_actor::stateful_pointer<exporter_state> self,
   // Perform candidate check, splitting the slice into subsets if needed.
   self->state.query_status.processed += slice.rows();
   auto selection = evaluate(checker, slice, {});
-  auto selection_size = rank(selection);
-  if (selection_size == 0) {
+  if (!any(selection)) {
     // No rows qualify.
     return;
   }
-  for (auto&& selected : select(slice, expression{}, selection)) {
-    ship_results(self, std::move(selected));
-  }
+  ship_results(self, detail::collect(select(slice, expression{}, selection)));
 }
 
 } // namespace
@@ -227,12 +314,10 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
   }
   expr = *normalized_expr;
   self->state.options = options;
-  self->state.query_context
-    = vast::query_context::make_extract("export", self, std::move(expr));
-  self->state.query_context.priority
-    = has_low_priority_option(self->state.options)
-        ? query_context::priority::low
-        : query_context::priority::normal;
+  self->state.max_events = export_max_events;
+  self->state.partition_window
+    = partition_request_window{partition_request_window::make_options(
+      content(self->system().config()))};
   VAST_DEBUG("spawned exporter with {} pipelines", pipelines.size());
   self->state.pipeline = pipeline_executor{std::move(pipelines)};
   if (auto err = self->state.pipeline.validate(
@@ -242,6 +327,50 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
       fmt::format("{} received an invalid pipeline: {}", *self, err)));
     return exporter_actor::behavior_type::make_empty_behavior();
   }
+  auto parallelism
+    = pipeline_parallelism::make(content(self->system().config()));
+  if (!parallelism) {
+    self->quit(std::move(parallelism.error()));
+    return exporter_actor::behavior_type::make_empty_behavior();
+  }
+  self->state.pipeline.parallelize(*parallelism);
+  // Historical queries evaluate the leading operators of their pipeline as
+  // part of the query: Filters narrow down the query expression, so that the
+  // catalog and the indexes prune more partitions and events; the stores
+  // apply projections and partial aggregations close to the data; and limits
+  // cancel the evaluation of the remaining partitions once reached.
+  auto pushdown = pipeline_pushdown_plan{};
+  if (has_historical_option(options) && !has_continuous_option(options))
+    pushdown = self->state.pipeline.push_down();
+  self->state.pushdown = pushdown.explain();
+  if (pushdown.filter) {
+    auto filtered_expr = normalize_and_validate(
+      conjunction{std::move(expr), std::move(*pushdown.filter)});
+    if (!filtered_expr) {
+      self->quit(caf::make_error(ec::format_error,
+                                 fmt::format("{} failed to normalize and "
+                                             "validate expression with "
+                                             "pipeline filter: {}",
+                                             *self, filtered_expr.error())));
+      return exporter_actor::behavior_type::make_empty_behavior();
+    }
+    expr = std::move(*filtered_expr);
+  }
+  if (pushdown.limit > 0)
+    self->state.max_events = pushdown.limit;
+  self->state.merge_partials = pushdown.merge_partials;
+  if (pushdown.filter || !pushdown.store_operators.empty()
+      || pushdown.limit > 0)
+    VAST_VERBOSE("{} pushes pipeline operators down into the query: {}",
+                 *self, self->state.pushdown);
+  self->state.query_context
+    = vast::query_context::make_extract("export", self, std::move(expr));
+  caf::get<extract_query_context>(self->state.query_context.cmd).operators
+    = std::move(pushdown.store_operators);
+  self->state.query_context.priority
+    = has_low_priority_option(self->state.options)
+        ? query_context::priority::low
+        : query_context::priority::normal;
   self->state.index = std::move(index);
   if (has_continuous_option(options)) {
     VAST_DEBUG("{} has continuous query option", *self);
@@ -299,6 +428,9 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
             self->state.query_status.scheduled = cursor.scheduled_partitions;
             if (cursor.scheduled_partitions == 0)
               request_more_hits(self);
+            else
+              self->state.partition_window.start(cursor.scheduled_partitions,
+                                                 stopwatch::now());
           },
           [=](const caf::error& e) {
             shutdown(self, e);
@@ -338,6 +470,7 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
           for (const auto& t : self->state.pipeline.pipelines())
             pipeline_names.emplace_back(t.name());
           exp["pipelines"] = std::move(pipeline_names);
+          exp["pushdown"] = self->state.pushdown;
           if (v >= status_verbosity::debug)
             detail::fill_status_map(exp, self);
         }
@@ -352,16 +485,41 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
       VAST_ASSERT(slice.encoding() != table_slice_encoding::none);
       VAST_DEBUG("{} got batch of {} events", *self, slice.rows());
       self->state.query_status.processed += slice.rows();
-      // Ship slices to connected SINKs.
-      ship_results(self, std::move(slice));
+      self->state.round_events += slice.rows();
+      ++self->state.round_slices;
+      auto& st = self->state;
+      if (st.max_events > 0) {
+        // Partitions that were already being evaluated when we reached the
+        // limit may still deliver results.
+        if (st.query_status.shipped >= st.max_events)
+          return;
+        slice = head(std::move(slice), st.max_events - st.query_status.shipped);
+      }
+      // Slices from stores contain only events that the store already matched
+      // against the query, so unlike for the continuous query we ship them to
+      // connected SINKs without another candidate check.
+      auto slices = std::vector<table_slice>{};
+      slices.push_back(std::move(slice));
+      ship_results(self, std::move(slices));
+      if (st.max_events > 0 && st.query_status.shipped >= st.max_events
+          && has_historical_option(st.options)
+          && !has_continuous_option(st.options))
+        cancel_remaining_partitions(self);
     },
     [self](atom::done) {
       using namespace std::string_literals;
       // Figure out if we're done by bumping the counter for `received`
       // and check whether it reaches `expected`.
+      // Ignore late completion signals for a query that we already
+      // cancelled.
+      if (self->state.query_status.scheduled == 0
+          && self->state.query_status.received
+               == self->state.query_status.expected)
+        return;
       caf::timespan runtime
         = std::chrono::system_clock::now() - self->state.start;
       self->state.query_status.runtime = runtime;
+      finish_round(self);
       self->state.query_status.received += self->state.query_status.scheduled;
       self->state.query_status.scheduled = 0u;
       if (self->state.query_status.received
@@ -380,6 +538,13 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
             runtime,
             metrics_metadata{
               {"query", fmt::to_string(self->state.query_context.id)}});
+        // A historical query ends once it received all hits, which is when
+        // merged partial aggregations are complete and windowed aggregations
+        // yield the results of their open windows.
+        if (!has_continuous_option(self->state.options)) {
+          self->state.pipeline.end_stream();
+          finish_pipeline(self);
+        }
         if (!self->state.source)
           self->send_exit(self->state.sink, caf::exit_reason::user_shutdown);
       }
@@ -224,6 +224,13 @@ importer(importer_actor::stateful_pointer<importer_state> self,
       fmt::format("{} received an invalid pipeline: {}", *self, err)));
     return importer_actor::behavior_type::make_empty_behavior();
   }
+  auto parallelism
+    = pipeline_parallelism::make(content(self->system().config()));
+  if (!parallelism) {
+    self->quit(std::move(parallelism.error()));
+    return importer_actor::behavior_type::make_empty_behavior();
+  }
+  self->state.executor.parallelize(*parallelism);
   if (index) {
     self->state.index = std::move(index);
     self->state.stage->add_outbound_path(self->state.index);
@@ -10,6 +10,7 @@
 
 #include "vast/fwd.hpp"
 
+#include "vast/bitmap_algorithms.hpp"
 #include "vast/chunk.hpp"
 #include "vast/concept/parseable/to.hpp"
 #include "vast/concept/parseable/vast/uuid.hpp"
@@ -26,6 +27,7 @@
 #include "vast/detail/fill_status_map.hpp"
 #include "vast/detail/narrow.hpp"
 #include "vast/detail/notifying_stream_manager.hpp"
+#include "vast/detail/settings.hpp"
 #include "vast/detail/shutdown_stream_stage.hpp"
 #include "vast/detail/spawn_container_source.hpp"
 #include "vast/detail/tracepoint.hpp"
@@ -47,12 +49,14 @@
 #include "vast/system/catalog.hpp"
 #include "vast/system/partition_transformer.hpp"
 #include "vast/system/passive_partition.hpp"
+#include "vast/system/query_result_cache.hpp"
 #include "vast/system/report.hpp"
 #include "vast/system/shutdown.hpp"
 #include "vast/system/status.hpp"
 #include "vast/table_slice.hpp"
 #include "vast/uuid.hpp"
 
+#include <caf/actor_system_config.hpp>
 #include <caf/attach_stream_source.hpp>
 #include <caf/error.hpp>
 #include <caf/make_copy_on_write.hpp>
@@ -298,7 +302,7 @@ partition_actor partition_factory::operator()(const uuid& id) const {
   VAST_DEBUG("{} loads partition {} for path {}", *state_.self, id, path);
   materializations_++;
   return state_.self->spawn(passive_partition, id, state_.accountant,
-                            filesystem_, path);
+                            filesystem_, path, state_.query_cache);
 }
 
 size_t partition_factory::materializations() const {
@@ -403,7 +407,7 @@ caf::error index_state::load_from_disk() {
             // statistics where already updated on-disk before VAST crashed or
             // not, which is hard to figure out here.
             auto partition = self->spawn(passive_partition, uuid, accountant,
-                                         filesystem, path);
+                                         filesystem, path, query_cache);
             self->request(partition, caf::infinite, atom::erase_v)
               .then(
                 [this, uuid](atom::done) {
@@ -840,6 +844,21 @@ void index_state::schedule_lookups() {
       immediate_completion(*next);
       continue;
     }
+    if (query_cache && persisted_partitions.contains(next->partition)) {
+      std::erase_if(next->queries, [&](const uuid& qid) {
+        if (!answer_from_cache(qid, next->partition, next->schema))
+          return false;
+        if (auto client = pending_queries.handle_completion(qid))
+          self->send(*client, atom::done_v);
+        return true;
+      });
+      if (next->queries.empty()) {
+        VAST_DEBUG("{} answers all queries for partition {} from the result "
+                   "cache",
+                   *self, next->partition);
+        continue;
+      }
+    }
     VAST_DEBUG("{} schedules partition {} for {}", *self, next->partition,
                next->queries);
     // 2. Acquire the actor for the selected partition, potentially materializing
@@ -940,6 +959,51 @@ void index_state::schedule_lookups() {
   }
 }
 
+bool index_state::answer_from_cache(const uuid& query_id,
+                                    const uuid& partition_id,
+                                    const type& schema) {
+  auto it = pending_queries.queries().find(query_id);
+  if (it == pending_queries.queries().end())
+    return false;
+  auto context_it = it->second.query_contexts_per_type.find(schema);
+  if (context_it == it->second.query_contexts_per_type.end())
+    return false;
+  const auto& query_context = context_it->second;
+  if (!query_context.ids.empty())
+    return false;
+  auto cached = query_cache->lookup(partition_id, query_context.expr);
+  if (!cached)
+    return false;
+  auto answered = caf::visit(
+    detail::overload{
+      [&](const count_query_context& count) {
+        // Answer the sink just like the partition and its store would,
+        // including for partitions without any results.
+        if (count.mode == count_query_context::estimate) {
+          if (!cached->hits)
+            return false;
+          self->send(count.sink, rank(*cached->hits));
+          return true;
+        }
+        if (!cached->count)
+          return false;
+        self->send(count.sink, *cached->count);
+        return true;
+      },
+      [&](const extract_query_context&) {
+        // Partitions with results must still ship them to the sink.
+        return cached->count == uint64_t{0};
+      },
+    },
+    query_context.cmd);
+  if (answered) {
+    VAST_DEBUG("{} answers query {} for partition {} from the result cache",
+               *self, query_id, partition_id);
+    ++counters.cached_lookups;
+  }
+  return answered;
+}
+
 // -- introspection ----------------------------------------------------------
 
 namespace {
@@ -986,6 +1050,7 @@ void index_state::send_report() {
       {"scheduler.partition.materializations", materializations},
       {"scheduler.partition.lookups", counters.partition_lookups},
       {"scheduler.partition.scheduled", counters.partition_scheduled},
+      {"scheduler.partition.cached-lookups", counters.cached_lookups},
       {"scheduler.partition.remaining-capacity",
        max_concurrent_partition_lookups - running_partition_lookups},
       {"scheduler.partition.current-lookups", running_partition_lookups},
@@ -997,6 +1062,15 @@ void index_state::send_report() {
             {"component", std::string{name}},
           },
         });
+  if (query_cache) {
+    auto statistics = query_cache->take_statistics();
+    msg.data.push_back({"query-cache.hits", statistics.hits});
+    msg.data.push_back({"query-cache.misses", statistics.misses});
+    msg.data.push_back({"query-cache.evictions", statistics.evictions});
+    msg.data.push_back({"query-cache.invalidations", statistics.invalidations});
+    msg.data.push_back({"query-cache.entries", query_cache->size()});
+    msg.data.push_back({"query-cache.memory-usage", query_cache->memusage()});
+  }
   self->send(accountant, atom::metrics_v, std::move(msg));
   auto r = performance_report{.data = {{{"scheduler", scheduler_measurement}}}};
   self->send(accountant, atom::metrics_v, std::move(r));
@@ -1177,6 +1251,19 @@ index(index_actor::stateful_pointer<index_state> self,
   self->state.partition_capacity = partition_capacity;
   self->state.active_partition_timeout = active_partition_timeout;
   self->state.taste_partitions = taste_partitions;
+  auto query_cache_size
+    = detail::get_bytesize(content(self->system().config()),
+                           "vast.query-cache-size",
+                           defaults::system::query_cache_size);
+  if (!query_cache_size) {
+    VAST_ERROR("{} failed to read vast.query-cache-size: {}", *self,
+               query_cache_size.error());
+    self->quit(query_cache_size.error());
+    return index_actor::behavior_type::make_empty_behavior();
+  }
+  if (*query_cache_size > 0)
+    self->state.query_cache
+      = std::make_shared<query_result_cache>(*query_cache_size);
   self->state.inmem_partitions.factory().filesystem() = self->state.filesystem;
   self->state.inmem_partitions.resize(max_inmem_partitions);
   // Setup stream manager.
@@ -1551,6 +1638,14 @@ index(index_actor::stateful_pointer<index_state> self,
         VAST_WARN("{} can't activate unknown query: {}", *self, err);
       self->state.schedule_lookups();
     },
+    [self](atom::stop, const uuid& query_id) {
+      // Lookups that already started run to completion, but the client does
+      // not receive a completion signal for them anymore.
+      if (auto err = self->state.pending_queries.remove_query(query_id))
+        VAST_DEBUG("{} did not cancel query {}: {}", *self, query_id, err);
+      else
+        VAST_DEBUG("{} cancels query {}", *self, query_id);
+    },
     [self](atom::erase, uuid partition_id) -> caf::result<atom::done> {
       VAST_VERBOSE("{} erases partition {}", *self, partition_id);
       auto rp = self->make_response_promise<atom::done>();
@@ -1576,6 +1671,10 @@ index(index_actor::stateful_pointer<index_state> self,
             auto partition_actor
               = self->state.inmem_partitions.eject(partition_id);
             self->state.persisted_partitions.erase(partition_id);
+            // This also covers partitions that were rebuilt by the partition
+            // transformer, which erases its input partitions.
+            if (self->state.query_cache)
+              self->state.query_cache->erase(partition_id);
             // We don't remove the partition from the queue directly because the
             // query API requires clients to keep track of the number of
             // candidate partitions. Removing the partition from the queue
@@ -9,34 +9,30 @@
 #include "vast/system/infer_command.hpp"
 
 #include "vast/command.hpp"
-#include "vast/concept/parseable/to.hpp"
-#include "vast/concept/parseable/vast/ip.hpp"
-#include "vast/concept/parseable/vast/subnet.hpp"
-#include "vast/concept/parseable/vast/time.hpp"
 #include "vast/concept/printable/stream.hpp"
-#include "vast/data.hpp"
 #include "vast/defaults.hpp"
 #include "vast/detail/assert.hpp"
 #include "vast/detail/make_io_stream.hpp"
 #include "vast/detail/narrow.hpp"
 #include "vast/detail/overload.hpp"
-#include "vast/detail/string.hpp"
 #include "vast/error.hpp"
 #include "vast/format/zeek.hpp"
 #include "vast/logger.hpp"
 #include "vast/module.hpp"
+#include "vast/schema_inference.hpp"
 
 #include <caf/actor_system.hpp>
 #include <caf/expected.hpp>
 #include <caf/message.hpp>
 #include <caf/settings.hpp>
 
-#include <cmath>
+#include <algorithm>
 #include <iostream>
-#include <simdjson.h>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace vast::system {
 
@@ -61,67 +57,40 @@ infer(const std::string& input, const caf::settings& options) {
   return result;
 }
 
-type deduce(simdjson::dom::element e) {
-  switch (e.type()) {
-    case ::simdjson::dom::element_type::ARRAY:
-      if (const auto arr = e.get_array(); arr.size())
-        return type{list_type{deduce(arr.at(0))}};
-      return type{list_type{type{}}};
-    case ::simdjson::dom::element_type::OBJECT: {
-      auto fields = std::vector<record_type::field_view>{};
-      auto xs = e.get_object();
-      if (xs.size() == 0)
-        return type{map_type{string_type{}, type{}}};
-      fields.reserve(xs.size());
-      for (auto [k, v] : xs)
-        fields.push_back({k, deduce(v)});
-      return type{record_type{fields}};
-    }
-    case ::simdjson::dom::element_type::INT64:
-      return type{int64_type{}};
-    case ::simdjson::dom::element_type::UINT64:
-      return type{uint64_type{}};
-    case ::simdjson::dom::element_type::DOUBLE:
-      return type{double_type{}};
-    case ::simdjson::dom::element_type::STRING: {
-      const std::string x{e.get_string().value()};
-      if (parsers::net(x))
-        return type{subnet_type{}};
-      if (parsers::ip(x))
-        return type{ip_type{}};
-      if (parsers::ymdhms(x))
-        return type{time_type{}};
-      if (parsers::duration(x))
-        return type{duration_type{}};
-      return type{string_type{}};
-    }
-    case ::simdjson::dom::element_type::BOOL:
-      return type{bool_type{}};
-    case ::simdjson::dom::element_type::NULL_VALUE:
-      return {};
-  }
-  return {};
-}
-
-caf::expected<module> infer_json(const std::string& input) {
-  using namespace vast;
-  // Try JSONLD.
-  auto lines = detail::split(input, "\r\n");
-  if (lines.empty())
-    return caf::make_error(ec::parse_error, "failed to get first line of "
-                                            "input");
-  ::simdjson::dom::parser json_parser;
-  auto x = json_parser.parse(lines[0]);
-  if (x.error() != ::simdjson::error_code::SUCCESS)
-    return caf::make_error(ec::parse_error, "failed to parse JSON value");
+/// A module that was inferred from JSON, along with the statistics of the
+/// fields that it is based on.
+struct json_module {
+  vast::module schema = {};
+  uint64_t documents = {};
+  std::vector<schema_inference::field_statistics> statistics = {};
+};
 
-  auto deduced = deduce(x.value());
-  const auto* rec_ptr = caf::get_if<record_type>(&deduced);
-  if (!rec_ptr)
-    return caf::make_error(ec::parse_error, "could not parse JSON object");
-  auto rec = type{"json", *rec_ptr};
-  module result;
-  result.add(rec);
+caf::expected<json_module>
+infer_json(std::string buffer, std::istream& input,
+           const caf::settings& options) {
+  auto workers = caf::get_or(options, "vast.infer.workers", int64_t{0});
+  if (workers < 0)
+    return caf::make_error(ec::invalid_configuration, "workers must not be "
+                                                      "negative");
+  if (workers == 0)
+    workers = std::max(std::thread::hardware_concurrency(), 1u);
+  auto max_bytes = caf::get_or(options, "vast.infer.max-bytes",
+                               uint64_t{defaults::infer::max_bytes});
+  auto inference
+    = infer_json_schema(std::move(buffer), input,
+                        detail::narrow_cast<size_t>(workers),
+                        detail::narrow_cast<size_t>(max_bytes));
+  if (inference.invalid() > 0)
+    VAST_WARN("infer skipped {} lines that are not JSON objects",
+              inference.invalid());
+  auto rec = inference.make_type("json", schema_inference::options{});
+  if (!rec)
+    return rec.error();
+  auto result = json_module{
+    .documents = inference.documents(),
+    .statistics = inference.statistics(),
+  };
+  result.schema.add(*rec);
   return result;
 }
 
@@ -130,6 +99,18 @@ caf::message show(const module& module) {
   return {};
 }
 
+caf::message show(const json_module& inferred) {
+  // The legacy schema language supports comments, so the printed module
+  // remains usable as is.
+  std::cout << fmt::format("// Inferred from {} documents.\n",
+                           inferred.documents)
+            << "// field: frequency, estimated distinct values\n";
+  for (const auto& field : inferred.statistics)
+    std::cout << fmt::format("// {}: {:.1f}%, {}\n", field.key,
+                             field.frequency * 100, field.distinct);
+  return show(inferred.schema);
+}
+
 } // namespace
 
 caf::message
@@ -155,11 +136,12 @@ infer_command(const invocation& inv, [[maybe_unused]] caf::actor_system& sys) {
     return show(*schema);
   VAST_INFO("{} failed to infer Zeek TSV: {}",
             detail::pretty_type_name(inv.full_name), render(schema.error()));
-  schema = infer_json(buffer);
-  if (schema)
-    return show(*schema);
+  auto json_schema = infer_json(std::move(buffer), stream, options);
+  if (json_schema)
+    return show(*json_schema);
   VAST_INFO("{} failed to infer JSON: {}",
-            detail::pretty_type_name(inv.full_name), render(schema.error()));
+            detail::pretty_type_name(inv.full_name),
+            render(json_schema.error()));
   // Failing to infer the input is not an error.
   return {};
 }
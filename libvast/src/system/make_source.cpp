@@ -15,6 +15,7 @@
 #include "vast/concept/parseable/vast/expression.hpp"
 #include "vast/concept/parseable/vast/schema.hpp"
 #include "vast/concept/parseable/vast/table_slice_encoding.hpp"
+#include "vast/concept/parseable/vast/time.hpp"
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/port.hpp"
 #include "vast/defaults.hpp"
@@ -27,7 +28,9 @@
 #include "vast/optional.hpp"
 #include "vast/system/datagram_source.hpp"
 #include "vast/system/parse_query.hpp"
+#include "vast/system/sharded_datagram_source.hpp"
 #include "vast/system/source.hpp"
+#include "vast/system/table_slice_size_controller.hpp"
 #include "vast/uuid.hpp"
 
 #include <caf/io/middleman.hpp>
@@ -74,8 +77,39 @@ make_source(caf::actor_system& sys, const std::string& format,
   VAST_ASSERT(encoding != table_slice_encoding::none);
   auto slice_size = caf::get_or(options, "vast.import.batch-size",
                                 defaults::import::table_slice_size);
+  auto udp_workers = caf::get_or(options, "vast.import.udp-workers", int64_t{0});
+  if (udp_workers < 0)
+    return caf::make_error(ec::invalid_configuration,
+                           "udp-workers must not be negative");
   if (slice_size == 0)
     slice_size = std::numeric_limits<decltype(slice_size)>::max();
+  // Adapting the table slice size to the input rate requires a target latency.
+  auto slice_size_options
+    = std::optional<table_slice_size_controller::options>{};
+  if (auto latency = caf::get_if<std::string>(
+        &options, "vast.import.batch-target-latency")) {
+    auto target_latency = to<duration>(*latency);
+    if (!target_latency || *target_latency <= duration::zero())
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("invalid batch-target-latency: {}",
+                                         *latency));
+    slice_size_options.emplace();
+    slice_size_options->target_latency = *target_latency;
+    slice_size_options->min_size
+      = caf::get_or(options, "vast.import.batch-size-min",
+                    defaults::import::min_table_slice_size);
+    slice_size_options->max_size
+      = caf::get_or(options, "vast.import.batch-size-max",
+                    defaults::import::max_table_slice_size);
+    if (slice_size_options->min_size == 0
+        || slice_size_options->min_size > slice_size_options->max_size)
+      return caf::make_error(ec::invalid_configuration,
+                             "batch-size-min must be positive and must not "
+                             "exceed batch-size-max");
+    if (udp_workers > 0)
+      VAST_WARN("{} ignores batch-target-latency with udp-workers",
+                inv.full_name);
+  }
   // Parse module local to the import command.
   auto module = get_module(options);
   if (!module)
@@ -123,8 +157,27 @@ make_source(caf::actor_system& sys, const std::string& format,
   // Spawn the source, falling back to the default spawn function.
   auto local_module = module ? std::move(*module) : vast::module{};
   auto type_filter = type ? std::move(*type) : std::string{};
+  // The high-rate UDP mode needs a separate reader per shard.
+  auto shard_readers = std::vector<format::reader_ptr>{};
+  if (udp_port) {
+    for (int64_t i = 0; i < udp_workers; ++i) {
+      auto shard_reader = format::reader::make(format, inv.options);
+      if (!shard_reader)
+        return shard_reader.error();
+      shard_readers.push_back(std::move(*shard_reader));
+    }
+  }
   auto src =
     [&](auto&&... args) {
+      if (!shard_readers.empty()) {
+        if (detached)
+          return sys.spawn<caf::detached>(
+            sharded_datagram_source, *udp_port, std::move(shard_readers),
+            std::forward<decltype(args)>(args)...);
+        return sys.spawn(sharded_datagram_source, *udp_port,
+                         std::move(shard_readers),
+                         std::forward<decltype(args)>(args)...);
+      }
       if (udp_port) {
         if (detached)
           return sys.middleman().spawn_broker<caf::spawn_options::detach_flag>(
@@ -134,8 +187,10 @@ make_source(caf::actor_system& sys, const std::string& format,
       }
       if (detached)
         return sys.spawn<caf::detached>(source,
-                                        std::forward<decltype(args)>(args)...);
-      return sys.spawn(source, std::forward<decltype(args)>(args)...);
+                                        std::forward<decltype(args)>(args)...,
+                                        std::move(slice_size_options));
+      return sys.spawn(source, std::forward<decltype(args)>(args)...,
+                       std::move(slice_size_options));
     }(std::move(*reader), slice_size, max_events, std::move(catalog),
       std::move(local_module), std::move(type_filter), std::move(accountant),
       std::move(pipelines));
@@ -0,0 +1,133 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/partition_request_window.hpp"
+
+#include "vast/detail/assert.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <utility>
+
+namespace vast::system {
+
+partition_request_window::partition_request_window()
+  : partition_request_window(options{}) {
+}
+
+partition_request_window::partition_request_window(options opts)
+  : options_{opts} {
+  if (options_.max_size == 0)
+    options_.max_size
+      = std::max(size_t{1}, size_t{std::thread::hardware_concurrency()});
+  options_.min_size = std::clamp(options_.min_size, size_t{1},
+                                 options_.max_size);
+  size_ = options_.min_size;
+  threshold_ = options_.max_size;
+}
+
+partition_request_window::options
+partition_request_window::make_options(const caf::settings& settings) {
+  auto get = [&](std::string_view key, size_t fallback) {
+    auto result = caf::get_or(settings, key, static_cast<int64_t>(fallback));
+    return static_cast<size_t>(std::max(int64_t{0}, result));
+  };
+  return {
+    .min_size = get("vast.min-partition-window",
+                    defaults::system::min_partition_window),
+    .max_size = get("vast.max-partition-window",
+                    defaults::system::max_partition_window),
+  };
+}
+
+size_t partition_request_window::size() const {
+  return size_;
+}
+
+size_t partition_request_window::max_size() const {
+  return options_.max_size;
+}
+
+duration partition_request_window::latency() const {
+  return latency_;
+}
+
+bool partition_request_window::in_flight() const {
+  return round_partitions_ > 0;
+}
+
+partition_request_window::statistics
+partition_request_window::take_statistics() {
+  return std::exchange(statistics_, {});
+}
+
+size_t partition_request_window::next(size_t remaining, size_t demand) const {
+  if (remaining == 0)
+    return 0;
+  auto result = std::min(size_, remaining);
+  if (demand > 0 && total_hits_ > 0) {
+    const auto hits_per_partition = static_cast<double>(total_hits_)
+                                    / static_cast<double>(total_partitions_);
+    const auto needed = static_cast<size_t>(
+      std::ceil(static_cast<double>(demand) / hits_per_partition));
+    result = std::min(result, std::max(needed, size_t{1}));
+  }
+  return result;
+}
+
+void partition_request_window::start(size_t partitions,
+                                     stopwatch::time_point now) {
+  VAST_ASSERT(partitions > 0);
+  round_partitions_ = partitions;
+  round_start_ = now;
+}
+
+partition_request_window::decision
+partition_request_window::finish(uint64_t hits, bool backlogged,
+                                 stopwatch::time_point now) {
+  VAST_ASSERT(in_flight());
+  const auto partitions = std::exchange(round_partitions_, 0);
+  latency_ = now - round_start_;
+  fastest_ = std::min(fastest_, latency_);
+  total_partitions_ += partitions;
+  total_hits_ += hits;
+  ++statistics_.rounds;
+  statistics_.partitions += partitions;
+  statistics_.hits += hits;
+  auto shrink = [&](size_t size) {
+    size = std::max(size, options_.min_size);
+    if (size >= size_)
+      return decision::keep;
+    size_ = size;
+    ++statistics_.shrunk;
+    return decision::shrink;
+  };
+  if (backlogged) {
+    threshold_ = std::max(size_ / 2, options_.min_size);
+    return shrink(size_ / 2);
+  }
+  // Rounds take about as long as a single partition for as long as the INDEX
+  // evaluates all requested partitions concurrently.
+  if (latency_ > 3 * fastest_) {
+    threshold_ = std::max(size_ - size_ / 4 - 1, options_.min_size);
+    return shrink(size_ - size_ / 4 - 1);
+  }
+  // Only a round that used the entire window tells whether a larger window
+  // helps.
+  if (2 * latency_ <= 3 * fastest_ && partitions >= size_
+      && size_ < options_.max_size) {
+    size_ = size_ < threshold_ ? std::min(size_ * 2, threshold_) : size_ + 1;
+    size_ = std::min(size_, options_.max_size);
+    ++statistics_.grown;
+    return decision::grow;
+  }
+  return decision::keep;
+}
+
+} // namespace vast::system
@@ -26,6 +26,7 @@
 #include "vast/logger.hpp"
 #include "vast/plugin.hpp"
 #include "vast/system/indexer.hpp"
+#include "vast/system/query_result_cache.hpp"
 #include "vast/system/report.hpp"
 #include "vast/system/shutdown.hpp"
 #include "vast/system/status.hpp"
@@ -68,6 +69,40 @@ void deliver_error_to_deferred_requests(passive_partition_state& state,
   }
 }
 
+/// Delivers the candidates of a query: count estimates are answered directly,
+/// all other queries are delegated to the store for the candidate check.
+void deliver_hits(
+  partition_actor::stateful_pointer<passive_partition_state> self,
+  caf::typed_response_promise<uint64_t> rp, query_context query_context,
+  const ids& hits) {
+  auto* count = caf::get_if<count_query_context>(&query_context.cmd);
+  if (count && count->mode == count_query_context::estimate) {
+    self->send(count->sink, rank(hits));
+    rp.deliver(rank(hits));
+    return;
+  }
+  query_context.ids = hits;
+  if (!self->state.cache) {
+    rp.delegate(self->state.store, atom::query_v, std::move(query_context));
+    return;
+  }
+  auto expr = query_context.expr;
+  self
+    ->request(self->state.store, caf::infinite, atom::query_v,
+              std::move(query_context))
+    .then(
+      [self, rp, expr = std::move(expr)](uint64_t num_hits) mutable {
+        // Stores report zero results for queries whose sink went away, so we
+        // only cache a non-zero number of results.
+        if (num_hits > 0)
+          self->state.cache->insert_count(self->state.id, expr, num_hits);
+        rp.deliver(num_hits);
+      },
+      [rp](caf::error& err) mutable {
+        rp.deliver(std::move(err));
+      });
+}
+
 caf::expected<vast::record_type>
 unpack_schema(const fbs::partition::LegacyPartition& partition) {
   if (auto const* data = partition.combined_schema_caf_0_17()) {
@@ -329,12 +364,14 @@ passive_partition_state::initialize_from_chunk(const vast::chunk_ptr& chunk) {
 partition_actor::behavior_type passive_partition(
   partition_actor::stateful_pointer<passive_partition_state> self, uuid id,
   accountant_actor accountant, filesystem_actor filesystem,
-  const std::filesystem::path& path) {
+  const std::filesystem::path& path,
+  std::shared_ptr<query_result_cache> cache) {
   auto id_string = to_string(id);
   self->state.self = self;
   self->state.path = path;
   self->state.accountant = std::move(accountant);
   self->state.filesystem = std::move(filesystem);
+  self->state.cache = std::move(cache);
   self->state.name = "partition-" + id_string;
   VAST_TRACEPOINT(passive_partition_spawned, id_string.c_str());
   self->set_down_handler([=](const caf::down_msg& msg) {
@@ -466,9 +503,25 @@ partition_actor::behavior_type passive_partition(
         rp.delegate(self->state.store, atom::query_v, query_context);
         return rp;
       }
+      // Passive partitions are immutable, so the candidates of an earlier
+      // evaluation of the same expression remain valid.
+      if (self->state.cache) {
+        if (auto hits = self->state.cache->find_hits(self->state.id,
+                                                     query_context.expr)) {
+          VAST_DEBUG("{} uses cached candidates for {}", *self, query_context);
+          deliver_hits(self, rp, std::move(query_context), *hits);
+          return rp;
+        }
+      }
       auto start = std::chrono::steady_clock::now();
       auto triples = detail::evaluate(self->state, query_context.expr);
       if (triples.empty()) {
+        if (self->state.cache) {
+          self->state.cache->insert_hits(self->state.id, query_context.expr,
+                                         ids{});
+          self->state.cache->insert_count(self->state.id, query_context.expr,
+                                          0);
+        }
         rp.deliver(uint64_t{0});
         return rp;
       }
@@ -501,17 +554,16 @@ partition_actor::behavior_type passive_partition(
                          {"issuer", query_context.issuer},
                          {"partition-type", "passive"},
                        });
+            if (self->state.cache) {
+              self->state.cache->insert_hits(self->state.id,
+                                             query_context.expr, hits);
+              if (rank(hits) == 0)
+                self->state.cache->insert_count(self->state.id,
+                                                query_context.expr, 0);
+            }
             // TODO: Use the first path if the expression can be evaluated
             // exactly.
-            auto* count = caf::get_if<count_query_context>(&query_context.cmd);
-            if (count && count->mode == count_query_context::estimate) {
-              self->send(count->sink, rank(hits));
-              rp.deliver(rank(hits));
-            } else {
-              query_context.ids = hits;
-              rp.delegate(self->state.store, atom::query_v,
-                          std::move(query_context));
-            }
+            deliver_hits(self, rp, std::move(query_context), hits);
           },
           [rp](caf::error& err) mutable {
             rp.deliver(std::move(err));
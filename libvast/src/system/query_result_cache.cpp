@@ -0,0 +1,211 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/query_result_cache.hpp"
+
+#include "vast/detail/assert.hpp"
+#include "vast/detail/overload.hpp"
+
+#include <utility>
+
+namespace vast::system {
+
+namespace {
+
+/// Approximates the memory that a data value of a predicate occupies beyond
+/// its own footprint.
+size_t approximate_size(const data& x) {
+  return caf::visit(detail::overload{
+                      [](const std::string& str) {
+                        return str.size();
+                      },
+                      [](const pattern& pat) {
+                        return pat.string().size();
+                      },
+                      [](const list& xs) {
+                        auto result = xs.size() * sizeof(data);
+                        for (const auto& x : xs)
+                          result += approximate_size(x);
+                        return result;
+                      },
+                      [](const auto&) {
+                        return size_t{0};
+                      },
+                    },
+                    x);
+}
+
+/// Approximates the memory that an expression occupies, including the nodes
+/// of its tree.
+size_t approximate_size(const expression& expr) {
+  auto operand_size = [](const predicate::operand& x) {
+    return caf::visit(detail::overload{
+                        [](const field_extractor& ex) {
+                          return ex.field.size();
+                        },
+                        [](const data& x) {
+                          return approximate_size(x);
+                        },
+                        [](const auto&) {
+                          return size_t{0};
+                        },
+                      },
+                      x);
+  };
+  auto connective_size = [](const std::vector<expression>& xs) {
+    auto result = size_t{0};
+    for (const auto& x : xs)
+      result += approximate_size(x);
+    return result;
+  };
+  return sizeof(expression)
+         + caf::visit(detail::overload{
+                        [&](const predicate& pred) {
+                          return operand_size(pred.lhs)
+                                 + operand_size(pred.rhs);
+                        },
+                        [&](const conjunction& xs) {
+                          return connective_size(xs);
+                        },
+                        [&](const disjunction& xs) {
+                          return connective_size(xs);
+                        },
+                        [](const negation& x) {
+                          return approximate_size(x.expr());
+                        },
+                        [](caf::none_t) {
+                          return size_t{0};
+                        },
+                      },
+                      expr);
+}
+
+} // namespace
+
+query_result_cache::query_result_cache(size_t capacity) : capacity_{capacity} {
+  // nop
+}
+
+size_t query_result_cache::capacity() const {
+  return capacity_;
+}
+
+size_t query_result_cache::size() const {
+  auto lock = std::lock_guard{mutex_};
+  return entries_.size();
+}
+
+size_t query_result_cache::memusage() const {
+  auto lock = std::lock_guard{mutex_};
+  return memusage_;
+}
+
+query_result_cache::statistics query_result_cache::take_statistics() {
+  auto lock = std::lock_guard{mutex_};
+  return std::exchange(statistics_, {});
+}
+
+std::optional<query_result_cache::entry>
+query_result_cache::lookup(const uuid& partition, const expression& expr) {
+  auto lock = std::lock_guard{mutex_};
+  auto partition_it = partitions_.find(partition);
+  if (partition_it == partitions_.end()) {
+    ++statistics_.misses;
+    return std::nullopt;
+  }
+  auto it = partition_it->second.find(expr);
+  if (it == partition_it->second.end()) {
+    ++statistics_.misses;
+    return std::nullopt;
+  }
+  ++statistics_.hits;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->value;
+}
+
+std::optional<ids>
+query_result_cache::find_hits(const uuid& partition, const expression& expr) {
+  auto lock = std::lock_guard{mutex_};
+  auto partition_it = partitions_.find(partition);
+  if (partition_it == partitions_.end())
+    return std::nullopt;
+  auto it = partition_it->second.find(expr);
+  if (it == partition_it->second.end())
+    return std::nullopt;
+  return it->second->value.hits;
+}
+
+void query_result_cache::insert_hits(const uuid& partition,
+                                     const expression& expr, ids hits) {
+  upsert(partition, expr, [&](entry& x) {
+    x.hits = std::move(hits);
+  });
+}
+
+void query_result_cache::insert_count(const uuid& partition,
+                                      const expression& expr, uint64_t count) {
+  upsert(partition, expr, [&](entry& x) {
+    x.count = count;
+  });
+}
+
+void query_result_cache::erase(const uuid& partition) {
+  auto lock = std::lock_guard{mutex_};
+  auto partition_it = partitions_.find(partition);
+  if (partition_it == partitions_.end())
+    return;
+  for (auto& [_, it] : partition_it->second) {
+    memusage_ -= it->memusage;
+    entries_.erase(it);
+    ++statistics_.invalidations;
+  }
+  partitions_.erase(partition_it);
+}
+
+template <class Update>
+void query_result_cache::upsert(const uuid& partition, const expression& expr,
+                                Update update) {
+  // The bookkeeping of the list node and the map entry comes on top of the
+  // cached results themselves, and both of them hold a copy of the expression.
+  const auto overhead = sizeof(node) + sizeof(partition_map::value_type)
+                        + 4 * sizeof(void*) + 2 * approximate_size(expr);
+  auto lock = std::lock_guard{mutex_};
+  auto& entries = partitions_[partition];
+  auto [it, inserted] = entries.try_emplace(expr);
+  if (inserted) {
+    entries_.push_front(node{partition, expr, {}, 0});
+    it->second = entries_.begin();
+  } else {
+    entries_.splice(entries_.begin(), entries_, it->second);
+  }
+  auto& x = *it->second;
+  update(x.value);
+  memusage_ -= x.memusage;
+  x.memusage = overhead + (x.value.hits ? x.value.hits->memusage() : 0);
+  memusage_ += x.memusage;
+  shrink();
+}
+
+void query_result_cache::shrink() {
+  while (memusage_ > capacity_ && !entries_.empty()) {
+    remove(std::prev(entries_.end()));
+    ++statistics_.evictions;
+  }
+}
+
+void query_result_cache::remove(list_type::iterator it) {
+  auto partition_it = partitions_.find(it->partition);
+  VAST_ASSERT(partition_it != partitions_.end());
+  partition_it->second.erase(it->expr);
+  if (partition_it->second.empty())
+    partitions_.erase(partition_it);
+  memusage_ -= it->memusage;
+  entries_.erase(it);
+}
+
+} // namespace vast::system
@@ -0,0 +1,393 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/sharded_datagram_source.hpp"
+
+#include "vast/fwd.hpp"
+
+#include "vast/defaults.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/detail/fill_status_map.hpp"
+#include "vast/detail/streambuf.hpp"
+#include "vast/detail/weak_run_delayed.hpp"
+#include "vast/error.hpp"
+#include "vast/expression.hpp"
+#include "vast/format/reader.hpp"
+#include "vast/logger.hpp"
+#include "vast/module.hpp"
+#include "vast/pipeline.hpp"
+#include "vast/system/status.hpp"
+#include "vast/table_slice.hpp"
+
+#include <caf/attach_continuous_stream_source.hpp>
+#include <caf/downstream.hpp>
+#include <caf/send.hpp>
+#include <caf/stateful_actor.hpp>
+
+#include <chrono>
+#include <limits>
+#include <optional>
+
+namespace vast::system {
+
+// -- datagram_slice_queue -----------------------------------------------------
+
+datagram_slice_queue::datagram_slice_queue(size_t capacity)
+  : capacity_{capacity} {
+  // nop
+}
+
+bool datagram_slice_queue::push(std::vector<table_slice>&& slices) {
+  auto guard = std::lock_guard{mutex_};
+  for (auto& slice : slices)
+    slices_.push_back(std::move(slice));
+  return !std::exchange(notified_, true);
+}
+
+std::vector<table_slice> datagram_slice_queue::pop(size_t num) {
+  auto guard = std::lock_guard{mutex_};
+  auto result = std::vector<table_slice>{};
+  num = std::min(num, slices_.size());
+  result.reserve(num);
+  for (size_t i = 0; i < num; ++i) {
+    result.push_back(std::move(slices_.front()));
+    slices_.pop_front();
+  }
+  // Once the consumer drained the queue, the next push must wake it up again.
+  if (slices_.empty())
+    notified_ = false;
+  return result;
+}
+
+bool datagram_slice_queue::full() const {
+  auto guard = std::lock_guard{mutex_};
+  return slices_.size() >= capacity_;
+}
+
+// -- datagram_shard -----------------------------------------------------------
+
+datagram_shard::datagram_shard(detail::udp_batch_receiver receiver,
+                               format::reader_ptr reader,
+                               size_t table_slice_size,
+                               std::shared_ptr<datagram_slice_queue> queue)
+  : receiver_{std::move(receiver)},
+    reader_{std::move(reader)},
+    table_slice_size_{table_slice_size},
+    queue_{std::move(queue)} {
+  // nop
+}
+
+datagram_shard::~datagram_shard() {
+  stop();
+}
+
+void datagram_shard::start(caf::actor source) {
+  VAST_ASSERT(!thread_.joinable());
+  running_ = true;
+  thread_ = std::thread{[this, source = std::move(source)]() mutable {
+    run(std::move(source));
+  }};
+}
+
+void datagram_shard::stop() {
+  running_ = false;
+  if (thread_.joinable())
+    thread_.join();
+}
+
+caf::error datagram_shard::module(vast::module mod) {
+  auto guard = std::lock_guard{reader_mutex_};
+  return reader_->module(std::move(mod));
+}
+
+measurement datagram_shard::take_metrics() {
+  auto guard = std::lock_guard{reader_mutex_};
+  return std::exchange(metrics_, {});
+}
+
+uint64_t datagram_shard::kernel_drops() const {
+  return kernel_drops_;
+}
+
+uint64_t datagram_shard::take_dropped_datagrams() {
+  return dropped_datagrams_.exchange(0);
+}
+
+void datagram_shard::run(caf::actor source) {
+  const auto read_timeout
+    = std::chrono::duration_cast<std::chrono::microseconds>(
+      reader_->read_timeout_);
+  const auto batch_timeout = reader_->batch_timeout_;
+  auto last_flush = format::reader::reader_clock::now();
+  while (running_) {
+    auto received = receiver_.receive(read_timeout);
+    if (!received) {
+      // The shard cannot recover from losing its socket, so we take down the
+      // source instead of silently losing the shard's share of the input.
+      VAST_ERROR("{} shard failed to receive datagrams: {}", reader_->name(),
+                 received.error());
+      caf::anon_send_exit(source, std::move(received.error()));
+      break;
+    }
+    kernel_drops_ = receiver_.kernel_drops();
+    if (*received > 0 && queue_->full()) {
+      // The source cannot keep up, so we drop the input before parsing it
+      // rather than parsing it and dropping the slices afterwards.
+      dropped_datagrams_ += *received;
+    } else {
+      for (size_t i = 0; i < *received; ++i) {
+        auto datagram = receiver_.datagram(i);
+        if (datagram.empty())
+          continue;
+        buffer_.append(datagram.data(), datagram.size());
+        // Every datagram holds at least one event, so we must make sure that
+        // events do not run into each other in the concatenated buffer.
+        if (buffer_.back() != '\n')
+          buffer_.push_back('\n');
+        ++buffered_datagrams_;
+      }
+    }
+    auto now = format::reader::reader_clock::now();
+    if (buffered_datagrams_ >= table_slice_size_
+        || (buffered_datagrams_ > 0 && now - last_flush >= batch_timeout)) {
+      flush(source);
+      last_flush = now;
+    }
+  }
+}
+
+void datagram_shard::flush(const caf::actor& source) {
+  auto slices = std::vector<table_slice>{};
+  {
+    auto guard = std::lock_guard{reader_mutex_};
+    auto t = timer::start(metrics_);
+    input_buffer_ = detail::arraybuf<>{buffer_.data(), buffer_.size()};
+    reader_->reset(std::make_unique<std::istream>(&input_buffer_));
+    auto push_slice = [&](table_slice slice) {
+      slices.push_back(std::move(slice));
+    };
+    auto [err, produced] = reader_->read(std::numeric_limits<size_t>::max(),
+                                         table_slice_size_, push_slice);
+    t.stop(produced);
+    if (err && err != ec::end_of_input)
+      VAST_WARN("{} shard failed to parse {} datagrams: {}", reader_->name(),
+                buffered_datagrams_, err);
+  }
+  buffer_.clear();
+  buffered_datagrams_ = 0;
+  if (!slices.empty() && queue_->push(std::move(slices)))
+    caf::anon_send(source, atom::wakeup_v);
+}
+
+// -- sharded_datagram_source --------------------------------------------------
+
+sharded_datagram_source_state::~sharded_datagram_source_state() {
+  for (auto& shard : shards)
+    shard->stop();
+}
+
+void sharded_datagram_source_state::send_udp_report() {
+  auto kernel_drops = uint64_t{0};
+  auto dropped_datagrams = uint64_t{0};
+  for (auto& shard : shards) {
+    metrics += shard->take_metrics();
+    kernel_drops += shard->kernel_drops();
+    dropped_datagrams += shard->take_dropped_datagrams();
+  }
+  send_report();
+  auto new_kernel_drops = kernel_drops - reported_kernel_drops;
+  reported_kernel_drops = kernel_drops;
+  if (new_kernel_drops > 0)
+    VAST_WARN("{} lost {} datagrams because the kernel's receive buffers "
+              "overflowed",
+              reader->name(), new_kernel_drops);
+  if (dropped_datagrams > 0)
+    VAST_WARN("{} has no capacity left in stream and dropped {} datagrams",
+              reader->name(), dropped_datagrams);
+  if (accountant) {
+    caf::unsafe_send_as(self, accountant, atom::metrics_v,
+                        fmt::format("{}.udp.kernel-drops", reader->name()),
+                        new_kernel_drops, metrics_metadata{});
+    caf::unsafe_send_as(self, accountant, atom::metrics_v,
+                        fmt::format("{}.udp.dropped-datagrams", reader->name()),
+                        dropped_datagrams, metrics_metadata{});
+  }
+}
+
+caf::behavior sharded_datagram_source(
+  caf::stateful_actor<sharded_datagram_source_state>* self,
+  uint16_t udp_listening_port, std::vector<format::reader_ptr> shard_readers,
+  format::reader_ptr reader, size_t table_slice_size,
+  std::optional<size_t> max_events, const catalog_actor& catalog,
+  vast::module local_module, std::string type_filter,
+  accountant_actor accountant, std::vector<pipeline>&& pipelines) {
+  VAST_ASSERT(!shard_readers.empty());
+  self->state.executor = pipeline_executor{std::move(pipelines)};
+  if (auto err = self->state.executor.validate(
+        pipeline_executor::allow_aggregate_pipelines::yes)) {
+    self->quit(caf::make_error(
+      ec::invalid_argument,
+      fmt::format("{} received an invalid pipeline: {}", *self, err)));
+    return {};
+  }
+  // Open one socket per shard. All sockets share the same port, and the
+  // kernel distributes incoming datagrams among them.
+  self->state.queue = std::make_shared<datagram_slice_queue>(
+    defaults::import::udp_max_buffered_slices);
+  for (auto& shard_reader : shard_readers) {
+    auto receiver = detail::udp_batch_receiver::make(
+      udp_listening_port, defaults::import::udp_batch_size,
+      defaults::import::udp_max_datagram_size, true);
+    if (!receiver) {
+      VAST_ERROR("{} could not open port {}: {}", *self, udp_listening_port,
+                 receiver.error());
+      self->quit(std::move(receiver.error()));
+      return {};
+    }
+    self->state.shards.push_back(std::make_unique<datagram_shard>(
+      std::move(*receiver), std::move(shard_reader), table_slice_size,
+      self->state.queue));
+  }
+  VAST_DEBUG("{} starts listening at port {} with {} shards", *self,
+             udp_listening_port, self->state.shards.size());
+  // Initialize state.
+  self->state.self = self;
+  self->state.name = reader->name();
+  self->state.reader = std::move(reader);
+  self->state.requested = max_events;
+  self->state.local_module = std::move(local_module);
+  self->state.accountant = std::move(accountant);
+  self->state.table_slice_size = table_slice_size;
+  self->state.has_sink = false;
+  self->state.done = false;
+  // Register with the accountant.
+  self->send(self->state.accountant, atom::announce_v, self->state.name);
+  self->state.initialize(catalog, std::move(type_filter));
+  for (auto& shard : self->state.shards)
+    if (auto err = shard->module(self->state.reader->module()))
+      VAST_ERROR("{} failed to set module for shard: {}", *self, err);
+  self->set_exit_handler([=](const caf::exit_msg& msg) {
+    VAST_VERBOSE("{} received EXIT from {}", *self, msg.source);
+    self->state.done = true;
+    for (auto& shard : self->state.shards)
+      shard->stop();
+    if (self->state.mgr) {
+      self->state.mgr->shutdown();
+      self->state.mgr->out().fan_out_flush();
+      self->state.mgr->out().close();
+      self->state.mgr->out().force_emit_batches();
+    }
+    self->quit(msg.reason);
+  });
+  // Spin up the stream manager for the source.
+  self->state.mgr = caf::attach_continuous_stream_source(
+    self,
+    // init
+    [self](caf::unit_t&) {
+      caf::timestamp now = std::chrono::system_clock::now();
+      self->send(self->state.accountant, atom::metrics_v, "source.start", now,
+                 metrics_metadata{});
+    },
+    // get next element
+    [self](caf::unit_t&, caf::downstream<table_slice>& out, size_t num) {
+      // The shards already parsed the input, so all that is left to do here
+      // is filtering and forwarding the slices.
+      for (auto& slice : self->state.queue->pop(num)) {
+        self->state.count += slice.rows();
+        self->state.filter_and_push(std::move(slice), [&](table_slice slice) {
+          const auto& schema = slice.schema();
+          self->state.event_counters[std::string{schema.name()}]
+            += slice.rows();
+          out.push(std::move(slice));
+        });
+      }
+      if (self->state.requested
+          && self->state.count >= *self->state.requested) {
+        VAST_DEBUG("{} finished with {} events", *self, self->state.count);
+        self->state.done = true;
+        for (auto& shard : self->state.shards)
+          shard->stop();
+        self->state.send_udp_report();
+        self->quit();
+      }
+    },
+    // done?
+    [self](const caf::unit_t&) {
+      return self->state.done;
+    });
+  auto result = source_actor::behavior_type{
+    [self](atom::get, atom::module) { //
+      return self->state.reader->module();
+    },
+    [self](atom::put, class module module) -> caf::result<void> {
+      VAST_DEBUG("{} received schema {}", *self, module);
+      for (auto& shard : self->state.shards)
+        if (auto err = shard->module(module))
+          return err;
+      if (auto err = self->state.reader->module(std::move(module)))
+        return err;
+      return caf::unit;
+    },
+    [self](atom::normalize, expression& expr) -> caf::result<void> {
+      auto normalized_expr = normalize_and_validate(std::move(expr));
+      if (!normalized_expr) {
+        return caf::make_error(ec::invalid_argument,
+                               fmt::format("failed to normalize expression: "
+                                           "{}",
+                                           normalized_expr.error()));
+      }
+      self->state.filter = std::move(*normalized_expr);
+      return {};
+    },
+    [self](stream_sink_actor<table_slice, std::string> sink) {
+      VAST_ASSERT(sink);
+      VAST_DEBUG("{} registers sink {}", *self, VAST_ARG(sink));
+      if (self->state.has_sink) {
+        self->quit(caf::make_error(ec::logic_error,
+                                   "source does not support "
+                                   "multiple sinks; sender =",
+                                   self->current_sender()));
+        return;
+      }
+      // Start streaming. The shards must not start receiving before we have a
+      // sink, as they would otherwise drop everything right away.
+      self->state.has_sink = true;
+      detail::weak_run_delayed_loop(self, defaults::system::telemetry_rate,
+                                    [self] {
+                                      self->state.send_udp_report();
+                                    });
+      self->state.mgr->add_outbound_path(
+        sink, std::make_tuple(self->state.reader->name()));
+      for (auto& shard : self->state.shards)
+        shard->start(caf::actor_cast<caf::actor>(self));
+    },
+    [self](atom::status, status_verbosity v) {
+      auto rs = make_status_request_state(self);
+      if (v >= status_verbosity::detailed) {
+        record src;
+        if (self->state.reader)
+          src["format"] = self->state.reader->name();
+        src["produced"] = uint64_t{self->state.count};
+        src["shards"] = uint64_t{self->state.shards.size()};
+        // General state such as open streams.
+        if (v >= status_verbosity::debug)
+          detail::fill_status_map(src, self);
+      }
+      return rs->promise;
+    },
+  };
+  // In addition to the SOURCE interface, the shards wake up the actor
+  // whenever new slices are ready for pickup.
+  caf::message_handler base{result.unbox().as_behavior_impl()};
+  return base.or_else([self](atom::wakeup) {
+    if (self->state.mgr->generate_messages())
+      self->state.mgr->push();
+  });
+}
+
+} // namespace vast::system
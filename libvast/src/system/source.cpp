@@ -129,6 +129,22 @@ void source_state::send_report() {
     send_to_accountant(self, accountant, atom::metrics_v,
                        fmt::format("{}.events.{}", reader->name(), name), count,
                        metrics_metadata{});
+  // Send the decisions of the table slice size controller to the accountant.
+  if (slice_size_controller) {
+    auto stats = slice_size_controller->take_statistics();
+    send_to_accountant(self, accountant, atom::metrics_v,
+                       fmt::format("{}.batch-size", reader->name()),
+                       uint64_t{table_slice_size}, metrics_metadata{});
+    send_to_accountant(self, accountant, atom::metrics_v,
+                       fmt::format("{}.batch-size.grown", reader->name()),
+                       stats.grown, metrics_metadata{});
+    send_to_accountant(self, accountant, atom::metrics_v,
+                       fmt::format("{}.batch-size.shrunk", reader->name()),
+                       stats.shrunk, metrics_metadata{});
+    send_to_accountant(self, accountant, atom::metrics_v,
+                       fmt::format("{}.batch-size.input-rate", reader->name()),
+                       slice_size_controller->rate(), metrics_metadata{});
+  }
 }
 
 void source_state::filter_and_push(
@@ -178,7 +194,8 @@ source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
        size_t table_slice_size, std::optional<size_t> max_events,
        const catalog_actor& catalog, vast::module local_module,
        std::string type_filter, accountant_actor accountant,
-       std::vector<pipeline>&& pipelines) {
+       std::vector<pipeline>&& pipelines,
+       std::optional<table_slice_size_controller::options> slice_size_options) {
   VAST_TRACE_SCOPE("{}", VAST_ARG(*self));
   // Initialize state.
   self->state.self = self;
@@ -188,6 +205,11 @@ source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
   self->state.local_module = std::move(local_module);
   self->state.accountant = std::move(accountant);
   self->state.table_slice_size = table_slice_size;
+  if (slice_size_options) {
+    self->state.slice_size_controller.emplace(table_slice_size,
+                                              *slice_size_options);
+    self->state.table_slice_size = self->state.slice_size_controller->size();
+  }
   self->state.has_sink = false;
   self->state.done = false;
   self->state.executor = pipeline_executor{std::move(pipelines)};
@@ -198,6 +220,13 @@ source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
       fmt::format("{} received an invalid pipeline: {}", *self, err)));
     return {};
   }
+  auto parallelism
+    = pipeline_parallelism::make(content(self->system().config()));
+  if (!parallelism) {
+    self->quit(std::move(parallelism.error()));
+    return {};
+  }
+  self->state.executor.parallelize(*parallelism);
   // Register with the accountant.
   self->send(self->state.accountant, atom::announce_v, self->state.name);
   self->state.initialize(catalog, std::move(type_filter));
@@ -253,6 +282,19 @@ source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
       // make. This is especially annoying when the filter is invalid.
       t.stop(produced);
       self->state.count += produced;
+      if (auto& controller = self->state.slice_size_controller) {
+        auto decision = controller->observe(produced, events, stopwatch::now());
+        if (decision != table_slice_size_controller::decision::keep) {
+          VAST_VERBOSE("{} {} its table slice size from {} to {} at {} events/s",
+                       *self,
+                       decision == table_slice_size_controller::decision::grow
+                         ? "grows"
+                         : "shrinks",
+                       self->state.table_slice_size, controller->size(),
+                       static_cast<uint64_t>(controller->rate()));
+          self->state.table_slice_size = controller->size();
+        }
+      }
       auto finish = [&] {
         self->state.done = true;
         self->state.send_report();
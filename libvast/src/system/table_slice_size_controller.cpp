@@ -0,0 +1,76 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/table_slice_size_controller.hpp"
+
+#include "vast/detail/assert.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace vast::system {
+
+table_slice_size_controller::table_slice_size_controller(size_t initial_size,
+                                                         options opts)
+  : options_{opts},
+    size_{std::clamp(initial_size, opts.min_size, opts.max_size)} {
+  VAST_ASSERT(options_.min_size > 0);
+  VAST_ASSERT(options_.min_size <= options_.max_size);
+}
+
+size_t table_slice_size_controller::size() const {
+  return size_;
+}
+
+double table_slice_size_controller::rate() const {
+  return rate_;
+}
+
+table_slice_size_controller::statistics
+table_slice_size_controller::take_statistics() {
+  return std::exchange(statistics_, {});
+}
+
+table_slice_size_controller::decision
+table_slice_size_controller::observe(size_t events, size_t capacity,
+                                     stopwatch::time_point now) {
+  if (window_start_ == stopwatch::time_point{})
+    window_start_ = now;
+  window_events_ += events;
+  window_saturated_ = window_saturated_ && events >= capacity;
+  const auto elapsed = now - window_start_;
+  if (elapsed < options_.target_latency)
+    return decision::keep;
+  using seconds = std::chrono::duration<double>;
+  rate_ = static_cast<double>(window_events_)
+          / std::chrono::duration_cast<seconds>(elapsed).count();
+  // The number of events that the source produces within the target latency.
+  const auto ideal_size
+    = rate_
+      * std::chrono::duration_cast<seconds>(options_.target_latency).count();
+  const auto current_size = static_cast<double>(size_);
+  auto result = decision::keep;
+  if ((window_saturated_ || ideal_size >= 2 * current_size)
+      && size_ < options_.max_size) {
+    size_ = std::min(size_ * 2, options_.max_size);
+    ++statistics_.grown;
+    result = decision::grow;
+  } else if (!window_saturated_ && 2 * ideal_size < current_size
+             && size_ > options_.min_size) {
+    size_ = std::max(size_ / 2, options_.min_size);
+    ++statistics_.shrunk;
+    result = decision::shrink;
+  }
+  window_start_ = now;
+  window_events_ = 0;
+  window_saturated_ = true;
+  return result;
+}
+
+} // namespace vast::system
@@ -0,0 +1,45 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE thread_pool
+
+#include "vast/detail/thread_pool.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <atomic>
+
+using namespace vast;
+
+TEST(runs all tasks before shutting down) {
+  auto counter = std::atomic<size_t>{0};
+  {
+    auto pool = detail::thread_pool{4};
+    CHECK_EQUAL(pool.size(), 4u);
+    for (size_t i = 0; i < 1'000; ++i)
+      pool.submit([&] {
+        counter.fetch_add(1, std::memory_order_relaxed);
+      });
+  }
+  CHECK_EQUAL(counter.load(), 1'000u);
+}
+
+TEST(runs tasks submitted from worker threads) {
+  auto counter = std::atomic<size_t>{0};
+  {
+    auto pool = detail::thread_pool{2};
+    for (size_t i = 0; i < 100; ++i)
+      pool.submit([&] {
+        for (size_t j = 0; j < 10; ++j)
+          pool.submit([&] {
+            counter.fetch_add(1, std::memory_order_relaxed);
+          });
+      });
+  }
+  CHECK_EQUAL(counter.load(), 1'000u);
+}
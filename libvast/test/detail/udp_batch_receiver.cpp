@@ -0,0 +1,77 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE udp_batch_receiver
+
+#include "vast/detail/udp_batch_receiver.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+using namespace vast;
+
+namespace {
+
+void send_datagram(int fd, uint16_t port, std::string_view payload) {
+  ::sockaddr_in6 addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin6_family = AF_INET6;
+  addr.sin6_addr = in6addr_loopback;
+  addr.sin6_port = htons(port);
+  auto sent = ::sendto(fd, payload.data(), payload.size(), 0,
+                       reinterpret_cast<::sockaddr*>(&addr), sizeof(addr));
+  REQUIRE_EQUAL(sent, static_cast<ssize_t>(payload.size()));
+}
+
+} // namespace
+
+TEST(receive batch) {
+  auto receiver = detail::udp_batch_receiver::make(0, 8, 64, true);
+  REQUIRE_NOERROR(receiver);
+  auto port = receiver->port();
+  REQUIRE_NOT_EQUAL(port, 0u);
+  auto sender = ::socket(AF_INET6, SOCK_DGRAM, 0);
+  REQUIRE(sender >= 0);
+  send_datagram(sender, port, "foo");
+  send_datagram(sender, port, "bar");
+  send_datagram(sender, port, "baz");
+  auto received = size_t{0};
+  auto datagrams = std::vector<std::string>{};
+  for (auto i = 0; i < 100 && received < 3; ++i) {
+    auto n = receiver->receive(10ms);
+    REQUIRE_NOERROR(n);
+    for (size_t j = 0; j < *n; ++j) {
+      auto dg = receiver->datagram(j);
+      datagrams.emplace_back(dg.data(), dg.size());
+    }
+    received += *n;
+  }
+  ::close(sender);
+  REQUIRE_EQUAL(datagrams.size(), 3u);
+  CHECK_EQUAL(datagrams[0], "foo");
+  CHECK_EQUAL(datagrams[1], "bar");
+  CHECK_EQUAL(datagrams[2], "baz");
+  CHECK_EQUAL(receiver->kernel_drops(), 0u);
+}
+
+TEST(receive timeout) {
+  auto receiver = detail::udp_batch_receiver::make(0, 8, 64, false);
+  REQUIRE_NOERROR(receiver);
+  auto n = receiver->receive(1ms);
+  REQUIRE_NOERROR(n);
+  CHECK_EQUAL(*n, 0u);
+}
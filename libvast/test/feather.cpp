@@ -12,6 +12,7 @@
 #include <vast/concept/parseable/to.hpp>
 #include <vast/concept/parseable/vast/expression.hpp>
 #include <vast/concept/parseable/vast/subnet.hpp>
+#include <vast/defaults.hpp>
 #include <vast/detail/collect.hpp>
 #include <vast/detail/narrow.hpp>
 #include <vast/detail/spawn_container_source.hpp>
@@ -318,6 +319,52 @@ TEST(passive feather store fetchall query) {
   compare_table_slices(slice, results[0]);
 }
 
+TEST(passive feather store with lz4 and small chunks) {
+  auto f = table_slice_fixture();
+  auto slice = f.slice;
+  const auto* plugin = vast::plugins::find<vast::store_actor_plugin>("feather");
+  REQUIRE(plugin);
+  // We know that initialize may be called multiple times for this plugin.
+  auto _
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    = const_cast<store_actor_plugin*>(plugin)->initialize(
+      record{{"compression", "lz4"}, {"chunk-size", 3u}});
+  auto builder_and_header
+    = plugin->make_store_builder(accountant, filesystem, vast::uuid::random());
+  REQUIRE_NOERROR(builder_and_header);
+  auto& [builder, header] = *builder_and_header;
+  auto slices = std::vector<table_slice>{slice, slice};
+  vast::detail::spawn_container_source(sys, slices, builder);
+  run();
+  auto store = plugin->make_store(accountant, filesystem, as_bytes(header));
+  REQUIRE_NOERROR(store);
+  run();
+  auto results = query(*store, vast::ids{});
+  run();
+  // Every slice of 4 events splits into record batches of 3 and 1 events.
+  REQUIRE_EQUAL(results.size(), 4ull);
+  CHECK_EQUAL(results[0].rows(), 3ull);
+  CHECK_EQUAL(results[1].rows(), 1ull);
+  CHECK_EQUAL(rows(results), 8ull);
+  CHECK_EQUAL(results[1].offset(), 3ull);
+  CHECK_EQUAL(materialize(results[1].at(0, 0)), materialize(slice.at(3, 0)));
+  const auto expr = unbox(to<expression>("f1 == \"n4\""));
+  CHECK_EQUAL(count(*store, vast::ids{}, expr), 2ull);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  _ = const_cast<store_actor_plugin*>(plugin)->initialize(
+    record{{"compression", "zstd"},
+           {"chunk-size", uint64_t{defaults::import::table_slice_size}}});
+}
+
+TEST(feather plugin rejects invalid options) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  auto* plugin = const_cast<store_actor_plugin*>(
+    vast::plugins::find<vast::store_actor_plugin>("feather"));
+  REQUIRE(plugin);
+  CHECK(plugin->initialize(record{{"compression", "brotli"}}));
+  CHECK(plugin->initialize(record{{"chunk-size", 0u}}));
+}
+
 TEST(passive feather store selective count query) {
   auto f = table_slice_fixture();
   auto slice = f.slice;
@@ -109,4 +109,30 @@ TEST(arrow IPC read) {
   CHECK_EQUAL(zeek_conn_log, slices);
 }
 
+TEST(arrow IPC streams) {
+  auto expected = zeek_conn_log;
+  expected.insert(expected.end(), zeek_dns_log.begin(), zeek_dns_log.end());
+  for (auto compression : {arrow::Compression::UNCOMPRESSED,
+                           arrow::Compression::LZ4_FRAME,
+                           arrow::Compression::ZSTD}) {
+    MESSAGE("compression: "
+            << arrow::util::Codec::GetCodecAsString(compression));
+    auto chunks = unbox(format::arrow::to_ipc_streams(expected, compression));
+    auto data = std::string{};
+    for (const auto& chunk : chunks)
+      data.append(reinterpret_cast<const char*>(chunk->data()), chunk->size());
+    auto in = std::make_unique<std::istringstream>(std::move(data));
+    format::arrow::reader reader{caf::settings{}, std::move(in)};
+    auto slices = std::vector<table_slice>{};
+    auto add_slice = [&](table_slice slice) {
+      slices.emplace_back(std::move(slice));
+    };
+    reader.read(1 << 16, 1 << 16, add_slice);
+    CHECK_EQUAL(slices, expected);
+  }
+  CHECK_EQUAL(unbox(format::arrow::to_ipc_compression("zstd")),
+              arrow::Compression::ZSTD);
+  CHECK(!format::arrow::to_ipc_compression("gzip"));
+}
+
 FIXTURE_SCOPE_END()
@@ -6,6 +6,8 @@
 // SPDX-FileCopyrightText: (c) 2016 The VAST Contributors
 // SPDX-License-Identifier: BSD-3-Clause
 
+#include "vast/arrow_table_slice.hpp"
+#include "vast/concept/printable/vast/json.hpp"
 #include "vast/detail/string.hpp"
 #include "vast/format/ascii.hpp"
 #include "vast/format/csv.hpp"
@@ -75,4 +77,48 @@ TEST(JSON writer - omit - nulls) {
   CHECK_EQUAL(lines.back(), last_zeek_http_log_line_json);
 }
 
+TEST(JSON writer - identical to the generic printer) {
+  auto logs = std::vector<std::vector<table_slice>>{
+    zeek_conn_log,        zeek_http_log,       suricata_alert_log,
+    suricata_dns_log,     suricata_flow_log,   suricata_http_log,
+    suricata_netflow_log, suricata_stats_log,
+  };
+  for (auto flatten : {false, true}) {
+    for (auto omit_empty : {false, true}) {
+      caf::settings options;
+      caf::put(options, "vast.export.json.flatten", flatten);
+      caf::put(options, "vast.export.json.numeric-durations", flatten);
+      caf::put(options, "vast.export.json.omit-empty", omit_empty);
+      auto printer = json_printer{{
+        .oneline = true,
+        .flattened = flatten,
+        .numeric_durations = flatten,
+        .omit_nulls = omit_empty,
+        .omit_empty_records = omit_empty,
+        .omit_empty_lists = omit_empty,
+        .omit_empty_maps = omit_empty,
+      }};
+      for (const auto& log : logs) {
+        auto out = std::make_unique<std::stringstream>();
+        auto& stream = *out;
+        auto writer = format::json::writer{std::move(out), options};
+        auto expected = std::string{};
+        auto out_iter = std::back_inserter(expected);
+        for (const auto& slice : log) {
+          REQUIRE_EQUAL(writer.write(slice), caf::none);
+          auto resolved_slice = resolve_enumerations(slice);
+          auto array
+            = to_record_batch(resolved_slice)->ToStructArray().ValueOrDie();
+          const auto& schema = caf::get<record_type>(resolved_slice.schema());
+          for (const auto& row : values(schema, *array)) {
+            REQUIRE(printer.print(out_iter, *row));
+            expected += '\n';
+          }
+        }
+        CHECK_EQUAL(stream.str(), expected);
+      }
+    }
+  }
+}
+
 FIXTURE_SCOPE_END()
@@ -0,0 +1,90 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE hash_column
+
+#include "vast/hash_column.hpp"
+
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/ip.hpp"
+#include "vast/hash/hash.hpp"
+#include "vast/hash/legacy_hash.hpp"
+#include "vast/table_slice_builder.hpp"
+#include "vast/test/test.hpp"
+
+#include <arrow/record_batch.h>
+
+#include <string>
+#include <vector>
+
+using namespace vast;
+using namespace std::string_literals;
+
+namespace {
+
+const auto schema = type{
+  "test",
+  record_type{
+    {"string", string_type{}},
+    {"int64", int64_type{}},
+    {"double", double_type{}},
+    {"ip", ip_type{}},
+    {"list", list_type{int64_type{}}},
+  },
+};
+
+table_slice make_slice() {
+  const auto rows = std::vector<std::vector<data>>{
+    {"foo"s, int64_t{1}, 1.5, *to<ip>("10.0.0.1"), list{int64_t{1}}},
+    {caf::none, caf::none, -0.0, caf::none, caf::none},
+    {""s, int64_t{-3}, caf::none, *to<ip>("2001:db8::1"), list{}},
+  };
+  auto builder = std::make_shared<table_slice_builder>(schema);
+  for (const auto& row : rows)
+    for (const auto& value : row)
+      REQUIRE(builder->add(make_view(value)));
+  return builder->finish();
+}
+
+} // namespace
+
+TEST(hash column equals hashing values one by one) {
+  const auto slice = make_slice();
+  const auto batch = to_record_batch(slice);
+  const auto& layout = caf::get<record_type>(slice.schema());
+  const auto salt = "salt"s;
+  for (size_t column = 0; column < layout.num_fields(); ++column) {
+    const auto field_type = layout.field(column).type;
+    const auto& array = *batch->column(detail::narrow_cast<int>(column));
+    auto digests = std::vector<default_hash::result_type>(slice.rows());
+    hash_column<default_hash>(field_type, array, digests, 0);
+    auto salted_digests = std::vector<default_hash::result_type>(slice.rows());
+    hash_column<default_hash>(field_type, array, salted_digests, 0, salt);
+    auto legacy_digests = std::vector<legacy_hash::result_type>(slice.rows());
+    hash_column<legacy_hash>(field_type, array, legacy_digests, 42);
+    for (size_t row = 0; row < slice.rows(); ++row) {
+      const auto value
+        = value_at(field_type, array, detail::narrow_cast<int64_t>(row));
+      CHECK_EQUAL(digests[row], vast::hash(value));
+      CHECK_EQUAL(salted_digests[row], vast::hash(value, salt));
+      CHECK_EQUAL(legacy_digests[row], seeded_hash<legacy_hash>{42}(value));
+    }
+  }
+}
+
+TEST(buffered hash equals incremental hash) {
+  const auto long_string = std::string(1'000, 'x');
+  for (const auto& value : {"foo"s, long_string}) {
+    auto hasher = buffered_hash<xxh3_64>{};
+    hash_append(hasher, value);
+    CHECK_EQUAL(hasher.finish(), vast::hash(value));
+    // Finishing discards the collected bytes.
+    hash_append(hasher, value);
+    CHECK_EQUAL(hasher.finish(), vast::hash(value));
+  }
+}
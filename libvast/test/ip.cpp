@@ -12,11 +12,13 @@
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/ip.hpp"
 #include "vast/ip.hpp"
+#include "vast/ip_pseudonymizer.hpp"
 
 #define SUITE address
 #include "vast/test/test.hpp"
 
 #include <unordered_map>
+#include <vector>
 
 using namespace vast;
 using namespace std::string_literals;
@@ -324,3 +326,31 @@ TEST(IPv6 pseudonymization - seed 3) {
   };
   check_address_pseudonymization(addresses, seed_3);
 }
+
+TEST(pseudonymization - memoized prefixes) {
+  auto pseudonymizer = ip_pseudonymizer{seed_1};
+  // Crypto-PAn derives the last pad bit from the first 31 bits of an IPv4
+  // address, so addresses that differ only in the last bit share all pad bits.
+  pseudonymizer(*to<ip>("128.11.68.132"));
+  CHECK_EQUAL(pseudonymizer.cache_size(), 32u);
+  pseudonymizer(*to<ip>("128.11.68.133"));
+  CHECK_EQUAL(pseudonymizer.cache_size(), 32u);
+  pseudonymizer(*to<ip>("128.11.68.134"));
+  CHECK_EQUAL(pseudonymizer.cache_size(), 33u);
+  // The memoized pad bits yield the same addresses as without a cache, also
+  // if the pseudonymizer needs to clear its cache repeatedly.
+  auto tiny_pseudonymizer = ip_pseudonymizer{seed_1, 40};
+  const auto addresses = std::vector<std::string>{
+    "128.11.68.132", "128.11.68.133", "128.11.3.1", "0.0.0.0",
+    "::1",           "::2",           "2001:db8::1", "2001:db8::2",
+  };
+  for (int i = 0; i < 2; ++i) {
+    for (const auto& address : addresses) {
+      const auto original = *to<ip>(address);
+      const auto expected = ip::pseudonymize(original, seed_1);
+      CHECK_EQUAL(pseudonymizer(original), expected);
+      CHECK_EQUAL(tiny_pseudonymizer(original), expected);
+      CHECK(tiny_pseudonymizer.cache_size() <= 40u);
+    }
+  }
+}
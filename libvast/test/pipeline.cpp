@@ -144,6 +144,38 @@ struct pipelines_fixture : fixtures::events {
     return builder->finish();
   }
 
+  /// Applies pipeline operators to two batches of the same schema, both fused
+  /// and one at a time, and checks that the results are equal. The second
+  /// batch reuses the transformations that the fused operator bound for the
+  /// first batch.
+  /// @returns The transformed batches.
+  static std::vector<vast::table_slice> check_fused_pipeline(
+    const std::vector<std::pair<std::string, vast::record>>& options) {
+    auto fused = vast::pipeline{"test", {}};
+    for (const auto& [name, config] : options)
+      fused.add_operator(unbox(vast::make_pipeline_operator(name, config)));
+    auto expected = std::vector<vast::table_slice>{};
+    for (int i = 0; i < 2; ++i) {
+      auto slice = make_pipelines_testdata();
+      REQUIRE_SUCCESS(fused.add(slice));
+      for (const auto& [name, config] : options) {
+        auto op = unbox(vast::make_pipeline_operator(name, config));
+        REQUIRE_SUCCESS(op->add(std::move(slice)));
+        auto transformed = unbox(op->finish());
+        REQUIRE_EQUAL(transformed.size(), 1u);
+        slice = std::move(transformed[0]);
+      }
+      expected.push_back(std::move(slice));
+    }
+    auto transformed = unbox(fused.finish());
+    REQUIRE_EQUAL(transformed.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      CHECK_EQUAL(transformed[i].schema(), expected[i].schema());
+      CHECK_EQUAL(transformed[i], expected[i]);
+    }
+    return transformed;
+  }
+
   const vast::pipeline_operator_plugin* rename_plugin
     = vast::plugins::find<vast::pipeline_operator_plugin>("rename");
 };
@@ -681,4 +713,114 @@ TEST(pipeline executor - aggregate validation pipelines) {
   CHECK_FAILURE(validation2);
 }
 
+TEST(pipeline push down) {
+  auto pipeline = unbox(vast::pipeline::parse(
+    "test", "where index > +5 | where index < +9 | select uid, index | head 3 "
+            "| head 2 | taste 1"));
+  const auto plan = pipeline.push_down();
+  REQUIRE(plan.filter);
+  const auto* filter = caf::get_if<vast::conjunction>(&*plan.filter);
+  REQUIRE(filter);
+  CHECK_EQUAL(filter->size(), 2u);
+  REQUIRE_EQUAL(plan.store_operators.size(), 1u);
+  CHECK_EQUAL(plan.store_operators[0].name, "select");
+  CHECK_EQUAL(plan.store_operators[0].options,
+              (vast::record{{"fields", vast::list{"uid", "index"}}}));
+  CHECK_EQUAL(plan.limit, 2u);
+  CHECK(!plan.merge_partials);
+  // Only the operators that the query cannot evaluate remain.
+  REQUIRE_SUCCESS(pipeline.add(make_pipelines_testdata()));
+  auto transformed = unbox(pipeline.finish());
+  const auto result = concatenate(std::move(transformed));
+  REQUIRE_EQUAL(result.rows(), 1u);
+  CHECK_EQUAL(caf::get<vast::record_type>(result.schema()).num_fields(), 3u);
+  // The explanation reflects the plan.
+  const auto explanation = plan.explain();
+  CHECK_EQUAL(explanation.at("limit"), vast::data{uint64_t{2}});
+  CHECK_EQUAL(explanation.at("merge-partials"), vast::data{false});
+}
+
+TEST(pipeline push down respects the evaluation order) {
+  auto pipeline
+    = unbox(vast::pipeline::parse("test", "select uid, index | where index > "
+                                          "+5 | head 3"));
+  const auto plan = pipeline.push_down();
+  CHECK(!plan.filter);
+  REQUIRE_EQUAL(plan.store_operators.size(), 1u);
+  CHECK_EQUAL(plan.limit, 0u);
+  REQUIRE_SUCCESS(pipeline.add(make_pipelines_testdata()));
+  auto transformed = unbox(pipeline.finish());
+  CHECK_EQUAL(concatenate(std::move(transformed)).rows(), 3u);
+  // Pipelines that only apply to some schemas run after the query.
+  auto restricted
+    = unbox(vast::pipeline::parse("test", "where index > +5", {"testdata"}));
+  const auto restricted_plan = restricted.push_down();
+  CHECK(!restricted_plan.filter);
+  CHECK(restricted_plan.store_operators.empty());
+}
+
+TEST(pipeline applies stateless operators concurrently) {
+  auto sequential = unbox(vast::pipeline::parse(
+    "test", "hash --salt=\"abc\" uid | where index > +2 | select uid, index"));
+  auto parallel = unbox(vast::pipeline::parse(
+    "test", "hash --salt=\"abc\" uid | where index > +2 | select uid, index"));
+  // A tiny memory budget allows only a single batch in flight at a time,
+  // which must not affect the result.
+  for (auto memory_budget : {uint64_t{1}, uint64_t{1'024 * 1'024}}) {
+    parallel.parallelize({.threads = 4, .memory_budget = memory_budget});
+    auto slices = std::vector<vast::table_slice>{};
+    for (int i = 0; i < 8; ++i)
+      slices.push_back(make_pipelines_testdata());
+    for (const auto& slice : slices) {
+      REQUIRE_SUCCESS(sequential.add(vast::table_slice{slice}));
+      REQUIRE_SUCCESS(parallel.add(vast::table_slice{slice}));
+    }
+    auto expected = unbox(sequential.finish());
+    auto transformed = unbox(parallel.finish());
+    REQUIRE_EQUAL(transformed.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+      CHECK_EQUAL(transformed[i], expected[i]);
+    CHECK_EQUAL(concatenate(std::move(transformed)).rows(), 56u);
+  }
+}
+
+TEST(pipeline fuses column transformations) {
+  const auto options = std::vector<std::pair<std::string, vast::record>>{
+    {"hash", {{"field", "uid"}, {"out", "hashed_uid"}, {"salt", "abc"}}},
+    {"rename",
+     {{"schemas", vast::list{vast::record{
+                    {"from", std::string{"testdata"}},
+                    {"to", std::string{"testdata_renamed"}},
+                  }}}}},
+    {"drop", {{"fields", vast::list{"desc"}}}},
+    {"select", {{"fields", vast::list{"hashed_uid", "index"}}}},
+  };
+  const auto transformed = check_fused_pipeline(options);
+  CHECK_EQUAL(transformed[0].schema().name(), "testdata_renamed");
+  CHECK_EQUAL(
+    caf::get<vast::record_type>(transformed[0].schema()).num_fields(), 2u);
+}
+
+TEST(pipeline composes consecutive column transformations) {
+  // The rename and replace operators transform an output of the hash operator
+  // and a column that it leaves untouched, and the selections select from
+  // each other, so the fused operator needs only two passes.
+  const auto options = std::vector<std::pair<std::string, vast::record>>{
+    {"hash", {{"field", "uid"}, {"out", "hashed_uid"}, {"salt", "abc"}}},
+    {"rename", {{"fields", vast::list{vast::record{
+                             {"from", std::string{"hashed_uid"}},
+                             {"to", std::string{"digest"}},
+                           }}}}},
+    {"replace", {{"fields", vast::record{{"desc", "redacted"}}}}},
+    {"select", {{"fields", vast::list{"uid", "desc", "digest"}}}},
+    {"select", {{"fields", vast::list{"desc", "digest"}}}},
+  };
+  const auto transformed = check_fused_pipeline(options);
+  const auto& schema = caf::get<vast::record_type>(transformed[0].schema());
+  REQUIRE_EQUAL(schema.num_fields(), 2u);
+  CHECK_EQUAL(schema.field(0).name, "desc");
+  CHECK_EQUAL(schema.field(1).name, "digest");
+  CHECK_EQUAL(materialize(transformed[0].at(0, 0)), "redacted");
+}
+
 FIXTURE_SCOPE_END()
@@ -156,4 +156,21 @@ TEST(2 overlapping queries) {
   CHECK(q.queries().empty());
 }
 
+TEST(newest partitions first) {
+  using namespace std::chrono_literals;
+  query_queue q;
+  auto candidates = system::catalog_lookup_result{};
+  auto& infos = candidates.candidate_infos[vast::type{}].partition_infos;
+  for (auto offset : {1h, 2h, 10h, 3h})
+    infos.emplace_back(xs[infos.size()], 0u, time{} + offset, vast::type{},
+                       version::current_partition_version);
+  auto qid = make_insert(q, std::move(candidates), 2);
+  CHECK_EQUAL(unbox(q.next()).partition, xs[2]);
+  CHECK_EQUAL(unbox(q.next()).partition, xs[3]);
+  CHECK_ERROR(q.next());
+  REQUIRE_SUCCESS(q.activate(qid, 2));
+  CHECK_EQUAL(unbox(q.next()).partition, xs[1]);
+  CHECK_EQUAL(unbox(q.next()).partition, xs[0]);
+}
+
 } // namespace vast
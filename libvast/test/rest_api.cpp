@@ -8,11 +8,18 @@
 
 #define SUITE rest_api
 
+#include <vast/detail/string.hpp>
 #include <vast/plugin.hpp>
 #include <vast/system/node.hpp>
 #include <vast/test/fixtures/node.hpp>
 #include <vast/test/test.hpp>
 
+#include <arrow/buffer.h>
+#include <arrow/io/memory.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/record_batch.h>
+
+#include <functional>
 #include <regex>
 #include <simdjson.h>
 
@@ -65,6 +72,56 @@ public:
   caf::error error_ = {};
 };
 
+// A streaming response whose writes complete only when the test says so.
+class deferred_response final : public vast::http_response {
+public:
+  void append(std::string body) override {
+    body_ += body;
+  }
+
+  void flush(std::function<void(caf::error)> on_written) override {
+    pending_writes_.push_back(std::move(on_written));
+  }
+
+  void abort(uint16_t error_code, std::string message) override {
+    error_
+      = caf::make_error(vast::ec::unspecified,
+                        fmt::format("http error {}: {}", error_code, message));
+  }
+
+  // Completes all pending writes. Returns whether there were any.
+  bool complete_writes() {
+    auto writes = std::exchange(pending_writes_, {});
+    for (auto& on_written : writes)
+      on_written(caf::error{});
+    return !writes.empty();
+  }
+
+  std::string body_ = {};
+  caf::error error_ = {};
+  std::vector<std::function<void(caf::error)>> pending_writes_ = {};
+};
+
+caf::settings make_streaming_settings() {
+  auto result = caf::settings{};
+  // Small partitions and a single partition per round make the export
+  // evaluate the partitions one after the other.
+  caf::put(result, "vast.max-partition-size", int64_t{8});
+  caf::put(result, "vast.max-taste-partitions", int64_t{1});
+  return result;
+}
+
+// Spreads the events over multiple partitions, and lets only a single byte of
+// streamed results be on the way to the client at a time.
+struct streaming_fixture : public fixtures::node {
+  streaming_fixture()
+    : fixtures::node(VAST_PP_STRINGIFY(SUITE), make_streaming_settings()) {
+    caf::put(cfg.content, "vast.max-inflight-export-bytes", int64_t{1});
+  }
+
+  ~streaming_fixture() override = default;
+};
+
 } // namespace
 
 TEST(OpenAPI specs) {
@@ -98,6 +155,40 @@ TEST(OpenAPI specs) {
   }
 }
 
+TEST(content negotiation) {
+  auto endpoint = vast::rest_endpoint{
+    .endpoint_id = 0,
+    .method = vast::http_method::get,
+    .path = "/export",
+    .params = std::nullopt,
+    .version = vast::api_version::v0,
+    .content_type = vast::http_content_type::json,
+    .alternative_content_types = {vast::http_content_type::arrow_stream},
+  };
+  auto negotiate = [&](std::string_view accept) {
+    return vast::negotiate_content_type(endpoint, accept);
+  };
+  using vast::http_content_type;
+  CHECK(negotiate("") == http_content_type::json);
+  CHECK(negotiate("*/*") == http_content_type::json);
+  CHECK(negotiate("application/json") == http_content_type::json);
+  CHECK(negotiate("application/vnd.apache.arrow.stream")
+        == http_content_type::arrow_stream);
+  CHECK(negotiate("application/json;q=0.5, "
+                  "application/vnd.apache.arrow.stream")
+        == http_content_type::arrow_stream);
+  CHECK(negotiate("application/vnd.apache.arrow.stream;q=0.5, */*")
+        == http_content_type::json);
+  CHECK(negotiate("application/*, application/json;q=0")
+        == http_content_type::arrow_stream);
+  CHECK(negotiate("application/vnd.apache.arrow.stream;q=0")
+        == http_content_type::json);
+  CHECK(negotiate("text/html") == http_content_type::json);
+  endpoint.alternative_content_types.clear();
+  CHECK(negotiate("application/vnd.apache.arrow.stream")
+        == http_content_type::json);
+}
+
 FIXTURE_SCOPE(rest_api_tests, fixture)
 
 TEST(status endpoint) {
@@ -227,6 +318,86 @@ TEST(export endpoint) {
     CHECK_EQUAL(std::string_view{first["name"]}, "zeek.conn");
     CHECK_EQUAL(first["data"].get_array().size(), 16ull);
   }
+  { // GET /export as a stream of newline-delimited JSON
+    auto const& export_endpoint = endpoints[0];
+    auto handler = plugin->handler(self->system(), test_node);
+    auto response = std::make_shared<test_response>();
+    auto request = vast::http_request{
+      .params = {
+        {"expression", ":ip in 192.168.0.0/16"},
+        {"limit", uint64_t{16}},
+      },
+      .response = response,
+      .content_type = vast::http_content_type::ndjson,
+    };
+    self->send(handler, vast::atom::http_request_v, export_endpoint.endpoint_id,
+               std::move(request));
+    run();
+    CHECK_EQUAL(response->error_, caf::error{});
+    auto lines = vast::detail::split(response->body_, "\n");
+    REQUIRE_EQUAL(lines.size(), 17ull);
+    CHECK(lines.back().empty());
+    simdjson::dom::parser parser;
+    for (size_t i = 0; i < 16; ++i) {
+      auto padded_string = simdjson::padded_string{lines[i]};
+      simdjson::dom::element doc;
+      CHECK(!parser.parse(padded_string).get(doc));
+      CHECK(doc.is_object());
+    }
+  }
+  { // GET /export as server-sent events
+    auto const& export_endpoint = endpoints[0];
+    auto handler = plugin->handler(self->system(), test_node);
+    auto response = std::make_shared<test_response>();
+    auto request = vast::http_request{
+      .params = {
+        {"expression", ":ip in 192.168.0.0/16"},
+        {"limit", uint64_t{16}},
+      },
+      .response = response,
+      .content_type = vast::http_content_type::event_stream,
+    };
+    self->send(handler, vast::atom::http_request_v, export_endpoint.endpoint_id,
+               std::move(request));
+    run();
+    CHECK_EQUAL(response->error_, caf::error{});
+    auto events = vast::detail::split(response->body_, "\n\n");
+    REQUIRE_EQUAL(events.size(), 17ull);
+    for (size_t i = 0; i < 16; ++i)
+      CHECK(events[i].starts_with("data: {"));
+  }
+  { // GET /export as an Arrow IPC stream
+    auto const& export_endpoint = endpoints[0];
+    auto handler = plugin->handler(self->system(), test_node);
+    auto response = std::make_shared<test_response>();
+    auto request = vast::http_request{
+      .params = {
+        {"expression", ":ip in 192.168.0.0/16"},
+        {"limit", uint64_t{16}},
+      },
+      .response = response,
+      .content_type = vast::http_content_type::arrow_stream,
+    };
+    self->send(handler, vast::atom::http_request_v, export_endpoint.endpoint_id,
+               std::move(request));
+    run();
+    CHECK_EQUAL(response->error_, caf::error{});
+    REQUIRE(!response->body_.empty());
+    // A change of the schema starts a new stream, so we read streams until the
+    // body is exhausted.
+    auto input = std::make_shared<arrow::io::BufferReader>(
+      arrow::Buffer::FromString(response->body_));
+    auto rows = int64_t{0};
+    while (input->Tell().ValueOrDie()
+           < static_cast<int64_t>(response->body_.size())) {
+      auto reader = arrow::ipc::RecordBatchStreamReader::Open(input);
+      REQUIRE(reader.ok());
+      auto batch = std::shared_ptr<arrow::RecordBatch>{};
+      while ((*reader)->ReadNext(&batch).ok() && batch)
+        rows += batch->num_rows();
+    }
+    CHECK_EQUAL(rows, 16);
+  }
 }
 
 TEST(query endpoint) {
@@ -283,3 +454,48 @@ TEST(query endpoint) {
 }
 
 FIXTURE_SCOPE_END()
+
+FIXTURE_SCOPE(rest_api_streaming_tests, streaming_fixture)
+
+TEST(export endpoint waits for the client) {
+  auto const* plugin
+    = vast::plugins::find<vast::rest_endpoint_plugin>("api-export");
+  REQUIRE(plugin);
+  auto const& export_endpoint = plugin->rest_endpoints()[0];
+  auto handler = plugin->handler(self->system(), test_node);
+  auto response = std::make_shared<deferred_response>();
+  auto request = vast::http_request{
+    .params = {
+      {"limit", uint64_t{20}},
+    },
+    .response = response,
+    .content_type = vast::http_content_type::ndjson,
+  };
+  self->send(handler, vast::atom::http_request_v, export_endpoint.endpoint_id,
+             std::move(request));
+  run();
+  // The results of the first partition exceed the bytes in flight, so the
+  // export holds on to the response until the client catches up.
+  CHECK_EQUAL(response->error_, caf::error{});
+  CHECK_GREATER(response.use_count(), 1);
+  const auto first_lines = vast::detail::split(response->body_, "\n").size();
+  CHECK_GREATER(first_lines, 1ull);
+  CHECK_LESS(first_lines, 21ull);
+  run();
+  CHECK_EQUAL(vast::detail::split(response->body_, "\n").size(),
+              first_lines);
+  // Every completed write returns credit, which resumes the export.
+  auto rounds = 0;
+  while (response->complete_writes()) {
+    run();
+    ++rounds;
+  }
+  CHECK_GREATER(rounds, 1);
+  CHECK_EQUAL(response->error_, caf::error{});
+  CHECK_EQUAL(response.use_count(), 1);
+  auto lines = vast::detail::split(response->body_, "\n");
+  REQUIRE_EQUAL(lines.size(), 21ull);
+  CHECK(lines.back().empty());
+}
+
+FIXTURE_SCOPE_END()
@@ -0,0 +1,153 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE schema_inference
+
+#include "vast/schema_inference.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <fmt/format.h>
+
+#include <sstream>
+
+using namespace vast;
+
+namespace {
+
+type infer(std::string_view input) {
+  auto inference = schema_inference{};
+  inference.add_lines(input);
+  return unbox(inference.make_type("json", schema_inference::options{}));
+}
+
+std::string make_sample(size_t num_lines) {
+  auto result = std::string{};
+  for (size_t i = 0; i < num_lines; ++i) {
+    result += fmt::format(R"({{"id": "{:08x}", "proto": "{}", "n": {})", i,
+                          i % 2 == 0 ? "tcp" : "udp", i);
+    if (i % 4 == 0)
+      result += R"(, "extra": {"x": 1.5})";
+    result += "}\n";
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(union of optional fields) {
+  auto inference = schema_inference{};
+  inference.add_lines(R"({"a": 1}
+{"b": "foo"}
+{"a": 2, "c": {"d": true}}
+{"a": null})");
+  CHECK_EQUAL(inference.documents(), 4u);
+  auto expected = type{
+    "json",
+    record_type{
+      {"a", int64_type{}},
+      {"b", string_type{}},
+      {"c", record_type{{"d", bool_type{}}}},
+    },
+  };
+  CHECK_EQUAL(unbox(inference.make_type("json", {})), expected);
+  auto stats = inference.statistics();
+  REQUIRE_EQUAL(stats.size(), 4u);
+  CHECK_EQUAL(stats[0].key, "a");
+  CHECK_EQUAL(stats[0].count, 2u);
+  CHECK_EQUAL(stats[0].nulls, 1u);
+  CHECK_EQUAL(stats[0].frequency, 0.75);
+  CHECK_EQUAL(stats[0].distinct, 2u);
+  CHECK_EQUAL(stats[2].key, "c");
+  CHECK_EQUAL(stats[3].key, "c.d");
+  CHECK_EQUAL(stats[3].frequency, 1.0);
+}
+
+TEST(type widening) {
+  auto result = infer(R"({"a": 1, "b": 1, "c": 1, "d": 1, "e": "10.0.0.1"}
+{"a": 1.5, "b": 18446744073709551615, "c": "x", "d": null, "e": "10.0.0.2"}
+{"b": 2, "f": null, "g": [1, 2], "h": {}})");
+  auto expected = type{
+    "json",
+    record_type{
+      {"a", double_type{}},
+      {"b", uint64_type{}},
+      {"c", string_type{}},
+      {"d", int64_type{}},
+      {"e", ip_type{}},
+      {"f", string_type{}},
+      {"g", list_type{int64_type{}}},
+      {"h", map_type{string_type{}, string_type{}}},
+    },
+  };
+  CHECK_EQUAL(result, expected);
+  // Negative values do not fit into an unsigned integer.
+  result = infer(R"({"a": -1}
+{"a": 18446744073709551615})");
+  CHECK_EQUAL(result, (type{"json", record_type{{"a", double_type{}}}}));
+}
+
+TEST(invalid lines) {
+  auto inference = schema_inference{};
+  inference.add_lines("{\"a\": 1}\nfoo\n[1, 2]\n\n{\"a\": 2}\r\n");
+  CHECK_EQUAL(inference.documents(), 2u);
+  CHECK_EQUAL(inference.invalid(), 2u);
+  auto empty = schema_inference{};
+  CHECK(!empty.make_type("json", {}));
+}
+
+TEST(index suggestions) {
+  auto inference = schema_inference{};
+  inference.add_lines(make_sample(4'000));
+  auto opts = schema_inference::options{
+    .index_min_distinct = 1'000,
+    .index_min_ratio = 0.5,
+  };
+  auto result = unbox(inference.make_type("json", opts));
+  const auto& layout = caf::get<record_type>(result);
+  CHECK_EQUAL(layout.field(0).type,
+              (type{string_type{}, {{"index", "hash"}}}));
+  CHECK_EQUAL(layout.field(1).type, type{string_type{}});
+  // The estimate of the distinct values is approximate, but exact for small
+  // numbers.
+  auto stats = inference.statistics();
+  CHECK_GREATER(stats[0].distinct, 3'000u);
+  CHECK_LESS(stats[0].distinct, 5'000u);
+  CHECK_EQUAL(stats[1].distinct, 2u);
+  CHECK_EQUAL(stats[3].frequency, 0.25);
+}
+
+TEST(parallel inference) {
+  const auto sample = make_sample(10'000);
+  auto sequential = schema_inference{};
+  sequential.add_lines(sample);
+  // The prefix ends in the middle of a line.
+  auto input = std::istringstream{sample.substr(100)};
+  auto parallel = infer_json_schema(sample.substr(0, 100), input, 4, 0);
+  CHECK_EQUAL(parallel.documents(), 10'000u);
+  CHECK_EQUAL(unbox(parallel.make_type("json", {})),
+              unbox(sequential.make_type("json", {})));
+  auto xs = sequential.statistics();
+  auto ys = parallel.statistics();
+  REQUIRE_EQUAL(xs.size(), ys.size());
+  for (size_t i = 0; i < xs.size(); ++i) {
+    CHECK_EQUAL(xs[i].key, ys[i].key);
+    CHECK_EQUAL(xs[i].count, ys[i].count);
+    CHECK_EQUAL(xs[i].distinct, ys[i].distinct);
+  }
+}
+
+TEST(maximum number of bytes) {
+  const auto sample = make_sample(100);
+  const auto first_line = sample.find('\n') + 1;
+  auto input = std::istringstream{sample};
+  // The incomplete second line does not count.
+  auto inference = infer_json_schema({}, input, 1, first_line + 10);
+  CHECK_EQUAL(inference.documents(), 1u);
+  CHECK_EQUAL(inference.invalid(), 0u);
+}
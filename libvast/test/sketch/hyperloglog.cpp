@@ -0,0 +1,99 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE hyperloglog
+
+#include "vast/sketch/hyperloglog.hpp"
+
+#include "vast/detail/legacy_deserialize.hpp"
+#include "vast/detail/serialize.hpp"
+#include "vast/hash/hash.hpp"
+#include "vast/test/test.hpp"
+
+#include <caf/test/dsl.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace vast;
+using namespace vast::sketch;
+
+namespace {
+
+/// Checks that an estimate lies within 5% of the true count, which is about
+/// three standard errors at the default precision.
+void check_estimate(const hyperloglog& sketch, uint64_t expected) {
+  const auto estimate = sketch.estimate();
+  MESSAGE("estimate " << estimate << " for " << expected << " digests");
+  CHECK_LESS(std::abs(estimate - static_cast<double>(expected)),
+             0.05 * static_cast<double>(expected));
+}
+
+} // namespace
+
+TEST(hyperloglog empty) {
+  auto sketch = hyperloglog{};
+  CHECK_EQUAL(sketch.precision(), hyperloglog::default_precision);
+  CHECK_EQUAL(sketch.estimate(), 0.0);
+}
+
+TEST(hyperloglog small and large cardinalities) {
+  auto sketch = hyperloglog{};
+  for (uint64_t i = 0; i < 100; ++i) {
+    sketch.add(hash(i));
+    sketch.add(hash(i));
+  }
+  check_estimate(sketch, 100);
+  for (uint64_t i = 100; i < 1'000'000; ++i)
+    sketch.add(hash(i));
+  check_estimate(sketch, 1'000'000);
+}
+
+TEST(hyperloglog merge) {
+  auto lhs = hyperloglog{};
+  auto rhs = hyperloglog{};
+  for (uint64_t i = 0; i < 60'000; ++i)
+    lhs.add(hash(i));
+  for (uint64_t i = 40'000; i < 100'000; ++i)
+    rhs.add(hash(i));
+  REQUIRE_EQUAL(lhs.merge(rhs), caf::error{});
+  check_estimate(lhs, 100'000);
+  auto other = unbox(hyperloglog::make(hyperloglog::min_precision));
+  CHECK_NOT_EQUAL(lhs.merge(other), caf::error{});
+}
+
+TEST(hyperloglog make) {
+  CHECK(!hyperloglog::make(hyperloglog::min_precision - 1));
+  CHECK(!hyperloglog::make(hyperloglog::max_precision + 1));
+  CHECK(!hyperloglog::make(std::vector<uint8_t>(100)));
+  CHECK(!hyperloglog::make(std::vector<uint8_t>(16, 255)));
+  auto sketch = hyperloglog{};
+  for (uint64_t i = 0; i < 1'000; ++i)
+    sketch.add(hash(i));
+  const auto registers = sketch.registers();
+  auto restored = unbox(hyperloglog::make(
+    std::vector<uint8_t>{registers.begin(), registers.end()}));
+  CHECK_EQUAL(restored.precision(), sketch.precision());
+  CHECK_EQUAL(restored.estimate(), sketch.estimate());
+}
+
+TEST(hyperloglog serialization) {
+  auto sketch = hyperloglog{};
+  for (uint64_t i = 0; i < 1'000; ++i)
+    sketch.add(hash(i));
+  caf::byte_buffer buf;
+  CHECK(detail::serialize(buf, sketch));
+  auto restored = hyperloglog{};
+  REQUIRE_EQUAL(detail::legacy_deserialize(buf, restored), true);
+  CHECK_EQUAL(restored.precision(), sketch.precision());
+  CHECK(std::equal(restored.registers().begin(), restored.registers().end(),
+                   sketch.registers().begin(), sketch.registers().end()));
+  CHECK_EQUAL(restored.estimate(), sketch.estimate());
+}
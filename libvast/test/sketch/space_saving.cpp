@@ -0,0 +1,91 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE space_saving
+
+#include "vast/sketch/space_saving.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <caf/test/dsl.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace vast;
+using namespace vast::sketch;
+
+TEST(space_saving exact below capacity) {
+  auto sketch = space_saving<std::string>{10};
+  sketch.add("foo", 3);
+  sketch.add("bar");
+  sketch.add("baz", 2);
+  sketch.add("bar", 4);
+  const auto top = sketch.top(2);
+  REQUIRE_EQUAL(top.size(), size_t{2});
+  CHECK_EQUAL(top[0].key, "bar");
+  CHECK_EQUAL(top[0].count, uint64_t{5});
+  CHECK_EQUAL(top[0].error, uint64_t{0});
+  CHECK_EQUAL(top[1].key, "foo");
+  CHECK_EQUAL(top[1].count, uint64_t{3});
+  CHECK_EQUAL(sketch.top(10).size(), size_t{3});
+}
+
+TEST(space_saving skewed stream) {
+  // Every value i < 10 occurs (10 - i) * 1000 times, shuffled with 20000
+  // values that occur once. This bounds the error of every counter by
+  // 75000 / 100 = 750, which is less than the gaps between the counts.
+  auto stream = std::vector<uint64_t>{};
+  for (uint64_t i = 0; i < 10; ++i)
+    stream.insert(stream.end(), (10 - i) * 1'000, i);
+  for (uint64_t i = 0; i < 20'000; ++i)
+    stream.push_back(1'000 + i);
+  std::shuffle(stream.begin(), stream.end(), std::mt19937_64{0});
+  auto sketch = space_saving<uint64_t>{100};
+  for (const auto value : stream)
+    sketch.add(value);
+  const auto top = sketch.top(10);
+  REQUIRE_EQUAL(top.size(), size_t{10});
+  for (uint64_t i = 0; i < 10; ++i) {
+    CHECK_EQUAL(top[i].key, i);
+    CHECK_GREATER_EQUAL(top[i].count, (10 - i) * 1'000);
+    CHECK_LESS_EQUAL(top[i].count - top[i].error, (10 - i) * 1'000);
+  }
+}
+
+TEST(space_saving merge) {
+  auto lhs = space_saving<uint64_t>{4};
+  auto rhs = space_saving<uint64_t>{4};
+  for (uint64_t i = 0; i < 8; ++i) {
+    lhs.add(i % 2 == 0 ? 1 : 100 + i);
+    rhs.add(i % 2 == 0 ? 2 : 200 + i);
+  }
+  lhs.add(2, 3);
+  lhs.merge(rhs);
+  CHECK_EQUAL(lhs.counters().size(), size_t{4});
+  const auto top = lhs.top(2);
+  REQUIRE_EQUAL(top.size(), size_t{2});
+  CHECK_EQUAL(top[0].key, uint64_t{2});
+  CHECK_GREATER_EQUAL(top[0].count, uint64_t{7});
+  CHECK_EQUAL(top[1].key, uint64_t{1});
+  CHECK_GREATER_EQUAL(top[1].count, uint64_t{4});
+}
+
+TEST(space_saving assign) {
+  auto sketch = space_saving<uint64_t>{2};
+  sketch.assign({{1, 5, 0}, {2, 7, 1}, {3, 1, 0}});
+  const auto top = sketch.top(3);
+  REQUIRE_EQUAL(top.size(), size_t{2});
+  CHECK_EQUAL(top[0].key, uint64_t{2});
+  CHECK_EQUAL(top[1].key, uint64_t{1});
+  sketch.add(1, 3);
+  CHECK_EQUAL(sketch.top(1)[0].key, uint64_t{1});
+}
@@ -0,0 +1,108 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE t_digest
+
+#include "vast/sketch/t_digest.hpp"
+
+#include "vast/detail/legacy_deserialize.hpp"
+#include "vast/detail/serialize.hpp"
+#include "vast/test/test.hpp"
+
+#include <caf/test/dsl.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace vast;
+using namespace vast::sketch;
+
+TEST(t_digest empty) {
+  auto digest = t_digest{};
+  CHECK_EQUAL(digest.weight(), 0.0);
+  CHECK(!digest.quantile(0.5));
+  digest.add(std::nan(""));
+  CHECK(!digest.quantile(0.5));
+}
+
+TEST(t_digest single value) {
+  auto digest = t_digest{};
+  digest.add(42.0);
+  CHECK_EQUAL(digest.quantile(0.0), 42.0);
+  CHECK_EQUAL(digest.quantile(0.5), 42.0);
+  CHECK_EQUAL(digest.quantile(1.0), 42.0);
+}
+
+TEST(t_digest uniform distribution) {
+  auto digest = t_digest{};
+  auto rng = std::mt19937_64{0};
+  auto dist = std::uniform_real_distribution<double>{0.0, 1.0};
+  for (size_t i = 0; i < 100'000; ++i)
+    digest.add(dist(rng));
+  CHECK_EQUAL(digest.weight(), 100'000.0);
+  CHECK_LESS_EQUAL(digest.centroids().size(), size_t{200});
+  for (const auto q : {0.01, 0.1, 0.5, 0.9, 0.99}) {
+    const auto estimate = unbox(digest.quantile(q));
+    MESSAGE("quantile " << q << " estimated as " << estimate);
+    CHECK_LESS(std::abs(estimate - q), 0.01);
+  }
+  CHECK_EQUAL(digest.quantile(0.0), digest.min());
+  CHECK_EQUAL(digest.quantile(1.0), digest.max());
+}
+
+TEST(t_digest merge) {
+  auto lhs = t_digest{};
+  auto rhs = t_digest{};
+  for (size_t i = 0; i < 50'000; ++i) {
+    lhs.add(static_cast<double>(i));
+    rhs.add(static_cast<double>(i + 50'000));
+  }
+  lhs.merge(rhs);
+  CHECK_EQUAL(lhs.weight(), 100'000.0);
+  CHECK_EQUAL(lhs.min(), 0.0);
+  CHECK_EQUAL(lhs.max(), 99'999.0);
+  CHECK_LESS(std::abs(unbox(lhs.quantile(0.5)) - 50'000.0), 500.0);
+  CHECK_LESS(std::abs(unbox(lhs.quantile(0.99)) - 99'000.0), 100.0);
+}
+
+TEST(t_digest make) {
+  using centroid = t_digest::centroid;
+  CHECK(!t_digest::make(0.0, {}, 0.0, 0.0));
+  CHECK(!t_digest::make(100.0, {{1.0, 1.0}}, 2.0, 3.0));
+  CHECK(!t_digest::make(100.0, {{1.0, 0.0}}, 0.0, 3.0));
+  CHECK(!t_digest::make(100.0, {{2.0, 1.0}, {1.0, 1.0}}, 0.0, 3.0));
+  auto digest = t_digest{};
+  for (size_t i = 0; i < 1'000; ++i)
+    digest.add(static_cast<double>(i));
+  const auto centroids = digest.centroids();
+  auto restored = unbox(t_digest::make(
+    digest.compression(),
+    std::vector<centroid>{centroids.begin(), centroids.end()}, digest.min(),
+    digest.max()));
+  CHECK_EQUAL(restored.weight(), digest.weight());
+  CHECK_EQUAL(restored.quantile(0.5), digest.quantile(0.5));
+}
+
+TEST(t_digest serialization) {
+  auto digest = t_digest{};
+  for (size_t i = 0; i < 1'000; ++i)
+    digest.add(static_cast<double>(i));
+  caf::byte_buffer buf;
+  CHECK(detail::serialize(buf, digest));
+  auto restored = t_digest{};
+  REQUIRE_EQUAL(detail::legacy_deserialize(buf, restored), true);
+  CHECK_EQUAL(restored.compression(), digest.compression());
+  CHECK_EQUAL(restored.weight(), digest.weight());
+  CHECK_EQUAL(restored.min(), digest.min());
+  CHECK_EQUAL(restored.max(), digest.max());
+  CHECK_EQUAL(restored.centroids().size(), digest.centroids().size());
+  CHECK_EQUAL(restored.quantile(0.5), digest.quantile(0.5));
+  CHECK_EQUAL(restored.quantile(0.99), digest.quantile(0.99));
+}
@@ -20,6 +20,11 @@
 #include <caf/settings.hpp>
 #include <caf/test/dsl.hpp>
 
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <map>
+
 namespace vast {
 
 namespace {
@@ -78,6 +83,34 @@ table_slice make_testdata() {
   return slice;
 }
 
+// Creates a table slice with a single column of the given values.
+table_slice make_column(type value_type, const std::vector<data>& values) {
+  const auto schema = type{"column", record_type{{"x", std::move(value_type)}}};
+  auto builder = std::make_shared<vast::table_slice_builder>(schema);
+  for (const auto& value : values)
+    REQUIRE(builder->add(make_view(value)));
+  return builder->finish();
+}
+
+// Creates an aggregation function for the given input type.
+std::unique_ptr<aggregation_function>
+make_function(std::string_view name, const type& input_type) {
+  const auto* plugin = plugins::find<aggregation_function_plugin>(name);
+  REQUIRE(plugin);
+  return unbox(plugin->make_aggregation_function(input_type));
+}
+
+// Extracts the bytes of the registers that approx_distinct packs into every
+// value of its saved state.
+std::vector<uint8_t> unpack_registers(const data& state) {
+  auto result = std::vector<uint8_t>{};
+  for (const auto& word : caf::get<list>(state))
+    for (size_t i = 0; i < 8; ++i)
+      result.push_back(static_cast<uint8_t>(caf::get<uint64_t>(word)
+                                            >> (8 * i)));
+  return result;
+}
+
 struct fixture : fixtures::events {
   fixture() {
     summarize_plugin = plugins::find<pipeline_operator_plugin>("summarize");
@@ -136,9 +169,10 @@ TEST(summarize Zeek conn log) {
   //   cat libvast_test/artifacts/logs/zeek/conn.log
   //     | zeek-cut -D "%Y-%m-%d" ts duration
   //     | awk '{sums[$1] += $2;}END{for (s in sums){print s,sums[s];}}'
+  // The rows are ordered by the first occurrence of their group.
   const auto expected_data = std::vector<std::vector<std::string_view>>{
-    {"2009-11-19", "33722481628959ns", "40", "498087", "286586076"},
     {"2009-11-18", "147082148590872ns", "0", "123661", "81051017"},
+    {"2009-11-19", "33722481628959ns", "40", "498087", "286586076"},
   };
   REQUIRE_EQUAL(summarized_slice.rows(), expected_data.size());
   REQUIRE_EQUAL(summarized_slice.columns(), expected_data[0].size());
@@ -148,6 +182,268 @@ TEST(summarize Zeek conn log) {
                   unbox(to<data>(expected_data[row][column])));
 }
 
+TEST(summarize with many groups) {
+  const auto opts = record{
+    {"group-by",
+     list{
+       "id.orig_h",
+       "id.resp_h",
+       "id.resp_p",
+     }},
+    {"aggregate",
+     record{
+       {"conns", record{{"count", "uid"}}},
+       {"first_ts", record{{"min", "ts"}}},
+       {"services", record{{"distinct", "service"}}},
+       {"proto", record{{"sample", "proto"}}},
+     }},
+  };
+  auto summarize_operator
+    = unbox(summarize_plugin->make_pipeline_operator(opts));
+  // Count the events per group, and remember their earliest timestamp.
+  auto expected = std::map<std::vector<data>, std::pair<uint64_t, data>>{};
+  for (const auto& slice : zeek_conn_log_full) {
+    CHECK_EQUAL(summarize_operator->add(slice), caf::none);
+    const auto& schema = caf::get<record_type>(slice.schema());
+    const auto column = [&](std::string_view key) {
+      return schema.flat_index(unbox(schema.resolve_key(key)));
+    };
+    for (size_t row = 0; row < slice.rows(); ++row) {
+      auto key = std::vector<data>{
+        materialize(slice.at(row, column("id.orig_h"))),
+        materialize(slice.at(row, column("id.resp_h"))),
+        materialize(slice.at(row, column("id.resp_p"))),
+      };
+      auto ts = materialize(slice.at(row, column("ts")));
+      auto& [count, min_ts] = expected[std::move(key)];
+      if (count++ == 0 || ts < min_ts)
+        min_ts = std::move(ts);
+    }
+  }
+  const auto summarized_slice
+    = concatenate(unbox(summarize_operator->finish()));
+  // The groups exceed the initial capacity of the group table.
+  REQUIRE_EQUAL(expected.size(), 664u);
+  REQUIRE_EQUAL(summarized_slice.rows(), expected.size());
+  REQUIRE_EQUAL(summarized_slice.columns(), 7u);
+  for (size_t row = 0; row < summarized_slice.rows(); ++row) {
+    const auto key = std::vector<data>{
+      materialize(summarized_slice.at(row, 0)),
+      materialize(summarized_slice.at(row, 1)),
+      materialize(summarized_slice.at(row, 2)),
+    };
+    const auto it = expected.find(key);
+    REQUIRE(it != expected.end());
+    CHECK_EQUAL(materialize(summarized_slice.at(row, 3)),
+                data{it->second.first});
+    CHECK_EQUAL(materialize(summarized_slice.at(row, 4)), it->second.second);
+    CHECK(caf::holds_alternative<list>(
+      materialize(summarized_slice.at(row, 5))));
+    CHECK(caf::holds_alternative<std::string>(
+      materialize(summarized_slice.at(row, 6))));
+    expected.erase(it);
+  }
+  CHECK(expected.empty());
+}
+
+TEST(summarize with partial aggregation) {
+  const auto opts = record{
+    {"group-by",
+     list{
+       "id.orig_h",
+       "id.resp_h",
+     }},
+    {"aggregate",
+     record{
+       {"conns", record{{"count", "uid"}}},
+       {"first_ts", record{{"min", "ts"}}},
+       {"duration", record{{"sum", "duration"}}},
+       {"services", record{{"distinct", "service"}}},
+       {"proto", record{{"sample", "proto"}}},
+     }},
+  };
+  auto summarize_operator
+    = unbox(summarize_plugin->make_pipeline_operator(opts));
+  auto merge_operator = unbox(summarize_plugin->make_pipeline_operator(opts));
+  const auto partial = merge_operator->split_partial();
+  REQUIRE(partial);
+  CHECK_EQUAL(partial->name, "summarize");
+  // Aggregate every slice separately, like the stores of different partitions
+  // would, and merge the partial results.
+  for (const auto& slice : zeek_conn_log_full) {
+    CHECK_EQUAL(summarize_operator->add(slice), caf::none);
+    auto partial_operator
+      = unbox(make_pipeline_operator(partial->name, partial->options));
+    CHECK_EQUAL(partial_operator->add(slice), caf::none);
+    for (auto& partial_result : unbox(partial_operator->finish())) {
+      CHECK_EQUAL(partial_result.schema().attribute("summarize"),
+                  std::optional<std::string_view>{"partial"});
+      CHECK_EQUAL(merge_operator->add(std::move(partial_result)), caf::none);
+    }
+  }
+  const auto expected = concatenate(unbox(summarize_operator->finish()));
+  const auto merged = concatenate(unbox(merge_operator->finish()));
+  CHECK_EQUAL(merged.schema(), expected.schema());
+  REQUIRE_EQUAL(merged.rows(), expected.rows());
+  REQUIRE_EQUAL(merged.columns(), 7u);
+  for (size_t row = 0; row < merged.rows(); ++row)
+    for (size_t column = 0; column < merged.columns(); ++column)
+      CHECK_EQUAL(materialize(merged.at(row, column)),
+                  materialize(expected.at(row, column)));
+}
+
+TEST(summarize with spilling to disk) {
+  const auto opts = record{
+    {"group-by",
+     list{
+       "id.orig_h",
+       "id.resp_h",
+     }},
+    {"aggregate",
+     record{
+       {"conns", record{{"count", "uid"}}},
+       {"first_ts", record{{"min", "ts"}}},
+       {"duration", record{{"sum", "duration"}}},
+       {"services", record{{"distinct", "service"}}},
+     }},
+  };
+  auto summarize_operator
+    = unbox(summarize_plugin->make_pipeline_operator(opts));
+  // A budget of a single byte makes the operator spill after every batch.
+  const auto spill_directory
+    = std::filesystem::temp_directory_path() / "vast-test-summarize-spill";
+  std::filesystem::remove_all(spill_directory);
+  auto spilling_opts = opts;
+  spilling_opts.emplace("memory-budget", uint64_t{1});
+  spilling_opts.emplace("spill-directory", spill_directory.string());
+  auto spilling_operator
+    = unbox(summarize_plugin->make_pipeline_operator(spilling_opts));
+  for (const auto& slice : zeek_conn_log_full) {
+    CHECK_EQUAL(summarize_operator->add(slice), caf::none);
+    CHECK_EQUAL(spilling_operator->add(slice), caf::none);
+  }
+  CHECK(!std::filesystem::is_empty(spill_directory));
+  const auto expected = concatenate(unbox(summarize_operator->finish()));
+  const auto spilled = concatenate(unbox(spilling_operator->finish()));
+  CHECK(std::filesystem::is_empty(spill_directory));
+  std::filesystem::remove_all(spill_directory);
+  const auto metrics = spilling_operator->take_metrics();
+  REQUIRE_EQUAL(metrics.size(), 3u);
+  CHECK_EQUAL(metrics[1].key, "summarize.spill.passes");
+  CHECK_EQUAL(caf::get<uint64_t>(metrics[1].value),
+              zeek_conn_log_full.size());
+  CHECK(spilling_operator->take_metrics().empty());
+  CHECK(summarize_operator->take_metrics().empty());
+  // The spilled groups are ordered by their partition, so we compare them by
+  // their group-by values.
+  CHECK_EQUAL(spilled.schema(), expected.schema());
+  REQUIRE_EQUAL(spilled.rows(), expected.rows());
+  REQUIRE_EQUAL(spilled.columns(), 6u);
+  auto expected_rows = std::map<std::vector<data>, std::vector<data>>{};
+  for (size_t row = 0; row < expected.rows(); ++row) {
+    auto& values = expected_rows[{
+      materialize(expected.at(row, 0)),
+      materialize(expected.at(row, 1)),
+    }];
+    for (size_t column = 2; column < expected.columns(); ++column)
+      values.push_back(materialize(expected.at(row, column)));
+  }
+  for (size_t row = 0; row < spilled.rows(); ++row) {
+    const auto it = expected_rows.find({
+      materialize(spilled.at(row, 0)),
+      materialize(spilled.at(row, 1)),
+    });
+    REQUIRE(it != expected_rows.end());
+    for (size_t column = 2; column < spilled.columns(); ++column)
+      CHECK_EQUAL(materialize(spilled.at(row, column)),
+                  it->second[column - 2]);
+    expected_rows.erase(it);
+  }
+  CHECK(expected_rows.empty());
+}
+
+TEST(summarize in sliding windows) {
+  const auto schema = vast::type{
+    "windowtestdata",
+    vast::record_type{
+      {"ts", vast::time_type{}},
+      {"x", vast::uint64_type{}},
+    },
+  };
+  const auto make_slice = [&](std::vector<int> seconds) {
+    auto builder = std::make_shared<vast::table_slice_builder>(schema);
+    for (auto second : seconds)
+      REQUIRE(builder->add(vast::time{std::chrono::seconds(second)},
+                           uint64_t{1}));
+    return builder->finish();
+  };
+  const auto opts = record{
+    {"group-by", list{"x"}},
+    {"aggregate", record{{"n", record{{"count", "ts"}}}}},
+    {"window",
+     record{
+       {"field", "ts"},
+       {"size", duration{std::chrono::seconds(4)}},
+       {"slide", duration{std::chrono::seconds(2)}},
+     }},
+  };
+  auto summarize_operator
+    = unbox(summarize_plugin->make_pipeline_operator(opts));
+  CHECK(summarize_operator->is_aggregate());
+  CHECK(summarize_operator->is_incremental());
+  CHECK(!summarize_operator->split_partial());
+  const auto check_windows
+    = [](const std::vector<table_slice>& slices,
+         const std::vector<std::pair<int, uint64_t>>& expected) {
+        const auto windows = concatenate(slices);
+        REQUIRE_EQUAL(windows.rows(), expected.size());
+        REQUIRE_EQUAL(windows.columns(), 4u);
+        for (size_t row = 0; row < expected.size(); ++row) {
+          const auto start = vast::time{
+            std::chrono::seconds(expected[row].first)};
+          CHECK_EQUAL(materialize(windows.at(row, 0)), start);
+          CHECK_EQUAL(materialize(windows.at(row, 1)),
+                      start + std::chrono::seconds(4));
+          CHECK_EQUAL(materialize(windows.at(row, 2)), uint64_t{1});
+          CHECK_EQUAL(materialize(windows.at(row, 3)), expected[row].second);
+        }
+      };
+  // The watermark at 9 closes all windows that end before then.
+  REQUIRE_SUCCESS(
+    summarize_operator->add(make_slice({0, 1, 2, 3, 4, 5, 6, 7, 8, 9})));
+  check_windows(unbox(summarize_operator->finish()),
+                {{-2, 2u}, {0, 4u}, {2, 4u}, {4, 4u}});
+  // Rows for closed windows are late, and the open windows close once the
+  // watermark passes them.
+  REQUIRE_SUCCESS(summarize_operator->add(make_slice({0, 1, 7, 20})));
+  check_windows(unbox(summarize_operator->finish()), {{6, 5u}, {8, 2u}});
+  const auto metrics = summarize_operator->take_metrics();
+  const auto late = std::find_if(metrics.begin(), metrics.end(),
+                                 [](const auto& metric) {
+                                   return metric.key == "summarize.window.late";
+                                 });
+  REQUIRE(late != metrics.end());
+  CHECK_EQUAL(caf::get<uint64_t>(late->value), 2u);
+  // Windowed aggregations do not require the end of the stream.
+  auto pipelines = std::vector<pipeline>{};
+  pipelines.emplace_back("windowed", std::vector<std::string>{});
+  pipelines.back().add_operator(std::move(summarize_operator));
+  auto executor = pipeline_executor{std::move(pipelines)};
+  CHECK_SUCCESS(
+    executor.validate(pipeline_executor::allow_aggregate_pipelines::no));
+  // The end of the stream flushes the open windows, even without input.
+  executor.end_stream();
+  check_windows(unbox(executor.finish()), {{18, 1u}, {20, 1u}});
+  // The slide must evenly divide the window size.
+  auto invalid_opts = opts;
+  invalid_opts["window"] = record{
+    {"field", "ts"},
+    {"size", duration{std::chrono::seconds(4)}},
+    {"slide", duration{std::chrono::seconds(3)}},
+  };
+  CHECK(!summarize_plugin->make_pipeline_operator(invalid_opts));
+}
+
 TEST(summarize test) {
   const auto opts = record{
     {"group-by",
@@ -303,6 +599,224 @@ TEST(summarize test wrong config) {
               caf::get<record_type>(expected_data.schema()));
 }
 
+TEST(approx_distinct switches from exact digests to a sketch) {
+  // The saved state holds the sorted digests of up to 256 distinct values,
+  // and the 512 packed registers of the sketch beyond that.
+  constexpr auto sketch_words = size_t{512};
+  const auto input_type = type{uint64_type{}};
+  auto function = make_function("approx_distinct", input_type);
+  CHECK_EQUAL(function->state_type(), type{list_type{uint64_type{}}});
+  for (uint64_t i = 0; i < 256; ++i) {
+    function->add(make_view(data{i}));
+    function->add(make_view(data{i}));
+    function->add(make_view(data{}));
+  }
+  const auto exact = caf::get<list>(unbox(function->save()));
+  REQUIRE_EQUAL(exact.size(), 256u);
+  CHECK(std::is_sorted(exact.begin(), exact.end()));
+  CHECK(std::adjacent_find(exact.begin(), exact.end()) == exact.end());
+  function->add(make_view(data{uint64_t{256}}));
+  const auto sketch = unbox(function->save());
+  REQUIRE_EQUAL(caf::get<list>(sketch).size(), sketch_words);
+  const auto sketch_estimate
+    = caf::get<uint64_t>(unbox(std::move(*function).finish()));
+  CHECK_GREATER_EQUAL(sketch_estimate, uint64_t{245});
+  CHECK_LESS_EQUAL(sketch_estimate, uint64_t{270});
+  // Merging the exact digests of two functions switches to a sketch once they
+  // exceed the limit together.
+  auto lhs = make_function("approx_distinct", input_type);
+  auto rhs = make_function("approx_distinct", input_type);
+  for (uint64_t i = 0; i < 200; ++i) {
+    lhs->add(make_view(data{i}));
+    rhs->add(make_view(data{i + 200}));
+  }
+  auto merged = make_function("approx_distinct", input_type);
+  REQUIRE_SUCCESS(merged->merge(unbox(lhs->save())));
+  CHECK_EQUAL(caf::get<list>(unbox(merged->save())).size(), 200u);
+  CHECK_EQUAL(unbox(std::move(*lhs).finish()), data{uint64_t{200}});
+  REQUIRE_SUCCESS(merged->merge(unbox(rhs->save())));
+  CHECK_EQUAL(caf::get<list>(unbox(merged->save())).size(), sketch_words);
+  const auto estimate = caf::get<uint64_t>(unbox(std::move(*merged).finish()));
+  CHECK_GREATER_EQUAL(estimate, uint64_t{380});
+  CHECK_LESS_EQUAL(estimate, uint64_t{420});
+}
+
+TEST(approx_distinct packs the registers of its sketch) {
+  const auto input_type = type{uint64_type{}};
+  auto lhs = make_function("approx_distinct", input_type);
+  auto rhs = make_function("approx_distinct", input_type);
+  for (uint64_t i = 0; i < 10'000; ++i) {
+    lhs->add(make_view(data{i}));
+    rhs->add(make_view(data{i + 5'000}));
+  }
+  const auto lhs_state = unbox(lhs->save());
+  const auto rhs_state = unbox(rhs->save());
+  // The state round-trips through the registers of a sketch.
+  auto restored = make_function("approx_distinct", input_type);
+  REQUIRE_SUCCESS(restored->merge(lhs_state));
+  CHECK_EQUAL(unbox(restored->save()), lhs_state);
+  // Merging takes the maximum of every register, which must be the maximum of
+  // every byte of the packed state.
+  REQUIRE_SUCCESS(restored->merge(rhs_state));
+  const auto lhs_registers = unpack_registers(lhs_state);
+  const auto rhs_registers = unpack_registers(rhs_state);
+  const auto merged_registers = unpack_registers(unbox(restored->save()));
+  REQUIRE_EQUAL(lhs_registers.size(), size_t{4096});
+  REQUIRE_EQUAL(merged_registers.size(), lhs_registers.size());
+  for (size_t i = 0; i < merged_registers.size(); ++i)
+    CHECK_EQUAL(merged_registers[i],
+                std::max(lhs_registers[i], rhs_registers[i]));
+  const auto estimate
+    = caf::get<uint64_t>(unbox(std::move(*restored).finish()));
+  CHECK_GREATER_EQUAL(estimate, uint64_t{14'250});
+  CHECK_LESS_EQUAL(estimate, uint64_t{15'750});
+}
+
+TEST(approx_distinct adds arrays like single values) {
+  // Check both the exact digests and the sketch for hashed values of fixed and
+  // variable size, with nulls in between.
+  for (const auto distinct_values : {100, 1'000}) {
+    auto uint64_values = std::vector<data>{};
+    auto string_values = std::vector<data>{};
+    for (int i = 0; i < 2'000; ++i) {
+      if (i % 7 == 0) {
+        uint64_values.emplace_back();
+        string_values.emplace_back();
+        continue;
+      }
+      const auto value = i % distinct_values;
+      uint64_values.emplace_back(detail::narrow_cast<uint64_t>(value));
+      string_values.emplace_back(fmt::format("value-{}", value));
+    }
+    for (const auto& slice : {
+           make_column(type{uint64_type{}}, uint64_values),
+           make_column(type{string_type{}}, string_values),
+         }) {
+      const auto& input_type
+        = caf::get<record_type>(slice.schema()).field(0).type;
+      auto scalar = make_function("approx_distinct", input_type);
+      auto bulk = make_function("approx_distinct", input_type);
+      for (size_t row = 0; row < slice.rows(); ++row)
+        scalar->add(slice.at(row, 0));
+      bulk->add(*to_record_batch(slice)->column(0));
+      CHECK_EQUAL(unbox(bulk->save()), unbox(scalar->save()));
+    }
+  }
+}
+
+TEST(approximate aggregation functions detect their state types) {
+  const auto check_state_type = [](std::string_view name,
+                                   const type& input_type,
+                                   const type& output_type) {
+    MESSAGE("checking the state type of " << name);
+    const auto function = make_function(name, input_type);
+    CHECK_EQUAL(function->output_type(), output_type);
+    const auto state_type = function->state_type();
+    CHECK(caf::holds_alternative<record_type>(state_type));
+    // Merging creates the function for the state type, which must summarize
+    // the same values as the original function.
+    const auto merging = make_function(name, state_type);
+    CHECK_EQUAL(merging->output_type(), output_type);
+    CHECK_EQUAL(merging->state_type(), state_type);
+  };
+  check_state_type("approx_top_k", type{string_type{}},
+                   type{list_type{string_type{}}});
+  check_state_type("approx_top_k", type{list_type{ip_type{}}},
+                   type{list_type{ip_type{}}});
+  check_state_type("approx_median", type{int64_type{}}, type{double_type{}});
+  check_state_type("approx_p90", type{uint64_type{}}, type{double_type{}});
+  check_state_type("approx_p99", type{duration_type{}},
+                   type{duration_type{}});
+  check_state_type("approx_median", type{time_type{}}, type{time_type{}});
+  const auto* plugin
+    = plugins::find<aggregation_function_plugin>("approx_median");
+  REQUIRE(plugin);
+  CHECK(!plugin->make_aggregation_function(type{string_type{}}));
+  // The bounds of the state keep the input type, even beyond the range of
+  // signed integers.
+  auto function = make_function("approx_median", type{uint64_type{}});
+  const auto large = std::numeric_limits<uint64_t>::max() - 1'000;
+  function->add(make_view(data{large}));
+  function->add(make_view(data{uint64_t{1}}));
+  const auto state = caf::get<record>(unbox(function->save()));
+  CHECK_EQUAL(state.at("min"), data{uint64_t{1}});
+  CHECK_EQUAL(state.at("max"), data{std::numeric_limits<uint64_t>::max()});
+}
+
+TEST(summarize with partial approximate aggregation) {
+  const auto opts = record{
+    {"group-by",
+     list{
+       "id.orig_h",
+     }},
+    {"aggregate",
+     record{
+       {"ports", record{{"approx_distinct", "id.resp_p"}}},
+       {"services", record{{"approx_top_k", "service"}}},
+       {"duration", record{{"approx_median", "duration"}}},
+     }},
+  };
+  auto summarize_operator
+    = unbox(summarize_plugin->make_pipeline_operator(opts));
+  auto merge_operator = unbox(summarize_plugin->make_pipeline_operator(opts));
+  const auto partial = merge_operator->split_partial();
+  REQUIRE(partial);
+  // Remember the durations of every group to check the merged medians.
+  auto durations = std::map<data, std::vector<duration>>{};
+  for (const auto& slice : zeek_conn_log_full) {
+    CHECK_EQUAL(summarize_operator->add(slice), caf::none);
+    auto partial_operator
+      = unbox(make_pipeline_operator(partial->name, partial->options));
+    CHECK_EQUAL(partial_operator->add(slice), caf::none);
+    for (auto& partial_result : unbox(partial_operator->finish()))
+      CHECK_EQUAL(merge_operator->add(std::move(partial_result)), caf::none);
+    const auto& schema = caf::get<record_type>(slice.schema());
+    const auto column = [&](std::string_view key) {
+      return schema.flat_index(unbox(schema.resolve_key(key)));
+    };
+    for (size_t row = 0; row < slice.rows(); ++row) {
+      auto& group = durations[materialize(slice.at(row, column("id.orig_h")))];
+      const auto value = materialize(slice.at(row, column("duration")));
+      if (const auto* duration = caf::get_if<vast::duration>(&value))
+        group.push_back(*duration);
+    }
+  }
+  const auto expected = concatenate(unbox(summarize_operator->finish()));
+  const auto merged = concatenate(unbox(merge_operator->finish()));
+  CHECK_EQUAL(merged.schema(), expected.schema());
+  REQUIRE_EQUAL(merged.rows(), expected.rows());
+  REQUIRE_EQUAL(merged.rows(), durations.size());
+  REQUIRE_EQUAL(merged.columns(), 4u);
+  for (size_t row = 0; row < merged.rows(); ++row) {
+    const auto group = materialize(merged.at(row, 0));
+    CHECK_EQUAL(group, materialize(expected.at(row, 0)));
+    // Few distinct values make both approx_distinct and approx_top_k exact,
+    // but the order of values with the same count may differ.
+    CHECK_EQUAL(materialize(merged.at(row, 1)),
+                materialize(expected.at(row, 1)));
+    auto merged_services = caf::get<list>(materialize(merged.at(row, 2)));
+    auto expected_services = caf::get<list>(materialize(expected.at(row, 2)));
+    std::sort(merged_services.begin(), merged_services.end());
+    std::sort(expected_services.begin(), expected_services.end());
+    CHECK_EQUAL(merged_services, expected_services);
+    // The t-digest keeps the values of small groups as they are, which makes
+    // the median independent of the merge order. For larger groups, the
+    // median must at least lie within the bounds of the group.
+    const auto& group_durations = durations.at(group);
+    const auto median = materialize(merged.at(row, 3));
+    if (group_durations.empty()) {
+      CHECK_EQUAL(median, data{});
+    } else if (group_durations.size() <= 30) {
+      CHECK_EQUAL(median, materialize(expected.at(row, 3)));
+    } else {
+      const auto [min, max] = std::minmax_element(group_durations.begin(),
+                                                  group_durations.end());
+      CHECK_GREATER_EQUAL(caf::get<duration>(median), *min);
+      CHECK_LESS_EQUAL(caf::get<duration>(median), *max);
+    }
+  }
+}
+
 FIXTURE_SCOPE_END()
 
 } // namespace vast
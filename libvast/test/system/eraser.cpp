@@ -105,6 +105,9 @@ mock_index(system::index_actor::stateful_pointer<mock_index_state>) {
     [=](atom::query, const uuid&, uint32_t) {
       FAIL("no mock implementation available");
     },
+    [=](atom::stop, uuid) {
+      FAIL("no mock implementation available");
+    },
     [=](atom::erase, uuid) -> atom::done {
       FAIL("no mock implementation available");
     },
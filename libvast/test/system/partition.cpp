@@ -116,7 +116,8 @@ TEST(passive_partition - load) {
   auto fs = self->spawn(mock_filesystem);
   auto path = std::filesystem::path{};
   auto aut = self->spawn(system::passive_partition, id,
-                         vast::system::accountant_actor{}, fs, path);
+                         vast::system::accountant_actor{}, fs, path,
+                         std::shared_ptr<system::query_result_cache>{});
   sched.run();
   self->send(aut, atom::erase_v);
   CHECK_EQUAL(sched.jobs.size(), 1u);
@@ -0,0 +1,113 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE partition_request_window
+
+#include "vast/system/partition_request_window.hpp"
+
+#include "vast/test/test.hpp"
+
+using namespace std::chrono_literals;
+using namespace vast;
+using namespace vast::system;
+
+namespace {
+
+using decision = partition_request_window::decision;
+
+struct fixture {
+  partition_request_window::options opts = {
+    .min_size = 1,
+    .max_size = 16,
+  };
+
+  stopwatch::time_point now = stopwatch::time_point{} + 1h;
+
+  /// Runs a round that requests the entire window.
+  decision round(partition_request_window& window, duration latency,
+                 uint64_t hits = 0, bool backlogged = false) {
+    window.start(window.next(1'000), now);
+    now += latency;
+    return window.finish(hits, backlogged, now);
+  }
+};
+
+} // namespace
+
+FIXTURE_SCOPE(partition_request_window_tests, fixture)
+
+TEST(defaults to one partition per core) {
+  auto window = partition_request_window{{.min_size = 1, .max_size = 0}};
+  CHECK_GREATER_EQUAL(window.max_size(), 1u);
+  CHECK_EQUAL(window.size(), 1u);
+  auto settings = caf::settings{};
+  caf::put(settings, "vast.max-partition-window", int64_t{8});
+  auto from_settings = partition_request_window::make_options(settings);
+  CHECK_EQUAL(from_settings.min_size, 1u);
+  CHECK_EQUAL(from_settings.max_size, 8u);
+}
+
+TEST(grows exponentially up to the cap) {
+  auto window = partition_request_window{opts};
+  CHECK(round(window, 100ms) == decision::grow);
+  CHECK_EQUAL(window.size(), 2u);
+  CHECK(round(window, 100ms) == decision::grow);
+  CHECK(round(window, 110ms) == decision::grow);
+  CHECK(round(window, 100ms) == decision::grow);
+  CHECK_EQUAL(window.size(), 16u);
+  CHECK(round(window, 100ms) == decision::keep);
+  CHECK_EQUAL(window.size(), 16u);
+  auto stats = window.take_statistics();
+  CHECK_EQUAL(stats.rounds, 5u);
+  CHECK_EQUAL(stats.partitions, 1u + 2u + 4u + 8u + 16u);
+  CHECK_EQUAL(stats.grown, 4u);
+  CHECK_EQUAL(window.take_statistics().rounds, 0u);
+}
+
+TEST(shrinks when partitions queue up) {
+  auto window = partition_request_window{opts};
+  for (auto i = 0; i < 3; ++i)
+    round(window, 100ms);
+  REQUIRE_EQUAL(window.size(), 8u);
+  // Twice as many partitions take twice as long: no change.
+  CHECK(round(window, 200ms) == decision::keep);
+  CHECK_EQUAL(window.size(), 8u);
+  CHECK(round(window, 400ms) == decision::shrink);
+  CHECK_EQUAL(window.size(), 5u);
+  // After shrinking, the window grows linearly.
+  CHECK(round(window, 100ms) == decision::grow);
+  CHECK_EQUAL(window.size(), 6u);
+}
+
+TEST(halves for slow consumers) {
+  auto window = partition_request_window{opts};
+  for (auto i = 0; i < 4; ++i)
+    round(window, 100ms);
+  REQUIRE_EQUAL(window.size(), 16u);
+  CHECK(round(window, 100ms, 0, true) == decision::shrink);
+  CHECK_EQUAL(window.size(), 8u);
+  CHECK(round(window, 100ms, 0, true) == decision::shrink);
+  CHECK_EQUAL(window.size(), 4u);
+  CHECK(round(window, 100ms) == decision::grow);
+  CHECK_EQUAL(window.size(), 5u);
+}
+
+TEST(limits the window by the remaining demand) {
+  auto window = partition_request_window{opts};
+  for (auto i = 0; i < 4; ++i)
+    round(window, 100ms, 100);
+  REQUIRE_EQUAL(window.size(), 16u);
+  // 15 partitions produced 400 hits so far.
+  CHECK_EQUAL(window.next(1'000), 16u);
+  CHECK_EQUAL(window.next(3), 3u);
+  CHECK_EQUAL(window.next(1'000, 50), 2u);
+  CHECK_EQUAL(window.next(1'000, 1), 1u);
+  CHECK_EQUAL(window.next(0, 50), 0u);
+}
+
+FIXTURE_SCOPE_END()
@@ -81,6 +81,9 @@ mock_index(system::index_actor::stateful_pointer<mock_index_state> self) {
         anon_self->send(hdl, *self->state.it++);
       anon_self->send(hdl, atom::done_v);
     },
+    [=](atom::stop, uuid) {
+      FAIL("no mock implementation available");
+    },
     [=](atom::erase, uuid) -> atom::done {
       FAIL("no mock implementation available");
     },
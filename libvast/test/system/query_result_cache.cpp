@@ -0,0 +1,117 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE query_result_cache
+
+#include "vast/system/query_result_cache.hpp"
+
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/expression.hpp"
+#include "vast/test/test.hpp"
+
+using namespace vast;
+using namespace vast::system;
+
+namespace {
+
+struct fixture {
+  fixture() {
+    x = unbox(to<expression>("x == 42"));
+    y = unbox(to<expression>("y != 1.2.3.4"));
+  }
+
+  uuid first = uuid::random();
+  uuid second = uuid::random();
+  expression x;
+  expression y;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(query_result_cache_tests, fixture)
+
+TEST(caches hits and counts per partition and expression) {
+  auto cache = query_result_cache{1'024 * 1'024};
+  CHECK(!cache.lookup(first, x));
+  cache.insert_hits(first, x, make_ids({{10, 20}}, 100));
+  auto entry = cache.lookup(first, x);
+  REQUIRE(entry);
+  REQUIRE(entry->hits);
+  CHECK_EQUAL(*entry->hits, make_ids({{10, 20}}, 100));
+  CHECK(!entry->count);
+  cache.insert_count(first, x, 7);
+  entry = cache.lookup(first, x);
+  REQUIRE(entry);
+  CHECK(entry->hits);
+  REQUIRE(entry->count);
+  CHECK_EQUAL(*entry->count, 7u);
+  CHECK(!cache.lookup(first, y));
+  CHECK(!cache.lookup(second, x));
+  auto hits = cache.find_hits(first, x);
+  REQUIRE(hits);
+  CHECK_EQUAL(*hits, make_ids({{10, 20}}, 100));
+  CHECK_EQUAL(cache.size(), 1u);
+  auto stats = cache.take_statistics();
+  CHECK_EQUAL(stats.hits, 2u);
+  CHECK_EQUAL(stats.misses, 3u);
+  CHECK_EQUAL(cache.take_statistics().hits, 0u);
+}
+
+TEST(erasing a partition invalidates its entries) {
+  auto cache = query_result_cache{1'024 * 1'024};
+  cache.insert_count(first, x, 1);
+  cache.insert_count(first, y, 2);
+  cache.insert_count(second, x, 3);
+  REQUIRE_EQUAL(cache.size(), 3u);
+  cache.erase(first);
+  CHECK_EQUAL(cache.size(), 1u);
+  CHECK(!cache.find_hits(first, x));
+  CHECK(!cache.lookup(first, y));
+  auto entry = cache.lookup(second, x);
+  REQUIRE(entry);
+  CHECK_EQUAL(entry->count.value_or(0), 3u);
+  CHECK_EQUAL(cache.take_statistics().invalidations, 2u);
+  cache.erase(second);
+  CHECK_EQUAL(cache.size(), 0u);
+  CHECK_EQUAL(cache.memusage(), 0u);
+}
+
+TEST(evicts the least recently used entries) {
+  auto probe = query_result_cache{1'024 * 1'024};
+  probe.insert_count(first, x, 1);
+  const auto entry_size = probe.memusage();
+  auto cache = query_result_cache{2 * entry_size};
+  cache.insert_count(first, x, 1);
+  cache.insert_count(first, y, 2);
+  // Using the first entry makes the second one the least recently used.
+  CHECK(cache.lookup(first, x));
+  cache.insert_count(second, x, 3);
+  CHECK_EQUAL(cache.size(), 2u);
+  CHECK(cache.lookup(first, x));
+  CHECK(!cache.lookup(first, y));
+  CHECK(cache.lookup(second, x));
+  CHECK_EQUAL(cache.take_statistics().evictions, 1u);
+  CHECK_LESS_EQUAL(cache.memusage(), cache.capacity());
+  // Entries that exceed the budget on their own are not cached at all.
+  auto tiny = query_result_cache{1};
+  tiny.insert_count(first, x, 1);
+  CHECK_EQUAL(tiny.size(), 0u);
+  CHECK_EQUAL(tiny.memusage(), 0u);
+}
+
+TEST(accounts for the size of the cached expressions) {
+  auto cache = query_result_cache{1'024 * 1'024};
+  cache.insert_count(first, x, 1);
+  const auto entry_size = cache.memusage();
+  auto long_field = std::string(1'024, 'x');
+  cache.insert_count(second, unbox(to<expression>(long_field + " == 42")), 1);
+  CHECK_GREATER_EQUAL(cache.memusage() - entry_size,
+                      entry_size + long_field.size());
+}
+
+FIXTURE_SCOPE_END()
@@ -0,0 +1,137 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE sharded_datagram_source
+
+#include "vast/system/sharded_datagram_source.hpp"
+
+#include "vast/detail/udp_batch_receiver.hpp"
+#include "vast/format/syslog.hpp"
+#include "vast/test/fixtures/actor_system.hpp"
+#include "vast/test/test.hpp"
+
+#include <caf/attach_stream_sink.hpp>
+#include <caf/exit_reason.hpp>
+#include <caf/send.hpp>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+using namespace vast;
+using namespace vast::system;
+
+namespace {
+
+using test_sink_actor = stream_sink_actor<table_slice, std::string>;
+
+/// Forwards all slices that it receives from the source to `receiver`.
+test_sink_actor::behavior_type
+test_sink(test_sink_actor::pointer self, caf::actor receiver) {
+  return {
+    [=](caf::stream<table_slice> in,
+        const std::string&) -> caf::inbound_stream_slot<table_slice> {
+      auto result = caf::attach_stream_sink(
+        self, in,
+        [](caf::unit_t&) {
+          // nop
+        },
+        [=](caf::unit_t&, table_slice slice) {
+          self->send(receiver, std::move(slice));
+        },
+        [=](caf::unit_t&, const caf::error&) {
+          CAF_MESSAGE(self->name() << " is done");
+        });
+      return result.inbound_slot();
+    },
+  };
+}
+
+void send_datagram(int fd, uint16_t port, std::string_view payload) {
+  ::sockaddr_in6 addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin6_family = AF_INET6;
+  addr.sin6_addr = in6addr_loopback;
+  addr.sin6_port = htons(port);
+  auto sent = ::sendto(fd, payload.data(), payload.size(), 0,
+                       reinterpret_cast<::sockaddr*>(&addr), sizeof(addr));
+  REQUIRE_EQUAL(sent, static_cast<ssize_t>(payload.size()));
+}
+
+struct fixture : fixtures::actor_system {
+  fixture() : fixtures::actor_system(VAST_PP_STRINGIFY(SUITE)) {
+  }
+};
+
+} // namespace
+
+FIXTURE_SCOPE(sharded_datagram_source_tests, fixture)
+
+TEST(syslog datagrams) {
+  // Let the kernel pick a free port for the shards to share.
+  auto port = uint16_t{0};
+  {
+    auto probe = detail::udp_batch_receiver::make(0, 1, 64, true);
+    REQUIRE_NOERROR(probe);
+    port = probe->port();
+  }
+  REQUIRE_NOT_EQUAL(port, 0u);
+  MESSAGE("spawn a source with two shards");
+  auto make_reader = [] {
+    return std::make_unique<format::syslog::reader>(caf::settings{});
+  };
+  auto shard_readers = std::vector<format::reader_ptr>{};
+  shard_readers.push_back(make_reader());
+  shard_readers.push_back(make_reader());
+  auto src = sys.spawn(sharded_datagram_source, port, std::move(shard_readers),
+                       make_reader(), 100u, std::nullopt, catalog_actor{},
+                       vast::module{}, std::string{}, accountant_actor{},
+                       std::vector<pipeline>{});
+  // The source opens its sockets when it starts, so we must wait for it to
+  // respond before sending datagrams.
+  self->request(src, caf::infinite, atom::get_v, atom::module_v)
+    .receive([](const vast::module&) { /* nop */ },
+             [](const caf::error& err) {
+               FAIL(err);
+             });
+  auto snk = sys.spawn(test_sink, caf::actor_cast<caf::actor>(self));
+  caf::anon_send(src, snk);
+  MESSAGE("send one event per datagram");
+  auto sender = ::socket(AF_INET6, SOCK_DGRAM, 0);
+  REQUIRE(sender >= 0);
+  constexpr auto num_datagrams = size_t{4};
+  for (size_t i = 0; i < num_datagrams; ++i)
+    send_datagram(sender, port,
+                  "<34>1 2003-10-11T22:14:15.003Z mymachineexamplecom su - "
+                  "ID47 - 'su root' failed for lonvick on /dev/pts/8");
+  ::close(sender);
+  MESSAGE("receive the parsed events from the shards");
+  // The shards flush their datagrams once the batch timeout expires.
+  auto rows = size_t{0};
+  auto timed_out = false;
+  while (rows < num_datagrams && !timed_out)
+    self->receive(
+      [&](table_slice slice) {
+        CHECK_EQUAL(slice.schema().name(), "syslog.rfc5424");
+        rows += slice.rows();
+      },
+      caf::after(10s) >> [&] {
+        timed_out = true;
+      });
+  CHECK_EQUAL(rows, num_datagrams);
+  self->send_exit(src, caf::exit_reason::user_shutdown);
+  self->send_exit(snk, caf::exit_reason::user_shutdown);
+}
+
+FIXTURE_SCOPE_END()
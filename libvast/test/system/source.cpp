@@ -82,7 +82,7 @@ TEST(zeek source) {
     = self->spawn(source, std::move(reader), events::slice_size, std::nullopt,
                   vast::system::catalog_actor{}, vast::module{}, std::string{},
                   vast::system::accountant_actor{},
-                  std::vector<vast::pipeline>{});
+                  std::vector<vast::pipeline>{}, std::nullopt);
   run();
   MESSAGE("start sink and run exhaustively");
   auto snk = self->spawn(test_sink, src);
@@ -0,0 +1,87 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE table_slice_size_controller
+
+#include "vast/system/table_slice_size_controller.hpp"
+
+#include "vast/test/test.hpp"
+
+using namespace std::chrono_literals;
+using namespace vast;
+using namespace vast::system;
+
+namespace {
+
+using decision = table_slice_size_controller::decision;
+
+struct fixture {
+  table_slice_size_controller::options opts = {
+    .min_size = 16,
+    .max_size = 1'024,
+    .target_latency = 1s,
+  };
+
+  stopwatch::time_point now = stopwatch::time_point{} + 1h;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(table_slice_size_controller_tests, fixture)
+
+TEST(clamps the initial size) {
+  CHECK_EQUAL(table_slice_size_controller(1, opts).size(), 16u);
+  CHECK_EQUAL(table_slice_size_controller(4'096, opts).size(), 1'024u);
+  CHECK_EQUAL(table_slice_size_controller(64, opts).size(), 64u);
+}
+
+TEST(grows for high input rates) {
+  auto controller = table_slice_size_controller{64, opts};
+  CHECK(controller.observe(1'000, 2'000, now) == decision::keep);
+  CHECK(controller.observe(1'000, 2'000, now + 500ms) == decision::keep);
+  CHECK(controller.observe(1'000, 2'000, now + 1s) == decision::grow);
+  CHECK_EQUAL(controller.size(), 128u);
+  CHECK_EQUAL(controller.rate(), 3'000.0);
+  // The size changes at most once per window, and never exceeds the bounds.
+  for (auto i = 2; i < 10; ++i)
+    controller.observe(1'000'000, 2'000'000, now + i * 1s);
+  CHECK_EQUAL(controller.size(), 1'024u);
+  auto stats = controller.take_statistics();
+  CHECK_EQUAL(stats.grown, 4u);
+  CHECK_EQUAL(stats.shrunk, 0u);
+  CHECK_EQUAL(controller.take_statistics().grown, 0u);
+}
+
+TEST(shrinks for low input rates) {
+  auto controller = table_slice_size_controller{1'024, opts};
+  controller.observe(10, 1'000, now);
+  CHECK(controller.observe(0, 1'000, now + 1s) == decision::shrink);
+  CHECK_EQUAL(controller.size(), 512u);
+  for (auto i = 2; i < 10; ++i)
+    controller.observe(10, 1'000, now + i * 1s);
+  CHECK_EQUAL(controller.size(), 16u);
+  CHECK_EQUAL(controller.take_statistics().shrunk, 6u);
+}
+
+TEST(keeps the size for matching input rates) {
+  auto controller = table_slice_size_controller{64, opts};
+  controller.observe(0, 1'000, now);
+  CHECK(controller.observe(100, 1'000, now + 1s) == decision::keep);
+  CHECK_EQUAL(controller.size(), 64u);
+}
+
+TEST(grows when saturated) {
+  // The source used up all of its credit, so the downstream components are
+  // the bottleneck and larger slices amortize their per-slice overhead.
+  auto controller = table_slice_size_controller{64, opts};
+  controller.observe(64, 64, now);
+  CHECK(controller.observe(0, 0, now + 1s) == decision::grow);
+  CHECK_EQUAL(controller.size(), 128u);
+}
+
+FIXTURE_SCOPE_END()
@@ -18,14 +18,12 @@ using namespace vast;
 
 namespace fixtures {
 
-node::node(std::string_view suite)
+node::node(std::string_view suite, caf::settings settings)
   : fixtures::deterministic_actor_system_and_events(suite) {
   MESSAGE("spawning node");
   test_node = self->spawn(system::node, "test", directory / "node",
                           system::detach_components::no);
   run();
-  auto settings = caf::settings{};
-  auto vast_settings = caf::settings{};
   // Don't run the catalog in a separate thread, otherwise it is
   // invisible to the `test_coordinator`.
   caf::put(settings, "vast.detach-components", false);
@@ -16,12 +16,18 @@
 #include "vast/test/fixtures/actor_system_and_events.hpp"
 #include "vast/uuid.hpp"
 
+#include <caf/settings.hpp>
+
 #include <string>
 
 namespace fixtures {
 
 struct node : deterministic_actor_system_and_events {
-  explicit node(std::string_view suite);
+  /// Spawns a node with a catalog, an index, and an importer, and ingests
+  /// the Zeek logs.
+  /// @param suite The name of the test suite.
+  /// @param settings Additional options for the catalog and the index.
+  explicit node(std::string_view suite, caf::settings settings = {});
 
   ~node() override;
 
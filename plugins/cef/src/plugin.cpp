@@ -132,7 +132,7 @@ protected:
       }
       produced++;
       batch_events_++;
-      if (bptr->rows() == max_slice_size)
+      if (bptr->rows() >= max_slice_size)
         if (auto err = finish(cons, bptr))
           return err;
     }
@@ -8,21 +8,32 @@
 
 #include <vast/arrow_compat.hpp>
 #include <vast/arrow_table_slice.hpp>
+#include <vast/bitmap_algorithms.hpp>
 #include <vast/concept/convertible/data.hpp>
 #include <vast/detail/base64.hpp>
 #include <vast/detail/inspection_common.hpp>
+#include <vast/detail/string.hpp>
 #include <vast/plugin.hpp>
 #include <vast/store.hpp>
+#include <vast/system/report.hpp>
 
 #include <arrow/array.h>
 #include <arrow/compute/cast.h>
 #include <arrow/io/api.h>
 #include <arrow/ipc/api.h>
 #include <arrow/table.h>
+#include <arrow/util/config.h>
 #include <arrow/util/key_value_metadata.h>
 #include <caf/expected.hpp>
 #include <parquet/arrow/reader.h>
 #include <parquet/arrow/writer.h>
+#include <parquet/metadata.h>
+#include <parquet/schema.h>
+#include <parquet/statistics.h>
+
+#include <algorithm>
+#include <numeric>
+#include <thread>
 
 namespace vast::plugins::parquet {
 
@@ -259,9 +270,10 @@ unwrap_record_batch(const std::shared_ptr<arrow::RecordBatch>& rb) {
 }
 
 /// Create multiple table slices for a record batch, splitting at `max_slice_size`
+/// and assigning IDs starting at `base_offset`.
 std::vector<table_slice>
 create_table_slices(const std::shared_ptr<arrow::RecordBatch>& rb,
-                    int64_t max_slice_size) {
+                    int64_t max_slice_size, int64_t base_offset) {
   auto final_rb = unwrap_record_batch(rb);
   auto time_col = rb->GetColumnByName("import_time");
   auto slices = std::vector<table_slice>{};
@@ -272,7 +284,7 @@ create_table_slices(const std::shared_ptr<arrow::RecordBatch>& rb,
     auto& slice = slices.emplace_back(rb_sliced, schema);
     slice.import_time(
       derive_import_time(time_col->Slice(offset, max_slice_size)));
-    slice.offset(detail::narrow_cast<id>(offset));
+    slice.offset(detail::narrow_cast<id>(base_offset + offset));
   }
   return slices;
 }
@@ -295,23 +307,215 @@ std::shared_ptr<arrow::Schema> parse_arrow_schema_from_metadata(
   return *arrow_schema;
 }
 
-caf::expected<std::shared_ptr<arrow::Table>>
-read_parquet_buffer(const chunk_ptr& chunk) {
-  VAST_ASSERT(chunk);
-  auto bufr = std::make_shared<arrow::io::BufferReader>(as_arrow_buffer(chunk));
-  const auto options = ::parquet::default_reader_properties();
-  auto parquet_reader = ::parquet::ParquetFileReader::Open(bufr, options);
-  auto arrow_schema
-    = parse_arrow_schema_from_metadata(parquet_reader->metadata());
-  std::unique_ptr<::parquet::arrow::FileReader> file_reader{};
-  if (auto st = ::parquet::arrow::OpenFile(bufr, arrow::default_memory_pool(),
-                                           &file_reader);
-      !st.ok())
-    return caf::make_error(ec::parse_error, st.ToString());
-  std::shared_ptr<arrow::Table> table{};
-  if (auto st = file_reader->ReadTable(&table); !st.ok())
-    return caf::make_error(ec::parse_error, st.ToString());
-  return align_table_to_schema(arrow_schema, table);
+/// The value range of a column chunk in a row group.
+struct column_statistics {
+  /// The smallest and largest non-null value, or nil if unknown.
+  data min = {};
+  data max = {};
+
+  /// Whether the column chunk may contain null values.
+  bool has_nulls = true;
+
+  /// Whether the column chunk contains only null values.
+  bool all_null = false;
+};
+
+/// Reads the statistics of a column chunk for a column of the given type.
+/// Leaves the value range unset for types whose Parquet representation does
+/// not sort like the corresponding VAST data.
+column_statistics
+make_column_statistics(const ::parquet::ColumnChunkMetaData& chunk,
+                       const type& column_type) {
+  auto result = column_statistics{};
+  const auto stats = chunk.statistics();
+  if (!stats || !chunk.is_stats_set())
+    return result;
+  if (stats->HasNullCount()) {
+    result.has_nulls = stats->null_count() > 0;
+    result.all_null = stats->null_count() == chunk.num_values();
+  }
+  if (!stats->HasMinMax())
+    return result;
+  auto int64_range = [&](auto make) {
+    if (stats->physical_type() != ::parquet::Type::INT64)
+      return;
+    const auto& typed = static_cast<const ::parquet::Int64Statistics&>(*stats);
+    result.min = make(typed.min());
+    result.max = make(typed.max());
+  };
+  auto f = detail::overload{
+    [&](const bool_type&) {
+      if (stats->physical_type() != ::parquet::Type::BOOLEAN)
+        return;
+      const auto& typed = static_cast<const ::parquet::BoolStatistics&>(*stats);
+      result.min = typed.min();
+      result.max = typed.max();
+    },
+    [&](const int64_type&) {
+      int64_range([](int64_t x) {
+        return x;
+      });
+    },
+    [&](const uint64_type&) {
+      // Parquet stores unsigned integers as INT64 with an unsigned sort order.
+      int64_range([](int64_t x) {
+        return static_cast<uint64_t>(x);
+      });
+    },
+    [&](const double_type&) {
+      if (stats->physical_type() != ::parquet::Type::DOUBLE)
+        return;
+      const auto& typed
+        = static_cast<const ::parquet::DoubleStatistics&>(*stats);
+      result.min = typed.min();
+      result.max = typed.max();
+    },
+    [&](const duration_type&) {
+      int64_range([](int64_t x) {
+        return duration{x};
+      });
+    },
+    [&](const time_type&) {
+      int64_range([](int64_t x) {
+        return time{duration{x}};
+      });
+    },
+    [&](const string_type&) {
+      if (stats->physical_type() != ::parquet::Type::BYTE_ARRAY)
+        return;
+      const auto& typed
+        = static_cast<const ::parquet::ByteArrayStatistics&>(*stats);
+      auto to_string = [](const ::parquet::ByteArray& x) {
+        return std::string{reinterpret_cast<const char*>(x.ptr), x.len};
+      };
+      result.min = to_string(typed.min());
+      result.max = to_string(typed.max());
+    },
+    [&](const auto&) {
+      // nop
+    },
+  };
+  caf::visit(f, column_type);
+  return result;
+}
+
+/// Checks whether any value in a column chunk may satisfy `x op rhs`.
+bool may_match(const column_statistics& stats, relational_operator op,
+               const data& rhs) {
+  if (caf::holds_alternative<caf::none_t>(rhs)) {
+    if (op == relational_operator::equal)
+      return stats.has_nulls;
+    if (op == relational_operator::not_equal)
+      return !stats.all_null;
+    return true;
+  }
+  switch (op) {
+    case relational_operator::equal:
+    case relational_operator::less:
+    case relational_operator::less_equal:
+    case relational_operator::greater:
+    case relational_operator::greater_equal:
+    case relational_operator::in:
+      if (stats.all_null)
+        return false;
+      break;
+    default:
+      return true;
+  }
+  if (caf::holds_alternative<caf::none_t>(stats.min))
+    return true;
+  if (op == relational_operator::in) {
+    const auto* values = caf::get_if<list>(&rhs);
+    if (!values)
+      return true;
+    return std::any_of(values->begin(), values->end(), [&](const data& x) {
+      return may_match(stats, relational_operator::equal, x);
+    });
+  }
+  // Values of different types do not compare meaningfully.
+  if (rhs.get_data().index() != stats.min.get_data().index())
+    return true;
+  switch (op) {
+    case relational_operator::equal:
+      return !(rhs < stats.min) && !(stats.max < rhs);
+    case relational_operator::less:
+      return stats.min < rhs;
+    case relational_operator::less_equal:
+      return !(rhs < stats.min);
+    case relational_operator::greater:
+      return rhs < stats.max;
+    case relational_operator::greater_equal:
+      return !(stats.max < rhs);
+    default:
+      return true;
+  }
+}
+
+/// The location and column statistics of a row group.
+struct row_group_info {
+  /// The ID of the first event in the row group.
+  int64_t offset = {};
+
+  /// The number of events in the row group.
+  int64_t num_rows = {};
+
+  /// The statistics of the import time column.
+  column_statistics import_time = {};
+
+  /// Maps the flat column index of the event schema to the statistics of the
+  /// column, for all columns with a known value range.
+  std::unordered_map<size_t, column_statistics> columns = {};
+};
+
+/// Checks whether any event in a row group may satisfy the expression, which
+/// must be tailored to the event schema.
+bool may_match(const expression& expr, const row_group_info& row_group) {
+  auto f = detail::overload{
+    [&](const conjunction& xs) {
+      return std::all_of(xs.begin(), xs.end(), [&](const expression& x) {
+        return may_match(x, row_group);
+      });
+    },
+    [&](const disjunction& xs) {
+      return std::any_of(xs.begin(), xs.end(), [&](const expression& x) {
+        return may_match(x, row_group);
+      });
+    },
+    [&](const negation&) {
+      return true;
+    },
+    [&](const predicate& pred) {
+      const auto* rhs = caf::get_if<data>(&pred.rhs);
+      if (!rhs)
+        return true;
+      if (const auto* extractor = caf::get_if<data_extractor>(&pred.lhs)) {
+        auto it = row_group.columns.find(extractor->column);
+        if (it == row_group.columns.end())
+          return true;
+        return may_match(it->second, pred.op, *rhs);
+      }
+      if (const auto* extractor = caf::get_if<meta_extractor>(&pred.lhs);
+          extractor && extractor->kind == meta_extractor::import_time)
+        return may_match(row_group.import_time, pred.op, *rhs);
+      return true;
+    },
+    [&](const caf::none_t&) {
+      return true;
+    },
+  };
+  return caf::visit(f, expr);
+}
+
+/// Checks whether a selection contains any ID in [first, last). An empty
+/// selection selects all IDs.
+bool intersects(const ids& selection, id first, id last) {
+  if (selection.empty())
+    return true;
+  if (first >= selection.size())
+    return false;
+  last = std::min(last, selection.size());
+  const auto before = first == 0 ? 0 : rank(selection, first - 1);
+  return rank(selection, last - 1) > before;
 }
 
 std::shared_ptr<::parquet::WriterProperties>
@@ -319,9 +523,14 @@ writer_properties(const configuration& config) {
   auto builder = ::parquet::WriterProperties::Builder{};
   builder.created_by("VAST")
     ->enable_dictionary()
+    ->enable_statistics()
     ->compression(::parquet::Compression::ZSTD)
     ->compression_level(detail::narrow_cast<int>(config.zstd_compression_level))
     ->version(::parquet::ParquetVersion::PARQUET_2_6);
+#if ARROW_VERSION_MAJOR >= 13
+  // The page index lets readers skip pages within a row group.
+  builder.enable_write_page_index();
+#endif
   return builder.build();
 }
 
@@ -369,9 +578,12 @@ auto write_parquet_buffer(const std::vector<table_slice>& slices,
   auto table = arrow::Table::FromRecordBatches(batches).ValueOrDie();
   auto writer_props = writer_properties(config);
   auto arrow_writer_props = arrow_writer_properties();
-  auto status
-    = ::parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), sink,
-                                   1 << 24, writer_props, arrow_writer_props);
+  // Row groups are the unit for skipping data on read, so we keep them at the
+  // configured size rather than writing one large row group.
+  auto status = ::parquet::arrow::WriteTable(
+    *table, arrow::default_memory_pool(), sink,
+    detail::narrow_cast<int64_t>(config.row_group_size), writer_props,
+    arrow_writer_props);
   VAST_ASSERT(status.ok(), status.ToString().c_str());
   return sink->Finish().ValueOrDie();
 }
@@ -386,41 +598,200 @@ public:
   /// @param chunk The chunk pointing to the store's persisted data.
   /// @returns An error on failure.
   [[nodiscard]] caf::error load(chunk_ptr chunk) override {
-    auto table = read_parquet_buffer(chunk);
-    if (!table)
-      return table.error();
-    for (const auto& rb : arrow::TableBatchReader(*table)) {
-      if (!rb.ok())
-        return caf::make_error(ec::system_error,
-                               fmt::format("unable to read record batch: {}",
-                                           rb.status().ToString()));
-      auto slices_for_batch = create_table_slices(
-        *rb, detail::narrow_cast<int64_t>(parquet_config_.row_group_size));
-      slices_.reserve(slices_for_batch.size() + slices_.size());
-      slices_.insert(slices_.end(),
-                     std::make_move_iterator(slices_for_batch.begin()),
-                     std::make_move_iterator(slices_for_batch.end()));
-      num_rows_ += (*rb)->num_rows();
+    VAST_ASSERT(chunk);
+    auto input
+      = std::make_shared<arrow::io::BufferReader>(as_arrow_buffer(chunk));
+    auto properties = ::parquet::default_arrow_reader_properties();
+    // Decode the columns of the requested row groups in parallel.
+    properties.set_use_threads(true);
+    auto builder = ::parquet::arrow::FileReaderBuilder{};
+    if (auto st = builder.Open(input); !st.ok())
+      return caf::make_error(ec::parse_error, st.ToString());
+    builder.properties(properties)->memory_pool(arrow::default_memory_pool());
+    if (auto st = builder.Build(&reader_); !st.ok())
+      return caf::make_error(ec::parse_error, st.ToString());
+    const auto metadata = reader_->parquet_reader()->metadata();
+    arrow_schema_ = parse_arrow_schema_from_metadata(metadata);
+    if (!arrow_schema_)
+      return caf::make_error(ec::parse_error,
+                             "failed to read Arrow schema from Parquet "
+                             "metadata");
+    const auto event_field = arrow_schema_->GetFieldByName("event");
+    if (!event_field || event_field->type()->id() != arrow::Type::STRUCT)
+      return caf::make_error(ec::parse_error,
+                             "Parquet file lacks an event column");
+    schema_ = type::from_arrow(
+      *arrow::schema(event_field->type()->fields(), event_field->metadata()));
+    // Map the Parquet leaf columns to the flat columns of the event schema.
+    auto leaf_columns = std::unordered_map<std::string, int>{};
+    auto import_time_column = -1;
+    for (int i = 0; i < metadata->num_columns(); ++i) {
+      auto path = metadata->schema()->Column(i)->path()->ToDotVector();
+      if (path.size() == 1 && path[0] == "import_time")
+        import_time_column = i;
+      else if (path.size() > 1 && path[0] == "event")
+        leaf_columns.emplace(detail::join(path.begin() + 1, path.end(), "."),
+                             i);
+    }
+    const auto& event_schema = caf::get<record_type>(schema_);
+    auto columns = std::vector<std::tuple<size_t, int, type>>{};
+    auto flat_index = size_t{0};
+    for (const auto& [field, index] : event_schema.leaves()) {
+      if (auto it = leaf_columns.find(event_schema.key(index));
+          it != leaf_columns.end())
+        columns.emplace_back(flat_index, it->second, field.type);
+      ++flat_index;
     }
+    auto offset = int64_t{0};
+    row_groups_.reserve(metadata->num_row_groups());
+    for (int i = 0; i < metadata->num_row_groups(); ++i) {
+      const auto row_group = metadata->RowGroup(i);
+      auto& info = row_groups_.emplace_back();
+      info.offset = offset;
+      info.num_rows = row_group->num_rows();
+      if (import_time_column >= 0)
+        info.import_time = make_column_statistics(
+          *row_group->ColumnChunk(import_time_column), type{time_type{}});
+      for (const auto& [column, leaf, column_type] : columns) {
+        auto stats
+          = make_column_statistics(*row_group->ColumnChunk(leaf), column_type);
+        if (!caf::holds_alternative<caf::none_t>(stats.min) || stats.all_null
+            || !stats.has_nulls)
+          info.columns.emplace(column, std::move(stats));
+      }
+      offset += info.num_rows;
+    }
+    num_rows_ = detail::narrow_cast<uint64_t>(offset);
+    decoded_.resize(row_groups_.size());
     return {};
   }
 
   /// Retrieve all of the store's slices.
   /// @returns The store's slices.
   [[nodiscard]] detail::generator<table_slice> slices() const override {
-    // We need to make a copy of the slices here because the slices_ vector may
-    // get invalidated while we iterate over it.
-    auto slices = slices_;
-    for (auto& slice : slices)
+    auto all = std::vector<size_t>(row_groups_.size());
+    std::iota(all.begin(), all.end(), size_t{0});
+    for (auto&& slice : decode(std::move(all)))
       co_yield std::move(slice);
   }
 
+  [[nodiscard]] type schema() const override {
+    return schema_;
+  }
+
   [[nodiscard]] uint64_t num_events() const override {
     return num_rows_;
   }
 
+  /// Counts the matching events, skipping row groups that cannot match.
+  [[nodiscard]] detail::generator<uint64_t>
+  count(expression expr, ids selection) const override {
+    for (auto&& slice : decode(candidates(expr, selection)))
+      co_yield count_matching(slice, expr, selection);
+  }
+
+  /// Extracts the matching events, skipping row groups that cannot match.
+  [[nodiscard]] detail::generator<table_slice>
+  extract(expression expr, ids selection) const override {
+    for (auto&& slice : decode(candidates(expr, selection)))
+      if (auto filtered_slice = filter(slice, expr, selection))
+        co_yield std::move(*filtered_slice);
+  }
+
+  /// Reports the number of row groups that queries skipped.
+  [[nodiscard]] std::vector<system::data_point> take_metrics() override {
+    return {
+      {"passive-store.lookup.skipped-row-groups",
+       std::exchange(skipped_row_groups_, 0)},
+    };
+  }
+
 private:
-  std::vector<table_slice> slices_ = {};
+  /// Selects the row groups that may contain events matching the expression
+  /// and the selection, based on the row group statistics.
+  std::vector<size_t>
+  candidates(const expression& expr, const ids& selection) const {
+    auto result = std::vector<size_t>{};
+    for (size_t i = 0; i < row_groups_.size(); ++i) {
+      const auto& row_group = row_groups_[i];
+      const auto first = detail::narrow_cast<id>(row_group.offset);
+      const auto last = first + detail::narrow_cast<id>(row_group.num_rows);
+      if (intersects(selection, first, last) && may_match(expr, row_group))
+        result.push_back(i);
+    }
+    VAST_DEBUG("parquet store skips {} of {} row groups for {}",
+               row_groups_.size() - result.size(), row_groups_.size(), expr);
+    skipped_row_groups_ += row_groups_.size() - result.size();
+    return result;
+  }
+
+  /// Retrieves the slices of the given row groups, decoding the row groups
+  /// that were not used before in parallel batches.
+  detail::generator<table_slice> decode(std::vector<size_t> indices) const {
+    const auto batch_size
+      = std::max(size_t{1}, size_t{std::thread::hardware_concurrency()});
+    for (size_t begin = 0; begin < indices.size(); begin += batch_size) {
+      const auto end = std::min(begin + batch_size, indices.size());
+      auto missing = std::vector<int>{};
+      for (auto i = begin; i < end; ++i)
+        if (!decoded_[indices[i]])
+          missing.push_back(detail::narrow_cast<int>(indices[i]));
+      if (!missing.empty()) {
+        if (auto err = decode_row_groups(missing)) {
+          VAST_ERROR("parquet store failed to decode row groups: {}", err);
+          co_return;
+        }
+      }
+      for (auto i = begin; i < end; ++i)
+        for (const auto& slice : *decoded_[indices[i]])
+          co_yield slice;
+    }
+  }
+
+  /// Decodes row groups and keeps their slices for subsequent queries.
+  caf::error decode_row_groups(const std::vector<int>& indices) const {
+    std::shared_ptr<arrow::Table> table{};
+    if (auto st = reader_->ReadRowGroups(indices, &table); !st.ok())
+      return caf::make_error(ec::parse_error, st.ToString());
+    table = align_table_to_schema(arrow_schema_, table);
+    // The table holds the rows of the row groups one after the other in the
+    // order of the indices, but its record batches may span row groups, so
+    // we slice the table by row group first.
+    auto table_offset = int64_t{0};
+    for (const auto index : indices) {
+      const auto& row_group = row_groups_[index];
+      VAST_ASSERT(table_offset + row_group.num_rows <= table->num_rows());
+      const auto row_group_table
+        = table->Slice(table_offset, row_group.num_rows);
+      table_offset += row_group.num_rows;
+      auto& slices = decoded_[index].emplace();
+      auto offset = row_group.offset;
+      for (const auto& rb : arrow::TableBatchReader(*row_group_table)) {
+        if (!rb.ok())
+          return caf::make_error(ec::system_error,
+                                 fmt::format("unable to read record batch: {}",
+                                             rb.status().ToString()));
+        auto slices_for_batch = create_table_slices(
+          *rb, detail::narrow_cast<int64_t>(parquet_config_.row_group_size),
+          offset);
+        slices.insert(slices.end(),
+                      std::make_move_iterator(slices_for_batch.begin()),
+                      std::make_move_iterator(slices_for_batch.end()));
+        offset += (*rb)->num_rows();
+      }
+    }
+    return {};
+  }
+
+  std::unique_ptr<::parquet::arrow::FileReader> reader_ = {};
+  std::shared_ptr<arrow::Schema> arrow_schema_ = {};
+  type schema_ = {};
+  std::vector<row_group_info> row_groups_ = {};
+  /// The slices of the row groups that were decoded already. The vector never
+  /// grows after loading, so slices remain valid while queries iterate them.
+  mutable std::vector<std::optional<std::vector<table_slice>>> decoded_ = {};
+  /// The number of row groups that queries skipped since the last report.
+  mutable uint64_t skipped_row_groups_ = {};
   configuration parquet_config_ = {};
   uint64_t num_rows_ = {};
 };
@@ -20,7 +20,9 @@
 #include <vast/logger.hpp>
 #include <vast/plugin.hpp>
 #include <vast/query_context.hpp>
+#include <vast/store.hpp>
 #include <vast/system/posix_filesystem.hpp>
+#include <vast/system/report.hpp>
 #include <vast/system/status.hpp>
 #include <vast/table_slice_builder.hpp>
 #include <vast/test/fixtures/actor_system_and_events.hpp>
@@ -137,6 +139,49 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
     REQUIRE_EQUAL(rows, tally);
     return tally;
   }
+
+  /// A Parquet store available both as an actor and as a plain passive store.
+  struct row_group_store {
+    system::store_actor actor;
+    std::unique_ptr<passive_store> store;
+  };
+
+  /// Writes the slices into a Parquet store whose row groups hold at most
+  /// `row_group_size` events each.
+  row_group_store make_row_group_store(const std::vector<table_slice>& slices,
+                                       uint64_t row_group_size) {
+    const auto* plugin = vast::plugins::find<vast::store_plugin>("parquet");
+    REQUIRE(plugin);
+    // We know that initialize may be called multiple times for this plugin.
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    auto* mutable_plugin = const_cast<store_plugin*>(plugin);
+    REQUIRE_EQUAL(
+      mutable_plugin->initialize(record{{"row-group-size", row_group_size}}),
+      caf::none);
+    auto builder_and_header = plugin->make_store_builder(
+      accountant, filesystem, vast::uuid::random());
+    REQUIRE_NOERROR(builder_and_header);
+    auto& [builder, header] = *builder_and_header;
+    vast::detail::spawn_container_source(sys, slices, builder);
+    run();
+    auto actor = plugin->make_store(accountant, filesystem, as_bytes(header));
+    REQUIRE_NOERROR(actor);
+    run();
+    auto active = plugin->make_active_store(caf::settings{});
+    REQUIRE_NOERROR(active);
+    REQUIRE_EQUAL((*active)->add(slices), caf::none);
+    auto chunk = (*active)->finish();
+    REQUIRE_NOERROR(chunk);
+    auto store = plugin->make_passive_store();
+    REQUIRE_NOERROR(store);
+    REQUIRE_EQUAL((*store)->load(std::move(*chunk)), caf::none);
+    REQUIRE_EQUAL(mutable_plugin->initialize(record{
+                    {"row-group-size",
+                     uint64_t{defaults::import::table_slice_size}}}),
+                  caf::none);
+    return {std::move(*actor), std::move(*store)};
+  }
+
   vast::system::accountant_actor accountant = {};
   vast::system::filesystem_actor filesystem;
 };
@@ -400,6 +445,66 @@ TEST(passive parquet store selective query) {
   compare_table_slices(*expected_slice, results[0]);
 }
 
+TEST(passive parquet store skips row groups) {
+  auto f = table_slice_fixture();
+  // Write every slice into a row group of its own.
+  auto [actor, store]
+    = make_row_group_store(std::vector<table_slice>{4, f.slice}, 4);
+  auto& passive = *store;
+  const auto count_direct = [&](const ids& selection, std::string_view expr) {
+    auto result = uint64_t{};
+    for (auto hits : passive.count(unbox(to<expression>(expr)), selection))
+      result += hits;
+    return result;
+  };
+  const auto skipped_row_groups = [&] {
+    auto result = uint64_t{};
+    for (auto& metric : passive.take_metrics())
+      if (metric.key == "passive-store.lookup.skipped-row-groups")
+        result += caf::get<uint64_t>(metric.value);
+    return result;
+  };
+  // Every row group contains a match, so the statistics rule out none.
+  CHECK_EQUAL(count_direct(vast::ids{}, "f2 > 3"), 4ull);
+  CHECK_EQUAL(skipped_row_groups(), 0ull);
+  // No row group can contain a match.
+  CHECK_EQUAL(count_direct(vast::ids{}, "f2 > 4"), 0ull);
+  CHECK_EQUAL(skipped_row_groups(), 4ull);
+  // Selections rule out the row groups that they do not overlap with.
+  auto selection = make_ids({{8, 12}}, 16);
+  CHECK_EQUAL(count_direct(selection, "f2 >= 3"), 2ull);
+  CHECK_EQUAL(skipped_row_groups(), 3ull);
+  // The store actor refers to the correct events for selections past the
+  // first row group.
+  CHECK_EQUAL(count(actor, selection, unbox(to<expression>("f2 >= 3"))),
+              2ull);
+  auto results = query(actor, selection, unbox(to<expression>("f1 == \"n4\"")));
+  REQUIRE_EQUAL(results.size(), 1ull);
+  CHECK_EQUAL(results[0].rows(), 1ull);
+}
+
+TEST(passive parquet store decodes non-adjacent row groups) {
+  auto f = table_slice_fixture();
+  // Write every slice into a row group of its own.
+  auto [actor, store]
+    = make_row_group_store(std::vector<table_slice>{4, f.slice}, 4);
+  // The first query decodes the first and the third row group together, and
+  // every row must end up with its own row group.
+  auto selection = make_ids({{0, 4}, {8, 12}}, 16);
+  auto results = query(actor, selection);
+  REQUIRE_EQUAL(results.size(), 2ull);
+  CHECK_EQUAL(results[0].offset(), 0ull);
+  CHECK_EQUAL(results[0].rows(), 4ull);
+  CHECK_EQUAL(results[1].offset(), 8ull);
+  CHECK_EQUAL(results[1].rows(), 4ull);
+  for (const auto& result : results)
+    compare_table_slices(f.slice, result);
+  CHECK_EQUAL(count(actor, selection, unbox(to<expression>("f2 >= 3"))),
+              4ull);
+  CHECK_EQUAL(count(actor, vast::ids{}, unbox(to<expression>("f2 >= 3"))),
+              8ull);
+}
+
 TEST(passive parquet store erase) {
   auto f = table_slice_fixture();
   auto slice = f.slice;
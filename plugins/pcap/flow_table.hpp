@@ -0,0 +1,250 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include <vast/detail/assert.hpp>
+#include <vast/flow.hpp>
+#include <vast/hash/hash.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace vast::plugins::pcap {
+
+/// Computes a hash of a flow that is identical for both of its directions.
+inline size_t symmetric_hash(const flow& x) {
+  auto h1 = hash(x.src_addr) ^ hash(x.src_port.number());
+  auto h2 = hash(x.dst_addr) ^ hash(x.dst_port.number());
+  // Combine order-independently, but keep the protocol in the mix.
+  return (h1 ^ h2) + (h1 & h2) + static_cast<size_t>(x.src_port.type());
+}
+
+/// A hash table for per-flow state that uses open addressing with linear
+/// probing, and a timer wheel for expiring inactive flows.
+///
+/// Every flow is scheduled in the wheel slot of the time it was last seen at
+/// the time of scheduling. When the wheel advances, it only looks at the slots
+/// that fall out of the window, and reschedules flows that were active since.
+/// Expiry therefore costs time proportional to the number of expiring flows
+/// rather than to the size of the table. When the table is full, flows from
+/// the oldest slots get evicted first.
+/// @tparam State The per-flow state.
+template <class State>
+class flow_table {
+public:
+  // -- member types -----------------------------------------------------------
+
+  struct entry {
+    flow key = {};
+    State state = {};
+    uint64_t last = 0;
+    uint64_t tick = 0;
+    bool occupied = false;
+  };
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// Constructs a flow table.
+  /// @param max_flows The maximum number of flows to track.
+  /// @param max_age The maximum number of time units a flow may be inactive.
+  flow_table(size_t max_flows, uint64_t max_age)
+    : max_flows_{std::max(max_flows, size_t{1})}, max_age_{max_age} {
+    // The wheel needs to cover the maximum age. Up to a certain size, every
+    // slot corresponds to a single time unit, which makes expiry exact.
+    // Coarser slots delay expiry by at most one slot.
+    constexpr uint64_t max_slots = 65'536;
+    granularity_ = max_age_ / max_slots + 1;
+    wheel_.resize(max_age_ / granularity_ + 2);
+    slots_.resize(std::min(std::bit_ceil(2 * max_flows_), size_t{1024}));
+  }
+
+  // -- properties -------------------------------------------------------------
+
+  /// @returns The number of tracked flows.
+  [[nodiscard]] size_t size() const {
+    return size_;
+  }
+
+  /// Looks up the state of a flow.
+  /// @returns A pointer to the state, or `nullptr` if the flow is not tracked.
+  /// @note The pointer remains valid only until the next modification.
+  State* find(const flow& key) {
+    if (auto* e = find_entry(key))
+      return &e->state;
+    return nullptr;
+  }
+
+  /// Looks up the state of a flow, or inserts a new state if the flow is not
+  /// tracked yet, and marks the flow as active at time `now`.
+  /// @param key The flow to look up.
+  /// @param now The current time.
+  /// @param make A function that creates the initial state for the flow.
+  /// @returns A reference to the state of the flow.
+  /// @note The reference remains valid only until the next modification.
+  template <class Factory>
+  State& touch(const flow& key, uint64_t now, Factory&& make) {
+    if (auto* e = find_entry(key)) {
+      e->last = now;
+      return e->state;
+    }
+    if (2 * (size_ + 1) > slots_.size())
+      grow();
+    auto& e = slots_[probe(key)];
+    VAST_ASSERT(!e.occupied);
+    e.key = key;
+    e.state = make();
+    e.last = now;
+    e.occupied = true;
+    schedule(e, now);
+    ++size_;
+    return e.state;
+  }
+
+  /// Stops tracking a flow.
+  /// @returns `true` if the flow was tracked.
+  bool erase(const flow& key) {
+    auto mask = slots_.size() - 1;
+    auto i = hash(key) & mask;
+    while (slots_[i].occupied) {
+      if (slots_[i].key == key) {
+        erase_at(i);
+        return true;
+      }
+      i = (i + 1) & mask;
+    }
+    return false;
+  }
+
+  /// Advances the timer wheel and evicts all flows that have been inactive
+  /// for more than the maximum age.
+  /// @param now The current time.
+  /// @returns The number of evicted flows.
+  size_t expire(uint64_t now) {
+    auto result = size_t{0};
+    const auto num_slots = wheel_.size();
+    const auto horizon = max_age_ / granularity_;
+    const auto now_tick = now / granularity_;
+    // All ticks before `end` only contain flows that may have expired.
+    const auto end = now_tick > horizon ? now_tick - horizon : uint64_t{0};
+    if (end <= next_tick_)
+      return result;
+    // Process every slot at most once, even if time advanced by more than a
+    // full rotation of the wheel.
+    const auto begin
+      = std::max(next_tick_, end > num_slots ? end - num_slots : uint64_t{0});
+    next_tick_ = end;
+    for (auto tick = begin; tick < end; ++tick) {
+      auto keys = std::exchange(wheel_[tick % num_slots], {});
+      for (const auto& key : keys) {
+        auto* e = find_entry(key);
+        if (!e || e->tick % num_slots != tick % num_slots)
+          continue;
+        if (e->last < now && now - e->last > max_age_) {
+          erase(key);
+          ++result;
+        } else {
+          schedule(*e, e->last);
+        }
+      }
+    }
+    return result;
+  }
+
+  /// Evicts the least recently scheduled flows until the table has room for
+  /// at least one more flow.
+  /// @returns The number of evicted flows.
+  size_t shrink_to_max_size() {
+    auto result = size_t{0};
+    const auto num_slots = wheel_.size();
+    for (auto tick = next_tick_;
+         size_ >= max_flows_ && tick < next_tick_ + num_slots; ++tick) {
+      auto& keys = wheel_[tick % num_slots];
+      while (size_ >= max_flows_ && !keys.empty()) {
+        auto key = keys.back();
+        keys.pop_back();
+        auto* e = find_entry(key);
+        if (e && e->tick % num_slots == tick % num_slots) {
+          erase(key);
+          ++result;
+        }
+      }
+    }
+    return result;
+  }
+
+private:
+  entry* find_entry(const flow& key) {
+    auto mask = slots_.size() - 1;
+    for (auto i = hash(key) & mask; slots_[i].occupied; i = (i + 1) & mask)
+      if (slots_[i].key == key)
+        return &slots_[i];
+    return nullptr;
+  }
+
+  /// @returns The index of the first free slot for `key`.
+  size_t probe(const flow& key) const {
+    auto mask = slots_.size() - 1;
+    auto i = hash(key) & mask;
+    while (slots_[i].occupied)
+      i = (i + 1) & mask;
+    return i;
+  }
+
+  /// Removes the entry at index `i` via backward-shift deletion, which keeps
+  /// probe sequences intact without the need for tombstones.
+  void erase_at(size_t i) {
+    auto mask = slots_.size() - 1;
+    auto j = i;
+    while (true) {
+      j = (j + 1) & mask;
+      if (!slots_[j].occupied)
+        break;
+      auto home = hash(slots_[j].key) & mask;
+      // Move the entry at j into the hole at i unless its home slot lies
+      // cyclically within (i, j].
+      auto within = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+      if (!within) {
+        slots_[i] = std::move(slots_[j]);
+        i = j;
+      }
+    }
+    slots_[i] = entry{};
+    --size_;
+  }
+
+  /// Adds a flow to the wheel slot of `time`, or to the oldest slot that was
+  /// not processed yet if `time` lies further in the past.
+  void schedule(entry& e, uint64_t time) {
+    auto tick = std::max(time / granularity_, next_tick_);
+    e.tick = tick;
+    wheel_[tick % wheel_.size()].push_back(e.key);
+  }
+
+  void grow() {
+    auto old = std::exchange(slots_, std::vector<entry>(slots_.size() * 2));
+    for (auto& e : old) {
+      if (e.occupied)
+        slots_[probe(e.key)] = std::move(e);
+    }
+  }
+
+  std::vector<entry> slots_ = {};
+  std::vector<std::vector<flow>> wheel_ = {};
+  size_t size_ = 0;
+  size_t max_flows_ = 0;
+  uint64_t max_age_ = 0;
+  uint64_t granularity_ = 1;
+  uint64_t next_tick_ = 0;
+};
+
+} // namespace vast::plugins::pcap
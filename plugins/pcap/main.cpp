@@ -6,6 +6,7 @@
 // SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
 // SPDX-License-Identifier: BSD-3-Clause
 
+#include <vast/chunk.hpp>
 #include <vast/community_id.hpp>
 #include <vast/data.hpp>
 #include <vast/error.hpp>
@@ -17,15 +18,24 @@
 #include <vast/logger.hpp>
 #include <vast/module.hpp>
 #include <vast/plugin.hpp>
+#include <vast/table_slice_builder.hpp>
 #include <vast/type.hpp>
 
+#include "flow_table.hpp"
+#include "mapped_trace.hpp"
+
 #include <caf/settings.hpp>
 #include <netinet/in.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <optional>
 #include <pcap.h>
-#include <random>
 #include <span>
+#include <thread>
 
 namespace vast::defaults {
 
@@ -55,6 +65,10 @@ struct pcap {
   /// of 65535 should be sufficient, on most if not all networks, to capture all
   /// the data available from the packet.
   static constexpr size_t snaplen = 65'535;
+
+  /// Number of threads that track flows and build table slices. A value of 0
+  /// tracks flows on the thread that reads the packets.
+  static constexpr size_t workers = 0;
 };
 
 } // namespace import
@@ -283,6 +297,359 @@ struct segment {
   std::span<const std::byte> payload;
 };
 
+/// The state of a tracked flow.
+struct flow_state {
+  uint64_t bytes;
+  std::string community_id;
+};
+
+/// Tracks the flows of a trace to enforce the cutoff, and caches the
+/// community ID per flow.
+class flow_tracker {
+public:
+  flow_tracker(uint64_t cutoff, size_t max_flows, uint64_t max_age,
+               uint64_t expire_interval, bool community_id)
+    : flows_{max_flows, max_age},
+      max_flows_{max_flows},
+      cutoff_{cutoff},
+      expire_interval_{expire_interval},
+      community_id_{community_id} {
+    // nop
+  }
+
+  /// Accounts for a packet of a flow.
+  /// @param conn The flow of the packet.
+  /// @param packet_time The time of the packet in seconds.
+  /// @param payload_size The size of the layer 4 payload.
+  /// @returns The state of the flow, or `nullptr` if the flow reached the
+  ///          configured cutoff.
+  /// @note The returned pointer remains valid until the next call.
+  const flow_state*
+  update(const flow& conn, uint64_t packet_time, uint64_t payload_size) {
+    auto make_state = [&] {
+      auto id = community_id_ ? community_id::compute<policy::base64>(conn)
+                              : std::string{};
+      return flow_state{0, std::move(id)};
+    };
+    if (last_expire_ == 0)
+      last_expire_ = packet_time;
+    // Evict all flows that have been inactive for the maximum age, and make
+    // room for a new flow if the table is full. We do so before looking up the
+    // flow of the packet, as evicting moves entries around in the table. Only
+    // a flow that was inactive for the maximum age gets evicted itself, and
+    // then starts over with this packet.
+    if (packet_time - last_expire_ > expire_interval_) {
+      last_expire_ = packet_time;
+      flows_.expire(packet_time);
+    }
+    if (flows_.size() >= max_flows_ && !flows_.find(conn))
+      flows_.shrink_to_max_size();
+    auto& st = flows_.touch(conn, packet_time, make_state);
+    auto& flow_size = st.bytes;
+    if (flow_size == cutoff_)
+      return nullptr;
+    VAST_ASSERT(flow_size < cutoff_);
+    // Trim the packet if needed.
+    flow_size += std::min(payload_size, cutoff_ - flow_size);
+    return &st;
+  }
+
+private:
+  flow_table<flow_state> flows_;
+  size_t max_flows_;
+  uint64_t cutoff_;
+  uint64_t expire_interval_;
+  uint64_t last_expire_ = 0;
+  bool community_id_;
+};
+
+/// A decapsulated packet.
+struct packet_info {
+  flow conn;
+  time ts;
+  uint64_t packet_time;
+  uint64_t payload_size;
+  std::optional<uint16_t> outer_vid;
+  std::optional<uint16_t> inner_vid;
+};
+
+/// The outcome of decoding a captured frame.
+enum class decode_status {
+  ok,      ///< The packet was decoded successfully.
+  skipped, ///< The packet has an unsupported layer 3 or 4 protocol.
+  invalid, ///< The frame is malformed.
+};
+
+/// Decodes layers 2 to 4 of a captured Ethernet frame.
+/// @param raw_frame The captured bytes of the frame.
+/// @param ts The capture time of the frame.
+/// @param result The decoded packet, valid only if the result is
+///        `decode_status::ok`.
+decode_status decode_packet(std::span<const std::byte> raw_frame, time ts,
+                            packet_info& result) {
+  // Parse layer 2.
+  auto frame = frame::make(raw_frame, frame_type::ethernet);
+  if (!frame)
+    return decode_status::invalid;
+  // Parse layer 3.
+  auto packet = packet::make(frame->payload, frame->type);
+  if (!packet) {
+    VAST_DEBUG("skipping packet of type {}", frame->type);
+    return decode_status::skipped;
+  }
+  // Parse layer 4.
+  auto segment = segment::make(packet->payload, packet->type);
+  if (!segment) {
+    VAST_DEBUG("skipping segment of type {:#0x}", packet->type);
+    return decode_status::skipped;
+  }
+  using namespace std::chrono;
+  result = packet_info{
+    .conn = make_flow(packet->src, packet->dst, segment->src, segment->dst,
+                      segment->type),
+    .ts = ts,
+    .packet_time = static_cast<uint64_t>(
+      duration_cast<seconds>(ts.time_since_epoch()).count()),
+    .payload_size = segment->payload.size(),
+    .outer_vid = frame->outer_vid,
+    .inner_vid = frame->inner_vid,
+  };
+  return decode_status::ok;
+}
+
+/// Splits `size` elements into up to `num_segments` contiguous segments of
+/// roughly equal size, and invokes `f(segment, begin, end)` for every segment
+/// on its own thread. Returns after all invocations finished.
+template <class F>
+void for_each_segment(size_t size, size_t num_segments, F f) {
+  VAST_ASSERT(num_segments > 0);
+  const auto segment_size = (size + num_segments - 1) / num_segments;
+  auto threads = std::vector<std::thread>{};
+  for (size_t i = 1; i < num_segments && i * segment_size < size; ++i)
+    threads.emplace_back([&, i] {
+      f(i, i * segment_size, std::min((i + 1) * segment_size, size));
+    });
+  // The calling thread handles the first segment itself.
+  f(size_t{0}, size_t{0}, std::min(segment_size, size));
+  for (auto& thread : threads)
+    thread.join();
+}
+
+/// Adds a packet as a new row to a builder for the packet type.
+/// @returns `true` on success.
+bool add_packet(table_slice_builder& builder, const packet_info& pkt,
+                std::span<const std::byte> raw_frame, const flow_state& st,
+                bool community_id) {
+  auto payload = std::string_view{
+    reinterpret_cast<const char*>(raw_frame.data()), raw_frame.size()};
+  auto add_vid = [&](const std::optional<uint16_t>& vid) {
+    return vid ? builder.add(uint64_t{*vid}) : builder.add(caf::none);
+  };
+  return builder.add(pkt.ts) && builder.add(pkt.conn.src_addr)
+         && builder.add(pkt.conn.dst_addr)
+         && builder.add(pkt.conn.src_port.number())
+         && builder.add(pkt.conn.dst_port.number()) && add_vid(pkt.outer_vid)
+         && add_vid(pkt.inner_vid)
+         && (community_id ? builder.add(std::string_view{st.community_id})
+                          : builder.add(caf::none))
+         && builder.add(payload);
+}
+
+/// Spreads flow tracking and table slice building over multiple worker
+/// threads. The capture thread dispatches every packet by its symmetric flow
+/// hash, so both directions of a flow end up in the same worker. Every worker
+/// owns its own flow table and builder.
+class flow_pipeline {
+public:
+  /// The number of packets that the capture thread collects per worker before
+  /// handing them over.
+  static constexpr size_t batch_size = 256;
+
+  /// The number of batches per worker that may be in flight before the
+  /// capture thread blocks.
+  static constexpr size_t max_queued_batches = 64;
+
+  flow_pipeline(size_t num_workers, const type& packet_type,
+                const std::function<flow_tracker()>& make_tracker,
+                bool community_id)
+    : community_id_{community_id} {
+    VAST_ASSERT(num_workers > 0);
+    for (size_t i = 0; i < num_workers; ++i) {
+      auto w = std::make_unique<worker>(make_tracker());
+      w->builder = std::make_shared<table_slice_builder>(packet_type);
+      workers_.push_back(std::move(w));
+    }
+    for (auto& w : workers_)
+      w->thread = std::thread{[this, w = w.get()] {
+        run(*w);
+      }};
+  }
+
+  flow_pipeline(const flow_pipeline&) = delete;
+  flow_pipeline& operator=(const flow_pipeline&) = delete;
+
+  ~flow_pipeline() {
+    for (auto& w : workers_) {
+      {
+        auto guard = std::lock_guard{w->mutex};
+        w->stop = true;
+      }
+      w->cv.notify_all();
+    }
+    for (auto& w : workers_)
+      w->thread.join();
+  }
+
+  /// Hands a packet over to the worker responsible for its flow. Blocks if
+  /// the worker is too far behind.
+  void dispatch(const packet_info& pkt, std::span<const std::byte> raw_frame,
+                size_t max_slice_size) {
+    auto& w = *workers_[symmetric_hash(pkt.conn) % workers_.size()];
+    auto& batch = w.pending;
+    batch.packets.push_back(pkt);
+    batch.offsets.push_back(batch.frames.size());
+    batch.frames.insert(batch.frames.end(), raw_frame.begin(),
+                        raw_frame.end());
+    batch.max_slice_size = max_slice_size;
+    if (batch.packets.size() >= batch_size)
+      submit(w, false);
+  }
+
+  /// Makes all workers finish their current table slices, and waits until
+  /// they did.
+  void flush() {
+    {
+      auto guard = std::lock_guard{out_mutex_};
+      pending_flushes_ = workers_.size();
+    }
+    for (auto& w : workers_)
+      submit(*w, true);
+    auto guard = std::unique_lock{out_mutex_};
+    out_cv_.wait(guard, [&] {
+      return pending_flushes_ == 0;
+    });
+  }
+
+  /// Retrieves all table slices the workers finished so far.
+  std::vector<table_slice> take_slices() {
+    auto guard = std::lock_guard{out_mutex_};
+    return std::exchange(slices_, {});
+  }
+
+  /// Retrieves and resets the number of packets the workers discarded
+  /// because their flows reached the cutoff.
+  size_t take_discarded() {
+    return discarded_.exchange(0);
+  }
+
+private:
+  struct packet_batch {
+    std::vector<packet_info> packets = {};
+    std::vector<size_t> offsets = {};
+    std::vector<std::byte> frames = {};
+    size_t max_slice_size = 0;
+    bool flush = false;
+  };
+
+  struct worker {
+    explicit worker(flow_tracker tracker) : tracker{std::move(tracker)} {
+      // nop
+    }
+
+    flow_tracker tracker;
+    table_slice_builder_ptr builder = {};
+    packet_batch pending = {};
+    std::mutex mutex = {};
+    std::condition_variable cv = {};
+    std::deque<packet_batch> queue = {};
+    bool stop = false;
+    std::thread thread = {};
+  };
+
+  void submit(worker& w, bool flush) {
+    w.pending.flush = flush;
+    {
+      auto guard = std::unique_lock{w.mutex};
+      w.cv.wait(guard, [&] {
+        return w.queue.size() < max_queued_batches;
+      });
+      w.queue.push_back(std::exchange(w.pending, {}));
+    }
+    w.cv.notify_all();
+  }
+
+  void run(worker& w) {
+    while (true) {
+      auto batch = packet_batch{};
+      {
+        auto guard = std::unique_lock{w.mutex};
+        w.cv.wait(guard, [&] {
+          return w.stop || !w.queue.empty();
+        });
+        if (w.queue.empty())
+          return;
+        batch = std::move(w.queue.front());
+        w.queue.pop_front();
+      }
+      w.cv.notify_all();
+      process(w, batch);
+    }
+  }
+
+  void process(worker& w, const packet_batch& batch) {
+    auto finished = std::vector<table_slice>{};
+    auto finish = [&] {
+      if (w.builder->rows() == 0)
+        return;
+      auto slice = w.builder->finish();
+      if (slice.encoding() == table_slice_encoding::none)
+        VAST_ERROR("pcap-reader worker failed to finish table slice");
+      else
+        finished.push_back(std::move(slice));
+    };
+    auto discarded = size_t{0};
+    for (size_t i = 0; i < batch.packets.size(); ++i) {
+      const auto& pkt = batch.packets[i];
+      auto first = batch.offsets[i];
+      auto last = i + 1 < batch.offsets.size() ? batch.offsets[i + 1]
+                                               : batch.frames.size();
+      auto raw_frame = std::span{batch.frames}.subspan(first, last - first);
+      const auto* st
+        = w.tracker.update(pkt.conn, pkt.packet_time, pkt.payload_size);
+      if (!st) {
+        ++discarded;
+        continue;
+      }
+      if (!add_packet(*w.builder, pkt, raw_frame, *st, community_id_)) {
+        VAST_ERROR("pcap-reader worker failed to fill row");
+        continue;
+      }
+      if (w.builder->rows() >= batch.max_slice_size)
+        finish();
+    }
+    if (batch.flush)
+      finish();
+    discarded_ += discarded;
+    {
+      auto guard = std::lock_guard{out_mutex_};
+      for (auto& slice : finished)
+        slices_.push_back(std::move(slice));
+      if (batch.flush)
+        --pending_flushes_;
+    }
+    if (batch.flush)
+      out_cv_.notify_all();
+  }
+
+  std::vector<std::unique_ptr<worker>> workers_ = {};
+  std::mutex out_mutex_ = {};
+  std::condition_variable out_cv_ = {};
+  std::vector<table_slice> slices_ = {};
+  size_t pending_flushes_ = 0;
+  std::atomic<size_t> discarded_ = 0;
+  bool community_id_;
+};
+
 /// A PCAP reader.
 class reader : public format::single_schema_reader {
 public:
@@ -311,6 +678,8 @@ public:
     drop_rate_threshold_
       = get_or(options, category + ".drop-rate-threshold", 0.05);
     community_id_ = !get_or(options, category + ".disable-community-id", false);
+    workers_ = get_or(options, category + ".workers", defaults_t::workers);
+    mmap_ = get_or(options, category + ".mmap", false);
     packet_type_ = make_packet_type();
     last_stats_ = {};
     discard_count_ = 0;
@@ -394,7 +763,7 @@ protected:
     // Local buffer for storing error messages.
     char buf[PCAP_ERRBUF_SIZE];
     // Initialize PCAP if needed.
-    if (!pcap_) {
+    if (!pcap_ && !trace_) {
       std::error_code err{};
       const auto file_exists
         = std::filesystem::exists(std::filesystem::path{input_}, err);
@@ -419,6 +788,26 @@ protected:
                   *interface_);
       } else if (input_ != "-" && !file_exists) {
         return caf::make_error(ec::format_error, "no such file: ", input_);
+      } else if (mmap_ && input_ != "-") {
+        auto chunk = chunk::mmap(input_);
+        if (!chunk)
+          return chunk.error();
+        auto trace = mapped_trace::make(std::move(*chunk));
+        if (!trace)
+          return caf::make_error(ec::format_error,
+                                 fmt::format("failed to open pcap file {}: {}",
+                                             input_, trace.error()));
+        trace_ = std::move(*trace);
+        VAST_INFO("{} reads memory-mapped {} trace from {}",
+                  detail::pretty_type_name(this),
+                  trace_->format() == mapped_trace::file_format::pcap ? "pcap"
+                                                                      : "pcapng",
+                  input_);
+        if (pseudo_realtime_ > 0) {
+          pseudo_realtime_ = 0;
+          VAST_WARN("{} ignores pseudo-realtime for memory-mapped traces",
+                    detail::pretty_type_name(this));
+        }
       } else {
 #ifdef PCAP_TSTAMP_PRECISION_NANO
         pcap_.reset(::pcap_open_offline_with_tstamp_precision(
@@ -427,7 +816,7 @@ protected:
         pcap_ = ::pcap_open_offline(input_.c_str(), buf);
 #endif
         if (!pcap_) {
-          flows_.clear();
+          tracker_.reset();
           return caf::make_error(ec::format_error, "failed to open pcap file ",
                                  input_, ": ", std::string{buf});
         }
@@ -445,7 +834,39 @@ protected:
                    detail::pretty_type_name(this), max_age_);
       VAST_VERBOSE("{} expires flow table every {} s",
                    detail::pretty_type_name(this), expire_interval_);
+      // Memory-mapped traces track flows sequentially and parallelize the
+      // remaining work by themselves.
+      if ((workers_ == 0 || trace_) && !tracker_) {
+        tracker_.emplace(make_tracker());
+      } else if (workers_ > 0 && !trace_ && !pipeline_) {
+        VAST_VERBOSE("{} tracks flows in {} worker threads",
+                     detail::pretty_type_name(this), workers_);
+        pipeline_ = std::make_unique<flow_pipeline>(
+          workers_, packet_type_,
+          [this] {
+            return make_tracker();
+          },
+          community_id_);
+      }
     }
+    if (trace_)
+      return read_mapped(max_events, max_slice_size, f);
+    // Finishes the current table slices before returning. In multi-threaded
+    // mode, we only wait for the workers when we must flush our buffers, and
+    // otherwise forward only the slices that are ready.
+    auto finish = [&](consumer& f, caf::error result, bool flush = true) {
+      if (!pipeline_)
+        return this->finish(f, std::move(result));
+      if (flush) {
+        pipeline_->flush();
+        last_batch_sent_ = reader_clock::now();
+        batch_events_ = 0;
+      }
+      for (auto& slice : pipeline_->take_slices())
+        f(std::move(slice));
+      discard_count_ += pipeline_->take_discarded();
+      return result;
+    };
     auto produced = size_t{0};
     while (produced < max_events) {
       if (batch_events_ > 0 && batch_timeout_ > reader_clock::duration::zero()
@@ -460,7 +881,7 @@ protected:
       if (r == 0 && produced == 0)
         continue; // timed out, no events produced yet
       if (r == 0)
-        return finish(f, caf::none); // timed out
+        return finish(f, caf::none, false); // timed out
       if (r == -2)
         return finish(f, caf::make_error(ec::end_of_input, "reached end of "
                                                            "trace"));
@@ -472,38 +893,6 @@ protected:
       }
       auto raw_frame = std::span<const std::byte>{
         reinterpret_cast<const std::byte*>(data), header->len};
-      // Parse layer 2.
-      auto frame = frame::make(raw_frame, frame_type::ethernet);
-      if (!frame)
-        return caf::make_error(ec::format_error, "failed to decapsulate frame");
-      // Parse layer 3.
-      auto packet = packet::make(frame->payload, frame->type);
-      if (!packet) {
-        ++discard_count_;
-        VAST_DEBUG("skipping packet of type {}", frame->type);
-        continue;
-      }
-      // Parse layer 4.
-      auto segment = segment::make(packet->payload, packet->type);
-      if (!segment) {
-        ++discard_count_;
-        VAST_DEBUG("skipping segment of type {:#0x}", packet->type);
-        continue;
-      }
-      // Make connection
-      auto conn = make_flow(packet->src, packet->dst, segment->src,
-                            segment->dst, segment->type);
-      // Parse packet timestamp
-      uint64_t packet_time = header->ts.tv_sec;
-      if (last_expire_ == 0)
-        last_expire_ = packet_time;
-      if (!update_flow(conn, packet_time, segment->payload.size())) {
-        ++discard_count_;
-        VAST_DEBUG("{} skips cut off packet", detail::pretty_type_name(this));
-        continue;
-      }
-      evict_inactive(packet_time);
-      shrink_to_max_size();
       // Extract timestamp.
       using namespace std::chrono;
       auto secs = seconds(header->ts.tv_sec);
@@ -513,26 +902,30 @@ protected:
 #else
       ts += microseconds(header->ts.tv_usec);
 #endif
-      // Assemble packet.
-      auto make_string_view = [](std::span<const std::byte> bytes) {
-        auto data = reinterpret_cast<const char*>(bytes.data());
-        auto size = bytes.size();
-        return std::string_view{data, size};
-      };
-      auto payload = make_string_view(raw_frame);
-      auto& cid = state(conn).community_id;
-      if (!(builder_->add(ts) && builder_->add(conn.src_addr)
-            && builder_->add(conn.dst_addr)
-            && builder_->add(conn.src_port.number())
-            && builder_->add(conn.dst_port.number())
-            && (frame->outer_vid ? builder_->add(uint64_t{*frame->outer_vid})
-                                 : builder_->add(caf::none))
-            && (frame->outer_vid ? builder_->add(uint64_t{*frame->inner_vid})
-                                 : builder_->add(caf::none))
-            && (community_id_ ? builder_->add(std::string_view{cid})
-                              : builder_->add(caf::none))
-            && builder_->add(payload))) {
-        return caf::make_error(ec::parse_error, "unable to fill row");
+      auto pkt = packet_info{};
+      switch (decode_packet(raw_frame, ts, pkt)) {
+        case decode_status::invalid:
+          return caf::make_error(ec::format_error,
+                                 "failed to decapsulate frame");
+        case decode_status::skipped:
+          ++discard_count_;
+          continue;
+        case decode_status::ok:
+          break;
+      }
+      if (pipeline_) {
+        pipeline_->dispatch(pkt, raw_frame, max_slice_size);
+      } else {
+        const auto* st
+          = tracker_->update(pkt.conn, pkt.packet_time, pkt.payload_size);
+        if (!st) {
+          ++discard_count_;
+          VAST_DEBUG("{} skips cut off packet",
+                     detail::pretty_type_name(this));
+          continue;
+        }
+        if (!add_packet(*builder_, pkt, raw_frame, *st, community_id_))
+          return caf::make_error(ec::parse_error, "unable to fill row");
       }
       ++produced;
       ++batch_events_;
@@ -549,89 +942,121 @@ protected:
         }
         last_timestamp_ = ts;
       }
-      if (builder_->rows() == max_slice_size)
+      if (!pipeline_ && builder_->rows() >= max_slice_size)
         if (auto err = finish(f, caf::none))
           return err;
     }
-    return finish(f, caf::none);
+    return finish(f, caf::none, false);
   }
 
 private:
-  struct flow_state {
-    uint64_t bytes;
-    uint64_t last;
-    std::string community_id;
+  /// The state of a packet from a memory-mapped trace between the stages of
+  /// processing a batch.
+  struct mapped_packet {
+    decode_status status = decode_status::skipped;
+    packet_info info = {};
+    flow_state state = {};
   };
 
-  /// @returns either an existing state associated to `x` or a new state for
-  ///          the flow.
-  flow_state& state(const flow& x) {
-    auto i = flows_.find(x);
-    if (i == flows_.end()) {
-      auto id = community_id::compute<policy::base64>(x);
-      i = flows_.emplace(x, flow_state{0, 0, std::move(id)}).first;
+  /// Reads packets from a memory-mapped trace. Every batch of records gets
+  /// split into segments that are decoded and turned into table slices in
+  /// parallel. Flow tracking happens sequentially in between to retain the
+  /// semantics of the cutoff, so the result is identical to reading the trace
+  /// sequentially.
+  caf::error
+  read_mapped(size_t max_events, size_t max_slice_size, consumer& f) {
+    const auto num_segments = std::max(workers_, size_t{1});
+    auto produced = size_t{0};
+    while (produced < max_events) {
+      // Locating the records only requires hopping over their headers, which
+      // is cheap enough to do sequentially.
+      records_.clear();
+      auto max_records
+        = std::min(max_events - produced, max_slice_size * num_segments);
+      if (auto err = trace_->read(max_records, records_))
+        return err;
+      auto packets = std::vector<mapped_packet>(records_.size());
+      for_each_segment(records_.size(), num_segments,
+                       [&](size_t, size_t begin, size_t end) {
+                         for (auto i = begin; i < end; ++i) {
+                           const auto& record = records_[i];
+                           if (record.link_type
+                               == mapped_trace::link_type_ethernet)
+                             packets[i].status = decode_packet(
+                               record.data, record.timestamp, packets[i].info);
+                         }
+                       });
+      for (auto& packet : packets) {
+        if (packet.status == decode_status::invalid)
+          return caf::make_error(ec::format_error,
+                                 "failed to decapsulate frame");
+        if (packet.status != decode_status::ok) {
+          ++discard_count_;
+          continue;
+        }
+        const auto* st = tracker_->update(
+          packet.info.conn, packet.info.packet_time, packet.info.payload_size);
+        if (!st) {
+          ++discard_count_;
+          packet.status = decode_status::skipped;
+          continue;
+        }
+        packet.state = *st;
+      }
+      auto slices = std::vector<table_slice>(num_segments);
+      auto failed = std::atomic<bool>{false};
+      for_each_segment(
+        records_.size(), num_segments,
+        [&](size_t segment, size_t begin, size_t end) {
+          auto builder = table_slice_builder{packet_type_};
+          for (auto i = begin; i < end; ++i) {
+            const auto& packet = packets[i];
+            if (packet.status == decode_status::ok
+                && !add_packet(builder, packet.info, records_[i].data,
+                               packet.state, community_id_))
+              failed = true;
+          }
+          if (builder.rows() > 0)
+            slices[segment] = builder.finish();
+        });
+      if (failed)
+        return caf::make_error(ec::parse_error, "unable to fill row");
+      for (auto& slice : slices) {
+        if (slice.rows() == 0)
+          continue;
+        if (slice.encoding() == table_slice_encoding::none)
+          return caf::make_error(ec::parse_error, "unable to finish current "
+                                                  "slice");
+        produced += slice.rows();
+        f(std::move(slice));
+      }
+      last_batch_sent_ = reader_clock::now();
+      batch_events_ = 0;
+      if (trace_->done())
+        return caf::make_error(ec::end_of_input, "reached end of trace");
     }
-    return i->second;
+    return caf::none;
   }
 
-  /// @returns whether `true` if the flow remains active, `false` if the flow
-  ///          reached the configured cutoff.
-  bool update_flow(const flow& x, uint64_t packet_time, uint64_t payload_size) {
-    auto& st = state(x);
-    st.last = packet_time;
-    auto& flow_size = st.bytes;
-    if (flow_size == cutoff_)
-      return false;
-    VAST_ASSERT(flow_size < cutoff_);
-    // Trim the packet if needed.
-    flow_size += std::min(payload_size, cutoff_ - flow_size);
-    return true;
-  }
-
-  /// Evict all flows that have been inactive for the maximum age.
-  void evict_inactive(uint64_t packet_time) {
-    if (packet_time - last_expire_ <= expire_interval_)
-      return;
-    last_expire_ = packet_time;
-    auto i = flows_.begin();
-    while (i != flows_.end())
-      if (packet_time - i->second.last > max_age_)
-        i = flows_.erase(i);
-      else
-        ++i;
-  }
-
-  /// Evicts random flows when exceeding the maximum configured flow count.
-  void shrink_to_max_size() {
-    while (flows_.size() >= max_flows_) {
-      auto buckets = flows_.bucket_count();
-      auto unif1 = std::uniform_int_distribution<size_t>{0, buckets - 1};
-      auto bucket = unif1(generator_);
-      auto bucket_size = flows_.bucket_size(bucket);
-      while (bucket_size == 0) {
-        ++bucket;
-        bucket %= buckets;
-        bucket_size = flows_.bucket_size(bucket);
-      }
-      auto unif2 = std::uniform_int_distribution<size_t>{0, bucket_size - 1};
-      auto offset = unif2(generator_);
-      VAST_ASSERT(offset < bucket_size);
-      auto begin = flows_.begin(bucket);
-      std::advance(begin, offset);
-      flows_.erase(begin->first);
-    }
+  /// @returns A flow tracker with the configured limits.
+  flow_tracker make_tracker() const {
+    return flow_tracker{cutoff_, max_flows_, max_age_, expire_interval_,
+                        community_id_};
   }
 
   std::unique_ptr<struct pcap, pcap_close_wrapper> pcap_ = nullptr;
-  std::unordered_map<flow, flow_state> flows_;
+  std::optional<flow_tracker> tracker_ = {};
+  std::unique_ptr<flow_pipeline> pipeline_ = nullptr;
+  std::optional<mapped_trace> trace_ = {};
+  std::vector<trace_record> records_ = {};
   std::string input_;
   std::optional<std::string> interface_;
   uint64_t cutoff_;
   size_t max_flows_;
-  std::mt19937 generator_;
   uint64_t max_age_;
   uint64_t expire_interval_;
-  uint64_t last_expire_ = 0;
+  size_t workers_;
+  bool mmap_;
   time last_timestamp_ = time::min();
   int64_t pseudo_realtime_;
   size_t snaplen_;
@@ -797,6 +1222,10 @@ public:
                                           "warnings to occur")
       .add<bool>("disable-community-id", "disable computation of community id "
                                          "for every packet")
+      .add<size_t>("workers", "number of threads that track flows and build "
+                              "table slices")
+      .add<bool>("mmap", "memory-map trace files and parse them without "
+                         "libpcap")
       .finish();
   };
 
@@ -0,0 +1,314 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include <vast/chunk.hpp>
+#include <vast/detail/byte_swap.hpp>
+#include <vast/error.hpp>
+#include <vast/time.hpp>
+
+#include <caf/error.hpp>
+#include <caf/expected.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace vast::plugins::pcap {
+
+/// A packet record of a trace file.
+struct trace_record {
+  /// The capture time of the packet.
+  time timestamp = {};
+
+  /// The captured bytes of the packet.
+  std::span<const std::byte> data = {};
+
+  /// The link-layer header type of the interface that captured the packet.
+  uint32_t link_type = 0;
+};
+
+/// A memory-mapped trace file in the classic PCAP or the PCAPNG format that
+/// parses the record headers without libpcap. The records point into the
+/// mapped region, so reading them requires no copies.
+class mapped_trace {
+public:
+  // -- constants --------------------------------------------------------------
+
+  /// The link-layer header type for Ethernet, i.e., `DLT_EN10MB`.
+  static constexpr uint32_t link_type_ethernet = 1;
+
+  // -- member types -----------------------------------------------------------
+
+  /// The supported file formats.
+  enum class file_format { pcap, pcapng };
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// Creates a trace from the contents of a trace file.
+  /// @param chunk The contents of the trace file, usually memory-mapped.
+  /// @returns The trace, or an error if the file header is malformed.
+  static caf::expected<mapped_trace> make(chunk_ptr chunk) {
+    auto result = mapped_trace{std::move(chunk)};
+    if (auto err = result.read_file_header())
+      return err;
+    return result;
+  }
+
+  // -- properties -------------------------------------------------------------
+
+  /// @returns The format of the trace file.
+  [[nodiscard]] file_format format() const {
+    return format_;
+  }
+
+  /// @returns Whether all records have been read.
+  [[nodiscard]] bool done() const {
+    return offset_ >= chunk_->size();
+  }
+
+  /// Appends up to `max_records` packet records to `result`. The records
+  /// remain valid for the lifetime of the trace.
+  /// @returns An error if the trace is malformed or truncated.
+  caf::error read(size_t max_records, std::vector<trace_record>& result) {
+    // Not every PCAPNG block carries a packet, so we count the records.
+    const auto limit = result.size() + max_records;
+    while (result.size() < limit && !done()) {
+      auto err = format_ == file_format::pcap ? read_pcap_record(result)
+                                              : read_pcapng_block(result);
+      if (err)
+        return err;
+    }
+    return caf::none;
+  }
+
+private:
+  // -- implementation details -------------------------------------------------
+
+  // Block types of PCAPNG, see https://www.ietf.org/archive/id/
+  // draft-tuexen-opsawg-pcapng-05.html.
+  static constexpr uint32_t section_header_block = 0x0A0D0D0A;
+  static constexpr uint32_t interface_description_block = 0x00000001;
+  static constexpr uint32_t simple_packet_block = 0x00000003;
+  static constexpr uint32_t enhanced_packet_block = 0x00000006;
+  static constexpr uint32_t byte_order_magic = 0x1A2B3C4D;
+
+  /// The per-interface state of a PCAPNG section.
+  struct interface {
+    uint32_t link_type = 0;
+    uint32_t snaplen = 0;
+    uint8_t tsresol = 6;
+  };
+
+  explicit mapped_trace(chunk_ptr chunk) : chunk_{std::move(chunk)} {
+    // nop
+  }
+
+  template <class T>
+  [[nodiscard]] T load(size_t offset) const {
+    auto result = T{};
+    std::memcpy(&result, chunk_->data() + offset, sizeof(T));
+    return swapped_ ? detail::byte_swap(result) : result;
+  }
+
+  [[nodiscard]] std::span<const std::byte>
+  bytes(size_t offset, size_t size) const {
+    return as_bytes(chunk_).subspan(offset, size);
+  }
+
+  [[nodiscard]] caf::error malformed(std::string_view what) const {
+    return caf::make_error(ec::format_error,
+                           fmt::format("malformed trace file at offset {}: {}",
+                                       offset_, what));
+  }
+
+  caf::error read_file_header() {
+    constexpr size_t pcap_header_size = 24;
+    if (chunk_->size() < 4)
+      return malformed("missing file header");
+    switch (load<uint32_t>(0)) {
+      default:
+        return malformed("unknown magic number");
+      case 0xa1b2c3d4:
+        break;
+      case 0xa1b23c4d:
+        nanosecond_precision_ = true;
+        break;
+      case 0xd4c3b2a1:
+        swapped_ = true;
+        break;
+      case 0x4d3cb2a1:
+        swapped_ = true;
+        nanosecond_precision_ = true;
+        break;
+      case section_header_block:
+        // The byte order gets determined by every section header block.
+        format_ = file_format::pcapng;
+        return caf::none;
+    }
+    format_ = file_format::pcap;
+    if (chunk_->size() < pcap_header_size)
+      return malformed("truncated file header");
+    // The upper bits of the link type may carry the FCS length.
+    link_type_ = load<uint32_t>(20) & 0x0FFFFFFF;
+    offset_ = pcap_header_size;
+    return caf::none;
+  }
+
+  caf::error read_pcap_record(std::vector<trace_record>& result) {
+    constexpr size_t record_header_size = 16;
+    if (chunk_->size() - offset_ < record_header_size)
+      return malformed("truncated record header");
+    auto secs = std::chrono::seconds{load<uint32_t>(offset_)};
+    auto frac = load<uint32_t>(offset_ + 4);
+    auto caplen = size_t{load<uint32_t>(offset_ + 8)};
+    if (chunk_->size() - offset_ - record_header_size < caplen)
+      return malformed("truncated packet");
+    auto ts = time{} + secs;
+    ts += nanosecond_precision_
+            ? duration{std::chrono::nanoseconds{frac}}
+            : duration{std::chrono::microseconds{frac}};
+    result.push_back({
+      .timestamp = ts,
+      .data = bytes(offset_ + record_header_size, caplen),
+      .link_type = link_type_,
+    });
+    offset_ += record_header_size + caplen;
+    return caf::none;
+  }
+
+  caf::error read_pcapng_block(std::vector<trace_record>& result) {
+    constexpr size_t block_overhead = 12;
+    if (chunk_->size() - offset_ < block_overhead)
+      return malformed("truncated block header");
+    auto type = load<uint32_t>(offset_);
+    if (type == section_header_block) {
+      auto magic = uint32_t{};
+      std::memcpy(&magic, chunk_->data() + offset_ + 8, sizeof(magic));
+      if (magic == byte_order_magic)
+        swapped_ = false;
+      else if (magic == detail::byte_swap(byte_order_magic))
+        swapped_ = true;
+      else
+        return malformed("invalid byte-order magic");
+      interfaces_.clear();
+    }
+    auto length = size_t{load<uint32_t>(offset_ + 4)};
+    if (length < block_overhead || length % 4 != 0
+        || length > chunk_->size() - offset_)
+      return malformed("invalid block length");
+    auto body = offset_ + 8;
+    auto body_size = length - block_overhead;
+    switch (type) {
+      default:
+        // We skip all blocks that do not carry packets.
+        break;
+      case interface_description_block: {
+        if (body_size < 8)
+          return malformed("truncated interface description block");
+        auto iface = interface{
+          .link_type = load<uint16_t>(body),
+          .snaplen = load<uint32_t>(body + 4),
+        };
+        // Look for the if_tsresol option.
+        auto pos = body + 8;
+        while (pos + 4 <= body + body_size) {
+          auto code = load<uint16_t>(pos);
+          auto option_size = size_t{load<uint16_t>(pos + 2)};
+          if (code == 0)
+            break;
+          if (code == 9 && option_size == 1 && pos + 5 <= body + body_size)
+            iface.tsresol = std::to_integer<uint8_t>(chunk_->data()[pos + 4]);
+          pos += 4 + (option_size + 3) / 4 * 4;
+        }
+        interfaces_.push_back(iface);
+        break;
+      }
+      case enhanced_packet_block: {
+        if (body_size < 20)
+          return malformed("truncated enhanced packet block");
+        auto id = load<uint32_t>(body);
+        if (id >= interfaces_.size())
+          return malformed("packet refers to unknown interface");
+        auto ticks = uint64_t{load<uint32_t>(body + 4)} << 32
+                     | load<uint32_t>(body + 8);
+        auto caplen = size_t{load<uint32_t>(body + 12)};
+        if (caplen > body_size - 20)
+          return malformed("truncated packet");
+        last_timestamp_ = to_time(ticks, interfaces_[id].tsresol);
+        result.push_back({
+          .timestamp = last_timestamp_,
+          .data = bytes(body + 20, caplen),
+          .link_type = interfaces_[id].link_type,
+        });
+        break;
+      }
+      case simple_packet_block: {
+        if (body_size < 4)
+          return malformed("truncated simple packet block");
+        if (interfaces_.empty())
+          return malformed("packet refers to unknown interface");
+        auto caplen = std::min(size_t{load<uint32_t>(body)}, body_size - 4);
+        if (interfaces_[0].snaplen > 0)
+          caplen = std::min(caplen, size_t{interfaces_[0].snaplen});
+        // Simple packet blocks carry no timestamp, so we use the one of the
+        // preceding packet.
+        result.push_back({
+          .timestamp = last_timestamp_,
+          .data = bytes(body + 4, caplen),
+          .link_type = interfaces_[0].link_type,
+        });
+        break;
+      }
+    }
+    offset_ += length;
+    return caf::none;
+  }
+
+  /// Converts a PCAPNG timestamp with the resolution given by the if_tsresol
+  /// option into a time point.
+  static time to_time(uint64_t ticks, uint8_t tsresol) {
+    auto exponent = tsresol & 0x7f;
+    auto ns = uint64_t{0};
+    if (tsresol & 0x80) {
+      // Binary resolution, i.e., ticks are 2^-exponent seconds.
+      auto wide = static_cast<unsigned __int128>(ticks) * 1'000'000'000u;
+      ns = static_cast<uint64_t>(wide >> exponent);
+    } else {
+      // Decimal resolution, i.e., ticks are 10^-exponent seconds.
+      auto pow10 = [](int n) {
+        auto result = uint64_t{1};
+        while (n-- > 0)
+          result *= 10;
+        return result;
+      };
+      if (exponent <= 9)
+        ns = ticks * pow10(9 - exponent);
+      else if (exponent - 9 < 20)
+        ns = ticks / pow10(exponent - 9);
+    }
+    return time{} + std::chrono::nanoseconds{ns};
+  }
+
+  chunk_ptr chunk_;
+  size_t offset_ = 0;
+  file_format format_ = file_format::pcap;
+  bool swapped_ = false;
+  bool nanosecond_precision_ = false;
+  uint32_t link_type_ = link_type_ethernet;
+  std::vector<interface> interfaces_ = {};
+  time last_timestamp_ = {};
+};
+
+} // namespace vast::plugins::pcap
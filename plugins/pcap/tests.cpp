@@ -11,6 +11,7 @@
 #include <vast/concept/parseable/to.hpp>
 #include <vast/concept/parseable/vast/ip.hpp>
 #include <vast/config.hpp>
+#include <vast/chunk.hpp>
 #include <vast/defaults.hpp>
 #include <vast/error.hpp>
 #include <vast/format/reader_factory.hpp>
@@ -21,7 +22,11 @@
 #include <vast/test/fixtures/actor_system.hpp>
 #include <vast/test/test.hpp>
 
+#include "flow_table.hpp"
+#include "mapped_trace.hpp"
+
 #include <filesystem>
+#include <set>
 
 namespace vast::plugins::pcap {
 
@@ -61,8 +66,154 @@ struct fixture {
   }
 };
 
+flow make_test_flow(uint16_t src_port) {
+  return make_flow<port_type::tcp>(unbox(to<ip>("10.0.0.1")),
+                                   unbox(to<ip>("10.0.0.2")), src_port, 80);
+}
+
+// Appends an integer in host byte order.
+template <class T>
+void append(std::vector<std::byte>& buffer, T x) {
+  auto bytes = std::as_bytes(std::span{&x, 1});
+  buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+}
+
 } // namespace
 
+TEST(mapped pcapng trace) {
+  auto buffer = std::vector<std::byte>{};
+  // Section header block.
+  append<uint32_t>(buffer, 0x0A0D0D0A);
+  append<uint32_t>(buffer, 28);
+  append<uint32_t>(buffer, 0x1A2B3C4D);
+  append<uint16_t>(buffer, 1);
+  append<uint16_t>(buffer, 0);
+  append<int64_t>(buffer, -1);
+  append<uint32_t>(buffer, 28);
+  // Interface description block with a nanosecond resolution.
+  append<uint32_t>(buffer, 1);
+  append<uint32_t>(buffer, 28);
+  append<uint16_t>(buffer, 1);
+  append<uint16_t>(buffer, 0);
+  append<uint32_t>(buffer, 65535);
+  append<uint16_t>(buffer, 9);
+  append<uint16_t>(buffer, 1);
+  append<uint32_t>(buffer, 9);
+  append<uint32_t>(buffer, 28);
+  // Enhanced packet block with 3 bytes of data.
+  const auto ticks = uint64_t{1'500'000'000'123'456'789};
+  append<uint32_t>(buffer, 6);
+  append<uint32_t>(buffer, 36);
+  append<uint32_t>(buffer, 0);
+  append<uint32_t>(buffer, static_cast<uint32_t>(ticks >> 32));
+  append<uint32_t>(buffer, static_cast<uint32_t>(ticks));
+  append<uint32_t>(buffer, 3);
+  append<uint32_t>(buffer, 3);
+  append<uint32_t>(buffer, 0x00636261);
+  append<uint32_t>(buffer, 36);
+  auto trace = mapped_trace::make(chunk::make(std::move(buffer)));
+  REQUIRE_NOERROR(trace);
+  CHECK(trace->format() == mapped_trace::file_format::pcapng);
+  auto records = std::vector<trace_record>{};
+  REQUIRE_EQUAL(trace->read(10, records), caf::none);
+  CHECK(trace->done());
+  REQUIRE_EQUAL(records.size(), 1u);
+  CHECK_EQUAL(records[0].link_type, mapped_trace::link_type_ethernet);
+  CHECK_EQUAL(records[0].timestamp.time_since_epoch(),
+              std::chrono::nanoseconds{ticks});
+  auto data = std::string_view{
+    reinterpret_cast<const char*>(records[0].data.data()),
+    records[0].data.size()};
+  CHECK_EQUAL(data, "abc");
+}
+
+TEST(mapped trace with invalid magic) {
+  auto buffer = std::vector<std::byte>(32, std::byte{0x42});
+  CHECK(!mapped_trace::make(chunk::make(std::move(buffer))));
+}
+
+TEST(flow table insert and lookup) {
+  auto table = flow_table<int>{16, 10};
+  auto x = make_test_flow(1000);
+  CHECK_EQUAL(table.find(x), nullptr);
+  table.touch(x, 1, [] {
+    return 42;
+  });
+  REQUIRE_NOT_EQUAL(table.find(x), nullptr);
+  CHECK_EQUAL(*table.find(x), 42);
+  // Touching an existing flow must not create a new state.
+  table.touch(x, 2, [] {
+    return 0;
+  }) += 1;
+  CHECK_EQUAL(*table.find(x), 43);
+  CHECK_EQUAL(table.size(), 1u);
+  CHECK(table.erase(x));
+  CHECK(!table.erase(x));
+  CHECK_EQUAL(table.find(x), nullptr);
+  CHECK_EQUAL(table.size(), 0u);
+}
+
+TEST(flow table growth) {
+  auto table = flow_table<uint16_t>{10'000, 10};
+  for (uint16_t i = 0; i < 5'000; ++i)
+    table.touch(make_test_flow(i), 1, [=] {
+      return i;
+    });
+  CHECK_EQUAL(table.size(), 5'000u);
+  for (uint16_t i = 0; i < 5'000; i += 2)
+    CHECK(table.erase(make_test_flow(i)));
+  CHECK_EQUAL(table.size(), 2'500u);
+  for (uint16_t i = 1; i < 5'000; i += 2) {
+    auto* st = table.find(make_test_flow(i));
+    REQUIRE_NOT_EQUAL(st, nullptr);
+    CHECK_EQUAL(*st, i);
+  }
+}
+
+TEST(flow table expiry) {
+  auto table = flow_table<int>{16, 5};
+  auto make = [] {
+    return 0;
+  };
+  auto x = make_test_flow(1);
+  auto y = make_test_flow(2);
+  table.touch(x, 1, make);
+  table.touch(y, 1, make);
+  table.touch(y, 4, make);
+  CHECK_EQUAL(table.expire(6), 0u);
+  CHECK_EQUAL(table.size(), 2u);
+  // The flow x was last seen at 1, so it expires once it's older than 5.
+  CHECK_EQUAL(table.expire(7), 1u);
+  CHECK_EQUAL(table.find(x), nullptr);
+  CHECK_NOT_EQUAL(table.find(y), nullptr);
+  CHECK_EQUAL(table.expire(10), 1u);
+  CHECK_EQUAL(table.size(), 0u);
+}
+
+TEST(flow table shrink to max size) {
+  auto table = flow_table<int>{3, 60};
+  auto make = [] {
+    return 0;
+  };
+  for (uint16_t i = 0; i < 3; ++i)
+    table.touch(make_test_flow(i), i + 1, make);
+  table.expire(3);
+  // Evicts the oldest flow to make room for one more.
+  CHECK_EQUAL(table.shrink_to_max_size(), 1u);
+  CHECK_EQUAL(table.size(), 2u);
+  CHECK_EQUAL(table.find(make_test_flow(0)), nullptr);
+  CHECK_NOT_EQUAL(table.find(make_test_flow(1)), nullptr);
+  CHECK_NOT_EQUAL(table.find(make_test_flow(2)), nullptr);
+}
+
+TEST(symmetric flow hash) {
+  auto x = make_flow<port_type::udp>(unbox(to<ip>("10.0.0.1")),
+                                     unbox(to<ip>("10.0.0.2")), 1234, 53);
+  auto y = make_flow<port_type::udp>(unbox(to<ip>("10.0.0.2")),
+                                     unbox(to<ip>("10.0.0.1")), 53, 1234);
+  CHECK_EQUAL(symmetric_hash(x), symmetric_hash(y));
+}
+
 FIXTURE_SCOPE(pcap_tests, fixture)
 
 TEST(PCAP read 1) {
@@ -153,6 +304,77 @@ TEST(PCAP read 2) {
   REQUIRE_EQUAL(writer->get()->write(slice), caf::none);
 }
 
+TEST(PCAP read with multiple workers) {
+  // Spread flow tracking over two worker threads. The workers produce one
+  // slice each, and the events of different flows may be interleaved
+  // differently than in the trace.
+  caf::settings settings;
+  caf::put(settings, "vast.import.read", artifacts::traces::nmap_vsn);
+  caf::put(settings, "vast.import.pcap.cutoff", static_cast<uint64_t>(-1));
+  caf::put(settings, "vast.import.pcap.max-flows", static_cast<size_t>(5));
+  caf::put(settings, "vast.import.pcap.workers", static_cast<size_t>(2));
+  caf::put(settings, "vast.import.batch-timeout", "0s");
+  auto reader = format::reader::make("pcap", settings);
+  REQUIRE(reader);
+  auto rows = size_t{0};
+  auto ids = std::multiset<std::string>{};
+  auto add_slice = [&](const table_slice& x) {
+    REQUIRE_NOT_EQUAL(x.encoding(), table_slice_encoding::none);
+    CHECK_EQUAL(x.schema().name(), "pcap.packet");
+    auto idx = caf::get<record_type>(x.schema()).resolve_key("community_id");
+    REQUIRE(idx);
+    auto column = table_slice_column{
+      x, caf::get<record_type>(x.schema()).flat_index(*idx)};
+    for (size_t row = 0; row < x.rows(); ++row)
+      ids.insert(caf::get<std::string>(materialize(column[row])));
+    rows += x.rows();
+  };
+  auto [err, produced] = reader->get()->read(std::numeric_limits<size_t>::max(),
+                                             100, add_slice);
+  CHECK_EQUAL(err, ec::end_of_input);
+  CHECK_EQUAL(produced, 44u);
+  CHECK_EQUAL(rows, 44u);
+  CHECK_EQUAL(ids, std::multiset<std::string>(std::begin(community_ids),
+                                              std::end(community_ids)));
+}
+
+TEST(PCAP read memory-mapped) {
+  // Reading a memory-mapped trace in multiple segments must yield the same
+  // events in the same order as reading it via libpcap.
+  caf::settings settings;
+  caf::put(settings, "vast.import.read", artifacts::traces::nmap_vsn);
+  caf::put(settings, "vast.import.pcap.cutoff", static_cast<uint64_t>(-1));
+  caf::put(settings, "vast.import.pcap.max-flows", static_cast<size_t>(5));
+  caf::put(settings, "vast.import.pcap.mmap", true);
+  caf::put(settings, "vast.import.pcap.workers", static_cast<size_t>(3));
+  caf::put(settings, "vast.import.batch-timeout", "0s");
+  auto reader = format::reader::make("pcap", settings);
+  REQUIRE(reader);
+  auto slices = std::vector<table_slice>{};
+  auto add_slice = [&](const table_slice& x) {
+    REQUIRE_NOT_EQUAL(x.encoding(), table_slice_encoding::none);
+    slices.push_back(x);
+  };
+  auto [err, produced] = reader->get()->read(std::numeric_limits<size_t>::max(),
+                                             20, add_slice);
+  CHECK_EQUAL(err, ec::end_of_input);
+  REQUIRE_EQUAL(produced, 44u);
+  auto row = size_t{0};
+  for (const auto& slice : slices) {
+    CHECK_LESS_EQUAL(slice.rows(), 20u);
+    auto&& schema = slice.schema();
+    CHECK_EQUAL(schema.name(), "pcap.packet");
+    auto idx = caf::get<record_type>(schema).resolve_key("community_id");
+    REQUIRE(idx);
+    auto community_id_column = table_slice_column{
+      slice, caf::get<record_type>(schema).flat_index(*idx)};
+    for (size_t i = 0; i < slice.rows(); ++i)
+      CHECK_VARIANT_EQUAL(materialize(community_id_column[i]),
+                          community_ids[row++]);
+  }
+  CHECK_EQUAL(row, 44u);
+}
+
 FIXTURE_SCOPE_END()
 
 } // namespace vast::plugins::pcap
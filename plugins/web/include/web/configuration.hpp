@@ -22,6 +22,7 @@ struct configuration {
       {"bind", vast::string_type{}},    {"port", vast::int64_type{}},
       {"mode", vast::string_type{}},    {"certfile", vast::string_type{}},
       {"keyfile", vast::string_type{}}, {"web-root", vast::string_type{}},
+      {"threads", vast::int64_type{}},  {"workers", vast::int64_type{}},
     };
     return result;
   }
@@ -32,7 +33,8 @@ struct configuration {
       .pretty_name("vast.plugins.rest.configuration")
       .fields(f.field("bind-address", x.bind_address), f.field("port", x.port),
               f.field("mode", x.mode), f.field("certfile", x.certfile),
-              f.field("keyfile", x.keyfile), f.field("web-root", x.web_root));
+              f.field("keyfile", x.keyfile), f.field("web-root", x.web_root),
+              f.field("threads", x.threads), f.field("workers", x.workers));
   }
 
   enum class server_mode {
@@ -48,6 +50,8 @@ struct configuration {
   std::string bind_address = "127.0.0.1";
   std::string web_root;
   int port = 42001;
+  int threads = 1;
+  int workers = 4;
 };
 
 // The resolved and validated configuration that gets used at runtime.
@@ -85,6 +89,15 @@ public:
 
   /// The path from which to serve static files.
   std::optional<std::filesystem::path> webroot = {};
+
+  /// The number of threads that run the I/O event loop. A single thread uses
+  /// restinio's single-threaded traits, which avoid the synchronization
+  /// overhead of strands.
+  size_t io_threads = 1;
+
+  /// The number of actors that parse and dispatch requests concurrently,
+  /// independent of the I/O threads.
+  size_t request_workers = 4;
 };
 
 /// Validate that the user-provided configuration makes sense.
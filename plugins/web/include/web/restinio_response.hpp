@@ -16,6 +16,9 @@
 #include <restinio/request_handler.hpp>
 #include <restinio/router/express.hpp>
 
+#include <variant>
+#include <vector>
+
 namespace vast::plugins::web {
 
 // Note: If desired, `restinio` provides users to embed arbitrary `extra_data`
@@ -24,8 +27,13 @@ using request_handle_t
   = restinio::generic_request_handle_t<restinio::no_extra_data_factory_t::data_t>;
 using response_t
   = restinio::response_builder_t<restinio::user_controlled_output_t>;
+using chunked_response_t
+  = restinio::response_builder_t<restinio::chunked_output_t>;
 using route_params_t = restinio::router::route_params_t;
 
+// Responses with a streaming content type use chunked transfer encoding and
+// may get flushed incrementally; all other responses get sent at once with a
+// known content length when the last reference to them goes away.
 class restinio_response final : public vast::http_response {
 public:
   restinio_response(request_handle_t&& handle, route_params_t&& route_params,
@@ -39,11 +47,18 @@ public:
 
   void append(std::string body) override;
 
+  void append_chunk(chunk_ptr body) override;
+
+  void flush(std::function<void(caf::error)> on_written) override;
+
   void abort(uint16_t error_code, std::string message) override;
 
   // Add a custom response header.
   void add_header(std::string field, std::string value);
 
+  // Get the content type of the response as negotiated with the client.
+  [[nodiscard]] http_content_type content_type() const;
+
   // Get a handle to the original request.
   [[nodiscard]] const request_handle_t& request() const;
 
@@ -51,10 +66,21 @@ public:
   [[nodiscard]] const route_params_t& route_params() const;
 
 private:
+  void append_item(restinio::writable_item_t item, size_t size);
+
   request_handle_t request_;
   route_params_t route_params_;
-  response_t response_;
+  http_content_type content_type_ = {};
+  std::variant<response_t, chunked_response_t> response_;
+  // The body parts of a chunked response that were not yet flushed.
+  std::vector<restinio::writable_item_t> pending_ = {};
   size_t body_size_ = {};
+  bool flushed_ = false;
+  // Set once the response was aborted, after which appending is a no-op.
+  bool aborted_ = false;
+  // Set once `done()` was called on the response, which must happen exactly
+  // once.
+  bool done_ = false;
 };
 
 } // namespace vast::plugins::web
@@ -33,10 +33,30 @@ using tls_traits_t = restinio::single_thread_tls_traits_t<
 /// The TLS server class.
 using tls_server_t = restinio::http_server_t<tls_traits_t>;
 
-/// A class representing either a dev or a TLS server.
+/// Traits class for the dev server when running on multiple I/O threads.
+struct mt_dev_traits_t : public restinio::default_traits_t {
+  using request_handler_t = restinio::router::express_router_t<>;
+};
+
+/// The multi-threaded dev server class.
+using mt_dev_server_t = restinio::http_server_t<mt_dev_traits_t>;
+
+/// Traits class for the TLS server when running on multiple I/O threads.
+using mt_tls_traits_t
+  = restinio::tls_traits_t<restinio::asio_timer_manager_t,
+                           restinio::shared_ostream_logger_t,
+                           restinio::router::express_router_t<>>;
+
+/// The multi-threaded TLS server class.
+using mt_tls_server_t = restinio::http_server_t<mt_tls_traits_t>;
+
+/// A class representing either a dev or a TLS server, each of which uses
+/// thread-safe traits only when running on multiple I/O threads.
 // Need to work with pointers since `restinio::http_server_t` is immovable.
 using server_t
-  = std::variant<std::unique_ptr<tls_server_t>, std::unique_ptr<dev_server_t>>;
+  = std::variant<std::unique_ptr<tls_server_t>, std::unique_ptr<dev_server_t>,
+                 std::unique_ptr<mt_tls_server_t>,
+                 std::unique_ptr<mt_dev_server_t>>;
 
 server_t make_server(server_config config, std::unique_ptr<router_t> router,
                      restinio::io_context_holder_t io_context);
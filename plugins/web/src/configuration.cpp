@@ -90,6 +90,18 @@ caf::expected<server_config> convert_and_validate(configuration config) {
         ec::invalid_argument,
         fmt::format("can only bind to localhost in {} mode", config.mode));
   result.port = config.port;
+  if (config.threads < 1)
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("number of threads must be positive, "
+                                       "got {}",
+                                       config.threads));
+  result.io_threads = config.threads;
+  if (config.workers < 1)
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("number of workers must be positive, "
+                                       "got {}",
+                                       config.workers));
+  result.request_workers = config.workers;
   return result;
 }
 
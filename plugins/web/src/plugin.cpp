@@ -62,7 +62,10 @@ class plugin final : public virtual command_plugin,
         .add<std::string>("keyfile", "path to TLS private key")
         .add<std::string>("root", "document root of the server")
         .add<std::string>("bind", "listen address of server")
-        .add<int64_t>("port", "listen port"));
+        .add<int64_t>("port", "listen port")
+        .add<int64_t>("threads", "number of I/O threads")
+        .add<int64_t>("workers", "number of concurrent request "
+                                 "dispatchers"));
     rest_command->add_subcommand("generate-token", "generate auth token",
                                  command::opts("?plugins.web.token"));
     rest_command->add_subcommand("openapi", "print openAPI spec",
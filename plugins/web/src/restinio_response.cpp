@@ -8,51 +8,181 @@
 
 #include "web/restinio_response.hpp"
 
+#include <vast/error.hpp>
+#include <vast/logger.hpp>
+
 namespace vast::plugins::web {
 
+namespace {
+
+// Exposes the contents of a chunk to the response body without copying it.
+struct chunk_body {
+  [[nodiscard]] const std::byte* data() const noexcept {
+    return chunk->data();
+  }
+
+  [[nodiscard]] size_t size() const noexcept {
+    return chunk->size();
+  }
+
+  chunk_ptr chunk;
+};
+
+} // namespace
+
 static std::string content_type_to_string(vast::http_content_type type) {
   switch (type) {
     case http_content_type::json:
       return "application/json; charset=utf-8";
     case http_content_type::ldjson:
       return "application/ld+json; charset=utf-8";
+    case http_content_type::arrow_stream:
+      return std::string{to_media_type(type)};
+    case http_content_type::ndjson:
+    case http_content_type::event_stream:
+      return fmt::format("{}; charset=utf-8", to_media_type(type));
   }
   // Unreachable
   return "application/octet-stream";
 }
 
+static std::variant<response_t, chunked_response_t>
+make_response(const request_handle_t& request, http_content_type type) {
+  // Note that ownership of the `connection` is transferred when creating a
+  // response.
+  if (is_streaming(type)) {
+    auto result = request->create_response<restinio::chunked_output_t>();
+    // The date needs to be part of the header, which gets sent with the
+    // first flush already.
+    result.append_header_date_field();
+    if (type == http_content_type::event_stream)
+      result.append_header(restinio::http_field::cache_control, "no-cache");
+    return result;
+  }
+  return request->create_response<restinio::user_controlled_output_t>();
+}
+
+static http_content_type
+negotiate(const request_handle_t& request, const rest_endpoint& endpoint) {
+  auto accept = request->header().opt_value_of(restinio::http_field_t::accept);
+  return negotiate_content_type(endpoint, accept ? *accept : "");
+}
+
 restinio_response::restinio_response(request_handle_t&& handle,
                                      route_params_t&& route_params,
                                      const rest_endpoint& endpoint)
   : request_(std::move(handle)),
     route_params_(std::move(route_params)),
-    // Note that ownership of the `connection` is transferred when creating a
-    // response.
-    response_(request_->create_response<restinio::user_controlled_output_t>()) {
-  response_.append_header(restinio::http_field::content_type,
-                          content_type_to_string(endpoint.content_type));
+    content_type_(negotiate(request_, endpoint)),
+    response_(make_response(request_, content_type_)) {
+  std::visit(
+    [&](auto& response) {
+      response.append_header(restinio::http_field::content_type,
+                             content_type_to_string(content_type_));
+    },
+    response_);
 }
 
 restinio_response::~restinio_response() {
   // `done()` must only be called exactly once.
-  response_.append_header_date_field().set_content_length(body_size_).done();
+  if (auto* response = std::get_if<response_t>(&response_)) {
+    response->append_header_date_field()
+      .set_content_length(body_size_)
+      .done();
+    return;
+  }
+  if (done_)
+    return;
+  auto& response = std::get<chunked_response_t>(response_);
+  for (auto& item : std::exchange(pending_, {}))
+    response.append_chunk(std::move(item));
+  response.done();
 }
 
 void restinio_response::append(std::string body) {
-  body_size_ += body.size();
-  response_.append_body(std::move(body));
+  auto size = body.size();
+  append_item(restinio::writable_item_t{std::move(body)}, size);
+}
+
+void restinio_response::append_chunk(chunk_ptr body) {
+  if (!body || body->size() == 0)
+    return;
+  auto size = body->size();
+  append_item(restinio::writable_item_t{std::make_shared<chunk_body>(
+                chunk_body{std::move(body)})},
+              size);
+}
+
+void restinio_response::append_item(restinio::writable_item_t item,
+                                    size_t size) {
+  // Data that arrives after an abort must not follow the error message.
+  if (aborted_)
+    return;
+  body_size_ += size;
+  if (auto* response = std::get_if<response_t>(&response_))
+    response->append_body(std::move(item));
+  else
+    pending_.push_back(std::move(item));
+}
+
+void restinio_response::flush(std::function<void(caf::error)> on_written) {
+  auto* response = std::get_if<chunked_response_t>(&response_);
+  if (!response)
+    return http_response::flush(std::move(on_written));
+  for (auto& item : std::exchange(pending_, {}))
+    response->append_chunk(std::move(item));
+  flushed_ = true;
+  response->flush([on_written = std::move(on_written)](
+                    const restinio::asio_ns::error_code& error) {
+    if (!on_written)
+      return;
+    if (error)
+      on_written(caf::make_error(ec::system_error,
+                                 fmt::format("failed to write response: {}",
+                                             error.message())));
+    else
+      on_written(caf::error{});
+  });
 }
 
 void restinio_response::abort(uint16_t error_code, std::string message) {
-  response_.header().status_code(restinio::http_status_code_t{error_code});
+  aborted_ = true;
+  if (auto* response = std::get_if<response_t>(&response_)) {
+    response->header().status_code(restinio::http_status_code_t{error_code});
+    body_size_ = message.size();
+    response->set_body(std::move(message));
+    // TODO: Proactively call `done()` here, and add some flag to prevent
+    // it from being called multiple times.
+    return;
+  }
+  auto& response = std::get<chunked_response_t>(response_);
+  pending_.clear();
+  // A chunked response that was flushed already sent its status line, so the
+  // client would mistake an appended error message for a part of the result.
+  // We end the response and close the connection instead.
+  if (flushed_) {
+    VAST_WARN("aborting a partially sent response with status {}: {}",
+              error_code, message);
+    response.connection_close();
+    response.done();
+    done_ = true;
+    return;
+  }
+  response.header().status_code(restinio::http_status_code_t{error_code});
   body_size_ = message.size();
-  response_.set_body(std::move(message));
-  // TODO: Proactively call `done()` here, and add some flag to prevent
-  // it from being called multiple times.
+  pending_.emplace_back(std::move(message));
 }
 
 void restinio_response::add_header(std::string field, std::string value) {
-  response_.append_header(std::move(field), std::move(value));
+  std::visit(
+    [&](auto& response) {
+      response.append_header(std::move(field), std::move(value));
+    },
+    response_);
+}
+
+http_content_type restinio_response::content_type() const {
+  return content_type_;
 }
 
 auto restinio_response::request() const -> const request_handle_t& {
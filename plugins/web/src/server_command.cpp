@@ -30,6 +30,7 @@
 
 #include <caf/event_based_actor.hpp>
 #include <caf/scoped_actor.hpp>
+#include <caf/send.hpp>
 #include <caf/stateful_actor.hpp>
 #include <restinio/all.hpp>
 #include <restinio/message_builders.hpp>
@@ -37,6 +38,9 @@
 #include <restinio/tls.hpp>
 #include <restinio/websocket/websocket.hpp>
 
+#include <atomic>
+#include <thread>
+
 // Needed to forward incoming requests to the request_dispatcher
 
 namespace vast::plugins::web {
@@ -215,9 +219,11 @@ request_dispatcher_actor::behavior_type request_dispatcher(
           params[name] = std::move(*typed_value);
         }
       }
+      auto content_type = response->content_type();
       auto vast_request = vast::http_request{
         .params = std::move(params),
         .response = std::move(response),
+        .content_type = content_type,
       };
       self->send(handler, atom::http_request_v, endpoint.endpoint_id,
                  std::move(vast_request));
@@ -225,26 +231,49 @@ request_dispatcher_actor::behavior_type request_dispatcher(
   };
 }
 
-void setup_route(caf::scoped_actor& self, std::unique_ptr<router_t>& router,
-                 std::string_view prefix, request_dispatcher_actor dispatcher,
+/// Distributes requests across a pool of request dispatchers. Multiple I/O
+/// threads may pick dispatchers concurrently.
+class dispatcher_pool {
+public:
+  explicit dispatcher_pool(std::vector<request_dispatcher_actor> dispatchers)
+    : dispatchers_{std::move(dispatchers)} {
+    VAST_ASSERT(!dispatchers_.empty());
+  }
+
+  const request_dispatcher_actor& next() {
+    auto index = next_.fetch_add(1, std::memory_order_relaxed);
+    return dispatchers_[index % dispatchers_.size()];
+  }
+
+  const std::vector<request_dispatcher_actor>& dispatchers() const {
+    return dispatchers_;
+  }
+
+private:
+  std::vector<request_dispatcher_actor> dispatchers_;
+  std::atomic<size_t> next_ = 0;
+};
+
+void setup_route(std::unique_ptr<router_t>& router, std::string_view prefix,
+                 std::shared_ptr<dispatcher_pool> dispatchers,
                  const server_config& config, vast::rest_endpoint endpoint,
                  system::rest_handler_actor handler) {
   auto method = to_restinio_method(endpoint.method);
   auto path = format_api_route(endpoint, prefix);
   VAST_VERBOSE("setting up route {}", path);
   // The handler just injects the request into the actor system, the
-  // actual processing starts in the request_dispatcher.
+  // actual processing starts in the request_dispatcher. Note that the
+  // handler may run on any of the I/O threads concurrently.
   router->add_handler(
     method, path,
-    [=, &self](request_handle_t req,
-               restinio::router::route_params_t route_params)
+    [=](request_handle_t req, restinio::router::route_params_t route_params)
       -> restinio::request_handling_status_t {
       auto response = std::make_shared<restinio_response>(
         std::move(req), std::move(route_params), endpoint);
       for (auto const& [field, value] : config.response_headers)
         response->add_header(field, value);
-      self->send(dispatcher, atom::request_v, std::move(response),
-                 std::move(endpoint), handler);
+      caf::anon_send(dispatchers->next(), atom::request_v, std::move(response),
+                     endpoint, handler);
       // TODO: Measure if always accepting introduces a noticeable
       // overhead and if so whether we can reject immediately in
       // some cases here.
@@ -304,11 +333,18 @@ auto server_command(const vast::invocation& inv, caf::actor_system& system)
     VAST_ERROR("failed to get web component: {}", authenticator.error());
     return caf::make_message(std::move(authenticator.error()));
   }
-  auto dispatcher
-    = self->spawn(request_dispatcher, *server_config, *authenticator);
+  // Parsing and dispatching requests happens in a pool of actors so that
+  // expensive requests do not hold up others.
+  auto dispatchers = std::vector<request_dispatcher_actor>{};
+  for (size_t i = 0; i < server_config->request_workers; ++i) {
+    auto dispatcher
+      = self->spawn(request_dispatcher, *server_config, *authenticator);
+    VAST_ASSERT_CHEAP(dispatcher);
+    dispatchers.push_back(std::move(dispatcher));
+  }
+  auto pool = std::make_shared<dispatcher_pool>(std::move(dispatchers));
   // Set up router.
   auto router = std::make_unique<router_t>();
-  VAST_ASSERT_CHEAP(dispatcher);
   // Set up API routes from plugins.
   std::vector<system::rest_handler_actor> handlers;
   std::vector<std::string> api_routes;
@@ -326,8 +362,8 @@ auto server_command(const vast::invocation& inv, caf::actor_system& system)
         continue;
       }
       api_routes.push_back(format_api_route(endpoint, rest_plugin->prefix()));
-      setup_route(self, router, rest_plugin->prefix(), dispatcher,
-                  *server_config, std::move(endpoint), handler);
+      setup_route(router, rest_plugin->prefix(), pool,
+                  *server_config, endpoint, handler);
     }
   }
   // Set up non-API routes.
@@ -401,13 +437,16 @@ auto server_command(const vast::invocation& inv, caf::actor_system& system)
                }},
                server);
   });
-  // Launch the thread on which the server will work.
-  std::thread server_thread{[&] {
-    auto const* scheme = server_config->require_tls ? "https" : "http";
-    VAST_INFO("server listening on on {}://{}:{}", scheme,
-              server_config->bind_address, server_config->port);
-    io_context.run();
-  }};
+  // Launch the threads on which the server will work.
+  auto const* scheme = server_config->require_tls ? "https" : "http";
+  VAST_INFO("server listening on on {}://{}:{} with {} I/O thread(s)", scheme,
+            server_config->bind_address, server_config->port,
+            server_config->io_threads);
+  auto server_threads = std::vector<std::thread>{};
+  for (size_t i = 0; i < server_config->io_threads; ++i)
+    server_threads.emplace_back([&] {
+      io_context.run();
+    });
   // Run main loop.
   caf::error err;
   auto stop = false;
@@ -439,10 +478,12 @@ auto server_command(const vast::invocation& inv, caf::actor_system& system)
       },
     },
     server);
-  self->send_exit(dispatcher, caf::exit_reason::user_shutdown);
+  for (const auto& dispatcher : pool->dispatchers())
+    self->send_exit(dispatcher, caf::exit_reason::user_shutdown);
   for (auto& handler : handlers)
     self->send_exit(handler, caf::exit_reason::user_shutdown);
-  server_thread.join();
+  for (auto& thread : server_threads)
+    thread.join();
   return caf::make_message(std::move(err));
 }
 
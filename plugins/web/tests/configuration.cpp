@@ -101,3 +101,33 @@ web:
   auto invalid_config = vast::plugins::web::configuration{};
   CHECK_ERROR(convert(invalid_data, invalid_config));
 }
+
+TEST(thread config validation) {
+  auto record = extract_config(R"_(
+web:
+  bind: 127.0.0.1
+  port: 8000
+  mode: dev
+  threads: 4
+  workers: 8
+  )_");
+  auto config = vast::plugins::web::configuration{};
+  CHECK_EQUAL(validate(record, vast::plugins::web::configuration::schema(),
+                       vast::validate::strict),
+              caf::error{});
+  REQUIRE_EQUAL(convert(record, config), caf::error{});
+  CHECK_EQUAL(config.threads, 4);
+  CHECK_EQUAL(config.workers, 8);
+  auto server_config = convert_and_validate(config);
+  REQUIRE_NOERROR(server_config);
+  CHECK_EQUAL(server_config->io_threads, 4u);
+  CHECK_EQUAL(server_config->request_workers, 8u);
+  // The defaults keep the single-threaded server.
+  auto defaults = convert_and_validate(vast::plugins::web::configuration{
+    .mode = "dev",
+  });
+  REQUIRE_NOERROR(defaults);
+  CHECK_EQUAL(defaults->io_threads, 1u);
+  config.threads = 0;
+  CHECK_ERROR(convert_and_validate(config));
+}
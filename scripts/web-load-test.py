@@ -0,0 +1,124 @@
+#! /usr/bin/env python3
+
+# Measures the request latency of the REST API under concurrent load.
+#
+# Every client keeps a persistent connection and sends its requests back to
+# back, so the number of clients is the number of concurrent requests.
+#
+# Example usage:
+# vast web server --mode=dev --threads=4 &
+# ./scripts/web-load-test.py --clients 200 --requests 20 \
+#     --path '/api/v0/export?expression=:ip&limit=100'
+
+import argparse
+import http.client
+import ssl
+import statistics
+import sys
+import threading
+import time
+import urllib.parse
+
+
+def percentile(sorted_values, p):
+    if not sorted_values:
+        return float("nan")
+    index = min(len(sorted_values) - 1, int(p / 100 * len(sorted_values)))
+    return sorted_values[index]
+
+
+def run_client(args, url, latencies, errors, lock, barrier):
+    if url.scheme == "https":
+        context = ssl.create_default_context()
+        if args.insecure:
+            context.check_hostname = False
+            context.verify_mode = ssl.CERT_NONE
+        connection = http.client.HTTPSConnection(
+            url.hostname, url.port or 443, timeout=args.timeout, context=context
+        )
+    else:
+        connection = http.client.HTTPConnection(
+            url.hostname, url.port or 80, timeout=args.timeout
+        )
+    headers = {"Accept": args.accept}
+    if args.token:
+        headers["X-VAST-Token"] = args.token
+    body = None
+    if args.body is not None:
+        body = args.body.encode()
+        headers["Content-Type"] = "application/json"
+    barrier.wait()
+    local_latencies = []
+    local_errors = 0
+    for _ in range(args.requests):
+        start = time.perf_counter()
+        try:
+            connection.request(args.method, args.path, body=body, headers=headers)
+            response = connection.getresponse()
+            response.read()
+            if response.status != 200:
+                local_errors += 1
+                continue
+        except (OSError, http.client.HTTPException):
+            local_errors += 1
+            connection.close()
+            continue
+        local_latencies.append(time.perf_counter() - start)
+    connection.close()
+    with lock:
+        latencies.extend(local_latencies)
+        errors[0] += local_errors
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Measure REST API latencies under concurrent load."
+    )
+    parser.add_argument("--url", default="http://127.0.0.1:42001")
+    parser.add_argument("--path", default="/api/v0/status")
+    parser.add_argument("--method", default="GET")
+    parser.add_argument("--body", help="JSON request body")
+    parser.add_argument("--accept", default="application/json")
+    parser.add_argument("--token", help="the value of the X-VAST-Token header")
+    parser.add_argument("--clients", type=int, default=100)
+    parser.add_argument("--requests", type=int, default=10,
+                        help="number of requests per client")
+    parser.add_argument("--timeout", type=float, default=60.0)
+    parser.add_argument("--insecure", action="store_true",
+                        help="skip TLS certificate verification")
+    args = parser.parse_args()
+    url = urllib.parse.urlparse(args.url)
+    latencies = []
+    errors = [0]
+    lock = threading.Lock()
+    barrier = threading.Barrier(args.clients + 1)
+    threads = [
+        threading.Thread(
+            target=run_client, args=(args, url, latencies, errors, lock, barrier)
+        )
+        for _ in range(args.clients)
+    ]
+    for thread in threads:
+        thread.start()
+    barrier.wait()
+    start = time.perf_counter()
+    for thread in threads:
+        thread.join()
+    elapsed = time.perf_counter() - start
+    latencies.sort()
+    total = len(latencies) + errors[0]
+    print(f"requests:   {total} ({errors[0]} failed)")
+    print(f"clients:    {args.clients}")
+    print(f"duration:   {elapsed:.2f} s")
+    print(f"throughput: {len(latencies) / elapsed:.1f} req/s")
+    if latencies:
+        print(f"mean:       {statistics.mean(latencies) * 1e3:.1f} ms")
+        print(f"p50:        {percentile(latencies, 50) * 1e3:.1f} ms")
+        print(f"p90:        {percentile(latencies, 90) * 1e3:.1f} ms")
+        print(f"p99:        {percentile(latencies, 99) * 1e3:.1f} ms")
+        print(f"max:        {latencies[-1] * 1e3:.1f} ms")
+    return 1 if errors[0] > 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())